@@ -71,6 +71,7 @@
 
 #include "spandsp/private/logging.h"
 #include "spandsp/private/queue.h"
+#include "spandsp/private/power_meter.h"
 #include "spandsp/private/tone_detect.h"
 #include "spandsp/private/tone_generate.h"
 #include "spandsp/private/dtmf.h"
@@ -52,6 +52,7 @@
 #include "spandsp/logging.h"
 #include "spandsp/fast_convert.h"
 #include "spandsp/queue.h"
+#include "spandsp/power_meter.h"
 #include "spandsp/complex.h"
 #include "spandsp/dds.h"
 #include "spandsp/tone_detect.h"
@@ -62,6 +63,7 @@
 
 #include "spandsp/private/logging.h"
 #include "spandsp/private/queue.h"
+#include "spandsp/private/power_meter.h"
 #include "spandsp/private/tone_generate.h"
 #include "spandsp/private/bell_r2_mf.h"
 
@@ -201,24 +203,24 @@ static const mf_digit_tones_t socotel_tones[] =
 static char socotel_mf_tone_codes[] = "1234567890ABCDEFG";
 #endif
 
-#define BELL_MF_SAMPLES_PER_BLOCK   120
+#define BELL_MF_THRESHOLD           -30.5f      /* In dBm0 */
 
-#define R2_MF_SAMPLES_PER_BLOCK     133
+#define R2_MF_THRESHOLD             -36.5f      /* In dBm0 */
 
 #if defined(SPANDSP_USE_FIXED_POINT)
-static const int bell_mf_threshold              = goertzel_threshold_dbm0(BELL_MF_SAMPLES_PER_BLOCK, -30.5f);
+static const int bell_mf_threshold              = goertzel_threshold_dbm0(BELL_MF_SAMPLES_PER_BLOCK, BELL_MF_THRESHOLD);
 static const float bell_mf_twist                = db_to_power_ratio(6.0f);
 static const float bell_mf_relative_peak        = db_to_power_ratio(11.0f);
 
-static const int r2_mf_threshold                = goertzel_threshold_dbm0(R2_MF_SAMPLES_PER_BLOCK, -36.5f);
+static const int r2_mf_threshold                = goertzel_threshold_dbm0(R2_MF_SAMPLES_PER_BLOCK, R2_MF_THRESHOLD);
 static const float r2_mf_twist                  = db_to_power_ratio(7.0f);
 static const float r2_mf_relative_peak          = db_to_power_ratio(11.0f);
 #else
-static const float bell_mf_threshold            = goertzel_threshold_dbm0(BELL_MF_SAMPLES_PER_BLOCK, -30.5f);
+static const float bell_mf_threshold            = goertzel_threshold_dbm0(BELL_MF_SAMPLES_PER_BLOCK, BELL_MF_THRESHOLD);
 static const float bell_mf_twist                = db_to_power_ratio(6.0f);
 static const float bell_mf_relative_peak        = db_to_power_ratio(11.0f);
 
-static const float r2_mf_threshold              = goertzel_threshold_dbm0(R2_MF_SAMPLES_PER_BLOCK, -36.5f);
+static const float r2_mf_threshold              = goertzel_threshold_dbm0(R2_MF_SAMPLES_PER_BLOCK, R2_MF_THRESHOLD);
 static const float r2_mf_twist                  = db_to_power_ratio(7.0f);
 static const float r2_mf_relative_peak          = db_to_power_ratio(11.0f);
 #endif
@@ -484,17 +486,37 @@ SPAN_DECLARE(int) r2_mf_tx_free(r2_mf_tx_state_t *s)
 }
 /*- End of function --------------------------------------------------------*/
 
+static void mf_rx_goertzels(goertzel_state_t out[6], const int16_t amp[], int len)
+{
+    int j;
+#if defined(SPANDSP_USE_FIXED_POINT)
+    int16_t xamp;
+#else
+    float xamp;
+#endif
+
+    for (j = 0;  j < len;  j++)
+    {
+        xamp = goertzel_preadjust_amp(amp[j]);
+        goertzel_samplex(&out[0], xamp);
+        goertzel_samplex(&out[1], xamp);
+        goertzel_samplex(&out[2], xamp);
+        goertzel_samplex(&out[3], xamp);
+        goertzel_samplex(&out[4], xamp);
+        goertzel_samplex(&out[5], xamp);
+    }
+    /*endfor*/
+}
+/*- End of function --------------------------------------------------------*/
+
 SPAN_DECLARE(int) bell_mf_rx(bell_mf_rx_state_t *s, const int16_t amp[], int samples)
 {
 #if defined(SPANDSP_USE_FIXED_POINT)
     int32_t energy[6];
-    int16_t xamp;
 #else
     float energy[6];
-    float xamp;
 #endif
     int i;
-    int j;
     int sample;
     int best;
     int second_best;
@@ -508,17 +530,8 @@ SPAN_DECLARE(int) bell_mf_rx(bell_mf_rx_state_t *s, const int16_t amp[], int sam
         else
             limit = samples;
         /*endif*/
-        for (j = sample;  j < limit;  j++)
-        {
-            xamp = goertzel_preadjust_amp(amp[j]);
-            goertzel_samplex(&s->out[0], xamp);
-            goertzel_samplex(&s->out[1], xamp);
-            goertzel_samplex(&s->out[2], xamp);
-            goertzel_samplex(&s->out[3], xamp);
-            goertzel_samplex(&s->out[4], xamp);
-            goertzel_samplex(&s->out[5], xamp);
-        }
-        /*endfor*/
+        memcpy(&s->block[s->current_sample], &amp[sample], (limit - sample)*sizeof(amp[0]));
+        power_gate_update(&s->gate, &amp[sample], limit - sample);
         s->current_sample += (limit - sample);
         if (s->current_sample < BELL_MF_SAMPLES_PER_BLOCK)
             continue;
@@ -531,8 +544,22 @@ SPAN_DECLARE(int) bell_mf_rx(bell_mf_rx_state_t *s, const int16_t amp[], int sam
            well. The sinc function mess, due to rectangular windowing
            ensure that! Find the two highest energies and ensure they
            are considerably stronger than any of the others. */
-        energy[0] = goertzel_result(&s->out[0]);
-        energy[1] = goertzel_result(&s->out[1]);
+        if (power_gate_block_end(&s->gate, BELL_MF_SAMPLES_PER_BLOCK))
+        {
+            /* The block is too quiet for any of the Goertzels to reach the threshold,
+               so don't waste time running them. */
+            for (i = 0;  i < 6;  i++)
+                energy[i] = 0;
+            /*endfor*/
+        }
+        else
+        {
+            mf_rx_goertzels(s->out, s->block, BELL_MF_SAMPLES_PER_BLOCK);
+            for (i = 0;  i < 6;  i++)
+                energy[i] = goertzel_result(&s->out[i]);
+            /*endfor*/
+        }
+        /*endif*/
         if (energy[0] > energy[1])
         {
             best = 0;
@@ -546,7 +573,6 @@ SPAN_DECLARE(int) bell_mf_rx(bell_mf_rx_state_t *s, const int16_t amp[], int sam
         /*endif*/
         for (i = 2;  i < 6;  i++)
         {
-            energy[i] = goertzel_result(&s->out[i]);
             if (energy[i] >= energy[best])
             {
                 second_best = best;
@@ -670,6 +696,12 @@ SPAN_DECLARE(size_t) bell_mf_rx_get(bell_mf_rx_state_t *s, char *buf, int max)
 }
 /*- End of function --------------------------------------------------------*/
 
+SPAN_DECLARE(power_gate_t *) bell_mf_rx_get_power_gate(bell_mf_rx_state_t *s)
+{
+    return &s->gate;
+}
+/*- End of function --------------------------------------------------------*/
+
 SPAN_DECLARE(bell_mf_rx_state_t *) bell_mf_rx_init(bell_mf_rx_state_t *s,
                                                    digits_rx_callback_t callback,
                                                    void *user_data)
@@ -706,6 +738,7 @@ SPAN_DECLARE(bell_mf_rx_state_t *) bell_mf_rx_init(bell_mf_rx_state_t *s,
     for (i = 0;  i < 6;  i++)
         goertzel_init(&s->out[i], &bell_mf_detect_desc[i]);
     /*endfor*/
+    power_gate_init(&s->gate, BELL_MF_THRESHOLD - POWER_GATE_GOERTZEL_MARGIN);
     s->current_sample = 0;
     s->lost_digits = 0;
     s->current_digits = 0;
@@ -731,13 +764,10 @@ SPAN_DECLARE(int) r2_mf_rx(r2_mf_rx_state_t *s, const int16_t amp[], int samples
 {
 #if defined(SPANDSP_USE_FIXED_POINT)
     int32_t energy[6];
-    int16_t xamp;
 #else
     float energy[6];
-    float xamp;
 #endif
     int i;
-    int j;
     int sample;
     int best;
     int second_best;
@@ -752,17 +782,8 @@ SPAN_DECLARE(int) r2_mf_rx(r2_mf_rx_state_t *s, const int16_t amp[], int samples
         else
             limit = samples;
         /*endif*/
-        for (j = sample;  j < limit;  j++)
-        {
-            xamp = goertzel_preadjust_amp(amp[j]);
-            goertzel_samplex(&s->out[0], xamp);
-            goertzel_samplex(&s->out[1], xamp);
-            goertzel_samplex(&s->out[2], xamp);
-            goertzel_samplex(&s->out[3], xamp);
-            goertzel_samplex(&s->out[4], xamp);
-            goertzel_samplex(&s->out[5], xamp);
-        }
-        /*endfor*/
+        memcpy(&s->block[s->current_sample], &amp[sample], (limit - sample)*sizeof(amp[0]));
+        power_gate_update(&s->gate, &amp[sample], limit - sample);
         s->current_sample += (limit - sample);
         if (s->current_sample < R2_MF_SAMPLES_PER_BLOCK)
             continue;
@@ -770,8 +791,22 @@ SPAN_DECLARE(int) r2_mf_rx(r2_mf_rx_state_t *s, const int16_t amp[], int samples
 
         /* We are at the end of an MF detection block */
         /* Find the two highest energies */
-        energy[0] = goertzel_result(&s->out[0]);
-        energy[1] = goertzel_result(&s->out[1]);
+        if (power_gate_block_end(&s->gate, R2_MF_SAMPLES_PER_BLOCK))
+        {
+            /* The block is too quiet for any of the Goertzels to reach the threshold,
+               so don't waste time running them. */
+            for (i = 0;  i < 6;  i++)
+                energy[i] = 0;
+            /*endfor*/
+        }
+        else
+        {
+            mf_rx_goertzels(s->out, s->block, R2_MF_SAMPLES_PER_BLOCK);
+            for (i = 0;  i < 6;  i++)
+                energy[i] = goertzel_result(&s->out[i]);
+            /*endfor*/
+        }
+        /*endif*/
         if (energy[0] > energy[1])
         {
             best = 0;
@@ -786,7 +821,6 @@ SPAN_DECLARE(int) r2_mf_rx(r2_mf_rx_state_t *s, const int16_t amp[], int samples
 
         for (i = 2;  i < 6;  i++)
         {
-            energy[i] = goertzel_result(&s->out[i]);
             if (energy[i] >= energy[best])
             {
                 second_best = best;
@@ -866,6 +900,12 @@ SPAN_DECLARE(int) r2_mf_rx_get(r2_mf_rx_state_t *s)
 }
 /*- End of function --------------------------------------------------------*/
 
+SPAN_DECLARE(power_gate_t *) r2_mf_rx_get_power_gate(r2_mf_rx_state_t *s)
+{
+    return &s->gate;
+}
+/*- End of function --------------------------------------------------------*/
+
 SPAN_DECLARE(r2_mf_rx_state_t *) r2_mf_rx_init(r2_mf_rx_state_t *s,
                                                bool fwd,
                                                span_tone_report_func_t callback,
@@ -909,6 +949,7 @@ SPAN_DECLARE(r2_mf_rx_state_t *) r2_mf_rx_init(r2_mf_rx_state_t *s,
         /*endfor*/
     }
     /*endif*/
+    power_gate_init(&s->gate, R2_MF_THRESHOLD - POWER_GATE_GOERTZEL_MARGIN);
     s->callback = callback;
     s->callback_data = user_data;
     s->current_digit = 0;
@@ -50,6 +50,7 @@
 #include "mmx_sse_decs.h"
 
 #include "spandsp/telephony.h"
+#include "spandsp/cpu_features.h"
 #include "spandsp/logging.h"
 #include "spandsp/complex.h"
 #include "spandsp/vector_float.h"
@@ -134,11 +135,62 @@ SPAN_DECLARE(void) cvec_mull(complexl_t z[], const complexl_t x[], const complex
 /*- End of function --------------------------------------------------------*/
 #endif
 
+#if defined(SPANDSP_USE_RUNTIME_DISPATCH)
+SPAN_TARGET("avx") static complexf_t cvec_dot_prodf_avx(const complexf_t x[], const complexf_t y[], int n)
+{
+    int i;
+    complexf_t z;
+    __m256 n1;
+    __m256 n2;
+    __m256 re;
+    __m256 im;
+    __m256 sign;
+    __m128 n3;
+    __m128 n4;
+
+    /* Each AVX register holds 4 complex values, as re/im pairs. The x.im*y.im products
+       are negated by flipping their sign bits, so all the lanes of re sum to the real part,
+       and all the lanes of im sum to the imaginary part. */
+    re = _mm256_setzero_ps();
+    im = _mm256_setzero_ps();
+    sign = _mm256_setr_ps(0.0f, -0.0f, 0.0f, -0.0f, 0.0f, -0.0f, 0.0f, -0.0f);
+    for (i = 0;  i + 4 <= n;  i += 4)
+    {
+        n1 = _mm256_loadu_ps((const float *) (x + i));
+        n2 = _mm256_loadu_ps((const float *) (y + i));
+        re = _mm256_add_ps(re, _mm256_xor_ps(_mm256_mul_ps(n1, n2), sign));
+        n2 = _mm256_permute_ps(n2, 0xB1);
+        im = _mm256_add_ps(im, _mm256_mul_ps(n1, n2));
+    }
+    /*endfor*/
+    n3 = _mm_add_ps(_mm256_castps256_ps128(re), _mm256_extractf128_ps(re, 1));
+    n4 = _mm_add_ps(_mm256_castps256_ps128(im), _mm256_extractf128_ps(im, 1));
+    n3 = _mm_hadd_ps(n3, n4);
+    n3 = _mm_hadd_ps(n3, n3);
+    z.re = _mm_cvtss_f32(n3);
+    z.im = _mm_cvtss_f32(_mm_shuffle_ps(n3, n3, 1));
+    /* Now deal with the last 1 to 3 elements, which don't fill an AVX register */
+    for (  ;  i < n;  i++)
+    {
+        z.re += (x[i].re*y[i].re - x[i].im*y[i].im);
+        z.im += (x[i].re*y[i].im + x[i].im*y[i].re);
+    }
+    /*endfor*/
+    return z;
+}
+/*- End of function --------------------------------------------------------*/
+#endif
+
 SPAN_DECLARE(complexf_t) cvec_dot_prodf(const complexf_t x[], const complexf_t y[], int n)
 {
     int i;
     complexf_t z;
 
+#if defined(SPANDSP_USE_RUNTIME_DISPATCH)
+    if ((span_cpu_dispatch_features & SPAN_CPU_FEATURE_AVX))
+        return cvec_dot_prodf_avx(x, y, n);
+    /*endif*/
+#endif
     z = complex_setf(0.0f, 0.0f);
     for (i = 0;  i < n;  i++)
     {
@@ -198,10 +250,54 @@ SPAN_DECLARE(complexf_t) cvec_circular_dot_prodf(const complexf_t x[], const com
 
 #define LMS_LEAK_RATE   0.9999f
 
+#if defined(SPANDSP_USE_RUNTIME_DISPATCH)
+SPAN_TARGET("avx") static void cvec_lmsf_avx(const complexf_t x[], complexf_t y[], int n, const complexf_t *error)
+{
+    int i;
+    __m256 n1;
+    __m256 n2;
+    __m256 err_re;
+    __m256 err_im;
+    __m256 leak;
+
+    /* The products and sums are formed in the same order as the scalar code, and the
+       x.im*error->re products are negated exactly, so the results are bit exact with the
+       scalar code, unless the compiler is allowed to reorder that (e.g. by -ffast-math). */
+    err_re = _mm256_setr_ps(error->re, -error->re, error->re, -error->re, error->re, -error->re, error->re, -error->re);
+    err_im = _mm256_set1_ps(error->im);
+    leak = _mm256_set1_ps(LMS_LEAK_RATE);
+    for (i = 0;  i + 4 <= n;  i += 4)
+    {
+        n1 = _mm256_loadu_ps((const float *) (x + i));
+        n2 = _mm256_mul_ps(_mm256_permute_ps(n1, 0xB1), err_im);
+        n2 = _mm256_add_ps(n2, _mm256_mul_ps(n1, err_re));
+        n1 = _mm256_mul_ps(_mm256_loadu_ps((const float *) (y + i)), leak);
+        _mm256_storeu_ps((float *) (y + i), _mm256_add_ps(n1, n2));
+    }
+    /*endfor*/
+    /* Now deal with the last 1 to 3 elements, which don't fill an AVX register */
+    for (  ;  i < n;  i++)
+    {
+        y[i].re = y[i].re*LMS_LEAK_RATE + (x[i].im*error->im + x[i].re*error->re);
+        y[i].im = y[i].im*LMS_LEAK_RATE + (x[i].re*error->im - x[i].im*error->re);
+    }
+    /*endfor*/
+}
+/*- End of function --------------------------------------------------------*/
+#endif
+
 SPAN_DECLARE(void) cvec_lmsf(const complexf_t x[], complexf_t y[], int n, const complexf_t *error)
 {
     int i;
 
+#if defined(SPANDSP_USE_RUNTIME_DISPATCH)
+    if ((span_cpu_dispatch_features & SPAN_CPU_FEATURE_AVX))
+    {
+        cvec_lmsf_avx(x, y, n, error);
+        return;
+    }
+    /*endif*/
+#endif
     for (i = 0;  i < n;  i++)
     {
         /* Leak a little to tame uncontrolled wandering */
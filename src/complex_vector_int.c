@@ -50,16 +50,117 @@
 #include "mmx_sse_decs.h"
 
 #include "spandsp/telephony.h"
+#include "spandsp/cpu_features.h"
 #include "spandsp/logging.h"
 #include "spandsp/complex.h"
 #include "spandsp/vector_int.h"
 #include "spandsp/complex_vector_int.h"
 
+#if defined(SPANDSP_USE_RUNTIME_DISPATCH)
+SPAN_TARGET("avx2") static __inline__ complexi32_t sum_complexi32_avx2(__m256i re, __m256i im)
+{
+    __m128i n1;
+    __m128i n2;
+    complexi32_t z;
+
+    n1 = _mm_add_epi32(_mm256_castsi256_si128(re), _mm256_extracti128_si256(re, 1));
+    n2 = _mm_add_epi32(_mm256_castsi256_si128(im), _mm256_extracti128_si256(im, 1));
+    n1 = _mm_add_epi32(n1, _mm_shuffle_epi32(n1, _MM_SHUFFLE(1, 0, 3, 2)));
+    n2 = _mm_add_epi32(n2, _mm_shuffle_epi32(n2, _MM_SHUFFLE(1, 0, 3, 2)));
+    n1 = _mm_add_epi32(n1, _mm_shuffle_epi32(n1, _MM_SHUFFLE(2, 3, 0, 1)));
+    n2 = _mm_add_epi32(n2, _mm_shuffle_epi32(n2, _MM_SHUFFLE(2, 3, 0, 1)));
+    z.re = _mm_cvtsi128_si32(n1);
+    z.im = _mm_cvtsi128_si32(n2);
+    return z;
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_TARGET("avx2") static complexi32_t cvec_dot_prodi16_avx2(const complexi16_t x[], const complexi16_t y[], int n)
+{
+    int i;
+    complexi32_t z;
+    __m256i n1;
+    __m256i n2;
+    __m256i re;
+    __m256i im;
+    __m256i mask;
+
+    /* Each 32 bit lane holds one complex value. Negating the imaginary parts of y, so
+       a single multiply-add could form the real part, would overflow for -32768. Instead,
+       the x.re*y.re and x.im*y.im products are formed separately, by masking y. The 32 bit
+       sums wrap around just like the scalar code, so the results are exactly the same. */
+    re = _mm256_setzero_si256();
+    im = _mm256_setzero_si256();
+    mask = _mm256_set1_epi32(0x0000FFFF);
+    for (i = 0;  i + 8 <= n;  i += 8)
+    {
+        n1 = _mm256_loadu_si256((const __m256i *) (x + i));
+        n2 = _mm256_loadu_si256((const __m256i *) (y + i));
+        re = _mm256_add_epi32(re, _mm256_madd_epi16(n1, _mm256_and_si256(n2, mask)));
+        re = _mm256_sub_epi32(re, _mm256_madd_epi16(n1, _mm256_andnot_si256(mask, n2)));
+        n2 = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(n2, 0xB1), 0xB1);
+        im = _mm256_add_epi32(im, _mm256_madd_epi16(n1, n2));
+    }
+    /*endfor*/
+    z = sum_complexi32_avx2(re, im);
+    /* Now deal with the last 1 to 7 elements, which don't fill an AVX2 register */
+    for (  ;  i < n;  i++)
+    {
+        z.re += ((int32_t) x[i].re*(int32_t) y[i].re - (int32_t) x[i].im*(int32_t) y[i].im);
+        z.im += ((int32_t) x[i].re*(int32_t) y[i].im + (int32_t) x[i].im*(int32_t) y[i].re);
+    }
+    /*endfor*/
+    return z;
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_TARGET("avx2") static complexi32_t cvec_dot_prodi32_avx2(const complexi32_t x[], const complexi32_t y[], int n)
+{
+    int i;
+    complexi32_t z;
+    __m256i n1;
+    __m256i n2;
+    __m256i re;
+    __m256i im;
+    __m256i sign;
+
+    /* The products are the low 32 bits, as in the scalar code. The x.im*y.im products
+       are negated in the odd lanes, so all the lanes of re sum to the real part. */
+    re = _mm256_setzero_si256();
+    im = _mm256_setzero_si256();
+    sign = _mm256_setr_epi32(1, -1, 1, -1, 1, -1, 1, -1);
+    for (i = 0;  i + 4 <= n;  i += 4)
+    {
+        n1 = _mm256_loadu_si256((const __m256i *) (x + i));
+        n2 = _mm256_loadu_si256((const __m256i *) (y + i));
+        re = _mm256_add_epi32(re, _mm256_sign_epi32(_mm256_mullo_epi32(n1, n2), sign));
+        n2 = _mm256_shuffle_epi32(n2, _MM_SHUFFLE(2, 3, 0, 1));
+        im = _mm256_add_epi32(im, _mm256_mullo_epi32(n1, n2));
+    }
+    /*endfor*/
+    z = sum_complexi32_avx2(re, im);
+    /* Now deal with the last 1 to 3 elements, which don't fill an AVX2 register */
+    for (  ;  i < n;  i++)
+    {
+        z.re += (x[i].re*y[i].re - x[i].im*y[i].im);
+        z.im += (x[i].re*y[i].im + x[i].im*y[i].re);
+    }
+    /*endfor*/
+    return z;
+}
+/*- End of function --------------------------------------------------------*/
+#endif
+
 SPAN_DECLARE(complexi32_t) cvec_dot_prodi16(const complexi16_t x[], const complexi16_t y[], int n)
 {
     int i;
     complexi32_t z;
 
+#if defined(SPANDSP_USE_RUNTIME_DISPATCH)
+    if ((span_cpu_dispatch_features & SPAN_CPU_FEATURE_AVX2))
+        return cvec_dot_prodi16_avx2(x, y, n);
+    /*endif*/
+#endif
     z = complex_seti32(0, 0);
     for (i = 0;  i < n;  i++)
     {
@@ -76,6 +177,11 @@ SPAN_DECLARE(complexi32_t) cvec_dot_prodi32(const complexi32_t x[], const comple
     int i;
     complexi32_t z;
 
+#if defined(SPANDSP_USE_RUNTIME_DISPATCH)
+    if ((span_cpu_dispatch_features & SPAN_CPU_FEATURE_AVX2))
+        return cvec_dot_prodi32_avx2(x, y, n);
+    /*endif*/
+#endif
     z = complex_seti32(0, 0);
     for (i = 0;  i < n;  i++)
     {
@@ -99,10 +205,59 @@ SPAN_DECLARE(complexi32_t) cvec_circular_dot_prodi16(const complexi16_t x[], con
 }
 /*- End of function --------------------------------------------------------*/
 
+#if defined(SPANDSP_USE_RUNTIME_DISPATCH)
+SPAN_TARGET("avx2") static void cvec_lmsi16_avx2(const complexi16_t x[], complexi16_t y[], int n, const complexi16_t *error)
+{
+    int i;
+    __m256i n1;
+    __m256i n2;
+    __m256i n3;
+    __m256i err;
+    __m256i err_im;
+    __m256i err_re;
+    __m256i mask;
+
+    /* Each 32 bit lane holds one complex value. The real part of the update is a single
+       multiply-add. Negating error->re would overflow for -32768, so the imaginary part
+       is the difference of two multiply-adds, with one product masked out of each. */
+    err = _mm256_set1_epi32(((uint32_t) (uint16_t) error->im << 16) | (uint16_t) error->re);
+    err_im = _mm256_set1_epi32((uint16_t) error->im);
+    err_re = _mm256_set1_epi32((uint32_t) (uint16_t) error->re << 16);
+    mask = _mm256_set1_epi32(0x0000FFFF);
+    for (i = 0;  i + 8 <= n;  i += 8)
+    {
+        n1 = _mm256_loadu_si256((const __m256i *) (x + i));
+        n2 = _mm256_srai_epi32(_mm256_madd_epi16(n1, err), 12);
+        n3 = _mm256_sub_epi32(_mm256_madd_epi16(n1, err_im), _mm256_madd_epi16(n1, err_re));
+        n3 = _mm256_srai_epi32(n3, 12);
+        n2 = _mm256_or_si256(_mm256_and_si256(n2, mask), _mm256_slli_epi32(n3, 16));
+        n1 = _mm256_loadu_si256((const __m256i *) (y + i));
+        _mm256_storeu_si256((__m256i *) (y + i), _mm256_add_epi16(n1, n2));
+    }
+    /*endfor*/
+    /* Now deal with the last 1 to 7 elements, which don't fill an AVX2 register */
+    for (  ;  i < n;  i++)
+    {
+        y[i].re += (int16_t) (((int32_t) x[i].im*(int32_t) error->im + (int32_t) x[i].re*(int32_t) error->re) >> 12);
+        y[i].im += (int16_t) (((int32_t) x[i].re*(int32_t) error->im - (int32_t) x[i].im*(int32_t) error->re) >> 12);
+    }
+    /*endfor*/
+}
+/*- End of function --------------------------------------------------------*/
+#endif
+
 SPAN_DECLARE(void) cvec_lmsi16(const complexi16_t x[], complexi16_t y[], int n, const complexi16_t *error)
 {
     int i;
 
+#if defined(SPANDSP_USE_RUNTIME_DISPATCH)
+    if ((span_cpu_dispatch_features & SPAN_CPU_FEATURE_AVX2))
+    {
+        cvec_lmsi16_avx2(x, y, n, error);
+        return;
+    }
+    /*endif*/
+#endif
     for (i = 0;  i < n;  i++)
     {
         y[i].re += (int16_t) (((int32_t) x[i].im*(int32_t) error->im + (int32_t) x[i].re*(int32_t) error->re) >> 12);
@@ -71,6 +71,7 @@
 #if defined(SPANDSP_SUPPORT_V32BIS)
 #include "spandsp/v17tx.h"
 #include "spandsp/v17rx.h"
+#include "spandsp/vector_int.h"
 #include "spandsp/modem_echo.h"
 #include "spandsp/v32bis.h"
 #endif
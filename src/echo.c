@@ -96,14 +96,20 @@
 #include "floating_fudge.h"
 #include <string.h>
 #include <stdio.h>
+#if defined(HAVE_STDATOMIC_H)
+#include <stdatomic.h>
+#endif
 
 #include "spandsp/telephony.h"
 #include "spandsp/alloc.h"
 #include "spandsp/fast_convert.h"
 #include "spandsp/logging.h"
+#include "spandsp/complex.h"
 #include "spandsp/saturated.h"
 #include "spandsp/dc_restore.h"
 #include "spandsp/bit_operations.h"
+#include "spandsp/vector_int.h"
+#include "spandsp/vector_float.h"
 #include "spandsp/echo.h"
 
 #include "spandsp/private/echo.h"
@@ -117,6 +123,76 @@
 #define MIN_TX_POWER_FOR_ADAPTION   64*64
 #define MIN_RX_POWER_FOR_ADAPTION   64*64
 
+/* The number of samples processed in each pass of echo_can_update_block() */
+#define ECHO_CAN_CHUNK_SIZE         160
+
+/* The power meter readings kept for each sample of a chunk */
+enum
+{
+    POWER_TX_SHORT = 0,
+    POWER_TX_MEDIUM,
+    POWER_TX_ABS,
+    POWER_RX_SHORT,
+    POWER_RX_MEDIUM,
+    POWER_TRACES
+};
+
+/* The number of samples over which the statistics average the signal powers */
+#define STATS_POWER_SAMPLES         4000
+
+/* Codes for last_adaption_skip_reason */
+enum
+{
+    ADAPTION_NOT_SKIPPED = 0,
+    ADAPTION_SKIPPED_LOW_TX = 1,
+    ADAPTION_SKIPPED_DOUBLE_TALK = 2,
+    ADAPTION_SKIPPED_DWELL = 3,
+    ADAPTION_SKIPPED_NARROWBAND = 4
+};
+
+/* The sequence count is a plain volatile in the state structure, so the structure is
+   the same for every user of the header. A naturally aligned 32 bit volatile is read
+   and written in one piece, and the fences order the copy of the statistics around it. */
+#if defined(HAVE_STDATOMIC_H)
+#define stats_fence_release()       atomic_thread_fence(memory_order_release)
+#define stats_fence_acquire()       atomic_thread_fence(memory_order_acquire)
+#else
+/* Without <stdatomic.h> the fences compile to nothing. Nothing then stops the CPU
+   reordering the copy of the statistics around the count, so a reader in another
+   thread might see a torn copy. */
+#define stats_fence_release()       /**/
+#define stats_fence_acquire()       /**/
+#endif
+
+/* The number of adaptions between updates of the proportionate step sizes */
+#define PNLMS_GAIN_INTERVAL         16
+/* The largest proportionate step size gain, in Q12 */
+#define PNLMS_MAX_GAIN              (8 << 12)
+/* The smallest sum of the tap magnitudes for which proportionate step sizes are used */
+#define PNLMS_MIN_NORM              (1 << 20)
+
+/* The number of samples between searches for the active region of the echo tail */
+#define TAIL_LOCATE_INTERVAL        800
+/* The ratio of received to cleaned power needed before the filter is narrowed */
+#define TAIL_WINDOW_MIN_ERLE        16
+/* The margins kept before and after the active region of the echo tail */
+#define TAIL_WINDOW_LEAD            16
+#define TAIL_WINDOW_TRAIL           64
+
+/* The block length, and FFT length, of the partitioned block frequency domain filter */
+#define FD_BLOCK_LEN                64
+#define FD_FFT_LEN                  (2*FD_BLOCK_LEN)
+/* The adaption step size of the frequency domain filter, before it is divided by the
+   number of partitions */
+#define FD_STEP_SIZE                0.5f
+/* The smoothing factor for the per bin power of the transmitted signal */
+#define FD_POWER_BETA               0.2f
+/* A floor for the per bin power, so very quiet bins do not cause huge steps */
+#define FD_POWER_FLOOR              (FD_FFT_LEN*256.0f*256.0f)
+
+/* The alignment of each array in an echo canceller bank's arena */
+#define ECHO_CAN_BANK_ALIGNMENT     64
+
 static int narrowband_detect(echo_can_state_t *ec)
 {
     int k;
@@ -134,7 +210,7 @@ static int narrowband_detect(echo_can_state_t *ec)
     for (i = 0;  i < len;  i++)
     {
         sf[i] = ec->fir_state.history[k++];
-        if (k >= 256)
+        if (k >= ec->taps)
             k = 0;
         /*endif*/
     }
@@ -251,6 +327,518 @@ static __inline__ void lms_adapt(echo_can_state_t *ec, int factor)
 }
 /*- End of function --------------------------------------------------------*/
 
+static void pnlms_update_gains(echo_can_state_t *ec)
+{
+    int64_t norm;
+    int64_t scale;
+    int32_t gain;
+    int end;
+    int i;
+
+    /* Improved proportionate NLMS (IPNLMS, with alpha = 0). Each tap's step is
+       weighted by half a uniform share, and half in proportion to the tap's own
+       magnitude. The gains are in Q12, and average to 1.0 over the active taps, so
+       the overall step size matches plain NLMS. */
+    end = ec->window_start + ec->window_len;
+    norm = 0;
+    for (i = ec->window_start;  i < end;  i++)
+        norm += abs(ec->fir_taps32[i] >> 4);
+    /*endfor*/
+    if (norm < PNLMS_MIN_NORM)
+    {
+        /* The taps are too small to say where the echo is. Adapt uniformly. */
+        for (i = ec->window_start;  i < end;  i++)
+            ec->pnlms_gains[i] = 1 << 12;
+        /*endfor*/
+        return;
+    }
+    /*endif*/
+    scale = ((int64_t) ec->window_len << 27)/norm;
+    for (i = ec->window_start;  i < end;  i++)
+    {
+        gain = (1 << 11) + (int32_t) ((abs(ec->fir_taps32[i] >> 4)*scale) >> 16);
+        ec->pnlms_gains[i] = (gain > PNLMS_MAX_GAIN)  ?  PNLMS_MAX_GAIN  :  gain;
+    }
+    /*endfor*/
+}
+/*- End of function --------------------------------------------------------*/
+
+static __inline__ void lms_adapt_window(echo_can_state_t *ec, int factor)
+{
+    const int16_t *history;
+    const int32_t *gains;
+    int32_t *taps32;
+    int16_t *taps16;
+    int end;
+    int len;
+    int i;
+    int j;
+    int k;
+
+    /* Update the FIR taps within the active window, optionally using proportionate
+       step sizes. */
+    if ((ec->adaption_mode & ECHO_CAN_USE_PNLMS)  &&  --ec->pnlms_countdown <= 0)
+    {
+        pnlms_update_gains(ec);
+        ec->pnlms_countdown = PNLMS_GAIN_INTERVAL;
+    }
+    /*endif*/
+    end = ec->window_start + ec->window_len;
+    /* The window covers at most two runs of the circular history. Each is updated
+       in a simple loop, with the choice of step sizes made outside it. */
+    for (i = ec->window_start;  i < end;  i += len)
+    {
+        if ((j = ec->curr_pos + i) >= ec->taps)
+            j -= ec->taps;
+        /*endif*/
+        len = ec->taps - j;
+        if (len > end - i)
+            len = end - i;
+        /*endif*/
+        history = &ec->fir_state.history[j];
+        taps32 = &ec->fir_taps32[i];
+        taps16 = &ec->fir_taps16[ec->tap_set][i];
+        if ((ec->adaption_mode & ECHO_CAN_USE_PNLMS))
+        {
+            gains = &ec->pnlms_gains[i];
+            for (k = 0;  k < len;  k++)
+            {
+                taps32[k] += (int32_t) (((int64_t) (history[k]*factor)*gains[k]) >> 12);
+                taps16[k] = (int16_t) (taps32[k] >> 15);
+            }
+            /*endfor*/
+        }
+        else
+        {
+            for (k = 0;  k < len;  k++)
+            {
+                taps32[k] += history[k]*factor;
+                taps16[k] = (int16_t) (taps32[k] >> 15);
+            }
+            /*endfor*/
+        }
+        /*endif*/
+    }
+    /*endfor*/
+}
+/*- End of function --------------------------------------------------------*/
+
+static __inline__ int16_t fir16_window(echo_can_state_t *ec, int16_t sample)
+{
+    fir16_state_t *fir;
+    int32_t y;
+    int first;
+    int len;
+
+    /* The same as fir16(), but only the taps in the active window are used */
+    fir = &ec->fir_state;
+    fir->history[fir->curr_pos] = sample;
+#if defined(USE_MMX)  ||  defined(USE_SSE2)
+    fir->history[fir->curr_pos + fir->taps] = sample;
+#endif
+    if ((first = fir->curr_pos + ec->window_start) >= fir->taps)
+        first -= fir->taps;
+    /*endif*/
+    if (first + ec->window_len <= fir->taps)
+    {
+        y = vec_dot_prodi16(&fir->history[first], &fir->coeffs[ec->window_start], ec->window_len);
+    }
+    else
+    {
+        len = fir->taps - first;
+        y = vec_dot_prodi16(&fir->history[first], &fir->coeffs[ec->window_start], len);
+        y += vec_dot_prodi16(&fir->history[0], &fir->coeffs[ec->window_start + len], ec->window_len - len);
+    }
+    /*endif*/
+    if (fir->curr_pos <= 0)
+        fir->curr_pos = fir->taps;
+    /*endif*/
+    fir->curr_pos--;
+    return (int16_t) (y >> 15);
+}
+/*- End of function --------------------------------------------------------*/
+
+static void echo_can_locate_tail(echo_can_state_t *ec, int rx_power)
+{
+    const int16_t *taps16;
+    int16_t peak;
+    int first;
+    int last;
+    int i;
+
+    /* If there is too little received signal to judge the state of the canceller,
+       leave things as they are. */
+    if (rx_power < MIN_RX_POWER_FOR_ADAPTION)
+        return;
+    /*endif*/
+    /* Only narrow the filter when the canceller has converged. Otherwise (e.g. when the
+       echo path has changed) use the whole length, so the echo can be found. */
+    if (ec->clean_rx_power >= rx_power/TAIL_WINDOW_MIN_ERLE)
+    {
+        ec->window_start = 0;
+        ec->window_len = ec->taps;
+        return;
+    }
+    /*endif*/
+    taps16 = ec->fir_taps16[ec->tap_set];
+    peak = 0;
+    for (i = 0;  i < ec->taps;  i++)
+    {
+        if (abs(taps16[i]) > peak)
+            peak = abs(taps16[i]);
+        /*endif*/
+    }
+    /*endfor*/
+    if (peak == 0)
+        return;
+    /*endif*/
+    /* The active region is where the taps are within about 30dB of the peak */
+    for (first = 0;  abs(taps16[first]) <= (peak >> 5);  first++)
+        ;
+    /*endfor*/
+    for (last = ec->taps - 1;  abs(taps16[last]) <= (peak >> 5);  last--)
+        ;
+    /*endfor*/
+    first = (first - TAIL_WINDOW_LEAD) & ~7;
+    if (first < 0)
+        first = 0;
+    /*endif*/
+    last = (last + TAIL_WINDOW_TRAIL + 7) & ~7;
+    if (last > ec->taps)
+        last = ec->taps;
+    /*endif*/
+    ec->window_start = first;
+    ec->window_len = last - first;
+}
+/*- End of function --------------------------------------------------------*/
+
+static void fd_fft(complexf_t data[], const complexf_t twiddle[], int inverse)
+{
+    complexf_t t;
+    complexf_t w;
+    int half;
+    int step;
+    int i;
+    int j;
+    int k;
+
+    /* A plain radix 2 FFT. It is only used on FD_FFT_LEN point blocks, so there is
+       nothing to be gained from anything fancier. The inverse transform is not
+       scaled. */
+    for (i = 1, j = 0;  i < FD_FFT_LEN;  i++)
+    {
+        for (k = FD_FFT_LEN >> 1;  j & k;  k >>= 1)
+            j ^= k;
+        /*endfor*/
+        j |= k;
+        if (i < j)
+        {
+            t = data[i];
+            data[i] = data[j];
+            data[j] = t;
+        }
+        /*endif*/
+    }
+    /*endfor*/
+    for (half = 1, step = FD_FFT_LEN >> 1;  half < FD_FFT_LEN;  half <<= 1, step >>= 1)
+    {
+        for (i = 0;  i < FD_FFT_LEN;  i += 2*half)
+        {
+            for (j = 0;  j < half;  j++)
+            {
+                w = twiddle[j*step];
+                if (inverse)
+                    w.im = -w.im;
+                /*endif*/
+                t = complex_mulf(&w, &data[i + j + half]);
+                data[i + j + half] = complex_subf(&data[i + j], &t);
+                data[i + j] = complex_addf(&data[i + j], &t);
+            }
+            /*endfor*/
+        }
+        /*endfor*/
+    }
+    /*endfor*/
+}
+/*- End of function --------------------------------------------------------*/
+
+static void echo_can_fd_reset(echo_can_fd_state_t *fd)
+{
+    fd->pos = 0;
+    fd->newest = 0;
+    fd->constrain = (fd->partitions > 1)  ?  1  :  0;
+    fd->dtd = false;
+    fd->active = false;
+    memset(fd->x, 0, 2*FD_BLOCK_LEN*sizeof(float));
+    memset(fd->head, 0, FD_BLOCK_LEN*sizeof(float));
+    memset(fd->tail, 0, FD_BLOCK_LEN*sizeof(float));
+    memset(fd->e, 0, FD_BLOCK_LEN*sizeof(float));
+    memset(fd->x_spec, 0, fd->partitions*FD_FFT_LEN*sizeof(complexf_t));
+    memset(fd->w, 0, fd->partitions*FD_FFT_LEN*sizeof(complexf_t));
+    memset(fd->x_power, 0, FD_FFT_LEN*sizeof(float));
+}
+/*- End of function --------------------------------------------------------*/
+
+static echo_can_fd_state_t *echo_can_fd_create(int taps)
+{
+    echo_can_fd_state_t *fd;
+    uint8_t *buf;
+    size_t floats;
+    size_t complexes;
+    int partitions;
+    int i;
+
+    partitions = (taps + FD_BLOCK_LEN - 1)/FD_BLOCK_LEN;
+    complexes = (2*partitions + 3)*FD_FFT_LEN;
+    floats = 5*FD_BLOCK_LEN + FD_FFT_LEN;
+    if ((buf = (uint8_t *) span_alloc(sizeof(*fd) + complexes*sizeof(complexf_t) + floats*sizeof(float))) == NULL)
+        return NULL;
+    /*endif*/
+    fd = (echo_can_fd_state_t *) buf;
+    buf += sizeof(*fd);
+    fd->partitions = partitions;
+    fd->x_spec = (complexf_t *) buf;
+    fd->w = fd->x_spec + partitions*FD_FFT_LEN;
+    fd->work = fd->w + partitions*FD_FFT_LEN;
+    fd->work2 = fd->work + FD_FFT_LEN;
+    fd->twiddle = fd->work2 + FD_FFT_LEN;
+    fd->x = (float *) (fd->twiddle + FD_FFT_LEN);
+    fd->head = fd->x + 2*FD_BLOCK_LEN;
+    fd->tail = fd->head + FD_BLOCK_LEN;
+    fd->e = fd->tail + FD_BLOCK_LEN;
+    fd->x_power = fd->e + FD_BLOCK_LEN;
+    for (i = 0;  i < FD_FFT_LEN;  i++)
+        fd->twiddle[i] = complex_setf(cosf(2.0f*3.1415926535f*i/FD_FFT_LEN), -sinf(2.0f*3.1415926535f*i/FD_FFT_LEN));
+    /*endfor*/
+    echo_can_fd_reset(fd);
+    return fd;
+}
+/*- End of function --------------------------------------------------------*/
+
+static void echo_can_fd_constrain(echo_can_fd_state_t *fd, complexf_t w[], float head[])
+{
+    int i;
+
+    /* Force the second half of a partition's impulse response to zero, so the
+       circular convolution performed in the frequency domain is a linear one. */
+    memcpy(fd->work2, w, FD_FFT_LEN*sizeof(complexf_t));
+    fd_fft(fd->work2, fd->twiddle, true);
+    for (i = 0;  i < FD_BLOCK_LEN;  i++)
+    {
+        fd->work2[i] = complex_setf(fd->work2[i].re/FD_FFT_LEN, 0.0f);
+        fd->work2[i + FD_BLOCK_LEN] = complex_setf(0.0f, 0.0f);
+    }
+    /*endfor*/
+    if (head)
+    {
+        /* The head taps are held in reverse order, for use with vec_dot_prodf() */
+        for (i = 0;  i < FD_BLOCK_LEN;  i++)
+            head[FD_BLOCK_LEN - 1 - i] = fd->work2[i].re;
+        /*endfor*/
+    }
+    /*endif*/
+    fd_fft(fd->work2, fd->twiddle, false);
+    memcpy(w, fd->work2, FD_FFT_LEN*sizeof(complexf_t));
+}
+/*- End of function --------------------------------------------------------*/
+
+static void echo_can_fd_block(echo_can_fd_state_t *fd)
+{
+    complexf_t *xs;
+    complexf_t *xp;
+    complexf_t *wp;
+    complexf_t z;
+    float mu;
+    float scale;
+    int partitions;
+    int i;
+    int p;
+
+    partitions = fd->partitions;
+    /* Transform the latest two blocks of the transmitted signal */
+    fd->newest = (fd->newest + 1)%partitions;
+    xs = &fd->x_spec[fd->newest*FD_FFT_LEN];
+    for (i = 0;  i < FD_FFT_LEN;  i++)
+        xs[i] = complex_setf(fd->x[i], 0.0f);
+    /*endfor*/
+    fd_fft(xs, fd->twiddle, false);
+    for (i = 0;  i < FD_FFT_LEN;  i++)
+        fd->x_power[i] += FD_POWER_BETA*(powerf(&xs[i]) - fd->x_power[i]);
+    /*endfor*/
+
+    if (fd->active  &&  !fd->dtd)
+    {
+        /* Transform the block of errors, and normalise it by the power in each bin */
+        for (i = 0;  i < FD_BLOCK_LEN;  i++)
+        {
+            fd->work[i] = complex_setf(0.0f, 0.0f);
+            fd->work[i + FD_BLOCK_LEN] = complex_setf(fd->e[i], 0.0f);
+        }
+        /*endfor*/
+        fd_fft(fd->work, fd->twiddle, false);
+        mu = FD_STEP_SIZE/partitions;
+        for (i = 0;  i < FD_FFT_LEN;  i++)
+        {
+            scale = mu/(fd->x_power[i] + FD_POWER_FLOOR);
+            fd->work[i].re *= scale;
+            fd->work[i].im *= scale;
+        }
+        /*endfor*/
+        /* Update every partition. Partition 0 is constrained for every block, as its
+           time domain version is needed for the head of the filter. The others are
+           constrained in turn, which is enough to keep them in check. */
+        for (p = 0;  p < partitions;  p++)
+        {
+            xp = &fd->x_spec[((fd->newest - p + partitions)%partitions)*FD_FFT_LEN];
+            wp = &fd->w[p*FD_FFT_LEN];
+            for (i = 0;  i < FD_FFT_LEN;  i++)
+            {
+                z = complex_conjf(&xp[i]);
+                z = complex_mulf(&z, &fd->work[i]);
+                wp[i] = complex_addf(&wp[i], &z);
+            }
+            /*endfor*/
+            if (p == 0)
+                echo_can_fd_constrain(fd, wp, fd->head);
+            else if (p == fd->constrain)
+                echo_can_fd_constrain(fd, wp, NULL);
+            /*endif*/
+        }
+        /*endfor*/
+        if (partitions > 1)
+            fd->constrain = fd->constrain%(partitions - 1) + 1;
+        /*endif*/
+    }
+    /*endif*/
+    fd->dtd = false;
+    fd->active = false;
+    memcpy(fd->x, &fd->x[FD_BLOCK_LEN], FD_BLOCK_LEN*sizeof(float));
+
+    /* Find the echo which the partitions other than the head will contribute to the
+       next block. This only depends on transmitted samples we already have. */
+    if (partitions > 1)
+    {
+        memset(fd->work2, 0, FD_FFT_LEN*sizeof(complexf_t));
+        for (p = 1;  p < partitions;  p++)
+        {
+            xp = &fd->x_spec[((fd->newest - p + 1 + partitions)%partitions)*FD_FFT_LEN];
+            wp = &fd->w[p*FD_FFT_LEN];
+            for (i = 0;  i < FD_FFT_LEN;  i++)
+            {
+                z = complex_mulf(&wp[i], &xp[i]);
+                fd->work2[i] = complex_addf(&fd->work2[i], &z);
+            }
+            /*endfor*/
+        }
+        /*endfor*/
+        fd_fft(fd->work2, fd->twiddle, true);
+        for (i = 0;  i < FD_BLOCK_LEN;  i++)
+            fd->tail[i] = fd->work2[i + FD_BLOCK_LEN].re/FD_FFT_LEN;
+        /*endfor*/
+    }
+    /*endif*/
+}
+/*- End of function --------------------------------------------------------*/
+
+static __inline__ int echo_can_fd_gate(echo_can_state_t *ec, const int power[], int stride)
+{
+    /* The same double talk logic as the time domain canceller, but any double talk
+       stops adaption for the whole block. */
+    if (ec->nonupdate_dwell > 0)
+        ec->nonupdate_dwell--;
+    /*endif*/
+    if (!(ec->adaption_mode & ECHO_CAN_USE_ADAPTION))
+        return -1;
+    /*endif*/
+    if (power[POWER_TX_SHORT*stride] <= MIN_TX_POWER_FOR_ADAPTION)
+    {
+        ec->last_adaption_skip_reason = ADAPTION_SKIPPED_LOW_TX;
+        ec->stats.skipped_low_tx++;
+        return 0;
+    }
+    /*endif*/
+    if (power[POWER_TX_MEDIUM*stride] <= power[POWER_RX_SHORT*stride])
+    {
+        if (ec->nonupdate_dwell == 0)
+            ec->stats.dtd_hits++;
+        /*endif*/
+        ec->nonupdate_dwell = NONUPDATE_DWELL_TIME;
+        ec->last_adaption_skip_reason = ADAPTION_SKIPPED_DOUBLE_TALK;
+        ec->stats.skipped_double_talk++;
+        return -1;
+    }
+    /*endif*/
+    if (ec->nonupdate_dwell != 0)
+    {
+        ec->last_adaption_skip_reason = ADAPTION_SKIPPED_DWELL;
+        ec->stats.skipped_dwell++;
+        return -1;
+    }
+    /*endif*/
+    ec->stats.adapted_samples++;
+    return 1;
+}
+/*- End of function --------------------------------------------------------*/
+
+static __inline__ int echo_can_fd_update(echo_can_state_t *ec, int16_t tx, int16_t rx, int gate)
+{
+    echo_can_fd_state_t *fd;
+    float echo_value;
+    int clean;
+
+    fd = ec->fd;
+    fd->x[FD_BLOCK_LEN + fd->pos] = tx;
+    /* The head of the filter is applied in the time domain, so there is no block delay */
+    echo_value = fd->tail[fd->pos] + vec_dot_prodf(fd->head, &fd->x[fd->pos + 1], FD_BLOCK_LEN);
+    clean = rx - saturate16(lfastrintf(echo_value));
+    fd->e[fd->pos] = clean;
+    if (gate < 0)
+        fd->dtd = true;
+    else if (gate > 0)
+        fd->active = true;
+    /*endif*/
+    if (++fd->pos >= FD_BLOCK_LEN)
+    {
+        echo_can_fd_block(fd);
+        fd->pos = 0;
+    }
+    /*endif*/
+    return clean;
+}
+/*- End of function --------------------------------------------------------*/
+
+static void echo_can_publish_stats(echo_can_state_t *ec)
+{
+    /* The statistics are published with a sequence count, which is odd while they
+       are being changed. A reader in another thread can then take a consistent copy
+       without any locking, by retrying if the count changes during its copy. Only
+       this thread changes the count, so it needs no atomic increment. */
+    uint32_t seq;
+
+    seq = ec->stats_seq;
+    ec->stats_seq = seq + 1;
+    stats_fence_release();
+    ec->published_stats = ec->stats;
+    stats_fence_release();
+    ec->stats_seq = seq + 2;
+}
+/*- End of function --------------------------------------------------------*/
+
+static void echo_can_set_defaults(echo_can_state_t *ec, int adaption_mode)
+{
+    ec->rx_power_threshold = 10000000;
+    ec->geigel_max = 0;
+    ec->geigel_lag = 0;
+    ec->dtd_onset = false;
+    ec->tap_set = 0;
+    ec->tap_rotate_counter = 1600;
+    ec->cng_level = 1000;
+    ec->window_start = 0;
+    ec->window_len = ec->taps;
+    echo_can_adaption_mode(ec, adaption_mode);
+}
+/*- End of function --------------------------------------------------------*/
+
 SPAN_DECLARE(echo_can_state_t *) echo_can_init(int len, int adaption_mode)
 {
     echo_can_state_t *ec;
@@ -289,14 +877,7 @@ SPAN_DECLARE(echo_can_state_t *) echo_can_init(int len, int adaption_mode)
     fir16_create(&ec->fir_state,
                  ec->fir_taps16[0],
                  ec->taps);
-    ec->rx_power_threshold = 10000000;
-    ec->geigel_max = 0;
-    ec->geigel_lag = 0;
-    ec->dtd_onset = false;
-    ec->tap_set = 0;
-    ec->tap_rotate_counter = 1600;
-    ec->cng_level = 1000;
-    echo_can_adaption_mode(ec, adaption_mode);
+    echo_can_set_defaults(ec, adaption_mode);
     return ec;
 }
 /*- End of function --------------------------------------------------------*/
@@ -316,13 +897,177 @@ SPAN_DECLARE(int) echo_can_free(echo_can_state_t *ec)
     for (i = 0;  i < 4;  i++)
         span_free(ec->fir_taps16[i]);
     /*endfor*/
+    if (ec->fd)
+        span_free(ec->fd);
+    /*endif*/
+    if (ec->pnlms_gains)
+        span_free(ec->pnlms_gains);
+    /*endif*/
     span_free(ec);
     return 0;
 }
 /*- End of function --------------------------------------------------------*/
 
+static size_t bank_align(size_t size)
+{
+    return (size + ECHO_CAN_BANK_ALIGNMENT - 1) & ~((size_t) ECHO_CAN_BANK_ALIGNMENT - 1);
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_DECLARE(echo_can_bank_state_t *) echo_can_bank_init(int channels, int len, int adaption_mode)
+{
+    echo_can_bank_state_t *s;
+    echo_can_state_t *ec;
+    uint8_t *arena;
+    size_t chan_size;
+    size_t taps32_size;
+    size_t taps16_size;
+    size_t history_size;
+    size_t state_size;
+    size_t block_size;
+    size_t power_size;
+    size_t total;
+    int history_len;
+    int i;
+    int j;
+
+    if (channels <= 0  ||  len <= 0)
+        return NULL;
+    /*endif*/
+    if ((s = (echo_can_bank_state_t *) span_alloc(sizeof(*s))) == NULL)
+        return NULL;
+    /*endif*/
+    memset(s, 0, sizeof(*s));
+    s->channels = channels;
+    s->taps = len;
+
+#if defined(USE_MMX)  ||  defined(USE_SSE2)
+    history_len = 2*len;
+#else
+    history_len = len;
+#endif
+    /* Everything lives in one aligned arena. Each channel keeps its own arrays, but
+       the arrays of each type for all the channels are placed one after another, and
+       each array starts on a cache line boundary. */
+    chan_size = bank_align(channels*sizeof(echo_can_state_t));
+    taps32_size = bank_align(len*sizeof(int32_t));
+    taps16_size = bank_align(len*sizeof(int16_t));
+    history_size = bank_align(history_len*sizeof(int16_t));
+    state_size = bank_align(6*channels*sizeof(int));
+    block_size = bank_align(ECHO_CAN_CHUNK_SIZE*channels*sizeof(int16_t));
+    power_size = bank_align(ECHO_CAN_CHUNK_SIZE*POWER_TRACES*channels*sizeof(int));
+    total = chan_size
+          + channels*(taps32_size + 4*taps16_size + history_size)
+          + state_size
+          + 2*block_size
+          + power_size;
+    if ((arena = (uint8_t *) span_aligned_alloc(ECHO_CAN_BANK_ALIGNMENT, total)) == NULL)
+    {
+        span_free(s);
+        return NULL;
+    }
+    /*endif*/
+    memset(arena, 0, total);
+    s->arena = arena;
+
+    s->chan = (echo_can_state_t *) arena;
+    arena += chan_size;
+    for (i = 0;  i < channels;  i++)
+    {
+        s->chan[i].fir_taps32 = (int32_t *) arena;
+        arena += taps32_size;
+    }
+    /*endfor*/
+    for (j = 0;  j < 4;  j++)
+    {
+        for (i = 0;  i < channels;  i++)
+        {
+            s->chan[i].fir_taps16[j] = (int16_t *) arena;
+            arena += taps16_size;
+        }
+        /*endfor*/
+    }
+    /*endfor*/
+    for (i = 0;  i < channels;  i++)
+    {
+        s->chan[i].fir_state.history = (int16_t *) arena;
+        arena += history_size;
+    }
+    /*endfor*/
+    s->power_state = (int *) arena;
+    arena += state_size;
+    s->tx_block = (int16_t *) arena;
+    arena += block_size;
+    s->rx_block = (int16_t *) arena;
+    arena += block_size;
+    s->power = (int *) arena;
+
+    for (i = 0;  i < channels;  i++)
+    {
+        ec = &s->chan[i];
+        ec->taps = len;
+        ec->curr_pos = ec->taps - 1;
+        ec->tap_mask = ec->taps - 1;
+        ec->fir_state.taps = len;
+        ec->fir_state.curr_pos = len - 1;
+        ec->fir_state.coeffs = ec->fir_taps16[0];
+        echo_can_set_defaults(ec, adaption_mode);
+    }
+    /*endfor*/
+    return s;
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_DECLARE(int) echo_can_bank_release(echo_can_bank_state_t *s)
+{
+    return 0;
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_DECLARE(int) echo_can_bank_free(echo_can_bank_state_t *s)
+{
+    int i;
+
+    for (i = 0;  i < s->channels;  i++)
+    {
+        if (s->chan[i].fd)
+            span_free(s->chan[i].fd);
+        /*endif*/
+        if (s->chan[i].pnlms_gains)
+            span_free(s->chan[i].pnlms_gains);
+        /*endif*/
+    }
+    /*endfor*/
+    span_aligned_free(s->arena);
+    span_free(s);
+    return 0;
+}
+/*- End of function --------------------------------------------------------*/
+
 SPAN_DECLARE(void) echo_can_adaption_mode(echo_can_state_t *ec, int adaption_mode)
 {
+    /* The frequency domain filter's state is only created when it is first needed */
+    if ((adaption_mode & ECHO_CAN_USE_FREQ_DOMAIN)  &&  ec->fd == NULL)
+    {
+        if ((ec->fd = echo_can_fd_create(ec->taps)) == NULL)
+            adaption_mode &= ~ECHO_CAN_USE_FREQ_DOMAIN;
+        /*endif*/
+    }
+    /*endif*/
+    if ((adaption_mode & ECHO_CAN_USE_PNLMS)  &&  ec->pnlms_gains == NULL)
+    {
+        if ((ec->pnlms_gains = (int32_t *) span_alloc(ec->taps*sizeof(int32_t))) == NULL)
+            adaption_mode &= ~ECHO_CAN_USE_PNLMS;
+        /*endif*/
+        ec->pnlms_countdown = 0;
+    }
+    /*endif*/
+    if (!(adaption_mode & ECHO_CAN_USE_TAIL_WINDOW))
+    {
+        ec->window_start = 0;
+        ec->window_len = ec->taps;
+    }
+    /*endif*/
     ec->adaption_mode = adaption_mode;
 }
 /*- End of function --------------------------------------------------------*/
@@ -364,15 +1109,30 @@ SPAN_DECLARE(void) echo_can_flush(echo_can_state_t *ec)
     ec->tap_rotate_counter = 1600;
 
     ec->latest_correction = 0;
+    ec->last_adaption_skip_reason = ADAPTION_NOT_SKIPPED;
 
     memset(ec->last_acf, 0, sizeof(ec->last_acf));
     ec->narrowband_count = 0;
     ec->narrowband_score = 0;
+
+    ec->window_start = 0;
+    ec->window_len = ec->taps;
+    ec->tail_locate_count = 0;
+    ec->pnlms_countdown = 0;
+
+    memset(&ec->stats, 0, sizeof(ec->stats));
+    ec->stats_tx_energy = 0;
+    ec->stats_rx_energy = 0;
+    ec->stats_clean_rx_energy = 0;
+    ec->stats_len = 0;
+    echo_can_publish_stats(ec);
+
+    if (ec->fd)
+        echo_can_fd_reset(ec->fd);
+    /*endif*/
 }
 /*- End of function --------------------------------------------------------*/
 
-int sample_no = 0;
-
 SPAN_DECLARE(void) echo_can_snapshot(echo_can_state_t *ec)
 {
     memcpy(ec->snapshot, ec->fir_taps16[0], ec->taps*sizeof(int16_t));
@@ -418,207 +1178,230 @@ static __inline__ int16_t echo_can_hpf(int32_t coeff[2], int16_t amp)
 }
 /*- End of function --------------------------------------------------------*/
 
-SPAN_DECLARE(int16_t) echo_can_update(echo_can_state_t *ec, int16_t tx, int16_t rx)
+static void echo_can_power_meters(int state[],
+                                  const int16_t tx[],
+                                  const int16_t rx[],
+                                  int power[],
+                                  int channels,
+                                  int len)
+{
+    int *tx_power0;
+    int *tx_power1;
+    int *tx_power2;
+    int *tx_power3;
+    int *rx_power0;
+    int *rx_power1;
+    int *p;
+    int i;
+    int j;
+
+    /* Calculate short term power levels using very simple single pole IIRs */
+    /* TODO: Is the nasty modulus approach the fastest, or would a real
+             tx*tx power calculation actually be faster? Using the squares
+             makes the numbers grow a lot! */
+    /* These only depend on the signals, and not on the state of the adaption, so
+       they are calculated for a whole chunk in one tight loop. The signals, the
+       filter states and the results are all interleaved by channel, so the inner
+       loop works across the channels of a bank in SIMD fashion. */
+    tx_power0 = &state[0*channels];
+    tx_power1 = &state[1*channels];
+    tx_power2 = &state[2*channels];
+    tx_power3 = &state[3*channels];
+    rx_power0 = &state[4*channels];
+    rx_power1 = &state[5*channels];
+    for (i = 0;  i < len;  i++)
+    {
+        p = &power[i*POWER_TRACES*channels];
+        for (j = 0;  j < channels;  j++)
+        {
+            tx_power3[j] += ((abs(tx[j]) - tx_power3[j]) >> 5);
+            tx_power2[j] += ((tx[j]*tx[j] - tx_power2[j]) >> 8);
+            tx_power1[j] += ((tx[j]*tx[j] - tx_power1[j]) >> 5);
+            tx_power0[j] += ((tx[j]*tx[j] - tx_power0[j]) >> 3);
+            rx_power1[j] += ((rx[j]*rx[j] - rx_power1[j]) >> 6);
+            rx_power0[j] += ((rx[j]*rx[j] - rx_power0[j]) >> 3);
+            p[POWER_TX_SHORT*channels + j] = tx_power0[j];
+            p[POWER_TX_MEDIUM*channels + j] = tx_power1[j];
+            p[POWER_TX_ABS*channels + j] = tx_power3[j];
+            p[POWER_RX_SHORT*channels + j] = rx_power0[j];
+            p[POWER_RX_MEDIUM*channels + j] = rx_power1[j];
+        }
+        /*endfor*/
+        tx += channels;
+        rx += channels;
+    }
+    /*endfor*/
+}
+/*- End of function --------------------------------------------------------*/
+
+static __inline__ void echo_can_get_power_state(echo_can_state_t *ec, int state[], int channels)
+{
+    state[0*channels] = ec->tx_power[0];
+    state[1*channels] = ec->tx_power[1];
+    state[2*channels] = ec->tx_power[2];
+    state[3*channels] = ec->tx_power[3];
+    state[4*channels] = ec->rx_power[0];
+    state[5*channels] = ec->rx_power[1];
+}
+/*- End of function --------------------------------------------------------*/
+
+static __inline__ void echo_can_put_power_state(echo_can_state_t *ec, const int state[], int channels)
+{
+    ec->tx_power[0] = state[0*channels];
+    ec->tx_power[1] = state[1*channels];
+    ec->tx_power[2] = state[2*channels];
+    ec->tx_power[3] = state[3*channels];
+    ec->rx_power[0] = state[4*channels];
+    ec->rx_power[1] = state[5*channels];
+}
+/*- End of function --------------------------------------------------------*/
+
+static __inline__ void echo_can_revert_taps(echo_can_state_t *ec, int set)
+{
+    int i;
+
+    memcpy(ec->fir_taps16[ec->tap_set], ec->fir_taps16[set], ec->taps*sizeof(int16_t));
+    memcpy(ec->fir_taps16[(ec->tap_set + 2)%3], ec->fir_taps16[set], ec->taps*sizeof(int16_t));
+    for (i = 0;  i < ec->taps;  i++)
+        ec->fir_taps32[i] = ec->fir_taps16[set][i] << 15;
+    /*endfor*/
+    ec->tap_rotate_counter = 1600;
+}
+/*- End of function --------------------------------------------------------*/
+
+static __inline__ void echo_can_adapt(echo_can_state_t *ec, int16_t tx, int clean_rx, const int power[], int stride)
 {
-    int32_t echo_value;
-    int clean_rx;
     int nsuppr;
     int score;
     int i;
 
-sample_no++;
-    if (ec->adaption_mode & ECHO_CAN_USE_RX_HPF)
-        rx = echo_can_hpf(ec->rx_hpf, rx);
-    /*endif*/
-
-    ec->latest_correction = 0;
-    /* Evaluate the echo - i.e. apply the FIR filter */
-    /* Assume the gain of the FIR does not exceed unity. Exceeding unity
-       would seem like a rather poor thing for an echo cancellor to do :)
-       This means we can compute the result with a total disregard for
-       overflows. 16bits x 16bits -> 31bits, so no overflow can occur in
-       any multiply. While accumulating we may overflow and underflow the
-       32 bit scale often. However, if the gain does not exceed unity,
-       everything should work itself out, and the final result will be
-       OK, without any saturation logic. */
-    /* Overflow is very much possible here, and we do nothing about it because
-       of the compute costs */
-    /* 16 bit coeffs for the LMS give lousy results (maths good, actual sound
-       bad!), but 32 bit coeffs require some shifting. On balance 32 bit seems
-       best */
-    echo_value = fir16(&ec->fir_state, tx);
-
-    /* And the answer is..... */
-    clean_rx = rx - echo_value;
-printf("echo is %" PRId32 "\n", echo_value);
     /* That was the easy part. Now we need to adapt! */
     if (ec->nonupdate_dwell > 0)
         ec->nonupdate_dwell--;
     /*endif*/
 
-    /* Calculate short term power levels using very simple single pole IIRs */
-    /* TODO: Is the nasty modulus approach the fastest, or would a real
-             tx*tx power calculation actually be faster? Using the squares
-             makes the numbers grow a lot! */
-    ec->tx_power[3] += ((abs(tx) - ec->tx_power[3]) >> 5);
-    ec->tx_power[2] += ((tx*tx - ec->tx_power[2]) >> 8);
-    ec->tx_power[1] += ((tx*tx - ec->tx_power[1]) >> 5);
-    ec->tx_power[0] += ((tx*tx - ec->tx_power[0]) >> 3);
-    ec->rx_power[1] += ((rx*rx - ec->rx_power[1]) >> 6);
-    ec->rx_power[0] += ((rx*rx - ec->rx_power[0]) >> 3);
-    ec->clean_rx_power += ((clean_rx*clean_rx - ec->clean_rx_power) >> 6);
-
-    score = 0;
     /* If there is very little being transmitted, any attempt to train is
        futile. We would either be training on the far end's noise or signal,
        the channel's own noise, or our noise. Either way, this is hardly good
        training, so don't do it (avoid trouble). */
-    if (ec->tx_power[0] > MIN_TX_POWER_FOR_ADAPTION)
+    if (power[POWER_TX_SHORT*stride] <= MIN_TX_POWER_FOR_ADAPTION)
     {
-        /* If the received power is very low, either we are sending very little or
-           we are already well adapted. There is little point in trying to improve
-           the adaption under these circumstances, so don't do it (reduce the
-           compute load). */
-        if (ec->tx_power[1] > ec->rx_power[0])
+        ec->last_adaption_skip_reason = ADAPTION_SKIPPED_LOW_TX;
+        ec->stats.skipped_low_tx++;
+        return;
+    }
+    /*endif*/
+    /* If the received power is very low, either we are sending very little or
+       we are already well adapted. There is little point in trying to improve
+       the adaption under these circumstances, so don't do it (reduce the
+       compute load). */
+    if (power[POWER_TX_MEDIUM*stride] <= power[POWER_RX_SHORT*stride])
+    {
+        if (!ec->dtd_onset)
         {
-            /* There is no (or little) far-end speech. */
-            if (ec->nonupdate_dwell == 0)
-            {
-                if (++ec->narrowband_count >= 160)
-                {
-                    ec->narrowband_count = 0;
-                    score = narrowband_detect(ec);
-printf("Do the narrowband test %d at %d\n", score, ec->curr_pos);
-                    if (score > 6)
-                    {
-                        if (ec->narrowband_score == 0)
-                            memcpy(ec->fir_taps16[3], ec->fir_taps16[(ec->tap_set + 1)%3], ec->taps*sizeof(int16_t));
-                        /*endif*/
-                        ec->narrowband_score += score;
-                    }
-                    else
-                    {
-                        if (ec->narrowband_score > 200)
-                        {
-printf("Revert to %d at %d\n", (ec->tap_set + 1)%3, sample_no);
-                            memcpy(ec->fir_taps16[ec->tap_set], ec->fir_taps16[3], ec->taps*sizeof(int16_t));
-                            memcpy(ec->fir_taps16[(ec->tap_set - 1)%3], ec->fir_taps16[3], ec->taps*sizeof(int16_t));
-                            for (i = 0;  i < ec->taps;  i++)
-                                ec->fir_taps32[i] = ec->fir_taps16[3][i] << 15;
-                            /*endfor*/
-                            ec->tap_rotate_counter = 1600;
-                        }
-                        /*endif*/
-                        ec->narrowband_score = 0;
-                    }
-                    /*endif*/
-                }
-                /*endif*/
-                ec->dtd_onset = false;
-                if (--ec->tap_rotate_counter <= 0)
-                {
-printf("Rotate to %d at %d\n", ec->tap_set, sample_no);
-                    ec->tap_rotate_counter = 1600;
-                    ec->tap_set++;
-                    if (ec->tap_set > 2)
-                        ec->tap_set = 0;
-                    /*endif*/
-                    ec->fir_state.coeffs = ec->fir_taps16[ec->tap_set];
-                }
-                /*endif*/
-                /* ... and we are not in the dwell time from previous speech. */
-                if ((ec->adaption_mode & ECHO_CAN_USE_ADAPTION)  &&   ec->narrowband_score == 0)
-                {
-                    //nsuppr = saturate16((clean_rx << 16)/ec->tx_power[1]);
-                    //nsuppr = clean_rx/ec->tx_power[1];
-                    /* If a sudden surge in signal level (e.g. the onset of a tone
-                       burst) cause an abnormally high instantaneous to average
-                       signal power ratio, we could kick the adaption badly in the
-                       wrong direction. This is because the tx_power takes too long
-                       to react and rise. We need to stop too rapid adaption to the
-                       new signal. We normalise to a value derived from the
-                       instantaneous signal if it exceeds the peak by too much. */
-                    nsuppr = clean_rx;
-                    /* Divide isn't very quick, but the "where is the top bit" and shift
-                       instructions are single cycle. */
-                    if (tx > 4*ec->tx_power[3])
-                        i = top_bit(tx) - 8;
-                    else
-                        i = top_bit(ec->tx_power[3]) - 8;
-                    /*endif*/
-                    if (i > 0)
-                        nsuppr >>= i;
-                    /*endif*/
-                    lms_adapt(ec, nsuppr);
-                }
-                /*endif*/
-            }
+            echo_can_revert_taps(ec, (ec->tap_set + 1)%3);
+            ec->dtd_onset = true;
+            ec->stats.dtd_hits++;
+        }
+        /*endif*/
+        ec->nonupdate_dwell = NONUPDATE_DWELL_TIME;
+        ec->last_adaption_skip_reason = ADAPTION_SKIPPED_DOUBLE_TALK;
+        ec->stats.skipped_double_talk++;
+        return;
+    }
+    /*endif*/
+    /* There is no (or little) far-end speech. */
+    if (ec->nonupdate_dwell != 0)
+    {
+        ec->last_adaption_skip_reason = ADAPTION_SKIPPED_DWELL;
+        ec->stats.skipped_dwell++;
+        return;
+    }
+    /*endif*/
+    if (++ec->narrowband_count >= 160)
+    {
+        ec->narrowband_count = 0;
+        score = narrowband_detect(ec);
+        if (score > 6)
+        {
+            if (ec->narrowband_score == 0)
+                memcpy(ec->fir_taps16[3], ec->fir_taps16[(ec->tap_set + 1)%3], ec->taps*sizeof(int16_t));
             /*endif*/
-            //printf("%10d %10d %10d %10d %10d\n", rx, clean_rx, nsuppr, ec->tx_power[1], ec->rx_power[1]);
-            //printf("%.4f\n", (float) ec->rx_power[1]/(float) ec->clean_rx_power);
+            ec->narrowband_score += score;
         }
         else
         {
-            if (!ec->dtd_onset)
-            {
-printf("Revert to %d at %d\n", (ec->tap_set + 1)%3, sample_no);
-                memcpy(ec->fir_taps16[ec->tap_set], ec->fir_taps16[(ec->tap_set + 1)%3], ec->taps*sizeof(int16_t));
-                memcpy(ec->fir_taps16[(ec->tap_set - 1)%3], ec->fir_taps16[(ec->tap_set + 1)%3], ec->taps*sizeof(int16_t));
-                for (i = 0;  i < ec->taps;  i++)
-                    ec->fir_taps32[i] = ec->fir_taps16[(ec->tap_set + 1)%3][i] << 15;
-                /*endfor*/
-                ec->tap_rotate_counter = 1600;
-                ec->dtd_onset = true;
-            }
+            if (ec->narrowband_score > 200)
+                echo_can_revert_taps(ec, 3);
             /*endif*/
-            ec->nonupdate_dwell = NONUPDATE_DWELL_TIME;
+            ec->narrowband_score = 0;
         }
         /*endif*/
     }
     /*endif*/
-
-    if (ec->rx_power[1])
-        ec->vad = (8000*ec->clean_rx_power)/ec->rx_power[1];
-    else
-        ec->vad = 0;
-    /*endif*/
-    if (ec->rx_power[1] > 2048*2048  &&  ec->clean_rx_power > 4*ec->rx_power[1])
+    ec->dtd_onset = false;
+    if (--ec->tap_rotate_counter <= 0)
     {
-        /* The EC seems to be making things worse, instead of better. Zap it! */
-        memset(ec->fir_taps32, 0, ec->taps*sizeof(int32_t));
-        for (i = 0;  i < 4;  i++)
-            memset(ec->fir_taps16[i], 0, ec->taps*sizeof(int16_t));
-        /*endfor*/
+        ec->tap_rotate_counter = 1600;
+        ec->tap_set++;
+        if (ec->tap_set > 2)
+            ec->tap_set = 0;
+        /*endif*/
+        ec->fir_state.coeffs = ec->fir_taps16[ec->tap_set];
     }
     /*endif*/
-
-#if defined(XYZZY)
-    if ((ec->adaption_mode & ECHO_CAN_USE_SUPPRESSOR))
+    /* ... and we are not in the dwell time from previous speech. */
+    if ((ec->adaption_mode & ECHO_CAN_USE_ADAPTION)  &&   ec->narrowband_score == 0)
     {
-        ec->supp_test1 += (ec->fir_state.history[ec->curr_pos] - ec->fir_state.history[(ec->curr_pos - 7) & ec->tap_mask]);
-        ec->supp_test2 += (ec->fir_state.history[(ec->curr_pos - 24) & ec->tap_mask] - ec->fir_state.history[(ec->curr_pos - 31) & ec->tap_mask]);
-        if (ec->supp_test1 > 42  &&  ec->supp_test2 > 42)
-            supp_change = 25;
+        /* If a sudden surge in signal level (e.g. the onset of a tone
+           burst) cause an abnormally high instantaneous to average
+           signal power ratio, we could kick the adaption badly in the
+           wrong direction. This is because the tx_power takes too long
+           to react and rise. We need to stop too rapid adaption to the
+           new signal. We normalise to a value derived from the
+           instantaneous signal if it exceeds the peak by too much. */
+        nsuppr = clean_rx;
+        /* Divide isn't very quick, but the "where is the top bit" and shift
+           instructions are single cycle. */
+        if (tx > 4*power[POWER_TX_ABS*stride])
+            i = top_bit(tx) - 8;
+        else
+            i = top_bit(power[POWER_TX_ABS*stride]) - 8;
+        /*endif*/
+        if (i > 0)
+            nsuppr >>= i;
+        /*endif*/
+        if ((ec->adaption_mode & ECHO_CAN_USE_PNLMS)  ||  ec->window_len < ec->taps)
+            lms_adapt_window(ec, nsuppr);
         else
-            supp_change = 50;
+            lms_adapt(ec, nsuppr);
         /*endif*/
-        supp = supp_change + k1*ec->supp1 + k2*ec->supp2;
-        ec->supp2 = ec->supp1;
-        ec->supp1 = supp;
-        clean_rx *= (1 - supp);
+        ec->latest_correction = nsuppr;
+        ec->stats.adapted_samples++;
+    }
+    else if (ec->narrowband_score)
+    {
+        ec->last_adaption_skip_reason = ADAPTION_SKIPPED_NARROWBAND;
+        ec->stats.skipped_narrowband++;
     }
     /*endif*/
-#endif
+}
+/*- End of function --------------------------------------------------------*/
 
-    if ((ec->adaption_mode & ECHO_CAN_USE_NLP))
+static __inline__ void echo_can_nlp(echo_can_state_t *ec, int16_t clean_rx[], const int power[], int stride, const int clean_rx_power[], int len)
+{
+    int i;
+
+    for (i = 0;  i < len;  i++)
     {
         /* Non-linear processor - a fancy way to say "zap small signals, to avoid
            residual echo due to (uLaw/ALaw) non-linearity in the channel.". */
-        if (ec->rx_power[1] < 30000000)
+        if (power[(i*POWER_TRACES + POWER_RX_MEDIUM)*stride] < 30000000)
         {
+            ec->stats.nlp_samples++;
             if (!ec->cng)
             {
-                ec->cng_level = ec->clean_rx_power;
+                ec->cng_level = clean_rx_power[i];
                 ec->cng = true;
             }
             /*endif*/
@@ -628,15 +1411,14 @@ printf("Revert to %d at %d\n", (ec->tap_set + 1)%3, sample_no);
                 /* Just random numbers rolled off very vaguely Hoth-like */
                 ec->cng_rndnum = 1664525U*ec->cng_rndnum + 1013904223U;
                 ec->cng_filter = ((ec->cng_rndnum & 0xFFFF) - 32768 + 5*ec->cng_filter) >> 3;
-                clean_rx = (ec->cng_filter*ec->cng_level) >> 17;
+                clean_rx[i] = (int16_t) ((ec->cng_filter*ec->cng_level) >> 17);
                 /* TODO: A better CNG, with more accurate (tracking) spectral shaping! */
             }
             else
             {
-                clean_rx = 0;
+                clean_rx[i] = 0;
             }
             /*endif*/
-//clean_rx = -16000;
         }
         else
         {
@@ -644,19 +1426,294 @@ printf("Revert to %d at %d\n", (ec->tap_set + 1)%3, sample_no);
         }
         /*endif*/
     }
-    else
+    /*endfor*/
+}
+/*- End of function --------------------------------------------------------*/
+
+static __inline__ void echo_can_update_stats(echo_can_state_t *ec,
+                                             int64_t tx_energy,
+                                             int64_t rx_energy,
+                                             int64_t clean_rx_energy,
+                                             int len)
+{
+    float alpha;
+
+    /* The energies are gathered until there is at least a chunk's worth, so
+       sample by sample processing does not pay for the averaging and
+       publishing on every sample. */
+    ec->stats_tx_energy += tx_energy;
+    ec->stats_rx_energy += rx_energy;
+    ec->stats_clean_rx_energy += clean_rx_energy;
+    if ((ec->stats_len += len) < ECHO_CAN_CHUNK_SIZE)
+        return;
+    /*endif*/
+    len = ec->stats_len;
+    /* Long term (about half a second) averages of the signal powers, for the
+       ERL and ERLE. */
+    alpha = (len >= STATS_POWER_SAMPLES)  ?  1.0f  :  (float) len/STATS_POWER_SAMPLES;
+    ec->stats.tx_power += alpha*((float) ec->stats_tx_energy/len - ec->stats.tx_power);
+    ec->stats.rx_power += alpha*((float) ec->stats_rx_energy/len - ec->stats.rx_power);
+    ec->stats.clean_rx_power += alpha*((float) ec->stats_clean_rx_energy/len - ec->stats.clean_rx_power);
+    ec->stats.samples += len;
+    ec->stats_tx_energy = 0;
+    ec->stats_rx_energy = 0;
+    ec->stats_clean_rx_energy = 0;
+    ec->stats_len = 0;
+    echo_can_publish_stats(ec);
+}
+/*- End of function --------------------------------------------------------*/
+
+static float power_to_dbm0(float power)
+{
+    return 10.0f*log10f(power/(32767.0f*32767.0f) + 1.0e-10f) + DBM0_MAX_POWER;
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_DECLARE(int) echo_can_get_stats(echo_can_state_t *ec, echo_can_stats_t *t)
+{
+    uint32_t seq;
+
+    do
     {
-        ec->cng = false;
+        seq = ec->stats_seq;
+        stats_fence_acquire();
+        *t = ec->published_stats;
+        stats_fence_acquire();
+    }
+    while ((seq & 1)  ||  seq != ec->stats_seq);
+    /* The powers are held as mean squares, and are only converted to dB here */
+    t->tx_power = power_to_dbm0(t->tx_power);
+    t->rx_power = power_to_dbm0(t->rx_power);
+    t->clean_rx_power = power_to_dbm0(t->clean_rx_power);
+    t->erl = t->tx_power - t->rx_power;
+    t->erle = t->rx_power - t->clean_rx_power;
+    return 0;
+}
+/*- End of function --------------------------------------------------------*/
+
+/* Process up to ECHO_CAN_CHUNK_SIZE samples, once the power meters have been run over
+   them. rx and power are interleaved with stride - 1 for a lone canceller, or the
+   number of channels for a bank. */
+static void echo_can_process_chunk(echo_can_state_t *ec,
+                                   const int16_t tx[],
+                                   const int16_t rx[],
+                                   int16_t clean_rx[],
+                                   const int power[],
+                                   int stride,
+                                   int len)
+{
+    int clean_rx_power[ECHO_CAN_CHUNK_SIZE];
+    const int *p;
+    int32_t echo_value;
+    int64_t tx_energy;
+    int64_t rx_energy;
+    int64_t clean_rx_energy;
+    int clean;
+    int i;
+    int j;
+
+    tx_energy = 0;
+    rx_energy = 0;
+    clean_rx_energy = 0;
+    for (i = 0;  i < len;  i++)
+    {
+        ec->latest_correction = 0;
+        ec->last_adaption_skip_reason = ADAPTION_NOT_SKIPPED;
+        /* Evaluate the echo - i.e. apply the FIR filter */
+        /* Assume the gain of the FIR does not exceed unity. Exceeding unity
+           would seem like a rather poor thing for an echo cancellor to do :)
+           This means we can compute the result with a total disregard for
+           overflows. 16bits x 16bits -> 31bits, so no overflow can occur in
+           any multiply. While accumulating we may overflow and underflow the
+           32 bit scale often. However, if the gain does not exceed unity,
+           everything should work itself out, and the final result will be
+           OK, without any saturation logic. */
+        /* Overflow is very much possible here, and we do nothing about it because
+           of the compute costs */
+        /* 16 bit coeffs for the LMS give lousy results (maths good, actual sound
+           bad!), but 32 bit coeffs require some shifting. On balance 32 bit seems
+           best */
+        p = &power[i*POWER_TRACES*stride];
+        if ((ec->adaption_mode & ECHO_CAN_USE_FREQ_DOMAIN))
+        {
+            clean = echo_can_fd_update(ec, tx[i], rx[i*stride], echo_can_fd_gate(ec, p, stride));
+            ec->clean_rx_power += ((clean*clean - ec->clean_rx_power) >> 6);
+        }
+        else
+        {
+            if (ec->window_len < ec->taps)
+                echo_value = fir16_window(ec, tx[i]);
+            else
+                echo_value = fir16(&ec->fir_state, tx[i]);
+            /*endif*/
+
+            /* And the answer is..... */
+            clean = rx[i*stride] - echo_value;
+            ec->clean_rx_power += ((clean*clean - ec->clean_rx_power) >> 6);
+            echo_can_adapt(ec, tx[i], clean, p, stride);
+            if ((ec->adaption_mode & ECHO_CAN_USE_TAIL_WINDOW)  &&  ++ec->tail_locate_count >= TAIL_LOCATE_INTERVAL)
+            {
+                ec->tail_locate_count = 0;
+                echo_can_locate_tail(ec, p[POWER_RX_MEDIUM*stride]);
+            }
+            /*endif*/
+        }
+        /*endif*/
+        clean_rx_power[i] = ec->clean_rx_power;
+        clean_rx[i] = (int16_t) clean;
+        tx_energy += tx[i]*tx[i];
+        rx_energy += rx[i*stride]*rx[i*stride];
+        clean_rx_energy += clean_rx[i]*clean_rx[i];
+
+        if (p[POWER_RX_MEDIUM*stride] > 2048*2048  &&  ec->clean_rx_power > 4*p[POWER_RX_MEDIUM*stride])
+        {
+            /* The EC seems to be making things worse, instead of better. Zap it! */
+            ec->stats.resets++;
+            memset(ec->fir_taps32, 0, ec->taps*sizeof(int32_t));
+            for (j = 0;  j < 4;  j++)
+                memset(ec->fir_taps16[j], 0, ec->taps*sizeof(int16_t));
+            /*endfor*/
+            if (ec->fd)
+            {
+                memset(ec->fd->w, 0, ec->fd->partitions*FD_FFT_LEN*sizeof(complexf_t));
+                memset(ec->fd->head, 0, FD_BLOCK_LEN*sizeof(float));
+                memset(ec->fd->tail, 0, FD_BLOCK_LEN*sizeof(float));
+            }
+            /*endif*/
+        }
+        /*endif*/
+
+        /* Roll around the rolling buffer */
+        if (ec->curr_pos <= 0)
+            ec->curr_pos = ec->taps;
+        /*endif*/
+        ec->curr_pos--;
     }
+    /*endfor*/
+
+    if (ec->rx_power[1])
+        ec->vad = (8000*ec->clean_rx_power)/ec->rx_power[1];
+    else
+        ec->vad = 0;
     /*endif*/
 
-printf("Narrowband score %4d %5d at %d\n", ec->narrowband_score, score, sample_no);
-    /* Roll around the rolling buffer */
-    if (ec->curr_pos <= 0)
-        ec->curr_pos = ec->taps;
+    if ((ec->adaption_mode & ECHO_CAN_USE_NLP))
+        echo_can_nlp(ec, clean_rx, power, stride, clean_rx_power, len);
+    else
+        ec->cng = false;
     /*endif*/
-    ec->curr_pos--;
-    return (int16_t) clean_rx;
+    echo_can_update_stats(ec, tx_energy, rx_energy, clean_rx_energy, len);
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_DECLARE(int) echo_can_update_block(echo_can_state_t *ec, const int16_t tx[], const int16_t rx[], int16_t clean_rx[], int len)
+{
+    int16_t rx_hpf[ECHO_CAN_CHUNK_SIZE];
+    int power[ECHO_CAN_CHUNK_SIZE*POWER_TRACES];
+    int state[6];
+    const int16_t *rxx;
+    int chunk;
+    int i;
+    int j;
+
+    for (j = 0;  j < len;  j += chunk)
+    {
+        chunk = len - j;
+        if (chunk > ECHO_CAN_CHUNK_SIZE)
+            chunk = ECHO_CAN_CHUNK_SIZE;
+        /*endif*/
+        rxx = &rx[j];
+        if (ec->adaption_mode & ECHO_CAN_USE_RX_HPF)
+        {
+            for (i = 0;  i < chunk;  i++)
+                rx_hpf[i] = echo_can_hpf(ec->rx_hpf, rxx[i]);
+            /*endfor*/
+            rxx = rx_hpf;
+        }
+        /*endif*/
+        echo_can_get_power_state(ec, state, 1);
+        echo_can_power_meters(state, &tx[j], rxx, power, 1, chunk);
+        echo_can_put_power_state(ec, state, 1);
+        echo_can_process_chunk(ec, &tx[j], rxx, &clean_rx[j], power, 1, chunk);
+    }
+    /*endfor*/
+    return len;
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_DECLARE(int16_t) echo_can_update(echo_can_state_t *ec, int16_t tx, int16_t rx)
+{
+    int16_t clean_rx;
+
+    echo_can_update_block(ec, &tx, &rx, &clean_rx, 1);
+    return clean_rx;
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_DECLARE(echo_can_state_t *) echo_can_bank_get_channel(echo_can_bank_state_t *s, int channel)
+{
+    if (channel < 0  ||  channel >= s->channels)
+        return NULL;
+    /*endif*/
+    return &s->chan[channel];
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_DECLARE(int) echo_can_bank_update_block(echo_can_bank_state_t *s,
+                                             const int16_t *tx[],
+                                             const int16_t *rx[],
+                                             int16_t *clean_rx[],
+                                             int len)
+{
+    echo_can_state_t *ec;
+    int channels;
+    int chunk;
+    int i;
+    int j;
+    int k;
+
+    channels = s->channels;
+    for (j = 0;  j < len;  j += chunk)
+    {
+        chunk = len - j;
+        if (chunk > ECHO_CAN_CHUNK_SIZE)
+            chunk = ECHO_CAN_CHUNK_SIZE;
+        /*endif*/
+        /* Interleave the chunk of each channel into the bank's working buffers,
+           applying the RX high pass filter on the way. */
+        for (k = 0;  k < channels;  k++)
+        {
+            ec = &s->chan[k];
+            for (i = 0;  i < chunk;  i++)
+                s->tx_block[i*channels + k] = tx[k][j + i];
+            /*endfor*/
+            if (ec->adaption_mode & ECHO_CAN_USE_RX_HPF)
+            {
+                for (i = 0;  i < chunk;  i++)
+                    s->rx_block[i*channels + k] = echo_can_hpf(ec->rx_hpf, rx[k][j + i]);
+                /*endfor*/
+            }
+            else
+            {
+                for (i = 0;  i < chunk;  i++)
+                    s->rx_block[i*channels + k] = rx[k][j + i];
+                /*endfor*/
+            }
+            /*endif*/
+            echo_can_get_power_state(ec, &s->power_state[k], channels);
+        }
+        /*endfor*/
+        echo_can_power_meters(s->power_state, s->tx_block, s->rx_block, s->power, channels, chunk);
+        for (k = 0;  k < channels;  k++)
+        {
+            ec = &s->chan[k];
+            echo_can_put_power_state(ec, &s->power_state[k], channels);
+            echo_can_process_chunk(ec, &tx[k][j], &s->rx_block[k], &clean_rx[k][j], &s->power[k], channels, chunk);
+        }
+        /*endfor*/
+    }
+    /*endfor*/
+    return len;
 }
 /*- End of function --------------------------------------------------------*/
 
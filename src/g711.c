@@ -34,14 +34,21 @@
 #include <string.h>
 #include <assert.h>
 
+#include "mmx_sse_decs.h"
+
 #include "spandsp/telephony.h"
+#include "spandsp/cpu_features.h"
 #include "spandsp/alloc.h"
 #include "spandsp/bit_operations.h"
 #include "spandsp/g711.h"
 #include "spandsp/private/g711.h"
 
+/* The transcoding tables have 3 bytes of padding, so the AVX2 code can gather
+   32 bits from any position in the 256 real entries. */
+#define G711_TABLE_PADDING  3
+
 /* Copied from the CCITT G.711 specification */
-static const uint8_t ulaw_to_alaw_table[256] =
+static const uint8_t ulaw_to_alaw_table[256 + G711_TABLE_PADDING] =
 {
      42,  43,  40,  41,  46,  47,  44,  45,  34,  35,  32,  33,  38,  39,  36,  37,
      58,  59,  56,  57,  62,  63,  60,  61,  50,  51,  48,  49,  54,  55,  52,  53,
@@ -64,7 +71,7 @@ static const uint8_t ulaw_to_alaw_table[256] =
 /* These transcoding tables are copied from the CCITT G.711 specification. To achieve
    optimal results, do not change them. */
 
-static const uint8_t alaw_to_ulaw_table[256] =
+static const uint8_t alaw_to_ulaw_table[256 + G711_TABLE_PADDING] =
 {
      42,  43,  40,  41,  46,  47,  44,  45,  34,  35,  32,  33,  38,  39,  36,  37,
      57,  58,  55,  56,  61,  62,  59,  60,  49,  50,  47,  48,  53,  54,  51,  52,
@@ -96,6 +103,183 @@ SPAN_DECLARE(uint8_t) ulaw_to_alaw(uint8_t ulaw)
 }
 /*- End of function --------------------------------------------------------*/
 
+#if defined(SPANDSP_USE_RUNTIME_DISPATCH)
+/* The AVX2 routines work on 8 samples at a time, in 32 bit lanes, so the variable
+   shifts can be used. They produce exactly the same results as the scalar routines in
+   g711.h, and return the number of samples they dealt with. The caller finishes off
+   the last few with the scalar code. */
+
+/* Pack the low bytes of 8 32 bit lanes into 8 consecutive bytes */
+SPAN_TARGET("avx2") static __inline__ void store_bytes_avx2(uint8_t *out, __m256i x)
+{
+    __m128i lo;
+    __m128i hi;
+
+    x = _mm256_shuffle_epi8(x,
+                            _mm256_setr_epi8(0, 4, 8, 12, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+                                             0, 4, 8, 12, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1));
+    lo = _mm256_castsi256_si128(x);
+    hi = _mm256_extracti128_si256(x, 1);
+    _mm_storel_epi64((__m128i *) out, _mm_unpacklo_epi32(lo, hi));
+}
+/*- End of function --------------------------------------------------------*/
+
+/* Pack 8 32 bit lanes, which are known to fit, into 8 consecutive 16 bit words */
+SPAN_TARGET("avx2") static __inline__ void store_words_avx2(int16_t *out, __m256i x)
+{
+    x = _mm256_packs_epi32(x, x);
+    x = _mm256_permute4x64_epi64(x, _MM_SHUFFLE(3, 1, 2, 0));
+    _mm_storeu_si128((__m128i *) out, _mm256_castsi256_si128(x));
+}
+/*- End of function --------------------------------------------------------*/
+
+/* Find top_bit(x | 0xFF) - 7 for each lane, limited to max_seg, with a comparison
+   against each segment boundary. */
+SPAN_TARGET("avx2") static __inline__ __m256i segment_avx2(__m256i x, int max_seg)
+{
+    __m256i seg;
+    int i;
+
+    seg = _mm256_setzero_si256();
+    for (i = 0;  i < max_seg;  i++)
+        seg = _mm256_sub_epi32(seg, _mm256_cmpgt_epi32(x, _mm256_set1_epi32((0x100 << i) - 1)));
+    /*endfor*/
+    return seg;
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_TARGET("avx2") static int linear_to_alaw_avx2(uint8_t g711_data[], const int16_t amp[], int len)
+{
+    __m256i x;
+    __m256i neg;
+    __m256i seg;
+    __m256i shift;
+    __m256i a;
+    int i;
+
+    for (i = 0;  i + 8 <= len;  i += 8)
+    {
+        x = _mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i *) &amp[i]));
+        /* Negative values become -x - 1, which is ~x */
+        neg = _mm256_cmpgt_epi32(_mm256_setzero_si256(), x);
+        x = _mm256_xor_si256(x, neg);
+        /* A 16 bit magnitude never gets beyond segment 7 */
+        seg = segment_avx2(x, 7);
+        /* Segment 0 is shifted by 4, like segment 1 */
+        shift = _mm256_add_epi32(seg, _mm256_set1_epi32(3));
+        shift = _mm256_sub_epi32(shift, _mm256_cmpeq_epi32(seg, _mm256_setzero_si256()));
+        a = _mm256_and_si256(_mm256_srlv_epi32(x, shift), _mm256_set1_epi32(0x0F));
+        a = _mm256_or_si256(a, _mm256_slli_epi32(seg, 4));
+        a = _mm256_xor_si256(a, _mm256_set1_epi32(0x80 | G711_ALAW_AMI_MASK));
+        a = _mm256_xor_si256(a, _mm256_and_si256(neg, _mm256_set1_epi32(0x80)));
+        store_bytes_avx2(&g711_data[i], a);
+    }
+    /*endfor*/
+    return i;
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_TARGET("avx2") static int alaw_to_linear_avx2(int16_t amp[], const uint8_t g711_data[], int len)
+{
+    __m256i a;
+    __m256i seg;
+    __m256i nonzero;
+    __m256i pos;
+    __m256i x;
+    int i;
+
+    for (i = 0;  i + 8 <= len;  i += 8)
+    {
+        a = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i *) &g711_data[i]));
+        a = _mm256_xor_si256(a, _mm256_set1_epi32(G711_ALAW_AMI_MASK));
+        seg = _mm256_srli_epi32(_mm256_and_si256(a, _mm256_set1_epi32(0x70)), 4);
+        nonzero = _mm256_cmpgt_epi32(seg, _mm256_setzero_si256());
+        /* Segment 0 is (q << 4) + 8. Segment n is ((q << 4) + 0x108) << (n - 1) */
+        x = _mm256_slli_epi32(_mm256_and_si256(a, _mm256_set1_epi32(0x0F)), 4);
+        x = _mm256_add_epi32(x, _mm256_set1_epi32(8));
+        x = _mm256_add_epi32(x, _mm256_and_si256(nonzero, _mm256_set1_epi32(0x100)));
+        x = _mm256_sllv_epi32(x, _mm256_and_si256(_mm256_sub_epi32(seg, _mm256_set1_epi32(1)), nonzero));
+        pos = _mm256_cmpeq_epi32(_mm256_and_si256(a, _mm256_set1_epi32(0x80)), _mm256_setzero_si256());
+        x = _mm256_sub_epi32(_mm256_xor_si256(x, pos), pos);
+        store_words_avx2(&amp[i], x);
+    }
+    /*endfor*/
+    return i;
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_TARGET("avx2") static int linear_to_ulaw_avx2(uint8_t g711_data[], const int16_t amp[], int len)
+{
+    __m256i x;
+    __m256i neg;
+    __m256i seg;
+    __m256i u;
+    int i;
+
+    for (i = 0;  i + 8 <= len;  i += 8)
+    {
+        x = _mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i *) &amp[i]));
+        neg = _mm256_cmpgt_epi32(_mm256_setzero_si256(), x);
+        x = _mm256_add_epi32(_mm256_abs_epi32(x), _mm256_set1_epi32(G711_ULAW_BIAS));
+        /* Segment 8 means the value must be clipped */
+        seg = segment_avx2(x, 8);
+        u = _mm256_and_si256(_mm256_srlv_epi32(x, _mm256_add_epi32(seg, _mm256_set1_epi32(3))), _mm256_set1_epi32(0x0F));
+        u = _mm256_or_si256(u, _mm256_slli_epi32(seg, 4));
+        u = _mm256_blendv_epi8(u, _mm256_set1_epi32(0x7F), _mm256_cmpeq_epi32(seg, _mm256_set1_epi32(8)));
+        u = _mm256_xor_si256(u, _mm256_set1_epi32(0xFF));
+        u = _mm256_xor_si256(u, _mm256_and_si256(neg, _mm256_set1_epi32(0x80)));
+#if defined(G711_ULAW_ZEROTRAP)
+        /* Optional ITU trap */
+        u = _mm256_or_si256(u, _mm256_and_si256(_mm256_cmpeq_epi32(u, _mm256_setzero_si256()), _mm256_set1_epi32(0x02)));
+#endif
+        store_bytes_avx2(&g711_data[i], u);
+    }
+    /*endfor*/
+    return i;
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_TARGET("avx2") static int ulaw_to_linear_avx2(int16_t amp[], const uint8_t g711_data[], int len)
+{
+    __m256i u;
+    __m256i neg;
+    __m256i x;
+    int i;
+
+    for (i = 0;  i + 8 <= len;  i += 8)
+    {
+        u = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i *) &g711_data[i]));
+        u = _mm256_xor_si256(u, _mm256_set1_epi32(0xFF));
+        x = _mm256_slli_epi32(_mm256_and_si256(u, _mm256_set1_epi32(0x0F)), 3);
+        x = _mm256_add_epi32(x, _mm256_set1_epi32(G711_ULAW_BIAS));
+        x = _mm256_sllv_epi32(x, _mm256_srli_epi32(_mm256_and_si256(u, _mm256_set1_epi32(0x70)), 4));
+        x = _mm256_sub_epi32(x, _mm256_set1_epi32(G711_ULAW_BIAS));
+        neg = _mm256_cmpeq_epi32(_mm256_and_si256(u, _mm256_set1_epi32(0x80)), _mm256_set1_epi32(0x80));
+        x = _mm256_sub_epi32(_mm256_xor_si256(x, neg), neg);
+        store_words_avx2(&amp[i], x);
+    }
+    /*endfor*/
+    return i;
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_TARGET("avx2") static int transcode_avx2(uint8_t g711_out[], const uint8_t g711_in[], int len, const uint8_t table[])
+{
+    __m256i x;
+    int i;
+
+    for (i = 0;  i + 8 <= len;  i += 8)
+    {
+        x = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i *) &g711_in[i]));
+        x = _mm256_i32gather_epi32((const int *) table, x, 1);
+        store_bytes_avx2(&g711_out[i], x);
+    }
+    /*endfor*/
+    return i;
+}
+/*- End of function --------------------------------------------------------*/
+#endif
+
 SPAN_DECLARE(int) g711_decode(g711_state_t *s,
                               int16_t amp[],
                               const uint8_t g711_data[],
@@ -103,15 +287,26 @@ SPAN_DECLARE(int) g711_decode(g711_state_t *s,
 {
     int i;
 
+    i = 0;
     if (s->mode == G711_ALAW)
     {
-        for (i = 0;  i < g711_bytes;  i++)
+#if defined(SPANDSP_USE_RUNTIME_DISPATCH)
+        if ((span_cpu_dispatch_features & SPAN_CPU_FEATURE_AVX2))
+            i = alaw_to_linear_avx2(amp, g711_data, g711_bytes);
+        /*endif*/
+#endif
+        for (  ;  i < g711_bytes;  i++)
             amp[i] = alaw_to_linear(g711_data[i]);
         /*endfor*/
     }
     else
     {
-        for (i = 0;  i < g711_bytes;  i++)
+#if defined(SPANDSP_USE_RUNTIME_DISPATCH)
+        if ((span_cpu_dispatch_features & SPAN_CPU_FEATURE_AVX2))
+            i = ulaw_to_linear_avx2(amp, g711_data, g711_bytes);
+        /*endif*/
+#endif
+        for (  ;  i < g711_bytes;  i++)
             amp[i] = ulaw_to_linear(g711_data[i]);
         /*endfor*/
     }
@@ -127,15 +322,26 @@ SPAN_DECLARE(int) g711_encode(g711_state_t *s,
 {
     int i;
 
+    i = 0;
     if (s->mode == G711_ALAW)
     {
-        for (i = 0;  i < len;  i++)
+#if defined(SPANDSP_USE_RUNTIME_DISPATCH)
+        if ((span_cpu_dispatch_features & SPAN_CPU_FEATURE_AVX2))
+            i = linear_to_alaw_avx2(g711_data, amp, len);
+        /*endif*/
+#endif
+        for (  ;  i < len;  i++)
             g711_data[i] = linear_to_alaw(amp[i]);
         /*endfor*/
     }
     else
     {
-        for (i = 0;  i < len;  i++)
+#if defined(SPANDSP_USE_RUNTIME_DISPATCH)
+        if ((span_cpu_dispatch_features & SPAN_CPU_FEATURE_AVX2))
+            i = linear_to_ulaw_avx2(g711_data, amp, len);
+        /*endif*/
+#endif
+        for (  ;  i < len;  i++)
             g711_data[i] = linear_to_ulaw(amp[i]);
         /*endfor*/
     }
@@ -151,15 +357,26 @@ SPAN_DECLARE(int) g711_transcode(g711_state_t *s,
 {
     int i;
 
+    i = 0;
     if (s->mode == G711_ALAW)
     {
-        for (i = 0;  i < g711_bytes;  i++)
+#if defined(SPANDSP_USE_RUNTIME_DISPATCH)
+        if ((span_cpu_dispatch_features & SPAN_CPU_FEATURE_AVX2))
+            i = transcode_avx2(g711_out, g711_in, g711_bytes, alaw_to_ulaw_table);
+        /*endif*/
+#endif
+        for (  ;  i < g711_bytes;  i++)
             g711_out[i] = alaw_to_ulaw_table[g711_in[i]];
         /*endfor*/
     }
     else
     {
-        for (i = 0;  i < g711_bytes;  i++)
+#if defined(SPANDSP_USE_RUNTIME_DISPATCH)
+        if ((span_cpu_dispatch_features & SPAN_CPU_FEATURE_AVX2))
+            i = transcode_avx2(g711_out, g711_in, g711_bytes, ulaw_to_alaw_table);
+        /*endif*/
+#endif
+        for (  ;  i < g711_bytes;  i++)
             g711_out[i] = ulaw_to_alaw_table[g711_in[i]];
         /*endfor*/
     }
@@ -45,12 +45,13 @@
 #include "spandsp/stdbool.h"
 #endif
 #include "floating_fudge.h"
+#include "mmx_sse_decs.h"
 
 #include "spandsp/telephony.h"
+#include "spandsp/cpu_features.h"
 #include "spandsp/alloc.h"
 #include "spandsp/fast_convert.h"
 #include "spandsp/saturated.h"
-#include "spandsp/vector_int.h"
 #include "spandsp/g722.h"
 
 #include "spandsp/private/g722.h"
@@ -65,6 +66,63 @@ static const int16_t qmf_coeffs_rev[12] =
     -11,   53, -156,  362, -805, 3876,  951, -210,   32,   12,  -11,    3
 };
 
+/* Apply both halves of the QMF to a window of history. The history is kept twice over,
+   so each window of 12 samples is contiguous. */
+static __inline__ void qmf_dot_prods_base(int32_t *sum_fwd, int32_t *sum_rev, const int16_t x[], const int16_t y[])
+{
+    int32_t fwd;
+    int32_t rev;
+    int i;
+
+    fwd = 0;
+    rev = 0;
+    for (i = 0;  i < 12;  i++)
+    {
+        fwd += (int32_t) x[i]*qmf_coeffs_fwd[i];
+        rev += (int32_t) y[i]*qmf_coeffs_rev[i];
+    }
+    /*endfor*/
+    *sum_fwd = fwd;
+    *sum_rev = rev;
+}
+/*- End of function --------------------------------------------------------*/
+
+#if defined(SPANDSP_USE_RUNTIME_DISPATCH)
+SPAN_TARGET("sse2") static __inline__ void qmf_dot_prods_sse2(int32_t *sum_fwd, int32_t *sum_rev, const int16_t x[], const int16_t y[])
+{
+    __m128i n1;
+    __m128i n2;
+
+    /* 8 taps of each filter in one register, and the other 4 in the low half of another.
+       The 32 bit sums wrap around just like the C code, so the results are exactly the same. */
+    n1 = _mm_add_epi32(_mm_madd_epi16(_mm_loadu_si128((const __m128i *) x), _mm_loadu_si128((const __m128i *) qmf_coeffs_fwd)),
+                       _mm_madd_epi16(_mm_loadl_epi64((const __m128i *) (x + 8)), _mm_loadl_epi64((const __m128i *) (qmf_coeffs_fwd + 8))));
+    n2 = _mm_add_epi32(_mm_madd_epi16(_mm_loadu_si128((const __m128i *) y), _mm_loadu_si128((const __m128i *) qmf_coeffs_rev)),
+                       _mm_madd_epi16(_mm_loadl_epi64((const __m128i *) (y + 8)), _mm_loadl_epi64((const __m128i *) (qmf_coeffs_rev + 8))));
+    /* Sum the two sets of 4 partial sums together, leaving the forward total in lane 0,
+       and the reverse total in lane 1 */
+    n1 = _mm_add_epi32(_mm_unpacklo_epi32(n1, n2), _mm_unpackhi_epi32(n1, n2));
+    n1 = _mm_add_epi32(n1, _mm_shuffle_epi32(n1, _MM_SHUFFLE(1, 0, 3, 2)));
+    *sum_fwd = _mm_cvtsi128_si32(n1);
+    *sum_rev = _mm_cvtsi128_si32(_mm_shuffle_epi32(n1, _MM_SHUFFLE(1, 1, 1, 1)));
+}
+/*- End of function --------------------------------------------------------*/
+#endif
+
+static __inline__ void qmf_dot_prods(int32_t *sum_fwd, int32_t *sum_rev, const int16_t x[], const int16_t y[])
+{
+#if defined(SPANDSP_USE_RUNTIME_DISPATCH)
+    if ((span_cpu_dispatch_features & SPAN_CPU_FEATURE_SSE2))
+    {
+        qmf_dot_prods_sse2(sum_fwd, sum_rev, x, y);
+        return;
+    }
+    /*endif*/
+#endif
+    qmf_dot_prods_base(sum_fwd, sum_rev, x, y);
+}
+/*- End of function --------------------------------------------------------*/
+
 static const int16_t qm2[4] =
 {
     -7408,  -1616,   7408,   1616
@@ -271,6 +329,8 @@ SPAN_DECLARE(int) g722_decode(g722_decode_state_t *s, int16_t amp[], const uint8
     int code;
     int outlen;
     int j;
+    int32_t sumeven;
+    int32_t sumodd;
 
     outlen = 0;
     rhigh = 0;
@@ -391,15 +451,18 @@ SPAN_DECLARE(int) g722_decode(g722_decode_state_t *s, int16_t amp[], const uint8
             else
             {
                 /* Apply the QMF to build the final signal */
-                s->x[s->ptr] = (int16_t) (rlow + rhigh);
-                s->y[s->ptr] = (int16_t) (rlow - rhigh);
+                s->x[s->ptr] =
+                s->x[s->ptr + 12] = (int16_t) (rlow + rhigh);
+                s->y[s->ptr] =
+                s->y[s->ptr + 12] = (int16_t) (rlow - rhigh);
                 if (++s->ptr >= 12)
                     s->ptr = 0;
                 /*endif*/
+                qmf_dot_prods(&sumodd, &sumeven, &s->x[s->ptr], &s->y[s->ptr]);
                 /* We shift by 12 to allow for the QMF filters (DC gain = 4096), less 1
                    to allow for the 15 bit input to the G.722 algorithm. */
-                amp[outlen++] = saturate16(vec_circular_dot_prodi16(s->y, qmf_coeffs_rev, 12, s->ptr) >> 11);
-                amp[outlen++] = saturate16(vec_circular_dot_prodi16(s->x, qmf_coeffs_fwd, 12, s->ptr) >> 11);
+                amp[outlen++] = saturate16(sumeven >> 11);
+                amp[outlen++] = saturate16(sumodd >> 11);
             }
             /*endif*/
         }
@@ -499,12 +562,14 @@ SPAN_DECLARE(int) g722_encode(g722_encode_state_t *s, uint8_t g722_data[], const
             else
             {
                 /* Apply the transmit QMF */
-                s->x[s->ptr] = amp[j++];
-                s->y[s->ptr] = amp[j++];
+                s->x[s->ptr] =
+                s->x[s->ptr + 12] = amp[j++];
+                s->y[s->ptr] =
+                s->y[s->ptr + 12] = amp[j++];
                 if (++s->ptr >= 12)
                     s->ptr = 0;
-                sumodd = vec_circular_dot_prodi16(s->x, qmf_coeffs_fwd, 12, s->ptr);
-                sumeven = vec_circular_dot_prodi16(s->y, qmf_coeffs_rev, 12, s->ptr);
+                /*endif*/
+                qmf_dot_prods(&sumodd, &sumeven, &s->x[s->ptr], &s->y[s->ptr]);
                 /* We shift by 12 to allow for the QMF filters (DC gain = 4096), plus 1
                    to allow for us summing two filters, plus 1 to allow for the 15 bit
                    input to the G.722 algorithm. */
@@ -70,8 +70,10 @@
 #include "spandsp/stdbool.h"
 #endif
 #include "floating_fudge.h"
+#include "mmx_sse_decs.h"
 
 #include "spandsp/telephony.h"
+#include "spandsp/cpu_features.h"
 #include "spandsp/alloc.h"
 #include "spandsp/bitstream.h"
 #include "spandsp/bit_operations.h"
@@ -1041,66 +1043,132 @@ static int16_t g726_40_decoder(g726_state_t *s, uint8_t code)
 }
 /*- End of function --------------------------------------------------------*/
 
-SPAN_DECLARE(int) g726_decode(g726_state_t *s,
-                              int16_t amp[],
-                              const uint8_t g726_data[],
-                              int g726_bytes)
+/* Get the next code from the G.726 data, or -1 if there is no more data. */
+static __inline__ int unpack_code(g726_state_t *s, const uint8_t g726_data[], int *i, int g726_bytes)
 {
-    int i;
-    int samples;
-    uint8_t code;
-    int sl;
+    int code;
 
-    for (samples = i = 0;  ;  )
+    if (s->packing != G726_PACKING_NONE)
     {
-        if (s->packing != G726_PACKING_NONE)
+        /* Unpack the code bits */
+        if (s->packing != G726_PACKING_LEFT)
         {
-            /* Unpack the code bits */
-            if (s->packing != G726_PACKING_LEFT)
+            if (s->bs.residue < s->bits_per_sample)
             {
-                if (s->bs.residue < s->bits_per_sample)
-                {
-                    if (i >= g726_bytes)
-                        break;
-                    /*endif*/
-                    s->bs.bitstream |= (g726_data[i++] << s->bs.residue);
-                    s->bs.residue += 8;
-                }
+                if (*i >= g726_bytes)
+                    return -1;
                 /*endif*/
-                code = (uint8_t) (s->bs.bitstream & ((1 << s->bits_per_sample) - 1));
-                s->bs.bitstream >>= s->bits_per_sample;
+                s->bs.bitstream |= (g726_data[(*i)++] << s->bs.residue);
+                s->bs.residue += 8;
             }
-            else
+            /*endif*/
+            code = (uint8_t) (s->bs.bitstream & ((1 << s->bits_per_sample) - 1));
+            s->bs.bitstream >>= s->bits_per_sample;
+        }
+        else
+        {
+            if (s->bs.residue < s->bits_per_sample)
             {
-                if (s->bs.residue < s->bits_per_sample)
-                {
-                    if (i >= g726_bytes)
-                        break;
-                    /*endif*/
-                    s->bs.bitstream = (s->bs.bitstream << 8) | g726_data[i++];
-                    s->bs.residue += 8;
-                }
+                if (*i >= g726_bytes)
+                    return -1;
                 /*endif*/
-                code = (uint8_t) ((s->bs.bitstream >> (s->bs.residue - s->bits_per_sample)) & ((1 << s->bits_per_sample) - 1));
+                s->bs.bitstream = (s->bs.bitstream << 8) | g726_data[(*i)++];
+                s->bs.residue += 8;
             }
             /*endif*/
-            s->bs.residue -= s->bits_per_sample;
+            code = (uint8_t) ((s->bs.bitstream >> (s->bs.residue - s->bits_per_sample)) & ((1 << s->bits_per_sample) - 1));
         }
-        else
+        /*endif*/
+        s->bs.residue -= s->bits_per_sample;
+    }
+    else
+    {
+        if (*i >= g726_bytes)
+            return -1;
+        /*endif*/
+        code = g726_data[(*i)++];
+    }
+    /*endif*/
+    return code;
+}
+/*- End of function --------------------------------------------------------*/
+
+/* Add a code to the G.726 data, and return the new length of the data. */
+static __inline__ int pack_code(g726_state_t *s, uint8_t g726_data[], int g726_bytes, uint8_t code)
+{
+    if (s->packing != G726_PACKING_NONE)
+    {
+        /* Pack the code bits */
+        if (s->packing != G726_PACKING_LEFT)
         {
-            if (i >= g726_bytes)
-                break;
+            s->bs.bitstream |= (code << s->bs.residue);
+            s->bs.residue += s->bits_per_sample;
+            if (s->bs.residue >= 8)
+            {
+                g726_data[g726_bytes++] = (uint8_t) (s->bs.bitstream & 0xFF);
+                s->bs.bitstream >>= 8;
+                s->bs.residue -= 8;
+            }
             /*endif*/
-            code = g726_data[i++];
         }
-        /*endif*/
-        sl = s->dec_func(s, code);
-        if (s->ext_coding != G726_ENCODING_LINEAR)
-            ((uint8_t *) amp)[samples++] = (uint8_t) sl;
         else
-            amp[samples++] = (int16_t) sl;
+        {
+            s->bs.bitstream = (s->bs.bitstream << s->bits_per_sample) | code;
+            s->bs.residue += s->bits_per_sample;
+            if (s->bs.residue >= 8)
+            {
+                g726_data[g726_bytes++] = (uint8_t) ((s->bs.bitstream >> (s->bs.residue - 8)) & 0xFF);
+                s->bs.residue -= 8;
+            }
+            /*endif*/
+        }
         /*endif*/
     }
+    else
+    {
+        g726_data[g726_bytes++] = (uint8_t) code;
+    }
+    /*endif*/
+    return g726_bytes;
+}
+/*- End of function --------------------------------------------------------*/
+
+/* Linearize an input sample to 14-bit PCM */
+static __inline__ int16_t input_sample(g726_state_t *s, const int16_t amp[], int i)
+{
+    switch (s->ext_coding)
+    {
+    case G726_ENCODING_ALAW:
+        return alaw_to_linear(((const uint8_t *) amp)[i]) >> 2;
+    case G726_ENCODING_ULAW:
+        return ulaw_to_linear(((const uint8_t *) amp)[i]) >> 2;
+    }
+    /*endswitch*/
+    return amp[i] >> 2;
+}
+/*- End of function --------------------------------------------------------*/
+
+static __inline__ void output_sample(g726_state_t *s, int16_t amp[], int i, int sl)
+{
+    if (s->ext_coding != G726_ENCODING_LINEAR)
+        ((uint8_t *) amp)[i] = (uint8_t) sl;
+    else
+        amp[i] = (int16_t) sl;
+    /*endif*/
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_DECLARE(int) g726_decode(g726_state_t *s,
+                              int16_t amp[],
+                              const uint8_t g726_data[],
+                              int g726_bytes)
+{
+    int i;
+    int samples;
+    int code;
+
+    for (samples = i = 0;  (code = unpack_code(s, g726_data, &i, g726_bytes)) >= 0;  samples++)
+        output_sample(s, amp, samples, s->dec_func(s, (uint8_t) code));
     /*endfor*/
     return samples;
 }
@@ -1113,62 +1181,741 @@ SPAN_DECLARE(int) g726_encode(g726_state_t *s,
 {
     int i;
     int g726_bytes;
-    int16_t sl;
-    uint8_t code;
 
     for (g726_bytes = i = 0;  i < len;  i++)
+        g726_bytes = pack_code(s, g726_data, g726_bytes, s->enc_func(s, input_sample(s, amp, i)));
+    /*endfor*/
+    return g726_bytes;
+}
+/*- End of function --------------------------------------------------------*/
+
+/* The number of channels processed side by side by the batch routines */
+#define G726_LANES          8
+
+#if defined(SPANDSP_USE_RUNTIME_DISPATCH)
+/* The batch routines run up to 8 channels side by side, one in each 32 bit lane of an
+   AVX2 register, so the adaptive predictor, the quantizer and all the adaptation work
+   on every channel at once. Each lane holds one of the 16 bit quantities of the scalar
+   code, sign extended, and is truncated to 16 bits wherever the scalar code truncates,
+   so the results are exactly the same. Packing, unpacking and tandem adjustment are
+   still done one channel at a time. */
+
+/* The number of samples each channel is processed in at one time */
+#define G726_BATCH_CHUNK    64
+
+/* The state variables, in the order they are held in the lanes */
+enum
+{
+    LANE_YL = 0,
+    LANE_YU,
+    LANE_DMS,
+    LANE_DML,
+    LANE_AP,
+    LANE_A,
+    LANE_B = LANE_A + 2,
+    LANE_PK = LANE_B + 6,
+    LANE_DQ = LANE_PK + 2,
+    LANE_SR = LANE_DQ + 6,
+    LANE_TD = LANE_SR + 2,
+    LANE_VARS
+};
+
+typedef struct
+{
+    const int *dqlntab;
+    const int *witab;
+    const int *fitab;
+    const int *qtab;
+    int quantizer_states;
+    int sign_bit;
+    int sr_mask;
+    int b_shift;
+} g726_rate_tables_t;
+
+/* The tables for each rate, indexed by the bits per sample, less 2 */
+static const g726_rate_tables_t rate_tables[4] =
+{
+    {g726_16_dqlntab, g726_16_witab, g726_16_fitab, qtab_726_16,  4, 0x02, 0x3FFF, 8},
+    {g726_24_dqlntab, g726_24_witab, g726_24_fitab, qtab_726_24,  7, 0x04, 0x3FFF, 8},
+    {g726_32_dqlntab, g726_32_witab, g726_32_fitab, qtab_726_32, 15, 0x08, 0x3FFF, 8},
+    {g726_40_dqlntab, g726_40_witab, g726_40_fitab, qtab_726_40, 31, 0x10, 0x7FFF, 9}
+};
+
+static int16_t tandem_adjust(g726_state_t *s, int16_t sr, int se, int y, int i)
+{
+    const g726_rate_tables_t *tab;
+
+    tab = &rate_tables[s->bits_per_sample - 2];
+    switch (s->ext_coding)
     {
-        /* Linearize the input sample to 14-bit PCM */
-        switch (s->ext_coding)
+    case G726_ENCODING_ALAW:
+        return tandem_adjust_alaw(sr, se, y, i, tab->sign_bit, tab->qtab, tab->quantizer_states);
+    case G726_ENCODING_ULAW:
+        return tandem_adjust_ulaw(sr, se, y, i, tab->sign_bit, tab->qtab, tab->quantizer_states);
+    }
+    /*endswitch*/
+    return (sr << 2);
+}
+/*- End of function --------------------------------------------------------*/
+
+/* Choose t where the mask is set, else f */
+SPAN_TARGET("avx2") static __inline__ __m256i select_avx2(__m256i mask, __m256i t, __m256i f)
+{
+    return _mm256_blendv_epi8(f, t, mask);
+}
+/*- End of function --------------------------------------------------------*/
+
+/* Truncate to 16 bits, and sign extend */
+SPAN_TARGET("avx2") static __inline__ __m256i int16_avx2(__m256i x)
+{
+    return _mm256_srai_epi32(_mm256_slli_epi32(x, 16), 16);
+}
+/*- End of function --------------------------------------------------------*/
+
+/* top_bit() for non-negative values less than 2^24, from the exponent of the value
+   converted to floating point. */
+SPAN_TARGET("avx2") static __inline__ __m256i top_bit_avx2(__m256i x)
+{
+    x = _mm256_castps_si256(_mm256_cvtepi32_ps(x));
+    x = _mm256_sub_epi32(_mm256_srli_epi32(x, 23), _mm256_set1_epi32(127));
+    return _mm256_max_epi32(x, _mm256_set1_epi32(-1));
+}
+/*- End of function --------------------------------------------------------*/
+
+/* Shift a non-negative value left by n, or right by -n where n is negative */
+SPAN_TARGET("avx2") static __inline__ __m256i shift_avx2(__m256i x, __m256i n)
+{
+    __m256i zero;
+
+    zero = _mm256_setzero_si256();
+    x = _mm256_srlv_epi32(x, _mm256_max_epi32(_mm256_sub_epi32(zero, n), zero));
+    return _mm256_sllv_epi32(x, _mm256_max_epi32(n, zero));
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_TARGET("avx2") static __inline__ __m256i fmult_avx2(__m256i an, __m256i srn)
+{
+    __m256i zero;
+    __m256i anmag;
+    __m256i anexp;
+    __m256i anmant;
+    __m256i wanexp;
+    __m256i wanmant;
+    __m256i retval;
+
+    zero = _mm256_setzero_si256();
+    anmag = select_avx2(_mm256_cmpgt_epi32(an, zero), an, _mm256_and_si256(_mm256_sub_epi32(zero, an), _mm256_set1_epi32(0x1FFF)));
+    anexp = _mm256_sub_epi32(top_bit_avx2(anmag), _mm256_set1_epi32(5));
+    anmant = select_avx2(_mm256_cmpeq_epi32(anmag, zero), _mm256_set1_epi32(32), shift_avx2(anmag, _mm256_sub_epi32(zero, anexp)));
+    wanexp = _mm256_add_epi32(anexp, _mm256_and_si256(_mm256_srai_epi32(srn, 6), _mm256_set1_epi32(0xF)));
+    wanexp = _mm256_sub_epi32(wanexp, _mm256_set1_epi32(13));
+    wanmant = _mm256_mullo_epi32(anmant, _mm256_and_si256(srn, _mm256_set1_epi32(0x3F)));
+    wanmant = _mm256_srli_epi32(_mm256_add_epi32(wanmant, _mm256_set1_epi32(0x30)), 4);
+    retval = _mm256_and_si256(shift_avx2(wanmant, wanexp), _mm256_set1_epi32(0x7FFF));
+    return select_avx2(_mm256_srai_epi32(_mm256_xor_si256(an, srn), 31), _mm256_sub_epi32(zero, retval), retval);
+}
+/*- End of function --------------------------------------------------------*/
+
+/* The signal estimate, from the pole and zero predictors. The zero predictor's part is
+   returned in sezi. */
+SPAN_TARGET("avx2") static __inline__ __m256i predictor_avx2(const __m256i v[], __m256i *sezi)
+{
+    __m256i sez;
+    __m256i sep;
+    int i;
+
+    sez = fmult_avx2(_mm256_srai_epi32(v[LANE_B], 2), v[LANE_DQ]);
+    for (i = 1;  i < 6;  i++)
+        sez = _mm256_add_epi32(sez, fmult_avx2(_mm256_srai_epi32(v[LANE_B + i], 2), v[LANE_DQ + i]));
+    /*endfor*/
+    sez = int16_avx2(sez);
+    sep = int16_avx2(_mm256_add_epi32(fmult_avx2(_mm256_srai_epi32(v[LANE_A + 1], 2), v[LANE_SR + 1]),
+                                      fmult_avx2(_mm256_srai_epi32(v[LANE_A], 2), v[LANE_SR])));
+    *sezi = sez;
+    return _mm256_srai_epi32(int16_avx2(_mm256_add_epi32(sez, sep)), 1);
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_TARGET("avx2") static __inline__ __m256i step_size_avx2(const __m256i v[])
+{
+    __m256i y;
+    __m256i dif;
+
+    y = _mm256_srai_epi32(v[LANE_YL], 6);
+    dif = _mm256_sub_epi32(v[LANE_YU], y);
+    dif = _mm256_mullo_epi32(dif, _mm256_srai_epi32(v[LANE_AP], 2));
+    /* Round negative differences towards zero */
+    dif = _mm256_add_epi32(dif, _mm256_and_si256(_mm256_srai_epi32(dif, 31), _mm256_set1_epi32(0x3F)));
+    y = _mm256_add_epi32(y, _mm256_srai_epi32(dif, 6));
+    return select_avx2(_mm256_cmpgt_epi32(v[LANE_AP], _mm256_set1_epi32(255)), v[LANE_YU], y);
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_TARGET("avx2") static __inline__ __m256i quantize_avx2(__m256i d, __m256i y, const g726_rate_tables_t *tab)
+{
+    __m256i zero;
+    __m256i dqm;
+    __m256i exp;
+    __m256i dln;
+    __m256i i;
+    __m256i neg;
+    int size;
+    int k;
+
+    zero = _mm256_setzero_si256();
+    /* LOG */
+    dqm = _mm256_abs_epi32(d);
+    exp = _mm256_add_epi32(top_bit_avx2(_mm256_srli_epi32(dqm, 1)), _mm256_set1_epi32(1));
+    dln = _mm256_and_si256(_mm256_srlv_epi32(_mm256_slli_epi32(dqm, 7), exp), _mm256_set1_epi32(0x7F));
+    dln = _mm256_add_epi32(_mm256_slli_epi32(exp, 7), dln);
+    /* SUBTB */
+    dln = int16_avx2(_mm256_sub_epi32(dln, _mm256_srai_epi32(y, 2)));
+    /* QUAN. The tables are in ascending order, so counting the entries not above
+       dln is the same as searching for the first one above it. */
+    size = (tab->quantizer_states - 1) >> 1;
+    i = zero;
+    for (k = 0;  k < size;  k++)
+        i = _mm256_sub_epi32(i, _mm256_cmpgt_epi32(dln, _mm256_set1_epi32(tab->qtab[k] - 1)));
+    /*endfor*/
+    neg = _mm256_cmpgt_epi32(zero, d);
+    if ((tab->quantizer_states & 1))
+        i = select_avx2(_mm256_andnot_si256(neg, _mm256_cmpeq_epi32(i, zero)), _mm256_set1_epi32(tab->quantizer_states), i);
+    /*endif*/
+    return select_avx2(neg, _mm256_sub_epi32(_mm256_set1_epi32((size << 1) + 1), i), i);
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_TARGET("avx2") static __inline__ __m256i reconstruct_avx2(__m256i i, __m256i y, const g726_rate_tables_t *tab)
+{
+    __m256i zero;
+    __m256i sign;
+    __m256i dql;
+    __m256i dex;
+    __m256i dq;
+
+    zero = _mm256_setzero_si256();
+    sign = _mm256_cmpgt_epi32(_mm256_and_si256(i, _mm256_set1_epi32(tab->sign_bit)), zero);
+    /* ADDA */
+    dql = int16_avx2(_mm256_add_epi32(_mm256_i32gather_epi32(tab->dqlntab, i, 4), _mm256_srai_epi32(y, 2)));
+    /* ANTILOG */
+    dex = _mm256_and_si256(_mm256_srai_epi32(dql, 7), _mm256_set1_epi32(15));
+    dq = _mm256_add_epi32(_mm256_and_si256(dql, _mm256_set1_epi32(127)), _mm256_set1_epi32(128));
+    dq = _mm256_srlv_epi32(_mm256_slli_epi32(dq, 7), _mm256_sub_epi32(_mm256_set1_epi32(14), dex));
+    dq = select_avx2(sign, _mm256_sub_epi32(dq, _mm256_set1_epi32(0x8000)), dq);
+    return select_avx2(_mm256_cmpgt_epi32(zero, dql), _mm256_and_si256(sign, _mm256_set1_epi32(-0x8000)), dq);
+}
+/*- End of function --------------------------------------------------------*/
+
+/* Convert to the 4 bit exponent, 6 bit mantissa floating point form, for a magnitude
+   and a sign mask. */
+SPAN_TARGET("avx2") static __inline__ __m256i float_avx2(__m256i mag, __m256i neg)
+{
+    __m256i exp;
+    __m256i f;
+
+    exp = _mm256_add_epi32(top_bit_avx2(mag), _mm256_set1_epi32(1));
+    f = _mm256_add_epi32(_mm256_slli_epi32(exp, 6), _mm256_srlv_epi32(_mm256_slli_epi32(mag, 6), exp));
+    return select_avx2(neg, _mm256_sub_epi32(f, _mm256_set1_epi32(0x400)), f);
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_TARGET("avx2") static void update_avx2(__m256i v[],
+                                            const g726_rate_tables_t *tab,
+                                            __m256i y,
+                                            __m256i wi,
+                                            __m256i fi,
+                                            __m256i dq,
+                                            __m256i sr,
+                                            __m256i dqsez)
+{
+    __m256i zero;
+    __m256i ones;
+    __m256i pk0;
+    __m256i mag;
+    __m256i thr;
+    __m256i tr;
+    __m256i yu;
+    __m256i pks1;
+    __m256i nz;
+    __m256i a2p;
+    __m256i fa1;
+    __m256i t;
+    __m256i c;
+    __m256i lim;
+    __m256i a1;
+    __m256i a1ul;
+    __m256i inc;
+    __m256i b;
+    __m256i fast;
+    __m256i neg;
+    int i;
+
+    zero = _mm256_setzero_si256();
+    ones = _mm256_cmpeq_epi32(zero, zero);
+    pk0 = _mm256_srli_epi32(dqsez, 31);
+    mag = _mm256_and_si256(dq, _mm256_set1_epi32(0x7FFF));
+    /* TRANS */
+    t = _mm256_srai_epi32(v[LANE_YL], 15);
+    thr = _mm256_sllv_epi32(_mm256_add_epi32(_mm256_and_si256(_mm256_srai_epi32(v[LANE_YL], 10), _mm256_set1_epi32(0x1F)), _mm256_set1_epi32(32)), t);
+    thr = select_avx2(_mm256_cmpgt_epi32(t, _mm256_set1_epi32(9)), _mm256_set1_epi32(31 << 10), thr);
+    thr = _mm256_srai_epi32(_mm256_add_epi32(thr, _mm256_srai_epi32(thr, 1)), 1);
+    tr = _mm256_and_si256(v[LANE_TD], _mm256_cmpgt_epi32(mag, thr));
+
+    /* FUNCTW & FILTD & DELAY & LIMB */
+    yu = int16_avx2(_mm256_add_epi32(y, _mm256_srai_epi32(_mm256_sub_epi32(wi, y), 5)));
+    yu = _mm256_min_epi32(_mm256_max_epi32(yu, _mm256_set1_epi32(544)), _mm256_set1_epi32(5120));
+    v[LANE_YU] = yu;
+    /* FILTE & DELAY */
+    v[LANE_YL] = _mm256_add_epi32(v[LANE_YL], _mm256_add_epi32(yu, _mm256_srai_epi32(_mm256_sub_epi32(zero, v[LANE_YL]), 6)));
+
+    /* UPA2 */
+    pks1 = _mm256_cmpgt_epi32(_mm256_xor_si256(pk0, v[LANE_PK]), zero);
+    nz = _mm256_xor_si256(_mm256_cmpeq_epi32(dqsez, zero), ones);
+    a2p = int16_avx2(_mm256_sub_epi32(v[LANE_A + 1], _mm256_srai_epi32(v[LANE_A + 1], 7)));
+    fa1 = select_avx2(pks1, v[LANE_A], _mm256_sub_epi32(zero, v[LANE_A]));
+    t = _mm256_srai_epi32(fa1, 5);
+    t = select_avx2(_mm256_cmpgt_epi32(_mm256_set1_epi32(-8191), fa1), _mm256_set1_epi32(-0x100), t);
+    t = select_avx2(_mm256_cmpgt_epi32(fa1, _mm256_set1_epi32(8191)), _mm256_set1_epi32(0xFF), t);
+    t = int16_avx2(_mm256_add_epi32(a2p, t));
+    /* LIMC */
+    c = _mm256_cmpgt_epi32(_mm256_xor_si256(pk0, v[LANE_PK + 1]), zero);
+    lim = int16_avx2(_mm256_add_epi32(t, select_avx2(c, _mm256_set1_epi32(-0x80), _mm256_set1_epi32(0x80))));
+    lim = select_avx2(_mm256_cmpgt_epi32(select_avx2(c, _mm256_set1_epi32(-12159), _mm256_set1_epi32(-12415)), t), _mm256_set1_epi32(-12288), lim);
+    lim = select_avx2(_mm256_cmpgt_epi32(t, select_avx2(c, _mm256_set1_epi32(12415), _mm256_set1_epi32(12159))), _mm256_set1_epi32(12288), lim);
+    a2p = select_avx2(nz, lim, a2p);
+    /* UPA1 */
+    a1 = int16_avx2(_mm256_sub_epi32(v[LANE_A], _mm256_srai_epi32(v[LANE_A], 8)));
+    a1 = int16_avx2(_mm256_add_epi32(a1, _mm256_and_si256(nz, select_avx2(pks1, _mm256_set1_epi32(-192), _mm256_set1_epi32(192)))));
+    /* LIMD */
+    a1ul = int16_avx2(_mm256_sub_epi32(_mm256_set1_epi32(15360), a2p));
+    a1 = _mm256_min_epi32(_mm256_max_epi32(a1, _mm256_sub_epi32(zero, a1ul)), a1ul);
+    /* Reset the a's and b's for a modem signal */
+    a2p = _mm256_andnot_si256(tr, a2p);
+    v[LANE_A + 1] = a2p;
+    v[LANE_A] = _mm256_andnot_si256(tr, a1);
+
+    /* UPB */
+    nz = _mm256_cmpgt_epi32(mag, zero);
+    for (i = 0;  i < 6;  i++)
+    {
+        b = int16_avx2(_mm256_sub_epi32(v[LANE_B + i], _mm256_sra_epi32(v[LANE_B + i], _mm_cvtsi32_si128(tab->b_shift))));
+        inc = select_avx2(_mm256_cmpgt_epi32(zero, _mm256_xor_si256(dq, v[LANE_DQ + i])), _mm256_set1_epi32(-128), _mm256_set1_epi32(128));
+        b = int16_avx2(_mm256_add_epi32(b, _mm256_and_si256(nz, inc)));
+        v[LANE_B + i] = _mm256_andnot_si256(tr, b);
+    }
+    /*endfor*/
+
+    /* FLOAT A */
+    for (i = 5;  i > 0;  i--)
+        v[LANE_DQ + i] = v[LANE_DQ + i - 1];
+    /*endfor*/
+    neg = _mm256_cmpgt_epi32(zero, dq);
+    v[LANE_DQ] = select_avx2(_mm256_cmpeq_epi32(mag, zero),
+                             select_avx2(neg, _mm256_set1_epi32(-992), _mm256_set1_epi32(0x20)),
+                             float_avx2(mag, neg));
+    /* FLOAT B */
+    v[LANE_SR + 1] = v[LANE_SR];
+    t = float_avx2(_mm256_abs_epi32(sr), _mm256_cmpgt_epi32(zero, sr));
+    t = select_avx2(_mm256_cmpeq_epi32(sr, zero), _mm256_set1_epi32(0x20), t);
+    v[LANE_SR] = select_avx2(_mm256_cmpeq_epi32(sr, _mm256_set1_epi32(-32768)), _mm256_set1_epi32(-992), t);
+
+    /* DELAY A */
+    v[LANE_PK + 1] = v[LANE_PK];
+    v[LANE_PK] = pk0;
+
+    /* TONE */
+    v[LANE_TD] = _mm256_andnot_si256(tr, _mm256_cmpgt_epi32(_mm256_set1_epi32(-11776), a2p));
+
+    /* FILTA & FILTB */
+    v[LANE_DMS] = int16_avx2(_mm256_add_epi32(v[LANE_DMS], _mm256_srai_epi32(_mm256_sub_epi32(fi, v[LANE_DMS]), 5)));
+    t = int16_avx2(_mm256_slli_epi32(fi, 2));
+    v[LANE_DML] = int16_avx2(_mm256_add_epi32(v[LANE_DML], _mm256_srai_epi32(_mm256_sub_epi32(t, v[LANE_DML]), 7)));
+
+    /* SUBTC */
+    t = _mm256_abs_epi32(_mm256_sub_epi32(_mm256_slli_epi32(v[LANE_DMS], 2), v[LANE_DML]));
+    fast = _mm256_xor_si256(_mm256_cmpgt_epi32(_mm256_srai_epi32(v[LANE_DML], 3), t), ones);
+    fast = _mm256_or_si256(fast, _mm256_or_si256(_mm256_cmpgt_epi32(_mm256_set1_epi32(1536), y), v[LANE_TD]));
+    t = select_avx2(fast, _mm256_sub_epi32(_mm256_set1_epi32(0x200), v[LANE_AP]), _mm256_sub_epi32(zero, v[LANE_AP]));
+    t = int16_avx2(_mm256_add_epi32(v[LANE_AP], _mm256_srai_epi32(t, 4)));
+    v[LANE_AP] = select_avx2(tr, _mm256_set1_epi32(256), t);
+}
+/*- End of function --------------------------------------------------------*/
+
+/* Reconstruct the signal from a code, adapt to it, and return the reconstructed signal */
+SPAN_TARGET("avx2") static __inline__ __m256i adapt_avx2(__m256i v[],
+                                                         const g726_rate_tables_t *tab,
+                                                         __m256i i,
+                                                         __m256i y,
+                                                         __m256i se,
+                                                         __m256i sezi)
+{
+    __m256i dq;
+    __m256i sr;
+    __m256i dqsez;
+
+    dq = reconstruct_avx2(i, y, tab);
+    sr = select_avx2(_mm256_cmpgt_epi32(_mm256_setzero_si256(), dq),
+                     _mm256_sub_epi32(se, _mm256_and_si256(dq, _mm256_set1_epi32(tab->sr_mask))),
+                     _mm256_add_epi32(se, dq));
+    sr = int16_avx2(sr);
+    dqsez = int16_avx2(_mm256_sub_epi32(_mm256_add_epi32(sr, _mm256_srai_epi32(sezi, 1)), se));
+    update_avx2(v,
+                tab,
+                y,
+                _mm256_i32gather_epi32(tab->witab, i, 4),
+                _mm256_i32gather_epi32(tab->fitab, i, 4),
+                dq,
+                sr,
+                dqsez);
+    return sr;
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_TARGET("avx2") static void lanes_load_avx2(__m256i v[], g726_state_t *s[])
+{
+    int32_t t[LANE_VARS][G726_LANES];
+    int i;
+    int k;
+
+    for (k = 0;  k < G726_LANES;  k++)
+    {
+        t[LANE_YL][k] = s[k]->yl;
+        t[LANE_YU][k] = s[k]->yu;
+        t[LANE_DMS][k] = s[k]->dms;
+        t[LANE_DML][k] = s[k]->dml;
+        t[LANE_AP][k] = s[k]->ap;
+        for (i = 0;  i < 2;  i++)
         {
-        case G726_ENCODING_ALAW:
-            sl = alaw_to_linear(((const uint8_t *) amp)[i]) >> 2;
-            break;
-        case G726_ENCODING_ULAW:
-            sl = ulaw_to_linear(((const uint8_t *) amp)[i]) >> 2;
-            break;
-        default:
-            sl = amp[i] >> 2;
+            t[LANE_A + i][k] = s[k]->a[i];
+            t[LANE_PK + i][k] = s[k]->pk[i];
+            t[LANE_SR + i][k] = s[k]->sr[i];
+        }
+        /*endfor*/
+        for (i = 0;  i < 6;  i++)
+        {
+            t[LANE_B + i][k] = s[k]->b[i];
+            t[LANE_DQ + i][k] = s[k]->dq[i];
+        }
+        /*endfor*/
+        t[LANE_TD][k] = (s[k]->td)  ?  -1  :  0;
+    }
+    /*endfor*/
+    for (i = 0;  i < LANE_VARS;  i++)
+        v[i] = _mm256_loadu_si256((const __m256i *) t[i]);
+    /*endfor*/
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_TARGET("avx2") static void lanes_store_avx2(const __m256i v[], g726_state_t *s[])
+{
+    int32_t t[LANE_VARS][G726_LANES];
+    int i;
+    int k;
+
+    for (i = 0;  i < LANE_VARS;  i++)
+        _mm256_storeu_si256((__m256i *) t[i], v[i]);
+    /*endfor*/
+    for (k = 0;  k < G726_LANES;  k++)
+    {
+        s[k]->yl = t[LANE_YL][k];
+        s[k]->yu = (int16_t) t[LANE_YU][k];
+        s[k]->dms = (int16_t) t[LANE_DMS][k];
+        s[k]->dml = (int16_t) t[LANE_DML][k];
+        s[k]->ap = (int16_t) t[LANE_AP][k];
+        for (i = 0;  i < 2;  i++)
+        {
+            s[k]->a[i] = (int16_t) t[LANE_A + i][k];
+            s[k]->pk[i] = (int16_t) t[LANE_PK + i][k];
+            s[k]->sr[i] = (int16_t) t[LANE_SR + i][k];
+        }
+        /*endfor*/
+        for (i = 0;  i < 6;  i++)
+        {
+            s[k]->b[i] = (int16_t) t[LANE_B + i][k];
+            s[k]->dq[i] = (int16_t) t[LANE_DQ + i][k];
+        }
+        /*endfor*/
+        s[k]->td = (t[LANE_TD][k] != 0);
+    }
+    /*endfor*/
+}
+/*- End of function --------------------------------------------------------*/
+
+/* Set up the lanes for a group of channels, which must all use the same bit rate.
+   Any unused lanes are given a spare context to work on. */
+static const g726_rate_tables_t *lanes_init(g726_state_t *lanes[], g726_state_t *s[], g726_state_t *spare, int channels)
+{
+    int k;
+
+    for (k = 1;  k < channels;  k++)
+    {
+        if (s[k]->rate != s[0]->rate)
+            return NULL;
+        /*endif*/
+    }
+    /*endfor*/
+    g726_init(spare, s[0]->rate, G726_ENCODING_LINEAR, G726_PACKING_NONE);
+    for (k = 0;  k < G726_LANES;  k++)
+        lanes[k] = (k < channels)  ?  s[k]  :  spare;
+    /*endfor*/
+    return &rate_tables[s[0]->bits_per_sample - 2];
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_TARGET("avx2") static int decode_lanes_avx2(g726_state_t *s[],
+                                                 int16_t *amp[],
+                                                 int samples[],
+                                                 const uint8_t *g726_data[],
+                                                 int g726_bytes,
+                                                 int channels)
+{
+    const g726_rate_tables_t *tab;
+    g726_state_t spare;
+    g726_state_t *lanes[G726_LANES];
+    __m256i v[LANE_VARS];
+    __m256i se;
+    __m256i sezi;
+    __m256i y;
+    __m256i sr;
+    int32_t code[G726_BATCH_CHUNK][G726_LANES];
+    int32_t sr_t[G726_BATCH_CHUNK][G726_LANES];
+    int32_t se_t[G726_BATCH_CHUNK][G726_LANES];
+    int32_t y_t[G726_BATCH_CHUNK][G726_LANES];
+    int pos[G726_LANES];
+    int len[G726_LANES];
+    int16_t *out;
+    int total;
+    int mask;
+    int m;
+    int i;
+    int j;
+    int k;
+
+    if ((tab = lanes_init(lanes, s, &spare, channels)) == NULL)
+        return -1;
+    /*endif*/
+    mask = (1 << s[0]->bits_per_sample) - 1;
+    lanes_load_avx2(v, lanes);
+    memset(code, 0, sizeof(code));
+    for (k = 0;  k < channels;  k++)
+    {
+        pos[k] = 0;
+        samples[k] = 0;
+    }
+    /*endfor*/
+    for (;;)
+    {
+        /* Unpack a chunk of codes for each channel, and work side by side for as long as
+           all the channels have codes */
+        m = G726_BATCH_CHUNK;
+        for (k = 0;  k < channels;  k++)
+        {
+            for (j = 0;  j < G726_BATCH_CHUNK  &&  (i = unpack_code(s[k], g726_data[k], &pos[k], g726_bytes)) >= 0;  j++)
+                code[j][k] = i & mask;
+            /*endfor*/
+            len[k] = j;
+            if (j < m)
+                m = j;
+            /*endif*/
+        }
+        /*endfor*/
+        for (j = 0;  j < m;  j++)
+        {
+            se = predictor_avx2(v, &sezi);
+            y = step_size_avx2(v);
+            sr = adapt_avx2(v, tab, _mm256_loadu_si256((const __m256i *) code[j]), y, se, sezi);
+            _mm256_storeu_si256((__m256i *) sr_t[j], sr);
+            _mm256_storeu_si256((__m256i *) se_t[j], se);
+            _mm256_storeu_si256((__m256i *) y_t[j], y);
+        }
+        /*endfor*/
+        /* Clean the upper halves of the YMM registers before the scalar code, so there
+           is no AVX to SSE transition penalty in the tandem adjustment */
+        _mm256_zeroupper();
+        for (k = 0;  k < channels;  k++)
+        {
+            for (j = 0;  j < m;  j++)
+                output_sample(s[k], amp[k], samples[k]++, tandem_adjust(s[k], (int16_t) sr_t[j][k], se_t[j][k], y_t[j][k], code[j][k]));
+            /*endfor*/
+        }
+        /*endfor*/
+        if (m < G726_BATCH_CHUNK)
             break;
+        /*endif*/
+    }
+    /*endfor*/
+    lanes_store_avx2(v, lanes);
+    _mm256_zeroupper();
+
+    /* Finish off any channels with more data one at a time */
+    total = 0;
+    for (k = 0;  k < channels;  k++)
+    {
+        for (j = m;  j < len[k];  j++)
+            output_sample(s[k], amp[k], samples[k]++, s[k]->dec_func(s[k], (uint8_t) code[j][k]));
+        /*endfor*/
+        if (s[k]->ext_coding != G726_ENCODING_LINEAR)
+            out = (int16_t *) ((uint8_t *) amp[k] + samples[k]);
+        else
+            out = amp[k] + samples[k];
+        /*endif*/
+        samples[k] += g726_decode(s[k], out, g726_data[k] + pos[k], g726_bytes - pos[k]);
+        total += samples[k];
+    }
+    /*endfor*/
+    return total;
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_TARGET("avx2") static int encode_lanes_avx2(g726_state_t *s[],
+                                                 uint8_t *g726_data[],
+                                                 int g726_bytes[],
+                                                 const int16_t *amp[],
+                                                 int len,
+                                                 int channels)
+{
+    const g726_rate_tables_t *tab;
+    g726_state_t spare;
+    g726_state_t *lanes[G726_LANES];
+    __m256i v[LANE_VARS];
+    __m256i se;
+    __m256i sezi;
+    __m256i y;
+    __m256i i;
+    int32_t sl[G726_BATCH_CHUNK][G726_LANES];
+    int32_t code[G726_BATCH_CHUNK][G726_LANES];
+    int total;
+    int n;
+    int j;
+    int k;
+    int l;
+
+    if ((tab = lanes_init(lanes, s, &spare, channels)) == NULL)
+        return -1;
+    /*endif*/
+    lanes_load_avx2(v, lanes);
+    memset(sl, 0, sizeof(sl));
+    for (k = 0;  k < channels;  k++)
+        g726_bytes[k] = 0;
+    /*endfor*/
+    for (l = 0;  l < len;  l += n)
+    {
+        n = (len - l < G726_BATCH_CHUNK)  ?  (len - l)  :  G726_BATCH_CHUNK;
+        for (k = 0;  k < channels;  k++)
+        {
+            for (j = 0;  j < n;  j++)
+                sl[j][k] = input_sample(s[k], amp[k], l + j);
+            /*endfor*/
         }
-        /*endswitch*/
-        code = s->enc_func(s, sl);
-        if (s->packing != G726_PACKING_NONE)
+        /*endfor*/
+        for (j = 0;  j < n;  j++)
         {
-            /* Pack the code bits */
-            if (s->packing != G726_PACKING_LEFT)
-            {
-                s->bs.bitstream |= (code << s->bs.residue);
-                s->bs.residue += s->bits_per_sample;
-                if (s->bs.residue >= 8)
-                {
-                    g726_data[g726_bytes++] = (uint8_t) (s->bs.bitstream & 0xFF);
-                    s->bs.bitstream >>= 8;
-                    s->bs.residue -= 8;
-                }
-                /*endif*/
-            }
-            else
+            se = predictor_avx2(v, &sezi);
+            y = step_size_avx2(v);
+            i = quantize_avx2(int16_avx2(_mm256_sub_epi32(_mm256_loadu_si256((const __m256i *) sl[j]), se)), y, tab);
+            adapt_avx2(v, tab, i, y, se, sezi);
+            _mm256_storeu_si256((__m256i *) code[j], i);
+        }
+        /*endfor*/
+        /* Clean the upper halves of the YMM registers before the scalar code */
+        _mm256_zeroupper();
+        for (k = 0;  k < channels;  k++)
+        {
+            for (j = 0;  j < n;  j++)
+                g726_bytes[k] = pack_code(s[k], g726_data[k], g726_bytes[k], (uint8_t) code[j][k]);
+            /*endfor*/
+        }
+        /*endfor*/
+    }
+    /*endfor*/
+    lanes_store_avx2(v, lanes);
+    _mm256_zeroupper();
+    total = 0;
+    for (k = 0;  k < channels;  k++)
+        total += g726_bytes[k];
+    /*endfor*/
+    return total;
+}
+/*- End of function --------------------------------------------------------*/
+#endif
+
+SPAN_DECLARE(int) g726_decode_batch(g726_state_t *s[],
+                                    int16_t *amp[],
+                                    int samples[],
+                                    const uint8_t *g726_data[],
+                                    int g726_bytes,
+                                    int channels)
+{
+    int total;
+    int len;
+    int n;
+    int i;
+    int k;
+
+    total = 0;
+    for (i = 0;  i < channels;  i += n)
+    {
+        n = (channels - i < G726_LANES)  ?  (channels - i)  :  G726_LANES;
+        len = -1;
+#if defined(SPANDSP_USE_RUNTIME_DISPATCH)
+        if ((span_cpu_dispatch_features & SPAN_CPU_FEATURE_AVX2)  &&  n > 1)
+            len = decode_lanes_avx2(&s[i], &amp[i], &samples[i], &g726_data[i], g726_bytes, n);
+        /*endif*/
+#endif
+        if (len < 0)
+        {
+            for (len = 0, k = i;  k < i + n;  k++)
             {
-                s->bs.bitstream = (s->bs.bitstream << s->bits_per_sample) | code;
-                s->bs.residue += s->bits_per_sample;
-                if (s->bs.residue >= 8)
-                {
-                    g726_data[g726_bytes++] = (uint8_t) ((s->bs.bitstream >> (s->bs.residue - 8)) & 0xFF);
-                    s->bs.residue -= 8;
-                }
-                /*endif*/
+                samples[k] = g726_decode(s[k], amp[k], g726_data[k], g726_bytes);
+                len += samples[k];
             }
-            /*endif*/
+            /*endfor*/
         }
-        else
+        /*endif*/
+        total += len;
+    }
+    /*endfor*/
+    return total;
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_DECLARE(int) g726_encode_batch(g726_state_t *s[],
+                                    uint8_t *g726_data[],
+                                    int g726_bytes[],
+                                    const int16_t *amp[],
+                                    int len,
+                                    int channels)
+{
+    int total;
+    int bytes;
+    int n;
+    int i;
+    int k;
+
+    total = 0;
+    for (i = 0;  i < channels;  i += n)
+    {
+        n = (channels - i < G726_LANES)  ?  (channels - i)  :  G726_LANES;
+        bytes = -1;
+#if defined(SPANDSP_USE_RUNTIME_DISPATCH)
+        if ((span_cpu_dispatch_features & SPAN_CPU_FEATURE_AVX2)  &&  n > 1)
+            bytes = encode_lanes_avx2(&s[i], &g726_data[i], &g726_bytes[i], &amp[i], len, n);
+        /*endif*/
+#endif
+        if (bytes < 0)
         {
-            g726_data[g726_bytes++] = (uint8_t) code;
+            for (bytes = 0, k = i;  k < i + n;  k++)
+            {
+                g726_bytes[k] = g726_encode(s[k], g726_data[k], amp[k], len);
+                bytes += g726_bytes[k];
+            }
+            /*endfor*/
         }
         /*endif*/
+        total += bytes;
     }
     /*endfor*/
-    return g726_bytes;
+    return total;
 }
 /*- End of function --------------------------------------------------------*/
 
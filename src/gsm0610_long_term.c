@@ -43,7 +43,10 @@
 #include "floating_fudge.h"
 #include <stdlib.h>
 
+#include "mmx_sse_decs.h"
+
 #include "spandsp/telephony.h"
+#include "spandsp/cpu_features.h"
 #include "spandsp/fast_convert.h"
 #include "spandsp/bitstream.h"
 #include "spandsp/saturated.h"
@@ -234,6 +237,47 @@ static int32_t gsm0610_max_cross_corr(const int16_t *wt, const int16_t *dp, int1
 }
 /*- End of function --------------------------------------------------------*/
 
+#if defined(SPANDSP_USE_RUNTIME_DISPATCH)
+/* The same search, with each 40 point cross-correlation done as two 16 point and one
+   8 point block of multiply-adds. */
+SPAN_TARGET("avx2") static int32_t gsm0610_max_cross_corr_avx2(const int16_t *wt, const int16_t *dp, int16_t *index_out)
+{
+    __m256i wt0;
+    __m256i wt1;
+    __m128i wt2;
+    __m256i sum;
+    __m128i res;
+    int32_t max;
+    int32_t index;
+    int i;
+
+    wt0 = _mm256_loadu_si256((const __m256i *) &wt[0]);
+    wt1 = _mm256_loadu_si256((const __m256i *) &wt[16]);
+    wt2 = _mm_loadu_si128((const __m128i *) &wt[32]);
+    max = 0;
+    index = 40;
+    for (i = 40;  i <= 120;  i++)
+    {
+        sum = _mm256_add_epi32(_mm256_madd_epi16(wt0, _mm256_loadu_si256((const __m256i *) &dp[0 - i])),
+                               _mm256_madd_epi16(wt1, _mm256_loadu_si256((const __m256i *) &dp[16 - i])));
+        res = _mm_add_epi32(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+        res = _mm_add_epi32(res, _mm_madd_epi16(wt2, _mm_loadu_si128((const __m128i *) &dp[32 - i])));
+        res = _mm_add_epi32(res, _mm_shuffle_epi32(res, _MM_SHUFFLE(1, 0, 3, 2)));
+        res = _mm_add_epi32(res, _mm_shuffle_epi32(res, _MM_SHUFFLE(2, 3, 0, 1)));
+        if (_mm_cvtsi128_si32(res) > max)
+        {
+            max = _mm_cvtsi128_si32(res);
+            index = i;
+        }
+        /*endif*/
+    }
+    /*endfor*/
+    *index_out = index;
+    return max;
+}
+/*- End of function --------------------------------------------------------*/
+#endif
+
 /* This procedure computes the LTP gain (bc) and the LTP lag (Nc)
    for the long term analysis filter.   This is done by calculating a
    maximum of the cross-correlation function between the current
@@ -300,7 +344,15 @@ static int16_t evaluate_ltp_parameters(int16_t d[40],
     /*endfor*/
 
     /* Search for the maximum cross-correlation and coding of the LTP lag */
+#if defined(SPANDSP_USE_RUNTIME_DISPATCH)
+    if ((span_cpu_dispatch_features & SPAN_CPU_FEATURE_AVX2))
+        L_max = gsm0610_max_cross_corr_avx2(wt, dp, Nc_out);
+    else
+        L_max = gsm0610_max_cross_corr(wt, dp, Nc_out);
+    /*endif*/
+#else
     L_max = gsm0610_max_cross_corr(wt, dp, Nc_out);
+#endif
     L_max <<= 1;
 
     /* Rescaling of L_max */
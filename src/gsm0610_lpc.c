@@ -45,7 +45,10 @@
 #include <memory.h>
 #include <string.h>
 
+#include "mmx_sse_decs.h"
+
 #include "spandsp/telephony.h"
+#include "spandsp/cpu_features.h"
 #include "spandsp/fast_convert.h"
 #include "spandsp/bitstream.h"
 #include "spandsp/bit_operations.h"
@@ -421,6 +424,92 @@ static void autocorrelation(int16_t amp[GSM0610_FRAME_LEN], int32_t L_ACF[9])
 }
 /*- End of function --------------------------------------------------------*/
 
+#if defined(SPANDSP_USE_RUNTIME_DISPATCH)
+/* The same as autocorrelation(), 16 samples at a time. The signal is copied into a
+   buffer padded with zeros, so every lag can be summed over the whole frame. */
+SPAN_TARGET("avx2") static void autocorrelation_avx2(int16_t amp[GSM0610_FRAME_LEN], int32_t L_ACF[9])
+{
+    int16_t buf[GSM0610_FRAME_LEN + 16];
+    __m256i zero;
+    __m256i x;
+    __m256i sum;
+    __m128i res;
+    int k;
+    int i;
+    int16_t smax;
+    int16_t scalauto;
+
+    /* Search for the maximum, with a saturated negation, as sat_abs16() does */
+    zero = _mm256_setzero_si256();
+    sum = zero;
+    for (i = 0;  i < GSM0610_FRAME_LEN;  i += 16)
+    {
+        x = _mm256_loadu_si256((const __m256i *) &amp[i]);
+        sum = _mm256_max_epi16(sum, _mm256_max_epi16(x, _mm256_subs_epi16(zero, x)));
+    }
+    /*endfor*/
+    res = _mm_max_epi16(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+    res = _mm_max_epi16(res, _mm_shuffle_epi32(res, _MM_SHUFFLE(1, 0, 3, 2)));
+    res = _mm_max_epi16(res, _mm_shuffle_epi32(res, _MM_SHUFFLE(2, 3, 0, 1)));
+    res = _mm_max_epi16(res, _mm_srli_epi32(res, 16));
+    smax = (int16_t) _mm_cvtsi128_si32(res);
+
+    /* Computation of the scaling factor. */
+    if (smax == 0)
+    {
+        scalauto = 0;
+    }
+    else
+    {
+        assert(smax > 0);
+        scalauto = (int16_t) (4 - gsm0610_norm((int32_t) smax << 16));
+    }
+    /*endif*/
+
+    /* Scaling of the array s[0...159]. The multiplier is positive, so this is exactly
+       gsm_mult_r(). */
+    if (scalauto > 0)
+    {
+        x = _mm256_set1_epi16(16384 >> (scalauto - 1));
+        for (i = 0;  i < GSM0610_FRAME_LEN;  i += 16)
+            _mm256_storeu_si256((__m256i *) &amp[i], _mm256_mulhrs_epi16(_mm256_loadu_si256((const __m256i *) &amp[i]), x));
+        /*endfor*/
+    }
+    /*endif*/
+
+    /* Compute the L_ACF[..]. */
+    memcpy(buf, amp, GSM0610_FRAME_LEN*sizeof(int16_t));
+    memset(&buf[GSM0610_FRAME_LEN], 0, 16*sizeof(int16_t));
+    for (k = 0;  k < 9;  k++)
+    {
+        sum = zero;
+        for (i = 0;  i < GSM0610_FRAME_LEN;  i += 16)
+        {
+            sum = _mm256_add_epi32(sum,
+                                   _mm256_madd_epi16(_mm256_loadu_si256((const __m256i *) &buf[i]),
+                                                     _mm256_loadu_si256((const __m256i *) &buf[i + k])));
+        }
+        /*endfor*/
+        res = _mm_add_epi32(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+        res = _mm_add_epi32(res, _mm_shuffle_epi32(res, _MM_SHUFFLE(1, 0, 3, 2)));
+        res = _mm_add_epi32(res, _mm_shuffle_epi32(res, _MM_SHUFFLE(2, 3, 0, 1)));
+        L_ACF[k] = _mm_cvtsi128_si32(res) << 1;
+    }
+    /*endfor*/
+
+    /* Rescaling of the array s[0..159] */
+    if (scalauto > 0)
+    {
+        assert(scalauto <= 4);
+        for (i = 0;  i < GSM0610_FRAME_LEN;  i += 16)
+            _mm256_storeu_si256((__m256i *) &amp[i], _mm256_sll_epi16(_mm256_loadu_si256((const __m256i *) &amp[i]), _mm_cvtsi32_si128(scalauto)));
+        /*endfor*/
+    }
+    /*endif*/
+}
+/*- End of function --------------------------------------------------------*/
+#endif
+
 /* 4.2.5 */
 static void reflection_coefficients(int32_t L_ACF[9], int16_t r[8])
 {
@@ -589,7 +678,15 @@ void gsm0610_lpc_analysis(gsm0610_state_t *s,
 {
     int32_t L_ACF[9];
 
+#if defined(SPANDSP_USE_RUNTIME_DISPATCH)
+    if ((span_cpu_dispatch_features & SPAN_CPU_FEATURE_AVX2))
+        autocorrelation_avx2(amp, L_ACF);
+    else
+        autocorrelation(amp, L_ACF);
+    /*endif*/
+#else
     autocorrelation(amp, L_ACF);
+#endif
     reflection_coefficients(L_ACF, LARc);
     transform_to_log_area_ratios(LARc);
     quantization_and_coding(LARc);
@@ -46,6 +46,7 @@
 #include "mmx_sse_decs.h"
 
 #include "spandsp/telephony.h"
+#include "spandsp/cpu_features.h"
 #include "spandsp/fast_convert.h"
 #include "spandsp/bitstream.h"
 #include "spandsp/saturated.h"
@@ -230,6 +231,44 @@ static void weighting_filter(int16_t x[40],
 }
 /*- End of function --------------------------------------------------------*/
 
+#if defined(SPANDSP_USE_RUNTIME_DISPATCH)
+/* The same filter, producing 8 outputs at a time in 32 bit lanes */
+SPAN_TARGET("avx2") static void weighting_filter_avx2(int16_t x[40],
+                                                      const int16_t *e)     // signal [-5..0.39.44] IN)
+{
+    /* Table 4.4   Coefficients of the weighting filter */
+    static const int16_t gsm_H[11] =
+    {
+        -134, -374, 0, 2054, 5741, 8192, 5741, 2054, 0, -374, -134
+    };
+    __m256i result;
+    int i;
+    int k;
+
+    e -= 5;
+    for (k = 0;  k < 40;  k += 8)
+    {
+        result = _mm256_set1_epi32(8192 >> 1);
+        for (i = 0;  i < 11;  i++)
+        {
+            if (gsm_H[i] == 0)
+                continue;
+            /*endif*/
+            result = _mm256_add_epi32(result,
+                                      _mm256_mullo_epi32(_mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i *) &e[k + i])),
+                                                         _mm256_set1_epi32(gsm_H[i])));
+        }
+        /*endfor*/
+        /* Shift, and saturate to 16 bits */
+        result = _mm256_srai_epi32(result, 13);
+        result = _mm256_permute4x64_epi64(_mm256_packs_epi32(result, result), _MM_SHUFFLE(3, 1, 2, 0));
+        _mm_storeu_si128((__m128i *) &x[k], _mm256_castsi256_si128(result));
+    }
+    /*endfor*/
+}
+/*- End of function --------------------------------------------------------*/
+#endif
+
 /* 4.2.14 */
 static void rpe_grid_selection(int16_t x[40], int16_t xM[13], int16_t *Mc_out)
 {
@@ -568,7 +607,15 @@ void gsm0610_rpe_encoding(gsm0610_state_t *s,
     int16_t mant;
     int16_t exp;
 
+#if defined(SPANDSP_USE_RUNTIME_DISPATCH)
+    if ((span_cpu_dispatch_features & SPAN_CPU_FEATURE_AVX2))
+        weighting_filter_avx2(x, e);
+    else
+        weighting_filter(x, e);
+    /*endif*/
+#else
     weighting_filter(x, e);
+#endif
     rpe_grid_selection(x, xM, Mc);
 
     apcm_quantization(xM, xMc, &mant, &exp, xmaxc);
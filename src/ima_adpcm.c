@@ -39,6 +39,11 @@
 #if defined(HAVE_MATH_H)
 #include <math.h>
 #endif
+#if defined(HAVE_STDBOOL_H)
+#include <stdbool.h>
+#else
+#include "spandsp/stdbool.h"
+#endif
 #include "floating_fudge.h"
 
 #include "spandsp/telephony.h"
@@ -188,39 +193,196 @@ static const struct
     {0xFF00,    0xFF00,     8}
 };
 
-static int16_t decode(ima_adpcm_state_t *s, uint8_t adpcm)
+/* The decoder works from tables, built from step_size[] and step_adjustment[] the first
+   time a context is initialised. For each step index and 4 bit code, decode_table[] holds
+   the change in the signal, times 256, plus the step index which follows. For each step
+   index and whole byte of two codes, with the first code in the upper 4 bits,
+   decode_next_byte[] holds the step index which follows the byte. This turns the step
+   index adaptation, which is the longest part of the chain from one sample to the next,
+   into a single lookup for each pair of samples. */
+static int32_t decode_table[(STEP_MAX + 1)*16];
+static uint8_t decode_next_byte[(STEP_MAX + 1)*256];
+static int decode_tables_initialised = false;
+
+static void make_decode_tables(void)
 {
+    int i;
+    int j;
+    int adpcm;
     int e;
     int ss;
+
+    for (i = 0;  i <= STEP_MAX;  i++)
+    {
+        for (adpcm = 0;  adpcm < 16;  adpcm++)
+        {
+            /* e = (adpcm + 0.5)*step/4 */
+            ss = step_size[i];
+            e = ss >> 3;
+            if (adpcm & 0x01)
+                e += (ss >> 2);
+            /*endif*/
+            if (adpcm & 0x02)
+                e += (ss >> 1);
+            /*endif*/
+            if (adpcm & 0x04)
+                e += ss;
+            /*endif*/
+            if (adpcm & 0x08)
+                e = -e;
+            /*endif*/
+            j = i + step_adjustment[adpcm & 0x07];
+            if (j < 0)
+                j = 0;
+            else if (j > STEP_MAX)
+                j = STEP_MAX;
+            /*endif*/
+            decode_table[16*i + adpcm] = e*256 + j;
+        }
+        /*endfor*/
+    }
+    /*endfor*/
+    for (i = 0;  i <= STEP_MAX;  i++)
+    {
+        for (adpcm = 0;  adpcm < 256;  adpcm++)
+        {
+            j = decode_table[16*i + (adpcm >> 4)] & 0xFF;
+            decode_next_byte[256*i + adpcm] = (uint8_t) (decode_table[16*j + (adpcm & 0x0F)] & 0xFF);
+        }
+        /*endfor*/
+    }
+    /*endfor*/
+    decode_tables_initialised = true;
+}
+/*- End of function --------------------------------------------------------*/
+
+static int16_t decode(ima_adpcm_state_t *s, uint8_t adpcm)
+{
+    int32_t x;
     int16_t linear;
 
-    /* e = (adpcm + 0.5)*step/4 */
-    ss = step_size[s->step_index];
-    e = ss >> 3;
-    if (adpcm & 0x01)
-        e += (ss >> 2);
-    /*endif*/
-    if (adpcm & 0x02)
-        e += (ss >> 1);
-    /*endif*/
-    if (adpcm & 0x04)
-        e += ss;
-    /*endif*/
-    if (adpcm & 0x08)
-        e = -e;
-    /*endif*/
-    linear = saturate16(s->last + e);
+    x = decode_table[16*s->step_index + adpcm];
+    linear = saturate16(s->last + (x >> 8));
     s->last = linear;
-    s->step_index += step_adjustment[adpcm & 0x07];
-    if (s->step_index < 0)
-        s->step_index = 0;
-    else if (s->step_index > STEP_MAX)
-        s->step_index = STEP_MAX;
-    /*endif*/
+    s->step_index = x & 0xFF;
     return linear;
 }
 /*- End of function --------------------------------------------------------*/
 
+/* Decode whole bytes of two codes each. For IMA4 the first code is in the lower 4 bits, so
+   the bytes are swapped around to match the tables. */
+static int decode_bytes(ima_adpcm_state_t *s, int16_t amp[], const uint8_t ima_data[], int ima_bytes)
+{
+    int i;
+    int last;
+    int step_index;
+    int adpcm;
+    int32_t x;
+    int swap;
+
+    swap = (s->variant == IMA_ADPCM_IMA4);
+    last = s->last;
+    step_index = s->step_index;
+    for (i = 0;  i < ima_bytes;  i++)
+    {
+        adpcm = ima_data[i];
+        if (swap)
+            adpcm = ((adpcm << 4) | (adpcm >> 4)) & 0xFF;
+        /*endif*/
+        x = decode_table[16*step_index + (adpcm >> 4)];
+        last = saturate16(last + (x >> 8));
+        amp[2*i] = (int16_t) last;
+        x = decode_table[16*(x & 0xFF) + (adpcm & 0x0F)];
+        last = saturate16(last + (x >> 8));
+        amp[2*i + 1] = (int16_t) last;
+        step_index = decode_next_byte[256*step_index + adpcm];
+    }
+    /*endfor*/
+    s->last = last;
+    s->step_index = step_index;
+    return 2*ima_bytes;
+}
+/*- End of function --------------------------------------------------------*/
+
+/* Decode the same number of whole bytes for 4 channels of the same variant, side by side.
+   Each channel is a chain of dependent lookups, so running 4 of them together keeps the
+   CPU busy while each one waits for its tables. */
+static void decode_bytes_x4(ima_adpcm_state_t *s[], int16_t *amp[], const uint8_t *ima_data[], int ima_bytes)
+{
+    int i;
+    int k;
+    int last[4];
+    int step_index[4];
+    int adpcm[4];
+    int32_t x[4];
+    int swap;
+
+    swap = (s[0]->variant == IMA_ADPCM_IMA4);
+    for (k = 0;  k < 4;  k++)
+    {
+        last[k] = s[k]->last;
+        step_index[k] = s[k]->step_index;
+    }
+    /*endfor*/
+    for (i = 0;  i < ima_bytes;  i++)
+    {
+        for (k = 0;  k < 4;  k++)
+        {
+            adpcm[k] = ima_data[k][i];
+            if (swap)
+                adpcm[k] = ((adpcm[k] << 4) | (adpcm[k] >> 4)) & 0xFF;
+            /*endif*/
+            x[k] = decode_table[16*step_index[k] + (adpcm[k] >> 4)];
+        }
+        /*endfor*/
+        for (k = 0;  k < 4;  k++)
+        {
+            last[k] = saturate16(last[k] + (x[k] >> 8));
+            amp[k][2*i] = (int16_t) last[k];
+            x[k] = decode_table[16*(x[k] & 0xFF) + (adpcm[k] & 0x0F)];
+        }
+        /*endfor*/
+        for (k = 0;  k < 4;  k++)
+        {
+            last[k] = saturate16(last[k] + (x[k] >> 8));
+            amp[k][2*i + 1] = (int16_t) last[k];
+            step_index[k] = decode_next_byte[256*step_index[k] + adpcm[k]];
+        }
+        /*endfor*/
+    }
+    /*endfor*/
+    for (k = 0;  k < 4;  k++)
+    {
+        s[k]->last = last[k];
+        s[k]->step_index = step_index[k];
+    }
+    /*endfor*/
+}
+/*- End of function --------------------------------------------------------*/
+
+/* Pick up the header at the start of a chunk, if the chunks are the size of each
+   decode operation, and return the number of bytes it used. */
+static int decode_header(ima_adpcm_state_t *s, int16_t amp[], int *samples, const uint8_t ima_data[])
+{
+    if (s->chunk_size != 0)
+        return 0;
+    /*endif*/
+    if (s->variant == IMA_ADPCM_IMA4)
+    {
+        s->last = (int16_t) ((ima_data[1] << 8) | ima_data[0]);
+        amp[(*samples)++] = (int16_t) s->last;
+    }
+    else
+    {
+        s->last = (int16_t) ((ima_data[0] << 8) | ima_data[1]);
+    }
+    /*endif*/
+    /* Don't let a bad header take us outside the tables */
+    s->step_index = (ima_data[2] <= STEP_MAX)  ?  ima_data[2]  :  STEP_MAX;
+    return 4;
+}
+/*- End of function --------------------------------------------------------*/
+
 static uint8_t encode(ima_adpcm_state_t *s, int16_t linear)
 {
     int e;
@@ -288,6 +450,9 @@ SPAN_DECLARE(ima_adpcm_state_t *) ima_adpcm_init(ima_adpcm_state_t *s,
     }
     /*endif*/
     memset(s, 0, sizeof(*s));
+    if (!decode_tables_initialised)
+        make_decode_tables();
+    /*endif*/
     s->variant = variant;
     s->chunk_size = chunk_size;
     return s;
@@ -321,47 +486,12 @@ SPAN_DECLARE(int) ima_adpcm_decode(ima_adpcm_state_t *s,
     switch (s->variant)
     {
     case IMA_ADPCM_IMA4:
-        i = 0;
-        if (s->chunk_size == 0)
-        {
-            amp[samples++] = (ima_data[1] << 8) | ima_data[0];
-            s->step_index = ima_data[2];
-            s->last = amp[0];
-            i = 4;
-        }
-        /*endif*/
-        for (  ;  i < ima_bytes;  i++)
-        {
-            amp[samples++] = decode(s, ima_data[i] & 0xF);
-            amp[samples++] = decode(s, (ima_data[i] >> 4) & 0xF);
-        }
-        /*endfor*/
-        break;
     case IMA_ADPCM_DVI4:
-        i = 0;
-        if (s->chunk_size == 0)
-        {
-            s->last = (int16_t) ((ima_data[0] << 8) | ima_data[1]);
-            s->step_index = ima_data[2];
-            i = 4;
-        }
-        /*endif*/
-        for (  ;  i < ima_bytes;  i++)
-        {
-            amp[samples++] = decode(s, (ima_data[i] >> 4) & 0xF);
-            amp[samples++] = decode(s, ima_data[i] & 0xF);
-        }
-        /*endfor*/
+        i = decode_header(s, amp, &samples, ima_data);
+        samples += decode_bytes(s, &amp[samples], &ima_data[i], ima_bytes - i);
         break;
     case IMA_ADPCM_VDVI:
-        i = 0;
-        if (s->chunk_size == 0)
-        {
-            s->last = (int16_t) ((ima_data[0] << 8) | ima_data[1]);
-            s->step_index = ima_data[2];
-            i = 4;
-        }
-        /*endif*/
+        i = decode_header(s, amp, &samples, ima_data);
         code = 0;
         s->bits = 0;
         for (;;)
@@ -423,6 +553,74 @@ SPAN_DECLARE(int) ima_adpcm_decode(ima_adpcm_state_t *s,
 }
 /*- End of function --------------------------------------------------------*/
 
+SPAN_DECLARE(int) ima_adpcm_decode_batch(ima_adpcm_state_t *s[],
+                                         int16_t *amp[],
+                                         int samples[],
+                                         const uint8_t *ima_data[],
+                                         int ima_bytes,
+                                         int channels)
+{
+    const uint8_t *data[4];
+    int16_t *out[4];
+    int total;
+    int hdr;
+    int n;
+    int i;
+    int k;
+
+    total = 0;
+    for (i = 0;  i < channels;  i += n)
+    {
+        n = (channels - i < 4)  ?  (channels - i)  :  4;
+        /* Only a full group of IMA4 or DVI4 channels, all with the same variant and
+           header arrangement, can run side by side. */
+        for (k = i;  k < i + n;  k++)
+        {
+            if (s[k]->variant == IMA_ADPCM_VDVI
+                ||
+                s[k]->variant != s[i]->variant
+                ||
+                (s[k]->chunk_size == 0) != (s[i]->chunk_size == 0))
+            {
+                break;
+            }
+            /*endif*/
+        }
+        /*endfor*/
+        if (n == 4  &&  k == i + n)
+        {
+            for (k = 0;  k < 4;  k++)
+            {
+                samples[i + k] = 0;
+                hdr = decode_header(s[i + k], amp[i + k], &samples[i + k], ima_data[i + k]);
+                data[k] = &ima_data[i + k][hdr];
+                out[k] = &amp[i + k][samples[i + k]];
+            }
+            /*endfor*/
+            decode_bytes_x4(&s[i], out, data, ima_bytes - hdr);
+            for (k = 0;  k < 4;  k++)
+            {
+                samples[i + k] += 2*(ima_bytes - hdr);
+                total += samples[i + k];
+            }
+            /*endfor*/
+        }
+        else
+        {
+            for (k = i;  k < i + n;  k++)
+            {
+                samples[k] = ima_adpcm_decode(s[k], amp[k], ima_data[k], ima_bytes);
+                total += samples[k];
+            }
+            /*endfor*/
+        }
+        /*endif*/
+    }
+    /*endfor*/
+    return total;
+}
+/*- End of function --------------------------------------------------------*/
+
 SPAN_DECLARE(int) ima_adpcm_encode(ima_adpcm_state_t *s,
                                    uint8_t ima_data[],
                                    const int16_t amp[],
@@ -48,7 +48,10 @@
 #endif
 #include "floating_fudge.h"
 
+#include "mmx_sse_decs.h"
+
 #include "spandsp/telephony.h"
+#include "spandsp/cpu_features.h"
 #include "spandsp/lpc10.h"
 #include "spandsp/private/lpc10.h"
 
@@ -121,6 +124,108 @@ static void eval_amdf(float speech[],
 }
 /*- End of function --------------------------------------------------------*/
 
+#if defined(SPANDSP_USE_RUNTIME_DISPATCH)
+SPAN_TARGET("avx2") static __inline__ float sum_avx2(__m256 x)
+{
+    __m128 y;
+
+    y = _mm_add_ps(_mm256_castps256_ps128(x), _mm256_extractf128_ps(x, 1));
+    y = _mm_add_ps(y, _mm_movehl_ps(y, y));
+    y = _mm_add_ss(y, _mm_shuffle_ps(y, y, 1));
+    return _mm_cvtss_f32(y);
+}
+/*- End of function --------------------------------------------------------*/
+
+/* The same AMDF, with the speech split into its four polyphase components. The
+   points used for any lag then lie in two contiguous runs, which can be differenced
+   8 at a time. */
+SPAN_TARGET("avx2") static void eval_amdf_avx2(float speech[],
+                                               int32_t lpita,
+                                               const int32_t tau[],
+                                               int32_t ltau,
+                                               int32_t maxlag,
+                                               float amdf[],
+                                               int32_t *minptr,
+                                               int32_t *maxptr)
+{
+    float phase[4][(2*LPC10_MIN_PITCH)/4 + 8];
+    __m256 abs_mask;
+    __m256 tail_mask;
+    __m256 sum;
+    __m256 diff;
+    const float *a;
+    const float *b;
+    int points;
+    int i;
+    int j;
+
+    /* Only every 4th point is used, from a window of lpita points */
+    points = (lpita + 3)/4;
+    memset(phase, 0, sizeof(phase));
+    for (i = 0;  i < maxlag + lpita;  i++)
+        phase[i & 3][i >> 2] = speech[i];
+    /*endfor*/
+    abs_mask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7FFFFFFF));
+    tail_mask = _mm256_castsi256_ps(_mm256_cmpgt_epi32(_mm256_set1_epi32(points & 7), _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7)));
+    for (i = 0;  i < ltau;  i++)
+    {
+        j = (maxlag - tau[i])/2;
+        a = &phase[j & 3][j >> 2];
+        j += tau[i];
+        b = &phase[j & 3][j >> 2];
+        sum = _mm256_setzero_ps();
+        for (j = 0;  j < (points & ~7);  j += 8)
+        {
+            diff = _mm256_sub_ps(_mm256_loadu_ps(&a[j]), _mm256_loadu_ps(&b[j]));
+            sum = _mm256_add_ps(sum, _mm256_and_ps(diff, abs_mask));
+        }
+        /*endfor*/
+        if ((points & 7))
+        {
+            diff = _mm256_sub_ps(_mm256_loadu_ps(&a[j]), _mm256_loadu_ps(&b[j]));
+            sum = _mm256_add_ps(sum, _mm256_and_ps(diff, _mm256_and_ps(abs_mask, tail_mask)));
+        }
+        /*endif*/
+        amdf[i] = sum_avx2(sum);
+    }
+    /*endfor*/
+    *minptr = 0;
+    *maxptr = 0;
+    for (i = 1;  i < ltau;  i++)
+    {
+        if (amdf[i] < amdf[*minptr])
+            *minptr = i;
+        /*endif*/
+        if (amdf[i] > amdf[*maxptr])
+            *maxptr = i;
+        /*endif*/
+    }
+    /*endfor*/
+}
+/*- End of function --------------------------------------------------------*/
+#endif
+
+static void select_eval_amdf(float speech[],
+                             int32_t lpita,
+                             const int32_t tau[],
+                             int32_t ltau,
+                             int32_t maxlag,
+                             float amdf[],
+                             int32_t *minptr,
+                             int32_t *maxptr)
+{
+#if defined(SPANDSP_USE_RUNTIME_DISPATCH)
+    if ((span_cpu_dispatch_features & SPAN_CPU_FEATURE_AVX2))
+        eval_amdf_avx2(speech, lpita, tau, ltau, maxlag, amdf, minptr, maxptr);
+    else
+        eval_amdf(speech, lpita, tau, ltau, maxlag, amdf, minptr, maxptr);
+    /*endif*/
+#else
+    eval_amdf(speech, lpita, tau, ltau, maxlag, amdf, minptr, maxptr);
+#endif
+}
+/*- End of function --------------------------------------------------------*/
+
 static void eval_highres_amdf(float speech[],
                               int32_t lpita,
                               const int32_t tau[],
@@ -141,7 +246,7 @@ static void eval_highres_amdf(float speech[],
     int ptr;
 
     /* Compute full AMDF using log spaced lags, find coarse minimum */
-    eval_amdf(speech, lpita, tau, ltau, tau[ltau - 1], amdf, minptr, maxptr);
+    select_eval_amdf(speech, lpita, tau, ltau, tau[ltau - 1], amdf, minptr, maxptr);
     *mintau = tau[*minptr];
     minamd = (int32_t) amdf[*minptr];
 
@@ -164,7 +269,7 @@ static void eval_highres_amdf(float speech[],
        if it is better than the coarse minimum */
     if (ltau2 > 0)
     {
-        eval_amdf(speech, lpita, tau2, ltau2, tau[ltau - 1], amdf2, &minp2, &maxp2);
+        select_eval_amdf(speech, lpita, tau2, ltau2, tau[ltau - 1], amdf2, &minp2, &maxp2);
         if (amdf2[minp2] < (float) minamd)
         {
             *mintau = tau2[minp2];
@@ -189,7 +294,7 @@ static void eval_highres_amdf(float speech[],
             tau2[0] = i;
         }
         /*endif*/
-        eval_amdf(speech, lpita, tau2, ltau2, tau[ltau - 1], amdf2, &minp2, &maxp2);
+        select_eval_amdf(speech, lpita, tau2, ltau2, tau[ltau - 1], amdf2, &minp2, &maxp2);
         if (amdf2[minp2] < (float) minamd)
         {
             *mintau = tau2[minp2];
@@ -406,6 +511,37 @@ static void onset(lpc10_encode_state_t *s,
 }
 /*- End of function --------------------------------------------------------*/
 
+/* Complete a covariance matrix, from its first column and the last element of PSI. */
+static void mload_end_correct(int32_t order, int32_t awins, int32_t awinf, float speech[], float phi[], float psi[])
+{
+    int32_t start;
+    int i;
+    int r;
+
+    start = awins + order;
+    /* End correct to get additional columns of phi */
+    for (r = 1;  r < order;  r++)
+    {
+        for (i = 1;  i <= r;  i++)
+        {
+            phi[i*order + r] = phi[(i - 1)*order + r - 1]
+                             - speech[awinf - (r + 1)]*speech[awinf - (i + 1)]
+                             + speech[start - (r + 2)]*speech[start - (i + 2)];
+        }
+        /*endfor*/
+    }
+    /*endfor*/
+    /* End correct to get additional elements of PSI */
+    for (i = 0;  i < order - 1;  i++)
+    {
+        psi[i] = phi[i + 1]
+               - speech[start - 2]*speech[start - i - 3]
+               + speech[awinf - 1]*speech[awinf - i - 2];
+    }
+    /*endfor*/
+}
+/*- End of function --------------------------------------------------------*/
+
 /* Load a covariance matrix. */
 static void mload(int32_t order, int32_t awins, int32_t awinf, float speech[], float phi[], float psi[])
 {
@@ -428,28 +564,52 @@ static void mload(int32_t order, int32_t awins, int32_t awinf, float speech[], f
     for (i = start - 1;  i < awinf;  i++)
         psi[order - 1] += speech[i]*speech[i - order];
     /*endfor*/
-    /* End correct to get additional columns of phi */
-    for (r = 1;  r < order;  r++)
+    mload_end_correct(order, awins, awinf, speech, phi, psi);
+}
+/*- End of function --------------------------------------------------------*/
+
+#if defined(SPANDSP_USE_RUNTIME_DISPATCH)
+/* The same covariance matrix load, less the end corrections, which the caller does
+   after this returns. Each sum is accumulated in the same order as in the C code. Lags 1 to 8 have a lane each, running backwards across the
+   register so each step is one broadcast and one unaligned load. The rest of the lags,
+   up to LPC10_ORDER, and the last element of PSI are summed alongside them. Keeping
+   them all in one loop leaves the compiler no reduction it might reorder. */
+SPAN_TARGET("avx2") static void mload_avx2(int32_t order, int32_t awins, int32_t awinf, float speech[], float phi[], float psi[])
+{
+    __m256 acc;
+    float sum[8];
+    float tail[LPC10_ORDER];
+    float last;
+    int32_t start;
+    int i;
+    int r;
+
+    start = awins + order;
+    acc = _mm256_setzero_ps();
+    for (r = 8;  r < order;  r++)
+        tail[r] = 0.0f;
+    /*endfor*/
+    last = 0.0f;
+    for (i = start;  i <= awinf;  i++)
     {
-        for (i = 1;  i <= r;  i++)
-        {
-            phi[i*order + r] = phi[(i - 1)*order + r - 1]
-                             - speech[awinf - (r + 1)]*speech[awinf - (i + 1)]
-                             + speech[start - (r + 2)]*speech[start - (i + 2)];
-        }
+        acc = _mm256_add_ps(acc, _mm256_mul_ps(_mm256_set1_ps(speech[i - 2]), _mm256_loadu_ps(&speech[i - 9])));
+        for (r = 8;  r < order;  r++)
+            tail[r] += speech[i - 2]*speech[i - r - 2];
         /*endfor*/
+        last += speech[i - 1]*speech[i - order - 1];
     }
     /*endfor*/
-    /* End correct to get additional elements of PSI */
-    for (i = 0;  i < order - 1;  i++)
-    {
-        psi[i] = phi[i + 1]
-               - speech[start - 2]*speech[start - i - 3]
-               + speech[awinf - 1]*speech[awinf - i - 2];
-    }
+    _mm256_storeu_ps(sum, acc);
+    for (r = 0;  r < 8;  r++)
+        phi[r] = sum[7 - r];
+    /*endfor*/
+    for (  ;  r < order;  r++)
+        phi[r] = tail[r];
     /*endfor*/
+    psi[order - 1] = last;
 }
 /*- End of function --------------------------------------------------------*/
+#endif
 
 /* Preemphasize speech with a single-zero filter. */
 /* (When coef = .9375, preemphasis is as in LPC43.) */
@@ -767,7 +927,18 @@ void lpc10_analyse(lpc10_encode_state_t *s, float speech[], int32_t voice[], int
        simplified by using diagonal elements of phi computed by mload(). */
     s->rmsbuf[2] = energyf(&abuf[ewin[2][0] - s->awin[2][0]], ewin[2][1] - ewin[2][0] + 1);
     /* Matrix load and invert, check RC's for stability */
+#if defined(SPANDSP_USE_RUNTIME_DISPATCH)
+    if ((span_cpu_dispatch_features & SPAN_CPU_FEATURE_AVX2))
+    {
+        mload_avx2(LPC10_ORDER, 1, lanal, abuf, phi, psi);
+        mload_end_correct(LPC10_ORDER, 1, lanal, abuf, phi, psi);
+    }
+    else
+        mload(LPC10_ORDER, 1, lanal, abuf, phi, psi);
+    /*endif*/
+#else
     mload(LPC10_ORDER, 1, lanal, abuf, phi, psi);
+#endif
     invert(LPC10_ORDER, phi, psi, &s->rcbuf[2][0]);
     rcchk(LPC10_ORDER, &s->rcbuf[1][0], &s->rcbuf[2][0]);
     /* Set return parameters */
@@ -48,13 +48,120 @@
 #endif
 #include "floating_fudge.h"
 
+#include "mmx_sse_decs.h"
+
 #include "spandsp/telephony.h"
+#include "spandsp/cpu_features.h"
 #include "spandsp/fast_convert.h"
 #include "spandsp/lpc10.h"
 #include "spandsp/private/lpc10.h"
 
 #include "lpc10_encdecs.h"
 
+#if defined(SPANDSP_USE_RUNTIME_DISPATCH)
+/* The sums vparms() collects over half a voicing window */
+enum
+{
+    VSUM_LP_RMS = 0,
+    VSUM_AP_RMS,
+    VSUM_E_PRE,
+    VSUM_E0AP,
+    VSUM_RC1,
+    VSUM_E_0,
+    VSUM_E_B,
+    VSUM_E_F,
+    VSUM_R_F,
+    VSUM_R_B,
+    VSUM_ENTRIES
+};
+
+SPAN_TARGET("avx2") static void vparms_sums_avx2(float sums[], const float inbuf[], const float lpbuf[], int start, int stop, int tau)
+{
+    __m256 acc[VSUM_ENTRIES];
+    __m256 abs_mask;
+    __m256 in;
+    __m256 in_1;
+    __m256 lp;
+    __m256 lp_b;
+    __m256 lp_f;
+    __m128 x;
+    int i;
+    int j;
+
+    abs_mask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7FFFFFFF));
+    for (j = 0;  j < VSUM_ENTRIES;  j++)
+        acc[j] = _mm256_setzero_ps();
+    /*endfor*/
+    for (i = start;  i + 7 <= stop;  i += 8)
+    {
+        in = _mm256_loadu_ps(&inbuf[i]);
+        in_1 = _mm256_loadu_ps(&inbuf[i - 1]);
+        lp = _mm256_loadu_ps(&lpbuf[i]);
+        lp_b = _mm256_loadu_ps(&lpbuf[i - tau]);
+        lp_f = _mm256_loadu_ps(&lpbuf[i + tau]);
+        acc[VSUM_LP_RMS] = _mm256_add_ps(acc[VSUM_LP_RMS], _mm256_and_ps(lp, abs_mask));
+        acc[VSUM_AP_RMS] = _mm256_add_ps(acc[VSUM_AP_RMS], _mm256_and_ps(in, abs_mask));
+        acc[VSUM_E_PRE] = _mm256_add_ps(acc[VSUM_E_PRE], _mm256_and_ps(_mm256_sub_ps(in, in_1), abs_mask));
+        acc[VSUM_E0AP] = _mm256_add_ps(acc[VSUM_E0AP], _mm256_mul_ps(in, in));
+        acc[VSUM_RC1] = _mm256_add_ps(acc[VSUM_RC1], _mm256_mul_ps(in, in_1));
+        acc[VSUM_E_0] = _mm256_add_ps(acc[VSUM_E_0], _mm256_mul_ps(lp, lp));
+        acc[VSUM_E_B] = _mm256_add_ps(acc[VSUM_E_B], _mm256_mul_ps(lp_b, lp_b));
+        acc[VSUM_E_F] = _mm256_add_ps(acc[VSUM_E_F], _mm256_mul_ps(lp_f, lp_f));
+        acc[VSUM_R_F] = _mm256_add_ps(acc[VSUM_R_F], _mm256_mul_ps(lp, lp_f));
+        acc[VSUM_R_B] = _mm256_add_ps(acc[VSUM_R_B], _mm256_mul_ps(lp, lp_b));
+    }
+    /*endfor*/
+    for (j = 0;  j < VSUM_ENTRIES;  j++)
+    {
+        x = _mm_add_ps(_mm256_castps256_ps128(acc[j]), _mm256_extractf128_ps(acc[j], 1));
+        x = _mm_add_ps(x, _mm_movehl_ps(x, x));
+        x = _mm_add_ss(x, _mm_shuffle_ps(x, x, 1));
+        sums[j] = _mm_cvtss_f32(x);
+    }
+    /*endfor*/
+    for (  ;  i <= stop;  i++)
+    {
+        sums[VSUM_LP_RMS] += fabsf(lpbuf[i]);
+        sums[VSUM_AP_RMS] += fabsf(inbuf[i]);
+        sums[VSUM_E_PRE] += fabsf(inbuf[i] - inbuf[i - 1]);
+        sums[VSUM_E0AP] += inbuf[i]*inbuf[i];
+        sums[VSUM_RC1] += inbuf[i]*inbuf[i - 1];
+        sums[VSUM_E_0] += lpbuf[i]*lpbuf[i];
+        sums[VSUM_E_B] += lpbuf[i - tau]*lpbuf[i - tau];
+        sums[VSUM_E_F] += lpbuf[i + tau]*lpbuf[i + tau];
+        sums[VSUM_R_F] += lpbuf[i]*lpbuf[i + tau];
+        sums[VSUM_R_B] += lpbuf[i]*lpbuf[i - tau];
+    }
+    /*endfor*/
+}
+/*- End of function --------------------------------------------------------*/
+
+/* Count the zero crossings of the dithered signal, without a branch per sample */
+static int32_t zero_crossings(const float inbuf[], int start, int stop, float *dither)
+{
+    float d;
+    int32_t zc;
+    int sgn;
+    int x;
+    int i;
+
+    d = *dither;
+    zc = 0;
+    sgn = (inbuf[start - 1] - d >= 0.0f);
+    for (i = start;  i <= stop;  i++)
+    {
+        x = (inbuf[i] + d >= 0.0f);
+        zc += (x ^ sgn);
+        sgn = x;
+        d = -d;
+    }
+    /*endfor*/
+    *dither = d;
+    return zc;
+}
+/*- End of function --------------------------------------------------------*/
+#endif
+
 static void vparms(int32_t vwin[],
                    float *inbuf,
                    float *lpbuf,
@@ -88,6 +195,9 @@ static void vparms(int32_t vwin[],
     float r_b;
     float r_f;
     float e0ap;
+#if defined(SPANDSP_USE_RUNTIME_DISPATCH)
+    float sums[VSUM_ENTRIES];
+#endif
 
     /* Calculate zero crossings (ZC) and several energy and correlation */
     /* measures on low band and full band speech.  Each measure is taken */
@@ -121,33 +231,54 @@ static void vparms(int32_t vwin[],
 
     /* 1     VWIN(1)+1      VWIN(1)+HVL */
     /* 2     VWIN(1)+HVL+1  VWIN(1)+2*HVL */
-    oldsgn = r_sign(1.0f, inbuf[start - 1] - *dither);
-    for (i = start;  i <= stop;  i++)
+#if defined(SPANDSP_USE_RUNTIME_DISPATCH)
+    if ((span_cpu_dispatch_features & SPAN_CPU_FEATURE_AVX2))
+    {
+        vparms_sums_avx2(sums, inbuf, lpbuf, start, stop, *mintau);
+        lp_rms = sums[VSUM_LP_RMS];
+        ap_rms = sums[VSUM_AP_RMS];
+        e_pre = sums[VSUM_E_PRE];
+        e0ap = sums[VSUM_E0AP];
+        *rc1 = sums[VSUM_RC1];
+        e_0 = sums[VSUM_E_0];
+        e_b = sums[VSUM_E_B];
+        e_f = sums[VSUM_E_F];
+        r_f = sums[VSUM_R_F];
+        r_b = sums[VSUM_R_B];
+        *zc = zero_crossings(inbuf, start, stop, dither);
+    }
+    else
+#endif
     {
-        lp_rms += fabsf(lpbuf[i]);
-        ap_rms += fabsf(inbuf[i]);
-        e_pre += fabsf(inbuf[i] - inbuf[i - 1]);
-        r1 = inbuf[i];
-        e0ap += r1*r1;
-        *rc1 += inbuf[i]*inbuf[i - 1];
-        r1 = lpbuf[i];
-        e_0 += r1*r1;
-        r1 = lpbuf[i - *mintau];
-        e_b += r1*r1;
-        r1 = lpbuf[i + *mintau];
-        e_f += r1*r1;
-        r_f += lpbuf[i]*lpbuf[i + *mintau];
-        r_b += lpbuf[i]*lpbuf[i - *mintau];
-        r1 = inbuf[i] + *dither;
-        if (r_sign(1.0f, r1) != oldsgn)
+        oldsgn = r_sign(1.0f, inbuf[start - 1] - *dither);
+        for (i = start;  i <= stop;  i++)
         {
-            ++(*zc);
-            oldsgn = -oldsgn;
+            lp_rms += fabsf(lpbuf[i]);
+            ap_rms += fabsf(inbuf[i]);
+            e_pre += fabsf(inbuf[i] - inbuf[i - 1]);
+            r1 = inbuf[i];
+            e0ap += r1*r1;
+            *rc1 += inbuf[i]*inbuf[i - 1];
+            r1 = lpbuf[i];
+            e_0 += r1*r1;
+            r1 = lpbuf[i - *mintau];
+            e_b += r1*r1;
+            r1 = lpbuf[i + *mintau];
+            e_f += r1*r1;
+            r_f += lpbuf[i]*lpbuf[i + *mintau];
+            r_b += lpbuf[i]*lpbuf[i - *mintau];
+            r1 = inbuf[i] + *dither;
+            if (r_sign(1.0f, r1) != oldsgn)
+            {
+                ++(*zc);
+                oldsgn = -oldsgn;
+            }
+            /*endif*/
+            *dither = -(*dither);
         }
-        /*endif*/
-        *dither = -(*dither);
+        /*endfor*/
     }
-    /*endfor*/
+    /*endif*/
     /* Normalized short-term autocovariance coefficient at unit sample delay */
     *rc1 /= max(e0ap, 1.0f);
     /* Ratio of the energy of the first difference signal (6 dB/oct preemphasis)*/
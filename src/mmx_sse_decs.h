@@ -60,6 +60,19 @@
 #include <x86intrin.h>
 #endif
 
+#if defined(SPANDSP_USE_RUNTIME_DISPATCH)
+/* With run time dispatch, the wider SIMD versions of routines are compiled for specific
+   instruction sets with a function attribute, and selected according to the features
+   found in the CPU when the library is loaded. GCC and clang make all the intrinsics
+   available, whatever the -m options used for the rest of the code. */
+#include <immintrin.h>
+
+#define SPAN_TARGET(isa) __attribute__((target(isa)))
+
+/* The SPAN_CPU_FEATURE_xxx features which may be used to select code paths */
+extern uint32_t span_cpu_dispatch_features;
+#endif
+
 #endif
 
 /*- End of include ---------------------------------------------------------*/
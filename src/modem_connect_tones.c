@@ -69,8 +69,8 @@
 #include "spandsp/dds.h"
 #include "spandsp/tone_detect.h"
 #include "spandsp/tone_generate.h"
-#include "spandsp/super_tone_rx.h"
 #include "spandsp/power_meter.h"
+#include "spandsp/super_tone_rx.h"
 #include "spandsp/async.h"
 #include "spandsp/fsk.h"
 #include "spandsp/modem_connect_tones.h"
@@ -81,6 +81,13 @@
 
 #define HDLC_FRAMING_OK_THRESHOLD       5
 
+/* The channel level, as tracked by the receiver, below which no tone is considered present.
+   This is about -43dBm0. */
+#define CHANNEL_LEVEL_CUTOFF            70
+/* The mean power of a chunk of audio below which the receiver's filters are skipped. This
+   is well below the channel level cut off. */
+#define QUIET_CHUNK_LEVEL               -55.0f
+
 SPAN_DECLARE(const char *) modem_connect_tone_to_str(int tone)
 {
     switch (tone)
@@ -518,6 +525,34 @@ static void v21_put_bit(void *user_data, int bit)
 }
 /*- End of function --------------------------------------------------------*/
 
+static bool quiet_chunk(modem_connect_tones_rx_state_t *s, const int16_t amp[], int len)
+{
+    int i;
+
+    /* Only take the quick route if the tone detector has already settled into seeing nothing. */
+    if (s->channel_level > CHANNEL_LEVEL_CUTOFF  ||  !power_gate_block(&s->gate, amp, len))
+        return false;
+    /*endif*/
+    /* The only thing the detectors look at while the channel level is below the cut off
+       is the channel level itself, so track that exactly, and say the tone is absent. A
+       click within an otherwise quiet chunk might take the channel level over the cut off
+       for a few samples, but not for long enough to be taken as a tone. */
+    for (i = 0;  i < len;  i++)
+        s->channel_level += ((abs(amp[i]) - s->channel_level) >> 5);
+    /*endfor*/
+    /* Restart the filters from rest. Any residue in them from before the quiet chunk is small,
+       and setting the notch level to the channel level errs on the side of a tone being absent,
+       until the notch filter has caught up. */
+    s->notch_level = s->channel_level;
+    s->am_level = 0;
+    s->znotch_1 = 0.0f;
+    s->znotch_2 = 0.0f;
+    s->z15hz_1 = 0.0f;
+    s->z15hz_2 = 0.0f;
+    return true;
+}
+/*- End of function --------------------------------------------------------*/
+
 SPAN_DECLARE(int) modem_connect_tones_rx(modem_connect_tones_rx_state_t *s,
                                          const int16_t amp[],
                                          int len)
@@ -531,6 +566,15 @@ SPAN_DECLARE(int) modem_connect_tones_rx(modem_connect_tones_rx_state_t *s,
     switch (s->tone_type)
     {
     case MODEM_CONNECT_TONES_FAX_CNG:
+        if (quiet_chunk(s, amp, len))
+        {
+            if (s->tone_present == MODEM_CONNECT_TONES_FAX_CNG)
+                report_tone_state(s, MODEM_CONNECT_TONES_NONE, -99);
+            /*endif*/
+            s->tone_cycle_duration = 0;
+            break;
+        }
+        /*endif*/
         for (i = 0;  i < len;  i++)
         {
             famp = amp[i];
@@ -549,7 +593,7 @@ SPAN_DECLARE(int) modem_connect_tones_rx(modem_connect_tones_rx_state_t *s,
                Use abs instead of multiply for speed (is it really faster?). */
             s->channel_level += ((abs(amp[i]) - s->channel_level) >> 5);
             s->notch_level += ((abs(notched) - s->notch_level) >> 5);
-            if (s->channel_level > 70  &&  s->notch_level*6 < s->channel_level)
+            if (s->channel_level > CHANNEL_LEVEL_CUTOFF  &&  s->notch_level*6 < s->channel_level)
             {
                 /* There is adequate energy in the channel, and it is mostly at 1100Hz. */
                 if (s->tone_present != MODEM_CONNECT_TONES_FAX_CNG)
@@ -587,6 +631,17 @@ SPAN_DECLARE(int) modem_connect_tones_rx(modem_connect_tones_rx_state_t *s,
         fsk_rx(&(s->v21rx), amp, len);
         /* Now fall through and look for a 2100Hz tone */
     case MODEM_CONNECT_TONES_ANS:
+        if (quiet_chunk(s, amp, len))
+        {
+            if (s->tone_present != MODEM_CONNECT_TONES_NONE)
+                report_tone_state(s, MODEM_CONNECT_TONES_NONE, -99);
+            /*endif*/
+            s->tone_cycle_duration = 0;
+            s->good_cycles = 0;
+            s->tone_on = false;
+            break;
+        }
+        /*endif*/
         for (i = 0;  i < len;  i++)
         {
             famp = amp[i];
@@ -617,7 +672,7 @@ SPAN_DECLARE(int) modem_connect_tones_rx(modem_connect_tones_rx_state_t *s,
             s->channel_level += ((abs(amp[i]) - s->channel_level) >> 5);
             s->notch_level += ((abs(notched) - s->notch_level) >> 4);
             /* This should cut off at about -43dBm0 */
-            if (s->channel_level <= 70)
+            if (s->channel_level <= CHANNEL_LEVEL_CUTOFF)
             {
                 /* If the energy level is low, even for a moment, we consider this the
                    end of the tone. */
@@ -703,6 +758,15 @@ SPAN_DECLARE(int) modem_connect_tones_rx(modem_connect_tones_rx_state_t *s,
         /*endfor*/
         break;
     case MODEM_CONNECT_TONES_BELL_ANS:
+        if (quiet_chunk(s, amp, len))
+        {
+            if (s->tone_present == MODEM_CONNECT_TONES_BELL_ANS)
+                report_tone_state(s, MODEM_CONNECT_TONES_NONE, -99);
+            /*endif*/
+            s->tone_cycle_duration = 0;
+            break;
+        }
+        /*endif*/
         for (i = 0;  i < len;  i++)
         {
             famp = amp[i];
@@ -721,7 +785,7 @@ SPAN_DECLARE(int) modem_connect_tones_rx(modem_connect_tones_rx_state_t *s,
                Use abs instead of multiply for speed (is it really faster?). */
             s->channel_level += ((abs(amp[i]) - s->channel_level) >> 5);
             s->notch_level += ((abs(notched) - s->notch_level) >> 5);
-            if (s->channel_level > 70  &&  s->notch_level*6 < s->channel_level)
+            if (s->channel_level > CHANNEL_LEVEL_CUTOFF  &&  s->notch_level*6 < s->channel_level)
             {
                 /* There is adequate energy in the channel, and it is mostly at 2225Hz. */
                 if (s->tone_present != MODEM_CONNECT_TONES_BELL_ANS)
@@ -750,6 +814,15 @@ SPAN_DECLARE(int) modem_connect_tones_rx(modem_connect_tones_rx_state_t *s,
         /*endfor*/
         break;
     case MODEM_CONNECT_TONES_CALLING_TONE:
+        if (quiet_chunk(s, amp, len))
+        {
+            if (s->tone_present == MODEM_CONNECT_TONES_CALLING_TONE)
+                report_tone_state(s, MODEM_CONNECT_TONES_NONE, -99);
+            /*endif*/
+            s->tone_cycle_duration = 0;
+            break;
+        }
+        /*endif*/
         for (i = 0;  i < len;  i++)
         {
             famp = amp[i];
@@ -768,7 +841,7 @@ SPAN_DECLARE(int) modem_connect_tones_rx(modem_connect_tones_rx_state_t *s,
                Use abs instead of multiply for speed (is it really faster?). */
             s->channel_level += ((abs(amp[i]) - s->channel_level) >> 5);
             s->notch_level += ((abs(notched) - s->notch_level) >> 5);
-            if (s->channel_level > 70  &&  s->notch_level*6 < s->channel_level)
+            if (s->channel_level > CHANNEL_LEVEL_CUTOFF  &&  s->notch_level*6 < s->channel_level)
             {
                 /* There is adequate energy in the channel, and it is mostly at 1300Hz. */
                 if (s->tone_present != MODEM_CONNECT_TONES_CALLING_TONE)
@@ -820,6 +893,12 @@ SPAN_DECLARE(int) modem_connect_tones_rx_get(modem_connect_tones_rx_state_t *s)
 }
 /*- End of function --------------------------------------------------------*/
 
+SPAN_DECLARE(power_gate_t *) modem_connect_tones_rx_get_power_gate(modem_connect_tones_rx_state_t *s)
+{
+    return &s->gate;
+}
+/*- End of function --------------------------------------------------------*/
+
 SPAN_DECLARE(modem_connect_tones_rx_state_t *) modem_connect_tones_rx_init(modem_connect_tones_rx_state_t *s,
                                                                            int tone_type,
                                                                            span_tone_report_func_t tone_callback,
@@ -856,6 +935,7 @@ SPAN_DECLARE(modem_connect_tones_rx_state_t *) modem_connect_tones_rx_init(modem
     s->channel_level = 0;
     s->notch_level = 0;
     s->am_level = 0;
+    power_gate_init(&s->gate, QUIET_CHUNK_LEVEL);
     s->tone_present = MODEM_CONNECT_TONES_NONE;
     s->tone_cycle_duration = 0;
     s->good_cycles = 0;
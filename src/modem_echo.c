@@ -50,6 +50,7 @@
 #include "spandsp/alloc.h"
 #include "spandsp/bit_operations.h"
 #include "spandsp/dc_restore.h"
+#include "spandsp/vector_int.h"
 #include "spandsp/modem_echo.h"
 
 #include "spandsp/private/modem_echo.h"
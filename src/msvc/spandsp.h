@@ -63,6 +63,7 @@
 #include <spandsp/schedule.h>
 #include <spandsp/g711.h>
 #include <spandsp/timing.h>
+#include <spandsp/cpu_features.h>
 #include <spandsp/math_fixed.h>
 #include <spandsp/vector_float.h>
 #include <spandsp/complex_vector_float.h>
@@ -71,6 +72,7 @@
 #include <spandsp/arctan2.h>
 #include <spandsp/biquad.h>
 #include <spandsp/fir.h>
+#include <spandsp/resample.h>
 #include <spandsp/awgn.h>
 #include <spandsp/bert.h>
 #include <spandsp/power_meter.h>
@@ -95,6 +97,7 @@
 #include <spandsp/sig_tone.h>
 #include <spandsp/fsk.h>
 #include <spandsp/modem_connect_tones.h>
+#include <spandsp/tone_analyser.h>
 #include <spandsp/silence_gen.h>
 #include <spandsp/v8.h>
 #include <spandsp/v29rx.h>
@@ -145,6 +148,7 @@
 #include <spandsp/g726.h>
 #include <spandsp/lpc10.h>
 #include <spandsp/gsm0610.h>
+#include <spandsp/transcoder.h>
 #include <spandsp/plc.h>
 #include <spandsp/playout.h>
 #include <spandsp/sprt.h>
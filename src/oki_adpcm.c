@@ -37,6 +37,11 @@
 #include <stdlib.h>
 #include <inttypes.h>
 #include <string.h>
+#if defined(HAVE_STDBOOL_H)
+#include <stdbool.h>
+#else
+#include "spandsp/stdbool.h"
+#endif
 
 #include "spandsp/telephony.h"
 #include "spandsp/alloc.h"
@@ -150,59 +155,184 @@ static const float cutoff_coeffs[] =
     -3.648392e-4f
 };
 
-static int16_t decode(oki_adpcm_state_t *s, uint8_t adpcm)
+/* The decoder works from tables, built from step_size[] and step_adjustment[] the first
+   time a context is initialised. For each step index and 4 bit code, decode_table[] holds
+   the change in the signal, times 256, plus the step index which follows. For each step
+   index and whole byte of two codes, decode_next_byte[] holds the step index which follows
+   the byte, so the step index adaptation takes a single lookup for each pair of samples. */
+static int32_t decode_table[49*16];
+static uint8_t decode_next_byte[49*256];
+static int decode_tables_initialised = false;
+
+static void make_decode_tables(void)
 {
+    int i;
+    int j;
+    int adpcm;
     int16_t d;
     int16_t ss;
-    int16_t linear;
-
-    /* Doing the next part as follows:
-     *
-     * x = adpcm & 0x07;
-     * e = (step_size[s->step_index]*(x + x + 1)) >> 3;
-     *
-     * Seems an obvious improvement on a modern machine, but remember
-     * the truncation errors do not come out the same. It would
-     * not, therefore, be an exact match for what this code is doing.
-     *
-     * Just what a Dialogic card does, I do not know!
-     */
 
-    ss = step_size[s->step_index];
-    d = ss >> 3;
-    if (adpcm & 0x01)
-        d += (ss >> 2);
-    /*endif*/
-    if (adpcm & 0x02)
-        d += (ss >> 1);
-    /*endif*/
-    if (adpcm & 0x04)
-        d += ss;
-    /*endif*/
-    if (adpcm & 0x08)
-        d = -d;
-    /*endif*/
-    linear = s->last + d;
+    for (i = 0;  i < 49;  i++)
+    {
+        for (adpcm = 0;  adpcm < 16;  adpcm++)
+        {
+            /* Doing the next part as follows:
+             *
+             * x = adpcm & 0x07;
+             * e = (step_size[s->step_index]*(x + x + 1)) >> 3;
+             *
+             * Seems an obvious improvement on a modern machine, but remember
+             * the truncation errors do not come out the same. It would
+             * not, therefore, be an exact match for what this code is doing.
+             *
+             * Just what a Dialogic card does, I do not know!
+             */
+            ss = step_size[i];
+            d = ss >> 3;
+            if (adpcm & 0x01)
+                d += (ss >> 2);
+            /*endif*/
+            if (adpcm & 0x02)
+                d += (ss >> 1);
+            /*endif*/
+            if (adpcm & 0x04)
+                d += ss;
+            /*endif*/
+            if (adpcm & 0x08)
+                d = -d;
+            /*endif*/
+            j = i + step_adjustment[adpcm & 0x07];
+            if (j < 0)
+                j = 0;
+            else if (j > 48)
+                j = 48;
+            /*endif*/
+            decode_table[16*i + adpcm] = d*256 + j;
+        }
+        /*endfor*/
+    }
+    /*endfor*/
+    for (i = 0;  i < 49;  i++)
+    {
+        for (adpcm = 0;  adpcm < 256;  adpcm++)
+        {
+            j = decode_table[16*i + (adpcm >> 4)] & 0xFF;
+            decode_next_byte[256*i + adpcm] = (uint8_t) (decode_table[16*j + (adpcm & 0x0F)] & 0xFF);
+        }
+        /*endfor*/
+    }
+    /*endfor*/
+    decode_tables_initialised = true;
+}
+/*- End of function --------------------------------------------------------*/
 
+static __inline__ int clamp12(int linear)
+{
     /* Saturate the values to +/- 2^11 (supposed to be 12 bits) */
     if (linear > 2047)
-        linear = 2047;
-    else if (linear < -2048)
-        linear = -2048;
+        return 2047;
     /*endif*/
+    if (linear < -2048)
+        return -2048;
+    /*endif*/
+    return linear;
+}
+/*- End of function --------------------------------------------------------*/
+
+static int16_t decode(oki_adpcm_state_t *s, uint8_t adpcm)
+{
+    int32_t x;
+    int16_t linear;
 
+    x = decode_table[16*s->step_index + adpcm];
+    linear = (int16_t) clamp12(s->last + (x >> 8));
     s->last = linear;
-    s->step_index += step_adjustment[adpcm & 0x07];
-    if (s->step_index < 0)
-        s->step_index = 0;
-    else if (s->step_index > 48)
-        s->step_index = 48;
-    /*endif*/
+    s->step_index = x & 0xFF;
     /* Note: the result here is a 12 bit value */
     return linear;
 }
 /*- End of function --------------------------------------------------------*/
 
+/* Decode whole bytes of two codes each, at 32kbps. */
+static int decode_bytes(oki_adpcm_state_t *s, int16_t amp[], const uint8_t oki_data[], int oki_bytes)
+{
+    int i;
+    int last;
+    int step_index;
+    int adpcm;
+    int32_t x;
+
+    last = s->last;
+    step_index = s->step_index;
+    for (i = 0;  i < oki_bytes;  i++)
+    {
+        adpcm = oki_data[i];
+        x = decode_table[16*step_index + (adpcm >> 4)];
+        last = clamp12(last + (x >> 8));
+        amp[2*i] = (int16_t) (last << 4);
+        x = decode_table[16*(x & 0xFF) + (adpcm & 0x0F)];
+        last = clamp12(last + (x >> 8));
+        amp[2*i + 1] = (int16_t) (last << 4);
+        step_index = decode_next_byte[256*step_index + adpcm];
+    }
+    /*endfor*/
+    s->last = (int16_t) last;
+    s->step_index = step_index;
+    return 2*oki_bytes;
+}
+/*- End of function --------------------------------------------------------*/
+
+/* Decode the same number of whole bytes for 4 channels at 32kbps, side by side. Each
+   channel is a chain of dependent lookups, so running 4 of them together keeps the
+   CPU busy while each one waits for its tables. */
+static void decode_bytes_x4(oki_adpcm_state_t *s[], int16_t *amp[], const uint8_t *oki_data[], int oki_bytes)
+{
+    int i;
+    int k;
+    int last[4];
+    int step_index[4];
+    int adpcm[4];
+    int32_t x[4];
+
+    for (k = 0;  k < 4;  k++)
+    {
+        last[k] = s[k]->last;
+        step_index[k] = s[k]->step_index;
+    }
+    /*endfor*/
+    for (i = 0;  i < oki_bytes;  i++)
+    {
+        for (k = 0;  k < 4;  k++)
+        {
+            adpcm[k] = oki_data[k][i];
+            x[k] = decode_table[16*step_index[k] + (adpcm[k] >> 4)];
+        }
+        /*endfor*/
+        for (k = 0;  k < 4;  k++)
+        {
+            last[k] = clamp12(last[k] + (x[k] >> 8));
+            amp[k][2*i] = (int16_t) (last[k] << 4);
+            x[k] = decode_table[16*(x[k] & 0xFF) + (adpcm[k] & 0x0F)];
+        }
+        /*endfor*/
+        for (k = 0;  k < 4;  k++)
+        {
+            last[k] = clamp12(last[k] + (x[k] >> 8));
+            amp[k][2*i + 1] = (int16_t) (last[k] << 4);
+            step_index[k] = decode_next_byte[256*step_index[k] + adpcm[k]];
+        }
+        /*endfor*/
+    }
+    /*endfor*/
+    for (k = 0;  k < 4;  k++)
+    {
+        s[k]->last = (int16_t) last[k];
+        s[k]->step_index = step_index[k];
+    }
+    /*endfor*/
+}
+/*- End of function --------------------------------------------------------*/
+
 static uint8_t encode(oki_adpcm_state_t *s, int16_t linear)
 {
     int16_t d;
@@ -251,6 +381,9 @@ SPAN_DECLARE(oki_adpcm_state_t *) oki_adpcm_init(oki_adpcm_state_t *s, int bit_r
             return NULL;
     }
     memset(s, 0, sizeof(*s));
+    if (!decode_tables_initialised)
+        make_decode_tables();
+    /*endif*/
     s->bit_rate = bit_rate;
 
     return s;
@@ -288,12 +421,7 @@ SPAN_DECLARE(int) oki_adpcm_decode(oki_adpcm_state_t *s,
     samples = 0;
     if (s->bit_rate == 32000)
     {
-        for (i = 0;  i < oki_bytes;  i++)
-        {
-            amp[samples++] = decode(s, (oki_data[i] >> 4) & 0xF) << 4;
-            amp[samples++] = decode(s, oki_data[i] & 0xF) << 4;
-        }
-        /*endwhile*/
+        samples = decode_bytes(s, amp, oki_data, oki_bytes);
     }
     else
     {
@@ -323,6 +451,57 @@ SPAN_DECLARE(int) oki_adpcm_decode(oki_adpcm_state_t *s,
 }
 /*- End of function --------------------------------------------------------*/
 
+SPAN_DECLARE(int) oki_adpcm_decode_batch(oki_adpcm_state_t *s[],
+                                         int16_t *amp[],
+                                         int samples[],
+                                         const uint8_t *oki_data[],
+                                         int oki_bytes,
+                                         int channels)
+{
+    int total;
+    int n;
+    int i;
+    int k;
+
+    total = 0;
+    for (i = 0;  i < channels;  i += n)
+    {
+        n = (channels - i < 4)  ?  (channels - i)  :  4;
+        /* Only a full group of 32kbps channels can run side by side. The 24kbps
+           channels must go through the rate converter one at a time. */
+        for (k = i;  k < i + n;  k++)
+        {
+            if (s[k]->bit_rate != 32000)
+                break;
+            /*endif*/
+        }
+        /*endfor*/
+        if (n == 4  &&  k == i + n)
+        {
+            decode_bytes_x4(&s[i], &amp[i], &oki_data[i], oki_bytes);
+            for (k = i;  k < i + n;  k++)
+            {
+                samples[k] = 2*oki_bytes;
+                total += samples[k];
+            }
+            /*endfor*/
+        }
+        else
+        {
+            for (k = i;  k < i + n;  k++)
+            {
+                samples[k] = oki_adpcm_decode(s[k], amp[k], oki_data[k], oki_bytes);
+                total += samples[k];
+            }
+            /*endfor*/
+        }
+        /*endif*/
+    }
+    /*endfor*/
+    return total;
+}
+/*- End of function --------------------------------------------------------*/
+
 SPAN_DECLARE(int) oki_adpcm_encode(oki_adpcm_state_t *s,
                                    uint8_t oki_data[],
                                    const int16_t amp[],
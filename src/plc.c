@@ -42,7 +42,10 @@
 #include "floating_fudge.h"
 #include <limits.h>
 
+#include "mmx_sse_decs.h"
+
 #include "spandsp/telephony.h"
+#include "spandsp/cpu_features.h"
 #include "spandsp/alloc.h"
 #include "spandsp/fast_convert.h"
 #include "spandsp/saturated.h"
@@ -122,6 +125,119 @@ static __inline__ int amdf_pitch(int min_pitch, int max_pitch, int16_t amp[], in
 }
 /*- End of function --------------------------------------------------------*/
 
+#if defined(SPANDSP_USE_RUNTIME_DISPATCH)
+/* The SIMD versions find exactly the same sums as the C version, and pick the same pitch.
+   max(a, b) - min(a, b) is the magnitude of the difference, which can need all 16 bits
+   unsigned, so it is zero extended before it is added up. */
+SPAN_TARGET("sse2") static int amdf_pitch_sse2(int min_pitch, int max_pitch, int16_t amp[], int len)
+{
+    int i;
+    int j;
+    int acc;
+    int min_acc;
+    int pitch;
+    __m128i zero;
+    __m128i sum;
+    __m128i a;
+    __m128i b;
+    __m128i d;
+
+    zero = _mm_setzero_si128();
+    pitch = min_pitch;
+    min_acc = INT_MAX;
+    for (i = max_pitch;  i <= min_pitch;  i++)
+    {
+        sum = _mm_setzero_si128();
+        for (j = 0;  j + 8 <= len;  j += 8)
+        {
+            a = _mm_loadu_si128((const __m128i *) &amp[i + j]);
+            b = _mm_loadu_si128((const __m128i *) &amp[j]);
+            d = _mm_sub_epi16(_mm_max_epi16(a, b), _mm_min_epi16(a, b));
+            sum = _mm_add_epi32(sum, _mm_unpacklo_epi16(d, zero));
+            sum = _mm_add_epi32(sum, _mm_unpackhi_epi16(d, zero));
+        }
+        /*endfor*/
+        sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(1, 0, 3, 2)));
+        sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(2, 3, 0, 1)));
+        acc = _mm_cvtsi128_si32(sum);
+        for (  ;  j < len;  j++)
+            acc += abs(amp[i + j] - amp[j]);
+        /*endfor*/
+        if (acc < min_acc)
+        {
+            min_acc = acc;
+            pitch = i;
+        }
+        /*endif*/
+    }
+    /*endfor*/
+    return pitch;
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_TARGET("avx2") static int amdf_pitch_avx2(int min_pitch, int max_pitch, int16_t amp[], int len)
+{
+    int i;
+    int j;
+    int acc;
+    int min_acc;
+    int pitch;
+    __m256i zero;
+    __m256i sum;
+    __m256i a;
+    __m256i b;
+    __m256i d;
+    __m128i sum128;
+
+    zero = _mm256_setzero_si256();
+    pitch = min_pitch;
+    min_acc = INT_MAX;
+    for (i = max_pitch;  i <= min_pitch;  i++)
+    {
+        sum = _mm256_setzero_si256();
+        for (j = 0;  j + 16 <= len;  j += 16)
+        {
+            a = _mm256_loadu_si256((const __m256i *) &amp[i + j]);
+            b = _mm256_loadu_si256((const __m256i *) &amp[j]);
+            d = _mm256_sub_epi16(_mm256_max_epi16(a, b), _mm256_min_epi16(a, b));
+            sum = _mm256_add_epi32(sum, _mm256_unpacklo_epi16(d, zero));
+            sum = _mm256_add_epi32(sum, _mm256_unpackhi_epi16(d, zero));
+        }
+        /*endfor*/
+        sum128 = _mm_add_epi32(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+        sum128 = _mm_add_epi32(sum128, _mm_shuffle_epi32(sum128, _MM_SHUFFLE(1, 0, 3, 2)));
+        sum128 = _mm_add_epi32(sum128, _mm_shuffle_epi32(sum128, _MM_SHUFFLE(2, 3, 0, 1)));
+        acc = _mm_cvtsi128_si32(sum128);
+        for (  ;  j < len;  j++)
+            acc += abs(amp[i + j] - amp[j]);
+        /*endfor*/
+        if (acc < min_acc)
+        {
+            min_acc = acc;
+            pitch = i;
+        }
+        /*endif*/
+    }
+    /*endfor*/
+    return pitch;
+}
+/*- End of function --------------------------------------------------------*/
+#endif
+
+static int select_amdf_pitch(int min_pitch, int max_pitch, int16_t amp[], int len)
+{
+#if defined(SPANDSP_USE_RUNTIME_DISPATCH)
+    if ((span_cpu_dispatch_features & SPAN_CPU_FEATURE_AVX2))
+        return amdf_pitch_avx2(min_pitch, max_pitch, amp, len);
+    /*endif*/
+    if ((span_cpu_dispatch_features & SPAN_CPU_FEATURE_SSE2))
+        return amdf_pitch_sse2(min_pitch, max_pitch, amp, len);
+    /*endif*/
+#endif
+    return amdf_pitch(min_pitch, max_pitch, amp, len);
+}
+/*- End of function --------------------------------------------------------*/
+
 SPAN_DECLARE(int) plc_rx(plc_state_t *s, int16_t amp[], int len)
 {
     int i;
@@ -189,7 +305,7 @@ SPAN_DECLARE(int) plc_fillin(plc_state_t *s, int16_t amp[], int len)
         /* As the gap in real speech starts we need to assess the last known pitch,
            and prepare the synthetic data we will use for fill-in */
         normalise_history(s);
-        s->pitch = amdf_pitch(PLC_PITCH_MIN, PLC_PITCH_MAX, s->history + PLC_HISTORY_LEN - CORRELATION_SPAN - PLC_PITCH_MIN, CORRELATION_SPAN);
+        s->pitch = select_amdf_pitch(PLC_PITCH_MIN, PLC_PITCH_MAX, s->history + PLC_HISTORY_LEN - CORRELATION_SPAN - PLC_PITCH_MIN, CORRELATION_SPAN);
         /* We overlap a 1/4 wavelength */
         pitch_overlap = s->pitch >> 2;
         /* Cook up a single cycle of pitch, using a single of the real signal with 1/4
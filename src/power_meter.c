@@ -148,6 +148,96 @@ SPAN_DECLARE(int) power_meter_free(power_meter_t *s)
 }
 /*- End of function --------------------------------------------------------*/
 
+SPAN_DECLARE(void) power_gate_set_level(power_gate_t *s, float level)
+{
+    s->threshold = (level <= -99.0f)  ?  0  :  power_meter_level_dbm0(level);
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_DECLARE(void) power_gate_update(power_gate_t *s, const int16_t amp[], int len)
+{
+    int64_t energy;
+    int i;
+
+    /* A 64 bit sum can't overflow for any sensible block, however loud the signal is. An
+       overflow could make a loud block look quiet. */
+    energy = 0;
+    for (i = 0;  i < len;  i++)
+        energy += (int32_t) amp[i]*amp[i];
+    /*endfor*/
+    s->energy += energy;
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_DECLARE(bool) power_gate_block_end(power_gate_t *s, int len)
+{
+    bool quiet;
+
+    quiet = (s->energy < (int64_t) s->threshold*len);
+    s->energy = 0;
+    s->blocks++;
+    if (quiet)
+        s->skipped++;
+    /*endif*/
+    return quiet;
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_DECLARE(bool) power_gate_block(power_gate_t *s, const int16_t amp[], int len)
+{
+    power_gate_update(s, amp, len);
+    return power_gate_block_end(s, len);
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_DECLARE(void) power_gate_restart(power_gate_t *s)
+{
+    s->energy = 0;
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_DECLARE(int) power_gate_blocks(power_gate_t *s)
+{
+    return s->blocks;
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_DECLARE(int) power_gate_skipped_blocks(power_gate_t *s)
+{
+    return s->skipped;
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_DECLARE(power_gate_t *) power_gate_init(power_gate_t *s, float level)
+{
+    if (s == NULL)
+    {
+        if ((s = (power_gate_t *) span_alloc(sizeof(*s))) == NULL)
+            return NULL;
+        /*endif*/
+    }
+    /*endif*/
+    memset(s, 0, sizeof(*s));
+    power_gate_set_level(s, level);
+    return s;
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_DECLARE(int) power_gate_release(power_gate_t *s)
+{
+    return 0;
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_DECLARE(int) power_gate_free(power_gate_t *s)
+{
+    if (s)
+        span_free(s);
+    /*endif*/
+    return 0;
+}
+/*- End of function --------------------------------------------------------*/
+
 SPAN_DECLARE(int32_t) power_surge_detector(power_surge_detector_state_t *s, int16_t amp)
 {
     int32_t pow_short;
@@ -0,0 +1,309 @@
+/*
+ * SpanDSP - a series of DSP components for telephony
+ *
+ * resample.c - Polyphase sample rate conversion.
+ *
+ * Written by Steve Underwood <steveu@coppice.org>
+ *
+ * Copyright (C) 2026 Steve Underwood
+ *
+ * All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License version 2.1,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+/*! \file */
+
+#if defined(HAVE_CONFIG_H)
+#include "config.h"
+#endif
+
+#include <stdlib.h>
+#include <inttypes.h>
+#include <string.h>
+#if defined(HAVE_TGMATH_H)
+#include <tgmath.h>
+#endif
+#if defined(HAVE_MATH_H)
+#include <math.h>
+#endif
+#include "floating_fudge.h"
+
+#include "spandsp/telephony.h"
+#include "spandsp/alloc.h"
+#include "spandsp/fast_convert.h"
+#include "spandsp/saturated.h"
+#include "spandsp/vector_int.h"
+#include "spandsp/vector_float.h"
+#include "spandsp/resample.h"
+
+#include "spandsp/private/resample.h"
+
+typedef struct
+{
+    /*! The number of taps, at the lower of the two rates. */
+    int taps;
+    /*! The Kaiser window's beta. */
+    double beta;
+} resample_design_t;
+
+static const resample_design_t designs[3] =
+{
+    {RESAMPLE_MAX_TAPS/4, 4.5},         /* RESAMPLE_LOW_LATENCY */
+    {RESAMPLE_MAX_TAPS/2, 7.0},         /* RESAMPLE_STANDARD */
+    {RESAMPLE_MAX_TAPS,   9.0}          /* RESAMPLE_HIGH_QUALITY */
+};
+
+static int gcd(int a, int b)
+{
+    int c;
+
+    while (b)
+    {
+        c = a%b;
+        a = b;
+        b = c;
+    }
+    /*endwhile*/
+    return a;
+}
+/*- End of function --------------------------------------------------------*/
+
+/* The zeroth order modified Bessel function of the first kind, for the Kaiser window */
+static double bessel_i0(double x)
+{
+    double sum;
+    double term;
+    int k;
+
+    sum = 1.0;
+    term = 1.0;
+    for (k = 1;  k < 50;  k++)
+    {
+        term *= (x/(2.0*k))*(x/(2.0*k));
+        sum += term;
+        if (term < 1.0e-12*sum)
+            break;
+        /*endif*/
+    }
+    /*endfor*/
+    return sum;
+}
+/*- End of function --------------------------------------------------------*/
+
+static void design_filter(resample_state_t *s, const resample_design_t *design)
+{
+    double h[RESAMPLE_MAX_COEFFS];
+    double fc;
+    double centre;
+    double x;
+    double sum;
+    int len;
+    int p;
+    int i;
+    int j;
+
+    /* Make the filter an odd length, with the final coefficient zero, so the delay is
+       a whole number of samples at the interpolated rate. */
+    len = s->taps*s->up - 1;
+    /* The cutoff is the Nyquist frequency of the lower rate, as a fraction of the
+       interpolated rate. */
+    fc = 0.5/((s->up > s->down)  ?  s->up  :  s->down);
+    centre = 0.5*(len - 1);
+    for (i = 0;  i < len;  i++)
+    {
+        x = i - centre;
+        h[i] = (x == 0.0)  ?  2.0*fc  :  sin(2.0*3.1415926535897932*fc*x)/(3.1415926535897932*x);
+        x /= (centre + 1.0);
+        h[i] *= bessel_i0(design->beta*sqrt(1.0 - x*x))/bessel_i0(design->beta);
+    }
+    /*endfor*/
+    h[len] = 0.0;
+    /* Split the filter into its phases. Each phase is stored in time order, to match the
+       history, and normalised to unity gain at DC. */
+    for (p = 0;  p < s->up;  p++)
+    {
+        sum = 0.0;
+        for (j = 0;  j < s->taps;  j++)
+            sum += h[p + (s->taps - 1 - j)*s->up];
+        /*endfor*/
+        for (j = 0;  j < s->taps;  j++)
+        {
+            x = h[p + (s->taps - 1 - j)*s->up]/sum;
+            s->coeffsf[p*s->taps + j] = (float) x;
+            s->coeffs[p*s->taps + j] = saturate16(lrint(x*32768.0));
+            if (s->coeffs[p*s->taps + j] == INT16_MIN)
+                s->coeffs[p*s->taps + j] = -INT16_MAX;
+            /*endif*/
+        }
+        /*endfor*/
+    }
+    /*endfor*/
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_DECLARE(int) resample_max_output(resample_state_t *s, int len)
+{
+    int units;
+
+    units = len*s->up - s->phase;
+    if (units <= 0)
+        return 0;
+    /*endif*/
+    return (units + s->down - 1)/s->down;
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_DECLARE(int) resample_delay(resample_state_t *s)
+{
+    if (s->up == s->down)
+        return 0;
+    /*endif*/
+    /* The filter's delay is half its length, at the interpolated rate. */
+    return (s->taps*s->up - 2 + s->down)/(2*s->down);
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_DECLARE(int) resample(resample_state_t *s, int16_t out[], const int16_t in[], int len)
+{
+    const int16_t *w;
+    int32_t acc;
+    int outs;
+    int i;
+
+    if (s->up == s->down)
+    {
+        memcpy(out, in, len*sizeof(int16_t));
+        return len;
+    }
+    /*endif*/
+    outs = 0;
+    for (i = 0;  i < len;  i++)
+    {
+        s->history[s->history_ptr] =
+        s->history[s->history_ptr + s->taps] = in[i];
+        if (++s->history_ptr >= s->taps)
+            s->history_ptr = 0;
+        /*endif*/
+        w = &s->history[s->history_ptr];
+        while (s->phase < s->up)
+        {
+            acc = vec_dot_prodi16(w, &s->coeffs[s->phase*s->taps], s->taps);
+            out[outs++] = saturate16((acc + 0x4000) >> 15);
+            s->phase += s->down;
+        }
+        /*endwhile*/
+        s->phase -= s->up;
+    }
+    /*endfor*/
+    return outs;
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_DECLARE(int) resamplef(resample_state_t *s, float out[], const float in[], int len)
+{
+    const float *w;
+    int outs;
+    int i;
+
+    if (s->up == s->down)
+    {
+        memcpy(out, in, len*sizeof(float));
+        return len;
+    }
+    /*endif*/
+    outs = 0;
+    for (i = 0;  i < len;  i++)
+    {
+        s->historyf[s->history_ptr] =
+        s->historyf[s->history_ptr + s->taps] = in[i];
+        if (++s->history_ptr >= s->taps)
+            s->history_ptr = 0;
+        /*endif*/
+        w = &s->historyf[s->history_ptr];
+        while (s->phase < s->up)
+        {
+            out[outs++] = vec_dot_prodf(w, &s->coeffsf[s->phase*s->taps], s->taps);
+            s->phase += s->down;
+        }
+        /*endwhile*/
+        s->phase -= s->up;
+    }
+    /*endfor*/
+    return outs;
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_DECLARE(int) resample_restart(resample_state_t *s)
+{
+    memset(s->history, 0, sizeof(s->history));
+    memset(s->historyf, 0, sizeof(s->historyf));
+    s->history_ptr = 0;
+    s->phase = 0;
+    return 0;
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_DECLARE(resample_state_t *) resample_init(resample_state_t *s, int in_rate, int out_rate, int quality)
+{
+    int common;
+    int up;
+    int down;
+
+    if (in_rate <= 0  ||  out_rate <= 0  ||  quality < RESAMPLE_LOW_LATENCY  ||  quality > RESAMPLE_HIGH_QUALITY)
+        return NULL;
+    /*endif*/
+    common = gcd(in_rate, out_rate);
+    up = out_rate/common;
+    down = in_rate/common;
+    if (up > RESAMPLE_MAX_FACTOR  ||  down > RESAMPLE_MAX_FACTOR)
+        return NULL;
+    /*endif*/
+    if (s == NULL)
+    {
+        if ((s = (resample_state_t *) span_alloc(sizeof(*s))) == NULL)
+            return NULL;
+        /*endif*/
+    }
+    /*endif*/
+    memset(s, 0, sizeof(*s));
+    s->in_rate = in_rate;
+    s->out_rate = out_rate;
+    s->up = up;
+    s->down = down;
+    if (up != down)
+    {
+        /* Keep the length of the filter constant in time at the lower rate, which is
+           where its transition band lies. */
+        s->taps = designs[quality].taps*((up > down)  ?  up  :  down)/up;
+        design_filter(s, &designs[quality]);
+    }
+    /*endif*/
+    return s;
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_DECLARE(int) resample_release(resample_state_t *s)
+{
+    return 0;
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_DECLARE(int) resample_free(resample_state_t *s)
+{
+    span_free(s);
+    return 0;
+}
+/*- End of function --------------------------------------------------------*/
+/*- End of file ------------------------------------------------------------*/
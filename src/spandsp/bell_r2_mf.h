@@ -205,6 +205,12 @@ SPAN_DECLARE(int) bell_mf_rx(bell_mf_rx_state_t *s, const int16_t amp[], int sam
     \return The number of digits actually returned. */
 SPAN_DECLARE(size_t) bell_mf_rx_get(bell_mf_rx_state_t *s, char *buf, int max);
 
+/*! \brief Get the power gate associated with a Bell MF receiver context. Blocks of audio
+           the gate finds to be quiet are not passed through the Goertzel filters.
+    \param s The Bell MF receiver context.
+    \return A pointer to the power gate context. */
+SPAN_DECLARE(power_gate_t *) bell_mf_rx_get_power_gate(bell_mf_rx_state_t *s);
+
 /*! \brief Initialise a Bell MF receiver context.
     \param s The Bell MF receiver context.
     \param callback An optional callback routine, used to report received digits. If
@@ -240,6 +246,12 @@ SPAN_DECLARE(int) r2_mf_rx(r2_mf_rx_state_t *s, const int16_t amp[], int samples
     \return The number digits being received. */
 SPAN_DECLARE(int) r2_mf_rx_get(r2_mf_rx_state_t *s);
 
+/*! \brief Get the power gate associated with an R2 MF receiver context. Blocks of audio
+           the gate finds to be quiet are not passed through the Goertzel filters.
+    \param s The R2 MF receiver context.
+    \return A pointer to the power gate context. */
+SPAN_DECLARE(power_gate_t *) r2_mf_rx_get_power_gate(r2_mf_rx_state_t *s);
+
 /*! \brief Initialise an R2 MF receiver context.
     \param s The R2 MF receiver context.
     \param fwd True if the context is for forward signals. False if the
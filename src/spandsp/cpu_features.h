@@ -0,0 +1,89 @@
+/*
+ * SpanDSP - a series of DSP components for telephony
+ *
+ * cpu_features.h - Run time identification of the CPU's SIMD capabilities.
+ *
+ * Written by Steve Underwood <steveu@coppice.org>
+ *
+ * Copyright (C) 2026 Steve Underwood
+ *
+ * All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License version 2.1,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+/*! \file */
+
+#if !defined(_SPANDSP_CPU_FEATURES_H_)
+#define _SPANDSP_CPU_FEATURES_H_
+
+/*! \page cpu_features_page CPU feature identification
+\section cpu_features_page_sec_1 What does it do?
+When spandsp is built with run time dispatch enabled (the default for x86 and x86_64
+builds with GCC or clang), the most time critical vector routines are compiled in several
+versions, each using a different level of the x86 SIMD instruction set. The CPU is probed
+when the library is loaded, and each call to one of these routines uses the best version
+the CPU supports. This allows a single binary package to run at full speed on any x86
+machine.
+
+\section cpu_features_page_sec_2 How does it work?
+The CPUID instruction is used to find which instruction set extensions the CPU supports,
+and XGETBV is used to check the operating system is saving the wider AVX and AVX-512
+registers across context switches. The set of features in use may be restricted by the
+application. This is mostly useful for testing and benchmarking the different code paths.
+*/
+
+enum
+{
+    SPAN_CPU_FEATURE_MMX = 0x0001,
+    SPAN_CPU_FEATURE_SSE = 0x0002,
+    SPAN_CPU_FEATURE_SSE2 = 0x0004,
+    SPAN_CPU_FEATURE_SSE3 = 0x0008,
+    SPAN_CPU_FEATURE_SSSE3 = 0x0010,
+    SPAN_CPU_FEATURE_SSE4_1 = 0x0020,
+    SPAN_CPU_FEATURE_SSE4_2 = 0x0040,
+    SPAN_CPU_FEATURE_AVX = 0x0080,
+    SPAN_CPU_FEATURE_FMA = 0x0100,
+    SPAN_CPU_FEATURE_AVX2 = 0x0200,
+    SPAN_CPU_FEATURE_AVX512F = 0x0400,
+    SPAN_CPU_FEATURE_AVX512BW = 0x0800
+};
+
+#if defined(__cplusplus)
+extern "C"
+{
+#endif
+
+/*! \brief Find the SIMD features of the CPU which spandsp knows how to use.
+    \return A mask of SPAN_CPU_FEATURE_xxx values. This will be zero if the
+            library was built without run time dispatch. */
+SPAN_DECLARE(uint32_t) span_cpu_features(void);
+
+/*! \brief Find the SIMD features currently being used to select code paths at run time.
+    \return A mask of SPAN_CPU_FEATURE_xxx values. */
+SPAN_DECLARE(uint32_t) span_cpu_features_in_use(void);
+
+/*! \brief Restrict the SIMD features used to select code paths at run time. Features the
+           CPU does not have can never be enabled by this. This should be called before
+           any processing starts, as it is not synchronised with other threads.
+    \param mask A mask of the SPAN_CPU_FEATURE_xxx values which may be used.
+    \return A mask of the SPAN_CPU_FEATURE_xxx values now in use. */
+SPAN_DECLARE(uint32_t) span_cpu_features_restrict(uint32_t mask);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif
+/*- End of file ------------------------------------------------------------*/
@@ -59,6 +59,13 @@ Basic DTMF specs:
     - Attenuation <= 26dB will detect OK
     - Frequency tolerance +- 1.5% will detect, +-3.5% will reject
 
+Systems handling many calls can use a bank of DTMF receivers. dtmf_rx_bank() takes
+a block of audio for every channel in the bank. The channels are interleaved, and the
+Goertzel filters for all the channels are updated together, with each channel in a
+separate lane of the SIMD registers. The end of block decisions are made by exactly
+the same code as dtmf_rx(), so a bank channel detects exactly what a separate
+receiver would. All the channels in a bank must be fed the same number of samples.
+
 TODO:
 */
 
@@ -87,6 +94,12 @@ typedef struct dtmf_tx_state_s dtmf_tx_state_t;
 */
 typedef struct dtmf_rx_state_s dtmf_rx_state_t;
 
+/*!
+    DTMF digit detector bank descriptor. This defines the working state for a set
+    of DTMF receivers, processed together.
+*/
+typedef struct dtmf_rx_bank_state_s dtmf_rx_bank_state_t;
+
 #if defined(__cplusplus)
 extern "C"
 {
@@ -205,6 +218,13 @@ SPAN_DECLARE(size_t) dtmf_rx_get(dtmf_rx_state_t *s, char *digits, int max);
     \return A pointer to the logging context */
 SPAN_DECLARE(logging_state_t *) dtmf_rx_get_logging_state(dtmf_rx_state_t *s);
 
+/*! \brief Get the power gate associated with a DTMF receiver context. Blocks of audio
+           the gate finds to be quiet are not passed through the Goertzel filters. The gate
+           is set to suit the detection threshold whenever that is changed by dtmf_rx_parms().
+    \param s The DTMF receiver context.
+    \return A pointer to the power gate context. */
+SPAN_DECLARE(power_gate_t *) dtmf_rx_get_power_gate(dtmf_rx_state_t *s);
+
 /*! \brief Initialise a DTMF receiver context.
     \param s The DTMF receiver context.
     \param callback An optional callback routine, used to report received digits. If
@@ -227,6 +247,48 @@ SPAN_DECLARE(int) dtmf_rx_release(dtmf_rx_state_t *s);
     \return 0 for OK, else -1. */
 SPAN_DECLARE(int) dtmf_rx_free(dtmf_rx_state_t *s);
 
+/*! \brief Initialise a bank of DTMF receivers.
+    \param channels The number of channels in the bank.
+    \param callback An optional callback routine, used to report received digits. If
+           no callback routine is set, digits may be collected, using the dtmf_rx_get()
+           function on the channel's context.
+    \param user_data An optional array of opaque pointers, one per channel, supplied
+           in callbacks for that channel.
+    \return A pointer to the DTMF receiver bank context, or NULL if the bank could not
+            be created. */
+SPAN_DECLARE(dtmf_rx_bank_state_t *) dtmf_rx_bank_init(int channels,
+                                                       digits_rx_callback_t callback,
+                                                       void *user_data[]);
+
+/*! \brief Release a bank of DTMF receivers.
+    \param s The DTMF receiver bank context.
+    \return 0 for OK, else -1. */
+SPAN_DECLARE(int) dtmf_rx_bank_release(dtmf_rx_bank_state_t *s);
+
+/*! \brief Free a bank of DTMF receivers.
+    \param s The DTMF receiver bank context.
+    \return 0 for OK, else -1. */
+SPAN_DECLARE(int) dtmf_rx_bank_free(dtmf_rx_bank_state_t *s);
+
+/*! \brief Get the context of one channel of a bank of DTMF receivers. This may be used
+           with dtmf_rx_get(), dtmf_rx_status(), dtmf_rx_parms(),
+           dtmf_rx_set_realtime_callback() and dtmf_rx_get_logging_state(). It must not
+           be passed to dtmf_rx() or dtmf_rx_fillin().
+    \param s The DTMF receiver bank context.
+    \param channel The channel number.
+    \return A pointer to the DTMF receiver context, or NULL for a bad channel number. */
+SPAN_DECLARE(dtmf_rx_state_t *) dtmf_rx_bank_get_channel(dtmf_rx_bank_state_t *s, int channel);
+
+/*! Process a block of received DTMF audio samples for every channel of a bank of
+    DTMF receivers. Each channel makes exactly the same decisions as dtmf_rx() would
+    for the same audio.
+    \brief Process a block of received DTMF audio samples for a bank of receivers.
+    \param s The DTMF receiver bank context.
+    \param amp An array of pointers to the audio sample buffer for each channel.
+    \param samples The number of samples in each buffer.
+    \return The number of samples unprocessed. */
+SPAN_DECLARE(int) dtmf_rx_bank(dtmf_rx_bank_state_t *s, const int16_t *amp[], int samples);
+
 #if defined(__cplusplus)
 }
 #endif
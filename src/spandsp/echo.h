@@ -110,6 +110,49 @@ The echo cancellor processes both the transmit and receive streams sample by
 sample. The processing function is not declared inline. Unfortunately,
 cancellation requires many operations per sample, so the call overhead is only a
 minor burden.
+
+Where the audio is handled in frames, such as the 10ms or 20ms frames of most VoIP
+and TDM systems, echo_can_update_block() may be used to process a whole frame in one
+call. This gives exactly the same output as calling echo_can_update() for each sample
+in turn, but the per sample bookkeeping is done in tighter loops, which is faster.
+The two functions may be freely mixed on the same canceller context.
+
+The cost of the normal time domain canceller grows in proportion to its length. For
+long tails (e.g. 128ms, or 1024 taps) the ECHO_CAN_USE_FREQ_DOMAIN adaption mode may
+be used. This uses a partitioned block frequency domain adaptive filter, with blocks
+of 64 samples. The first 64 taps are applied in the time domain, so the canceller
+adds no delay. The rest are applied, and all the taps adapted, once per block using
+FFTs. The NLP, CNG and double talk detection work as they do in the time domain mode,
+but the narrowband signal protection does not apply.
+
+Real hybrid echo paths usually occupy only a small part of a long tail. The
+ECHO_CAN_USE_PNLMS adaption mode gives each tap a step size which is partly in
+proportion to its magnitude (IPNLMS), which makes a sparse echo path converge much
+faster. The ECHO_CAN_USE_TAIL_WINDOW mode periodically looks for the active region of
+the taps, once the canceller has converged, and then restricts the filtering and
+adaption to that region. If the echo path changes, and the canceller is no longer
+converged, the whole length is used again until the new echo has been found. These
+modes apply to the time domain canceller, and may be used together. PNLMS costs about
+the same per sample as the normal adaption. It speeds up convergence, not processing.
+The tail window cuts the per sample cost in proportion to the active region's share
+of the full length, but only after the canceller has converged and found that region.
+
+echo_can_get_stats() gives the running ERL and ERLE, and counts of the double
+talk detections, NLP activity, and the reasons adaption was skipped. These are
+published after every 20ms or so of processing, and may be read from another
+thread without any locking.
+
+Gateways often run hundreds of cancellers. An echo canceller bank holds a number of
+cancellers in a single aligned block of memory. Each channel still has its own taps
+and history, but the arrays of each kind (taps, histories, etc.) for all the channels
+are placed one after another, each starting on a cache line boundary.
+echo_can_bank_update_block() processes a frame for every channel in one call. Only
+the signal power meters are run across all the channels at once, on signals
+interleaved by channel, which suits SIMD processing. The filtering and adaption are
+done one channel at a time, just as echo_can_update_block() does them. Each canceller
+in the bank behaves exactly like a separate canceller created by echo_can_init(),
+and echo_can_bank_get_channel() gives access to it for the other echo_can_xxx()
+functions.
 */
 
 #include "fir.h"
@@ -124,7 +167,13 @@ enum
     ECHO_CAN_USE_SUPPRESSOR = 0x10,
     ECHO_CAN_USE_TX_HPF = 0x20,
     ECHO_CAN_USE_RX_HPF = 0x40,
-    ECHO_CAN_DISABLE = 0x80
+    ECHO_CAN_DISABLE = 0x80,
+    /*! Use a partitioned block frequency domain filter, for long tails */
+    ECHO_CAN_USE_FREQ_DOMAIN = 0x100,
+    /*! Use proportionate (IPNLMS) step sizes for the adaption */
+    ECHO_CAN_USE_PNLMS = 0x200,
+    /*! Restrict the filter to the active region of the echo tail, once converged */
+    ECHO_CAN_USE_TAIL_WINDOW = 0x400
 };
 
 /*!
@@ -133,6 +182,48 @@ enum
 */
 typedef struct echo_can_state_s echo_can_state_t;
 
+/*!
+    Echo canceller bank descriptor. This defines the working state for a set of
+    line echo cancellers which are processed together.
+*/
+typedef struct echo_can_bank_state_s echo_can_bank_state_t;
+
+/*!
+    Echo canceller statistics.
+*/
+typedef struct
+{
+    /*! \brief The number of samples processed. */
+    uint32_t samples;
+    /*! \brief The long term power of the transmitted signal, in dBm0. */
+    float tx_power;
+    /*! \brief The long term power of the received signal, in dBm0. */
+    float rx_power;
+    /*! \brief The long term power of the echo cancelled received signal, in dBm0. */
+    float clean_rx_power;
+    /*! \brief The echo return loss (transmitted power to received power), in dB. */
+    float erl;
+    /*! \brief The echo return loss enhancement (received power to cleaned power), in dB. */
+    float erle;
+    /*! \brief The number of times double talk has been detected. */
+    uint32_t dtd_hits;
+    /*! \brief The number of samples replaced by the non-linear processor. */
+    uint32_t nlp_samples;
+    /*! \brief The number of samples for which the canceller adapted. */
+    uint32_t adapted_samples;
+    /*! \brief The number of samples not adapted, as there was too little transmitted signal. */
+    uint32_t skipped_low_tx;
+    /*! \brief The number of samples not adapted, due to double talk. */
+    uint32_t skipped_double_talk;
+    /*! \brief The number of samples not adapted, during the dwell time after double talk. */
+    uint32_t skipped_dwell;
+    /*! \brief The number of samples not adapted, due to narrowband signals. */
+    uint32_t skipped_narrowband;
+    /*! \brief The number of times the taps have been cleared, because the canceller was
+               making things worse. */
+    uint32_t resets;
+} echo_can_stats_t;
+
 #if defined(__cplusplus)
 extern "C"
 {
@@ -175,6 +266,69 @@ SPAN_DECLARE(void) echo_can_adaption_mode(echo_can_state_t *ec, int adaption_mod
 */
 SPAN_DECLARE(int16_t) echo_can_update(echo_can_state_t *ec, int16_t tx, int16_t rx);
 
+/*! Process a block of samples through a voice echo canceller. The result is
+    identical to calling echo_can_update() for each sample in turn.
+    \param ec The echo canceller context.
+    \param tx The transmitted audio samples.
+    \param rx The received audio samples.
+    \param clean_rx The clean (echo cancelled) received samples.
+    \param len The number of samples to process.
+    \return The number of samples processed.
+*/
+SPAN_DECLARE(int) echo_can_update_block(echo_can_state_t *ec, const int16_t tx[], const int16_t rx[], int16_t clean_rx[], int len);
+
+/*! Create a bank of voice echo cancellers.
+    \param channels The number of channels in the bank.
+    \param len The length of each canceller, in samples.
+    \param adaption_mode The initial adaption mode for all the channels.
+    \return The new bank context, or NULL if the bank could not be created.
+*/
+SPAN_DECLARE(echo_can_bank_state_t *) echo_can_bank_init(int channels, int len, int adaption_mode);
+
+/*! Release a bank of voice echo cancellers.
+    \param s The echo canceller bank context.
+    \return 0 for OK, else -1.
+*/
+SPAN_DECLARE(int) echo_can_bank_release(echo_can_bank_state_t *s);
+
+/*! Free a bank of voice echo cancellers.
+    \param s The echo canceller bank context.
+    \return 0 for OK, else -1.
+*/
+SPAN_DECLARE(int) echo_can_bank_free(echo_can_bank_state_t *s);
+
+/*! Get the context of one channel of a bank of voice echo cancellers. This may be
+    used with any of the echo_can_xxx() functions, except echo_can_release() and
+    echo_can_free().
+    \param s The echo canceller bank context.
+    \param channel The channel number, from 0.
+    \return The echo canceller context, or NULL if the channel number is invalid.
+*/
+SPAN_DECLARE(echo_can_state_t *) echo_can_bank_get_channel(echo_can_bank_state_t *s, int channel);
+
+/*! Process a block of samples for every channel of a bank of voice echo cancellers.
+    \param s The echo canceller bank context.
+    \param tx The transmitted audio samples, an array of one buffer per channel.
+    \param rx The received audio samples, an array of one buffer per channel.
+    \param clean_rx The clean (echo cancelled) received samples, an array of one buffer
+           per channel.
+    \param len The number of samples to process for each channel.
+    \return The number of samples processed.
+*/
+SPAN_DECLARE(int) echo_can_bank_update_block(echo_can_bank_state_t *s,
+                                             const int16_t *tx[],
+                                             const int16_t *rx[],
+                                             int16_t *clean_rx[],
+                                             int len);
+
+/*! Get the statistics for a voice echo canceller. This may be called from a
+    different thread to the one doing the processing.
+    \param ec The echo canceller context.
+    \param t A pointer to the buffer for the statistics.
+    \return 0 for OK, else -1.
+*/
+SPAN_DECLARE(int) echo_can_get_stats(echo_can_state_t *ec, echo_can_stats_t *t);
+
 /*! Process to high pass filter the tx signal.
     \param ec The echo canceller context.
     \param tx The transmitted auio sample.
@@ -37,6 +37,7 @@
 #include <spandsp/private/schedule.h>
 #include <spandsp/private/bitstream.h>
 #include <spandsp/private/queue.h>
+#include <spandsp/private/resample.h>
 #include <spandsp/private/awgn.h>
 #include <spandsp/private/noise.h>
 #include <spandsp/private/bert.h>
@@ -54,6 +55,7 @@
 #include <spandsp/private/playout.h>
 #include <spandsp/private/oki_adpcm.h>
 #include <spandsp/private/ima_adpcm.h>
+#include <spandsp/private/transcoder.h>
 #include <spandsp/private/hdlc.h>
 #include <spandsp/private/time_scale.h>
 #include <spandsp/private/super_tone_tx.h>
@@ -65,6 +67,7 @@
 #include <spandsp/private/async.h>
 #include <spandsp/private/fsk.h>
 #include <spandsp/private/modem_connect_tones.h>
+#include <spandsp/private/tone_analyser.h>
 #include <spandsp/private/v8.h>
 #include <spandsp/private/v80.h>
 #include <spandsp/private/v17rx.h>
@@ -37,6 +37,8 @@
 #if defined(USE_MMX)  ||  defined(USE_SSE2)
 #include "mmx.h"
 #endif
+/* The portable fir16() path uses vec_circular_dot_prodi16() */
+#include "vector_int.h"
 
 /*!
     16 bit integer FIR descriptor. This defines the working state for a single
@@ -116,9 +118,9 @@ static __inline__ void fir16_free(fir16_state_t *fir)
 
 static __inline__ int16_t fir16(fir16_state_t *fir, int16_t sample)
 {
-    int i;
     int32_t y;
 #if defined(USE_MMX)
+    int i;
     mmx_t *mmx_coeffs;
     mmx_t *mmx_hist;
 
@@ -150,6 +152,7 @@ static __inline__ int16_t fir16(fir16_state_t *fir, int16_t sample)
     movd_r2m(mm4, y);
     emms();
 #elif defined(USE_SSE2)
+    int i;
     xmm_t *xmm_coeffs;
     xmm_t *xmm_hist;
 
@@ -183,18 +186,10 @@ static __inline__ int16_t fir16(fir16_state_t *fir, int16_t sample)
     paddd_r2r(xmm0, xmm4);
     movd_r2m(xmm4, y);
 #else
-    int offset1;
-    int offset2;
-
     fir->history[fir->curr_pos] = sample;
-
-    offset2 = fir->curr_pos;
-    offset1 = fir->taps - offset2;
-    y = 0;
-    for (i = fir->taps - 1;  i >= offset1;  i--)
-        y += fir->coeffs[i]*fir->history[i - offset1];
-    for (  ;  i >= 0;  i--)
-        y += fir->coeffs[i]*fir->history[i + offset2];
+    /* The history is a circular buffer, starting at the newest sample. The SIMD
+       versions of the dot product are selected at run time, where available. */
+    y = vec_circular_dot_prodi16(fir->history, fir->coeffs, fir->taps, fir->curr_pos);
 #endif
     if (fir->curr_pos <= 0)
         fir->curr_pos = fir->taps;
@@ -45,6 +45,12 @@ favourite processor.
 Look up tables are used for transcoding between A-law and u-law, since it is
 difficult to achieve the precise transcoding procedure laid down in the G.711
 specification by other means.
+
+The block routines, g711_encode(), g711_decode() and g711_transcode(), are where
+most bulk conversion work is done. When the library is built with run time dispatch,
+they use AVX2 code on CPUs which support it. This finds the segments with parallel
+comparisons, rather than bit searching, and gathers the transcoding table entries 8 at
+a time. The results are exactly the same as those of the single sample routines.
 */
 
 #if !defined(_SPANDSP_G711_H_)
@@ -39,6 +39,11 @@ It supports:
 
 It passes the ITU tests.
 
+Many channels may be encoded or decoded in one call, with g726_encode_batch() and
+g726_decode_batch(). Where the CPU has AVX2, groups of 8 channels using the same bit rate
+are processed side by side, which is several times faster than processing them one at a
+time. The results are exactly the same either way.
+
 \section g726_page_sec_2 How does it work?
 ???.
 */
@@ -112,6 +117,39 @@ SPAN_DECLARE(int) g726_encode(g726_state_t *s,
                               const int16_t amp[],
                               int len);
 
+/*! Decode a buffer of G.726 ADPCM data to linear PCM, a-law or u-law, for each of a
+    number of channels. This is fastest when the channels are arranged in groups of 8
+    using the same bit rate.
+    \param s The G.726 contexts, one for each channel.
+    \param amp The audio sample buffers, one for each channel.
+    \param samples The number of samples returned for each channel.
+    \param g726_data The G.726 data, for each channel.
+    \param g726_bytes The number of bytes of G.726 data for each channel.
+    \param channels The number of channels.
+    \return The total number of samples returned. */
+SPAN_DECLARE(int) g726_decode_batch(g726_state_t *s[],
+                                    int16_t *amp[],
+                                    int samples[],
+                                    const uint8_t *g726_data[],
+                                    int g726_bytes,
+                                    int channels);
+
+/*! Encode a buffer of linear PCM data to G.726 ADPCM, for each of a number of channels.
+    This is fastest when the channels are arranged in groups of 8 using the same bit rate.
+    \param s The G.726 contexts, one for each channel.
+    \param g726_data The buffers for the G.726 data produced, one for each channel.
+    \param g726_bytes The number of bytes of G.726 data produced for each channel.
+    \param amp The audio sample buffers, one for each channel.
+    \param len The number of samples in each buffer.
+    \param channels The number of channels.
+    \return The total number of bytes of G.726 data produced. */
+SPAN_DECLARE(int) g726_encode_batch(g726_state_t *s[],
+                                    uint8_t *g726_data[],
+                                    int g726_bytes[],
+                                    const int16_t *amp[],
+                                    int len,
+                                    int channels);
+
 #if defined(__cplusplus)
 }
 #endif
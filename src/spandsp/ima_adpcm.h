@@ -37,7 +37,14 @@
 IMA ADPCM offers a good balance of simplicity and quality at a rate of
 32kbps.
 
+Many channels may be decoded in one call, with ima_adpcm_decode_batch(). Groups of 4
+IMA4 or DVI4 channels are decoded side by side, which is faster than decoding them one
+at a time, as the work on one channel can proceed while another waits for a table lookup.
+The results are exactly the same either way.
+
 \section ima_adpcm_page_sec_2 How does it work?
+The decoder is table driven. Tables give the change in the signal, and the next step
+size, for each step size and code, and the step size after each whole byte of two codes.
 
 \section ima_adpcm_page_sec_3 How do I use it?
 */
@@ -107,6 +114,23 @@ SPAN_DECLARE(int) ima_adpcm_decode(ima_adpcm_state_t *s,
                                    const uint8_t ima_data[],
                                    int ima_bytes);
 
+/*! Decode a buffer of IMA ADPCM data to linear PCM, for each of a number of channels.
+    This is fastest when the channels are arranged in groups of 4 using the same IMA4 or
+    DVI4 variant.
+    \param s The IMA ADPCM contexts, one for each channel.
+    \param amp The audio sample buffers, one for each channel.
+    \param samples The number of samples returned for each channel.
+    \param ima_data The IMA ADPCM data, for each channel.
+    \param ima_bytes The number of bytes of IMA ADPCM data for each channel.
+    \param channels The number of channels.
+    \return The total number of samples returned. */
+SPAN_DECLARE(int) ima_adpcm_decode_batch(ima_adpcm_state_t *s[],
+                                         int16_t *amp[],
+                                         int samples[],
+                                         const uint8_t *ima_data[],
+                                         int ima_bytes,
+                                         int channels);
+
 #if defined(__cplusplus)
 }
 #endif
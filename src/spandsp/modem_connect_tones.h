@@ -163,6 +163,15 @@ SPAN_DECLARE(int) modem_connect_tones_rx_fillin(modem_connect_tones_rx_state_t *
 */
 SPAN_DECLARE(int) modem_connect_tones_rx_get(modem_connect_tones_rx_state_t *s);
 
+/*! \brief Get the power gate associated with a modem connect tone receiver context. The
+           receiver's filters are skipped for calls with quiet audio. Skipping them is not
+           exact, as the filters are restarted from rest after a quiet chunk. Setting the
+           gate's level to -99 disables it.
+    \param s The context.
+    \return A pointer to the power gate context.
+*/
+SPAN_DECLARE(power_gate_t *) modem_connect_tones_rx_get_power_gate(modem_connect_tones_rx_state_t *s);
+
 /*! \brief Initialise an instance of the modem connect tones detector.
     \param s The context.
     \param tone_type The type of connect tone being tested for.
@@ -40,7 +40,13 @@ compression algorithm on the slower samples.
 
 The algorithms for this ADPCM codec can be found in "PC Telephony - The complete guide
 to designing, building and programming systems using Dialogic and Related Hardware"
-by Bob Edgar. pg 272-276. */
+by Bob Edgar. pg 272-276.
+
+The decoder is table driven. Tables give the change in the signal, and the next step
+size, for each step size and code, and the step size after each whole byte of two codes.
+Many channels may be decoded in one call, with oki_adpcm_decode_batch(). Groups of 4
+32kbps channels are decoded side by side. The results are exactly the same as decoding
+the channels one at a time. */
 
 /*!
     Oki (Dialogic) ADPCM conversion state descriptor. This defines the state of
@@ -83,6 +89,22 @@ SPAN_DECLARE(int) oki_adpcm_decode(oki_adpcm_state_t *s,
                                    const uint8_t oki_data[],
                                    int oki_bytes);
 
+/*! Decode a buffer of Oki ADPCM data to linear PCM, for each of a number of channels.
+    This is fastest when the channels are arranged in groups of 4 at 32kbps.
+    \param s The Oki ADPCM contexts, one for each channel.
+    \param amp The audio sample buffers, one for each channel.
+    \param samples The number of samples returned for each channel.
+    \param oki_data The Oki ADPCM data, for each channel.
+    \param oki_bytes The number of bytes of Oki ADPCM data for each channel.
+    \param channels The number of channels.
+    \return The total number of samples returned. */
+SPAN_DECLARE(int) oki_adpcm_decode_batch(oki_adpcm_state_t *s[],
+                                         int16_t *amp[],
+                                         int samples[],
+                                         const uint8_t *oki_data[],
+                                         int oki_bytes,
+                                         int channels);
+
 /*! Encode a buffer of linear PCM data to Oki ADPCM.
     \param s The Oki ADPCM context.
     \param oki_data The Oki ADPCM data produced
@@ -39,14 +39,38 @@ peak square wave, etc.? This code is based on the well defined wording in RFC338
 values +/-8031, and this square wave represents 0dBov.  This translates into 6.18dBm0".
 
 \section power_meter_page_sec_2 How does it work?
+
+\section power_meter_page_sec_3 Power gates
+Most of the audio seen by tone detectors on a typical call is silence, or speech pauses
+well below the level of any tone of interest. A power gate is a cheap block energy
+pre-screen. The energy of each block is accumulated as the samples arrive. At the end of
+the block the gate says if the block's mean power was below a set level, and the detector
+may then skip its filtering for the block. The gate counts the blocks tested, and the
+blocks found to be quiet.
+
+A block whose mean power is more than 3dB below that of a sine wave at some level cannot
+produce a Goertzel result as large as that sine wave would. Goertzel based detectors set
+their gate POWER_GATE_GOERTZEL_MARGIN below their detection threshold, which leaves some
+headroom for any filtering ahead of the Goertzels. Skipping their Goertzels for quiet
+blocks then makes no difference to what they detect.
 */
 
+/*! The distance below a Goertzel detection threshold, in dB, at which a power gate
+    may safely be set. */
+#define POWER_GATE_GOERTZEL_MARGIN      9.0f
+
 /*!
     Power meter descriptor. This defines the working state for a
     single instance of a power measurement device.
 */
 typedef struct power_meter_s power_meter_t;
 
+/*!
+    Power gate descriptor. This defines the working state for a single
+    instance of a block energy pre-screen.
+*/
+typedef struct power_gate_s power_gate_t;
+
 typedef struct power_surge_detector_state_s power_surge_detector_state_t;
 
 #if defined(__cplusplus)
@@ -109,6 +133,65 @@ SPAN_DECLARE(int32_t) power_meter_level_dbm0(float level);
     \return The equivalent power meter reading. */
 SPAN_DECLARE(int32_t) power_meter_level_dbov(float level);
 
+/*! Initialise a power gate context.
+    \brief Initialise a power gate context.
+    \param s The power gate context.
+    \param level The mean power, in dBm0, below which a block is considered quiet.
+           A level <= -99.0 disables the gate, so no block is considered quiet.
+    \return The power gate context. */
+SPAN_DECLARE(power_gate_t *) power_gate_init(power_gate_t *s, float level);
+
+SPAN_DECLARE(int) power_gate_release(power_gate_t *s);
+
+SPAN_DECLARE(int) power_gate_free(power_gate_t *s);
+
+/*! Change the level of a power gate.
+    \brief Change the level of a power gate.
+    \param s The power gate context.
+    \param level The mean power, in dBm0, below which a block is considered quiet.
+           A level <= -99.0 disables the gate. */
+SPAN_DECLARE(void) power_gate_set_level(power_gate_t *s, float level);
+
+/*! Add some samples to the block a power gate is measuring.
+    \brief Add some samples to the block a power gate is measuring.
+    \param s The power gate context.
+    \param amp The audio samples.
+    \param len The number of samples. */
+SPAN_DECLARE(void) power_gate_update(power_gate_t *s, const int16_t amp[], int len);
+
+/*! Finish the block a power gate is measuring, and start a new one.
+    \brief Finish the block a power gate is measuring.
+    \param s The power gate context.
+    \param len The total number of samples in the block.
+    \return True if the block was quiet. */
+SPAN_DECLARE(bool) power_gate_block_end(power_gate_t *s, int len);
+
+/*! Measure a complete block of samples with a power gate.
+    \brief Measure a complete block of samples with a power gate.
+    \param s The power gate context.
+    \param amp The audio samples.
+    \param len The number of samples.
+    \return True if the block was quiet. */
+SPAN_DECLARE(bool) power_gate_block(power_gate_t *s, const int16_t amp[], int len);
+
+/*! Abandon the block a power gate is measuring, without counting it.
+    \brief Abandon the block a power gate is measuring.
+    \param s The power gate context. */
+SPAN_DECLARE(void) power_gate_restart(power_gate_t *s);
+
+/*! Get the number of blocks a power gate has tested.
+    \brief Get the number of blocks a power gate has tested.
+    \param s The power gate context.
+    \return The number of blocks. */
+SPAN_DECLARE(int) power_gate_blocks(power_gate_t *s);
+
+/*! Get the number of blocks a power gate has found to be quiet. These are the blocks
+    for which the detector using the gate skipped its filtering.
+    \brief Get the number of blocks a power gate has found to be quiet.
+    \param s The power gate context.
+    \return The number of blocks. */
+SPAN_DECLARE(int) power_gate_skipped_blocks(power_gate_t *s);
+
 SPAN_DECLARE(int32_t) power_surge_detector(power_surge_detector_state_t *s, int16_t amp);
 
 /*! Get the current surge detector short term meter reading, in dBm0.
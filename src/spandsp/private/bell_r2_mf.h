@@ -26,6 +26,10 @@
 #if !defined(_SPANDSP_PRIVATE_BELL_R2_MF_H_)
 #define _SPANDSP_PRIVATE_BELL_R2_MF_H_
 
+#define BELL_MF_SAMPLES_PER_BLOCK   120
+
+#define R2_MF_SAMPLES_PER_BLOCK     133
+
 /*!
     Bell MF generator state descriptor. This defines the state of a single
     working instance of a Bell MF generator.
@@ -53,6 +57,11 @@ struct bell_mf_rx_state_s
     void *digits_callback_data;
     /*! Tone detector working states */
     goertzel_state_t out[6];
+    /*! The current block of samples. The Goertzels are only run when the block is
+        complete, and not quiet. */
+    int16_t block[BELL_MF_SAMPLES_PER_BLOCK];
+    /*! The block energy pre-screen. */
+    power_gate_t gate;
     /*! Short term history of results from the tone detection, using in persistence checking */
     uint8_t hits[5];
     /*! The current sample number within a processing block. */
@@ -92,6 +101,11 @@ struct r2_mf_rx_state_s
     bool fwd;
     /*! Tone detector working states */
     goertzel_state_t out[6];
+    /*! The current block of samples. The Goertzels are only run when the block is
+        complete, and not quiet. */
+    int16_t block[R2_MF_SAMPLES_PER_BLOCK];
+    /*! The block energy pre-screen. */
+    power_gate_t gate;
     /*! The current sample number within a processing block. */
     int current_sample;
     /*! The currently detected digit. */
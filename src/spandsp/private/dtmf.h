@@ -26,6 +26,8 @@
 #if !defined(_SPANDSP_PRIVATE_DTMF_H_)
 #define _SPANDSP_PRIVATE_DTMF_H_
 
+#define DTMF_SAMPLES_PER_BLOCK                  102
+
 /*!
     DTMF generator state descriptor. This defines the state of a single
     working instance of a DTMF generator.
@@ -90,6 +92,15 @@ struct dtmf_rx_state_s
     /*! The accumlating total energy on the same period over which the Goertzels work. */
     float energy;
 #endif
+    /*! The current block of samples, after any dialtone filtering and scaling. The
+        Goertzels are only run when the block is complete, and not quiet. */
+#if defined(SPANDSP_USE_FIXED_POINT)
+    int16_t block[DTMF_SAMPLES_PER_BLOCK];
+#else
+    float block[DTMF_SAMPLES_PER_BLOCK];
+#endif
+    /*! The block energy pre-screen. */
+    power_gate_t gate;
     /*! Tone detector working states for the row tones. */
     goertzel_state_t row_out[4];
     /*! Tone detector working states for the column tones. */
@@ -115,5 +126,48 @@ struct dtmf_rx_state_s
     logging_state_t logging;
 };
 
+/*!
+    DTMF digit detector bank descriptor. The Goertzel states of all the channels are
+    held together, one array per Goertzel, so the channels can be processed in the
+    lanes of SIMD registers. The decision making state of each channel is held in
+    an ordinary DTMF receiver context.
+*/
+struct dtmf_rx_bank_state_s
+{
+    /*! The number of channels in the bank. */
+    int channels;
+    /*! The number of channels, rounded up to a whole number of SIMD registers. */
+    int lanes;
+    /*! The current sample number within a processing block. This is common to all the channels. */
+    int current_sample;
+    /*! The receiver context for each channel. */
+    dtmf_rx_state_t *chan;
+#if defined(SPANDSP_USE_FIXED_POINT)
+    /*! The Goertzel coefficients, in the order row, column, row, column... */
+    int16_t fac[8];
+    /*! The Goertzel v2 states, as 8 arrays of lanes entries. */
+    int16_t *v2;
+    /*! The Goertzel v3 states, as 8 arrays of lanes entries. */
+    int16_t *v3;
+    /*! The accumlating total energy for each channel. */
+    int32_t *energy;
+    /*! The channels' samples for the current block, interleaved. */
+    int16_t *amp;
+#else
+    /*! The Goertzel coefficients, in the order row, column, row, column... */
+    float fac[8];
+    /*! The Goertzel v2 states, as 8 arrays of lanes entries. */
+    float *v2;
+    /*! The Goertzel v3 states, as 8 arrays of lanes entries. */
+    float *v3;
+    /*! The accumlating total energy for each channel. */
+    float *energy;
+    /*! The channels' samples for the current block, interleaved. */
+    float *amp;
+#endif
+    /*! The aligned memory block holding all the arrays. */
+    void *arena;
+};
+
 #endif
 /*- End of file ------------------------------------------------------------*/
@@ -30,6 +30,46 @@
 #if !defined(_SPANDSP_PRIVATE_ECHO_H_)
 #define _SPANDSP_PRIVATE_ECHO_H_
 
+/*!
+    Partitioned block frequency domain adaptive filter descriptor. This is the
+    working state for the filter used by an echo canceller in ECHO_CAN_USE_FREQ_DOMAIN
+    mode.
+*/
+typedef struct
+{
+    /*! The number of partitions of the filter */
+    int partitions;
+    /*! The position in the current block */
+    int pos;
+    /*! The index of the newest transmitted signal spectrum in x_spec */
+    int newest;
+    /*! The next partition to have its gradient constrained */
+    int constrain;
+    /*! True if double talk was detected during the current block */
+    int dtd;
+    /*! True if there was enough transmitted signal to adapt during the current block */
+    int active;
+    /*! The previous and current blocks of the transmitted signal */
+    float *x;
+    /*! The taps of the first partition, in reverse order, applied in the time domain */
+    float *head;
+    /*! The echo estimate from the other partitions, for the current block */
+    float *tail;
+    /*! The errors for the current block */
+    float *e;
+    /*! The smoothed power of the transmitted signal in each bin */
+    float *x_power;
+    /*! The spectra of the most recent blocks of the transmitted signal */
+    complexf_t *x_spec;
+    /*! The filter, as one spectrum per partition */
+    complexf_t *w;
+    /*! Work buffers */
+    complexf_t *work;
+    complexf_t *work2;
+    /*! The FFT twiddle factors */
+    complexf_t *twiddle;
+} echo_can_fd_state_t;
+
 /*!
     G.168 echo canceller descriptor. This defines the working state for a line
     echo canceller.
@@ -63,8 +103,10 @@ struct echo_can_state_s
     int tap_rotate_counter;
 
     int32_t latest_correction;  /* Indication of the magnitude of the latest
-                                   adaption, or a code to indicate why adaption
-                                   was skipped, for test purposes */
+                                   adaption, for test purposes */
+    int last_adaption_skip_reason;  /* A code to indicate why the latest adaption
+                                       was skipped, or zero if it was not, for
+                                       test purposes */
     int32_t last_acf[28];
     int narrowband_count;
     int narrowband_score;
@@ -86,6 +128,62 @@ struct echo_can_state_s
 
     /* Snapshot sample of coeffs used for development */
     int16_t *snapshot;
+
+    /*! The first tap of the active region of the echo tail */
+    int window_start;
+    /*! The length of the active region of the echo tail */
+    int window_len;
+    /*! Samples since the active region was last located */
+    int tail_locate_count;
+    /*! The proportionate step size for each tap, in Q12, created when ECHO_CAN_USE_PNLMS
+        mode is first used */
+    int32_t *pnlms_gains;
+    /*! Adaptions until the proportionate step sizes are next updated */
+    int pnlms_countdown;
+
+    /*! The statistics, as they are updated. The powers are held as mean squares. */
+    echo_can_stats_t stats;
+    /*! The latest published copy of the statistics */
+    echo_can_stats_t published_stats;
+    /*! A sequence count for the published statistics, which is odd while they are changing */
+    volatile uint32_t stats_seq;
+    /*! The transmitted signal energy since the statistics were last published */
+    int64_t stats_tx_energy;
+    /*! The received signal energy since the statistics were last published */
+    int64_t stats_rx_energy;
+    /*! The echo cancelled signal energy since the statistics were last published */
+    int64_t stats_clean_rx_energy;
+    /*! The number of samples since the statistics were last published */
+    int stats_len;
+
+    /*! The frequency domain filter, created when ECHO_CAN_USE_FREQ_DOMAIN mode is first used */
+    echo_can_fd_state_t *fd;
+};
+
+/*!
+    Echo canceller bank descriptor. This defines the working state for a set of
+    line echo cancellers, sharing a single block of memory.
+*/
+struct echo_can_bank_state_s
+{
+    /*! The number of channels in the bank */
+    int channels;
+    /*! The length of each canceller, in samples */
+    int taps;
+    /*! The cancellers */
+    echo_can_state_t *chan;
+
+    /*! The power meter states, held channel by channel for each meter */
+    int *power_state;
+    /*! The working chunk of the transmitted signals, interleaved by channel */
+    int16_t *tx_block;
+    /*! The working chunk of the received signals, interleaved by channel */
+    int16_t *rx_block;
+    /*! The power meter readings for the working chunk, interleaved by channel */
+    int *power;
+
+    /*! The memory holding the cancellers, their taps and histories, and the work buffers */
+    uint8_t *arena;
 };
 
 #endif
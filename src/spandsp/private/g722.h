@@ -57,9 +57,10 @@ struct g722_encode_state_s
     /*! 6 for 48000kbps, 7 for 56000kbps, or 8 for 64000kbps. */
     int bits_per_sample;
 
-    /*! Signal history for the QMF */
-    int16_t x[12];
-    int16_t y[12];
+    /*! Signal history for the QMF. This is stored twice over, so the 12 samples
+        in the window of each filter are always contiguous. */
+    int16_t x[2*12];
+    int16_t y[2*12];
     int ptr;
 
     g722_band_t band[2];
@@ -83,9 +84,10 @@ struct g722_decode_state_s
     /*! 6 for 48000kbps, 7 for 56000kbps, or 8 for 64000kbps. */
     int bits_per_sample;
 
-    /*! Signal history for the QMF */
-    int16_t x[12];
-    int16_t y[12];
+    /*! Signal history for the QMF. This is stored twice over, so the 12 samples
+        in the window of each filter are always contiguous. */
+    int16_t x[2*12];
+    int16_t y[2*12];
     int ptr;
 
     g722_band_t band[2];
@@ -76,6 +76,8 @@ struct modem_connect_tones_rx_state_s
     int32_t channel_level;
     /*! \brief The 15Hz AM power estimate */
     int32_t am_level;
+    /*! \brief The block energy pre-screen, used to skip the filters when the channel is quiet. */
+    power_gate_t gate;
     /*! \brief Sample counter for the small chunks of samples, after which a test is conducted. */
     int chunk_remainder;
     /*! \brief The code for the tone currently confirmed present in the audio. */
@@ -39,6 +39,23 @@ struct power_meter_s
     int32_t reading;
 };
 
+/*!
+    Power gate descriptor. This defines the working state for a single
+    instance of a block energy pre-screen.
+*/
+struct power_gate_s
+{
+    /*! The mean power per sample, in the units of power_meter_level_dbm0(), below
+        which a block is considered quiet. Zero disables the gate. */
+    int32_t threshold;
+    /*! The energy accumulated so far in the current block. */
+    int64_t energy;
+    /*! The number of blocks tested. */
+    int blocks;
+    /*! The number of blocks found to be quiet. */
+    int skipped;
+};
+
 struct power_surge_detector_state_s
 {
     power_meter_t short_term;
@@ -0,0 +1,73 @@
+/*
+ * SpanDSP - a series of DSP components for telephony
+ *
+ * private/resample.h - Polyphase sample rate conversion.
+ *
+ * Written by Steve Underwood <steveu@coppice.org>
+ *
+ * Copyright (C) 2026 Steve Underwood
+ *
+ * All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License version 2.1,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#if !defined(_SPANDSP_PRIVATE_RESAMPLE_H_)
+#define _SPANDSP_PRIVATE_RESAMPLE_H_
+
+/*! The largest interpolation or decimation factor. */
+#define RESAMPLE_MAX_FACTOR         6
+/*! The largest number of taps, at the lower of the two rates, of any filter. */
+#define RESAMPLE_MAX_TAPS           64
+/*! The largest number of coefficients in a filter, which is also the most taps in
+    any one of its phases. */
+#define RESAMPLE_MAX_COEFFS         (RESAMPLE_MAX_TAPS*RESAMPLE_MAX_FACTOR)
+
+/*!
+    Resampler descriptor. This defines the working state for a single instance of
+    a sample rate converter.
+*/
+struct resample_state_s
+{
+    /*! The sample rate of the input, in samples/second. */
+    int in_rate;
+    /*! The sample rate of the output, in samples/second. */
+    int out_rate;
+    /*! The interpolation factor. */
+    int up;
+    /*! The decimation factor. */
+    int down;
+    /*! The number of taps in each phase of the filter. */
+    int taps;
+    /*! The position of the next output sample after the newest input sample, in units
+        of 1/up of an input sample. */
+    int phase;
+
+    /*! The phases of the filter, one after the other, each in time order to match the
+        history. The coefficients are Q15. */
+    int16_t coeffs[RESAMPLE_MAX_COEFFS];
+    /*! The same phases, in floating point. */
+    float coeffsf[RESAMPLE_MAX_COEFFS];
+
+    /*! The filter's history, stored twice over so a complete window is always in one
+        piece. */
+    int16_t history[2*RESAMPLE_MAX_COEFFS];
+    /*! The floating point filter's history, stored twice over. */
+    float historyf[2*RESAMPLE_MAX_COEFFS];
+    /*! The current position in the history. */
+    int history_ptr;
+};
+
+#endif
+/*- End of file ------------------------------------------------------------*/
@@ -58,6 +58,13 @@ struct super_tone_rx_state_s
     tone_segment_func_t segment_callback;
     void *callback_data;
     super_tone_rx_segment_t segments[11];
+    /*! The current block of samples. The Goertzels are only run over a complete block,
+        and only if the power gate says it is not too quiet for a tone to be reported. */
+    int16_t block[SUPER_TONE_BINS];
+    /*! The current sample number within a processing block. */
+    int current_sample;
+    /*! The energy pre-screen for each block. */
+    power_gate_t gate;
     goertzel_state_t state[];
 };
 
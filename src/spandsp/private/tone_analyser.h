@@ -0,0 +1,101 @@
+/*
+ * SpanDSP - a series of DSP components for telephony
+ *
+ * private/tone_analyser.h - A combined set of tone detectors, sharing the
+ *                           work of analysing one audio stream.
+ *
+ * Written by Steve Underwood <steveu@coppice.org>
+ *
+ * Copyright (C) 2026 Steve Underwood
+ *
+ * All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License version 2.1,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#if !defined(_SPANDSP_PRIVATE_TONE_ANALYSER_H_)
+#define _SPANDSP_PRIVATE_TONE_ANALYSER_H_
+
+/* One bank for each distinct Goertzel block length in use. */
+#define TONE_ANALYSER_MAX_BANKS         2
+#define TONE_ANALYSER_MAX_GOERTZELS     (8 + SUPER_TONE_BINS/2)
+#define TONE_ANALYSER_MAX_BLOCK         ((DTMF_SAMPLES_PER_BLOCK > SUPER_TONE_BINS)  ?  DTMF_SAMPLES_PER_BLOCK  :  SUPER_TONE_BINS)
+
+/*!
+    A bank of Goertzel filters, which share a block length.
+*/
+typedef struct
+{
+    /*! The number of samples in each block. */
+    int samples;
+    /*! The current sample number within a processing block. */
+    int current_sample;
+    /*! The number of Goertzel filters in the bank. */
+    int goertzels;
+    /*! The Goertzel filter states. */
+    goertzel_state_t goertzel[TONE_ANALYSER_MAX_GOERTZELS];
+#if defined(SPANDSP_USE_FIXED_POINT)
+    /*! The results of the Goertzel filters for the last block. */
+    int32_t result[TONE_ANALYSER_MAX_GOERTZELS];
+    /*! The accumlating total energy over the current block. */
+    int32_t energy;
+    /*! The current block of samples, scaled for the Goertzels. */
+    int16_t block[TONE_ANALYSER_MAX_BLOCK];
+#else
+    /*! The results of the Goertzel filters for the last block. */
+    float result[TONE_ANALYSER_MAX_GOERTZELS];
+    /*! The accumlating total energy over the current block. */
+    float energy;
+    /*! The current block of samples, scaled for the Goertzels. */
+    float block[TONE_ANALYSER_MAX_BLOCK];
+#endif
+} tone_analyser_bank_t;
+
+/*!
+    Tone analyser descriptor. This defines the working state for a single
+    instance of a combined set of tone detectors.
+*/
+struct tone_analyser_state_s
+{
+    /*! The Goertzel banks. */
+    tone_analyser_bank_t bank[TONE_ANALYSER_MAX_BANKS];
+    /*! The number of Goertzel banks in use. */
+    int banks;
+
+    /*! True if DTMF detection is enabled. */
+    bool dtmf_enabled;
+    /*! The DTMF receiver. */
+    dtmf_rx_state_t dtmf;
+    /*! The bank holding the DTMF Goertzels. */
+    int dtmf_bank;
+    /*! The positions of the DTMF row Goertzels in their bank. */
+    int dtmf_row[4];
+    /*! The positions of the DTMF column Goertzels in their bank. */
+    int dtmf_col[4];
+
+    /*! The number of modem connect tone receivers in use. */
+    int modem_connect_tones;
+    /*! The modem connect tone receivers. */
+    modem_connect_tones_rx_state_t modem_connect_tones_rx[TONE_ANALYSER_MAX_MODEM_CONNECT_TONES];
+
+    /*! The supervisory tone receiver, or NULL if supervisory tone detection is not enabled. */
+    super_tone_rx_state_t *super_tone;
+    /*! The bank holding the supervisory tone Goertzels. */
+    int super_tone_bank;
+    /*! The positions of the supervisory tone Goertzels in their bank. */
+    int super_tone_map[SUPER_TONE_BINS/2];
+};
+
+#endif
+/*- End of file ------------------------------------------------------------*/
@@ -0,0 +1,88 @@
+/*
+ * SpanDSP - a series of DSP components for telephony
+ *
+ * private/transcoder.h - Transcode a stream of audio between any of the
+ *                        speech codecs.
+ *
+ * Written by Steve Underwood <steveu@coppice.org>
+ *
+ * Copyright (C) 2026 Steve Underwood
+ *
+ * All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License version 2.1,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#if !defined(_SPANDSP_PRIVATE_TRANSCODER_H_)
+#define _SPANDSP_PRIVATE_TRANSCODER_H_
+
+/*! The largest frame of any format, in bytes. */
+#define TRANSCODER_MAX_FRAME_BYTES      84
+/*! The number of samples, at the input sample rate, decoded in one step. */
+#define TRANSCODER_CHUNK_SAMPLES        640
+
+/*!
+    Transcoder descriptor. This defines the working state for a single instance of
+    a transcoder, converting one stream of audio.
+*/
+struct transcoder_state_s
+{
+    /*! The format of the input data. */
+    int in_format;
+    /*! The format of the output data. */
+    int out_format;
+
+    /*! The decoder for the input data. */
+    union
+    {
+        g711_state_t g711;
+        g722_decode_state_t g722;
+        g726_state_t g726;
+        gsm0610_state_t gsm0610;
+        ima_adpcm_state_t ima_adpcm;
+        oki_adpcm_state_t oki_adpcm;
+        lpc10_decode_state_t lpc10;
+    } dec;
+    /*! The encoder for the output data. */
+    union
+    {
+        g711_state_t g711;
+        g722_encode_state_t g722;
+        g726_state_t g726;
+        gsm0610_state_t gsm0610;
+        ima_adpcm_state_t ima_adpcm;
+        oki_adpcm_state_t oki_adpcm;
+        lpc10_encode_state_t lpc10;
+    } enc;
+
+    /*! A partial frame of input data, held until the rest of it arrives. */
+    uint8_t frame[TRANSCODER_MAX_FRAME_BYTES];
+    /*! The number of bytes in the partial input frame. */
+    int frame_len;
+
+    /*! Decoded audio, at the input sample rate, when it needs resampling. */
+    int16_t decoded[TRANSCODER_CHUNK_SAMPLES];
+    /*! Audio at the output sample rate, waiting to be encoded. There is room for a chunk
+        doubled in rate, plus the remains of an earlier chunk which did not fill a
+        frame of the output format. */
+    int16_t linear[2*TRANSCODER_CHUNK_SAMPLES + TRANSCODER_CHUNK_SAMPLES];
+    /*! The number of samples in linear waiting to be encoded. */
+    int linear_len;
+
+    /*! The resampler, used when the two formats have different sample rates. */
+    resample_state_t resampler;
+};
+
+#endif
+/*- End of file ------------------------------------------------------------*/
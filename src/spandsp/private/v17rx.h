@@ -46,6 +46,31 @@
 /*! How far we look back into history for trellis decisions */
 #define V17_TRELLIS_LOOKBACK_DEPTH  16
 
+/*!
+    The results of a successful V.17 training, in the form exported by
+    v17_rx_export_training(), and accepted by v17_rx_import_training().
+*/
+typedef struct
+{
+    /*! \brief The caller's identifier for the route over which the training was obtained. */
+    uint32_t route_id;
+    /*! \brief The bit rate at which the training was obtained. */
+    int32_t bit_rate;
+    /*! \brief The carrier update rate (i.e. the DDS increment). */
+    int32_t carrier_phase_rate;
+#if defined(SPANDSP_USE_FIXED_POINTx)
+    /*! \brief The scaling factor assessed by the AGC algorithm. */
+    int16_t agc_scaling;
+    /*! \brief The adaptive equalizer coefficients. */
+    complexi16_t eq_coeff[V17_EQUALIZER_LEN];
+#else
+    /*! \brief The scaling factor assessed by the AGC algorithm. */
+    float agc_scaling;
+    /*! \brief The adaptive equalizer coefficients. */
+    complexf_t eq_coeff[V17_EQUALIZER_LEN];
+#endif
+} v17_rx_training_record_t;
+
 /*!
     V.17 modem receive side descriptor. This defines the working state for a
     single instance of a V.17 modem receiver.
@@ -103,8 +128,9 @@ struct v17_rx_state_s
     int32_t carrier_track_p;
     /*! \brief The integral part of the carrier tracking filter. */
     int32_t carrier_track_i;
-    /*! \brief The root raised cosine (RRC) pulse shaping filter buffer. */
-    int16_t rrc_filter[V17_RX_FILTER_STEPS];
+    /*! \brief The root raised cosine (RRC) pulse shaping filter buffer. Each sample is stored twice,
+        one filter span apart, so the span ending at the latest sample is always contiguous. */
+    int16_t rrc_filter[2*V17_RX_FILTER_STEPS];
 
     /*! \brief A pointer to the current constellation. */
     const complexi16_t *constellation;
@@ -140,8 +166,9 @@ struct v17_rx_state_s
     float carrier_track_p;
     /*! \brief The integral part of the carrier tracking filter. */
     float carrier_track_i;
-    /*! \brief The root raised cosine (RRC) pulse shaping filter buffer. */
-    float rrc_filter[V17_RX_FILTER_STEPS];
+    /*! \brief The root raised cosine (RRC) pulse shaping filter buffer. Each sample is stored twice,
+        one filter span apart, so the span ending at the latest sample is always contiguous. */
+    float rrc_filter[2*V17_RX_FILTER_STEPS];
 
     /*! \brief A pointer to the current constellation. */
     const complexf_t *constellation;
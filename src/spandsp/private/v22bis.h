@@ -140,8 +140,9 @@ struct v22bis_state_s
 #if defined(SPANDSP_USE_FIXED_POINT)
         /*! \brief The scaling factor assessed by the AGC algorithm. */
         int16_t agc_scaling;
-        /*! \brief The root raised cosine (RRC) pulse shaping filter buffer. */
-        int16_t rrc_filter[V22BIS_RX_FILTER_STEPS];
+        /*! \brief The root raised cosine (RRC) pulse shaping filter buffer. Each sample is stored twice,
+            one filter span apart, so the span ending at the latest sample is always contiguous. */
+        int16_t rrc_filter[2*V22BIS_RX_FILTER_STEPS];
 
         /*! \brief The current delta factor for updating the equalizer coefficients. */
         int16_t eq_delta;
@@ -160,8 +161,9 @@ struct v22bis_state_s
 #else
         /*! \brief The scaling factor assessed by the AGC algorithm. */
         float agc_scaling;
-        /*! \brief The root raised cosine (RRC) pulse shaping filter buffer. */
-        float rrc_filter[V22BIS_RX_FILTER_STEPS];
+        /*! \brief The root raised cosine (RRC) pulse shaping filter buffer. Each sample is stored twice,
+            one filter span apart, so the span ending at the latest sample is always contiguous. */
+        float rrc_filter[2*V22BIS_RX_FILTER_STEPS];
 
         /*! \brief The current delta factor for updating the equalizer coefficients. */
         float eq_delta;
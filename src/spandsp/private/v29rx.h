@@ -36,6 +36,31 @@
 /*! The number of taps in the pulse shaping/bandpass filter */
 #define V29_RX_FILTER_STEPS     27
 
+/*!
+    The results of a successful V.29 training, in the form exported by
+    v29_rx_export_training(), and accepted by v29_rx_import_training().
+*/
+typedef struct
+{
+    /*! \brief The caller's identifier for the route over which the training was obtained. */
+    uint32_t route_id;
+    /*! \brief The bit rate at which the training was obtained. */
+    int32_t bit_rate;
+    /*! \brief The carrier update rate (i.e. the DDS increment). */
+    int32_t carrier_phase_rate;
+#if defined(SPANDSP_USE_FIXED_POINT)
+    /*! \brief The scaling factor assessed by the AGC algorithm. */
+    int16_t agc_scaling;
+    /*! \brief The adaptive equalizer coefficients. */
+    complexi16_t eq_coeff[V29_EQUALIZER_LEN];
+#else
+    /*! \brief The scaling factor assessed by the AGC algorithm. */
+    float agc_scaling;
+    /*! \brief The adaptive equalizer coefficients. */
+    complexf_t eq_coeff[V29_EQUALIZER_LEN];
+#endif
+} v29_rx_training_record_t;
+
 /*!
     V.29 modem receive side descriptor. This defines the working state for a
     single instance of a V.29 modem receiver.
@@ -93,8 +118,9 @@ struct v29_rx_state_s
     int32_t carrier_track_p;
     /*! \brief The integral part of the carrier tracking filter. */
     int32_t carrier_track_i;
-    /*! \brief The root raised cosine (RRC) pulse shaping filter buffer. */
-    int16_t rrc_filter[V29_RX_FILTER_STEPS];
+    /*! \brief The root raised cosine (RRC) pulse shaping filter buffer. Each sample is stored twice,
+        one filter span apart, so the span ending at the latest sample is always contiguous. */
+    int16_t rrc_filter[2*V29_RX_FILTER_STEPS];
 #else
     /*! \brief The scaling factor assessed by the AGC algorithm. */
     float agc_scaling;
@@ -127,8 +153,9 @@ struct v29_rx_state_s
     float carrier_track_p;
     /*! \brief The integral part of the carrier tracking filter. */
     float carrier_track_i;
-    /*! \brief The root raised cosine (RRC) pulse shaping filter buffer. */
-    float rrc_filter[V29_RX_FILTER_STEPS];
+    /*! \brief The root raised cosine (RRC) pulse shaping filter buffer. Each sample is stored twice,
+        one filter span apart, so the span ending at the latest sample is always contiguous. */
+    float rrc_filter[2*V29_RX_FILTER_STEPS];
 #endif
     /*! \brief Current offset into the RRC pulse shaping filter buffer. */
     int rrc_filter_step;
@@ -141,6 +168,8 @@ struct v29_rx_state_s
     int training_cd;
     /*! \brief True if the previous trained values are to be reused. */
     bool old_train;
+    /*! \brief True if the saved values hold the results of a successful training. */
+    bool old_train_valid;
     /*! \brief The section of the training data we are currently in. */
     int training_stage;
     /*! \brief A count of how far through the current training step we are. */
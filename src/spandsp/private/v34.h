@@ -500,6 +500,12 @@ typedef struct
     complexi16_t bb[2][16][8];
 
     const conv_decode_table_t *conv_decode_table;
+    /*! \brief The previous state for each of the 4 branches into each of the 16 states. This
+               is arranged by branch, so each row can be used as a set of SIMD permutation indices. */
+    int32_t acs_past_state[4][16];
+    /*! \brief The 4D subset for each of the 4 branches into each of the 16 states, arranged
+               by branch. */
+    int32_t acs_subset[4][16];
 } viterbi_t;
 
 typedef struct
@@ -594,11 +600,12 @@ typedef struct
     /*! \brief The update rate for the phase of the V.34 carrier (i.e. the DDS increment). */
     int32_t v34_carrier_phase_rate;
 
-    /*! \brief The root raised cosine (RRC) pulse shaping filter buffer. */
+    /*! \brief The root raised cosine (RRC) pulse shaping filter buffer. Each sample is stored twice,
+        one filter span apart, so the span ending at the latest sample is always contiguous. */
 #if defined(SPANDSP_USE_FIXED_POINT)
-    int16_t rrc_filter[V34_RX_FILTER_STEPS];
+    int16_t rrc_filter[2*V34_RX_FILTER_STEPS];
 #else
-    float rrc_filter[V34_RX_FILTER_STEPS];
+    float rrc_filter[2*V34_RX_FILTER_STEPS];
 #endif
     /*! \brief Current offset into the RRC pulse shaping filter buffer. */
     int rrc_filter_step;
@@ -0,0 +1,149 @@
+/*
+ * SpanDSP - a series of DSP components for telephony
+ *
+ * resample.h - Polyphase sample rate conversion.
+ *
+ * Written by Steve Underwood <steveu@coppice.org>
+ *
+ * Copyright (C) 2026 Steve Underwood
+ *
+ * All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License version 2.1,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+/*! \file */
+
+#if !defined(_SPANDSP_RESAMPLE_H_)
+#define _SPANDSP_RESAMPLE_H_
+
+/*! \page resample_page Sample rate conversion
+\section resample_page_sec_1 What does it do?
+A resampler converts a stream of audio from one sample rate to another, such as from
+the 16000 samples/second of G.722 to the 8000 samples/second used by the modems and
+tone handling, or between either of these and 32000 or 48000 samples/second. Any pair
+of rates may be used where the ratio between them reduces to a fraction whose
+numerator and denominator are both no more than 6.
+
+There are 16 bit integer and floating point versions of the conversion. A stream may
+be processed in blocks of any length, and the resampler keeps its position between
+calls.
+
+\section resample_page_sec_2 How does it work?
+The conversion is treated as interpolation by an integer factor, followed by
+decimation by another integer factor. Both are done in a single polyphase filter,
+so only the output samples which are actually needed are computed, and the zero
+samples inserted by interpolation are never multiplied. Each output sample is a
+single dot product of the recent input with one phase of the filter, which is done
+with the SIMD dot product routines in the vector modules.
+
+The filter is a Kaiser windowed sinc, designed when the resampler is initialised. Its
+cutoff is the Nyquist frequency of the lower of the two rates. The filter length is
+chosen by the quality setting:
+    - RESAMPLE_LOW_LATENCY uses 16 taps at the lower rate. The delay is 1ms at 8000
+      samples/second, and the aliasing is suppressed by about 50dB.
+    - RESAMPLE_STANDARD uses 32 taps at the lower rate, with a delay of 2ms at 8000
+      samples/second, and about 70dB of aliasing suppression.
+    - RESAMPLE_HIGH_QUALITY uses 64 taps at the lower rate, with a delay of 4ms at 8000
+      samples/second, about 80dB of aliasing suppression, and a wider passband.
+
+The 16 bit integer version uses Q15 coefficients, whose precision limits it to about
+75dB of suppression, whichever filter is used.
+
+Each phase of the filter is normalised to unity gain at DC, so a steady signal does
+not pick up a ripple at the output rate.
+*/
+
+/*! The choices of filter for a resampler. */
+enum
+{
+    /*! A short filter, for the least delay. */
+    RESAMPLE_LOW_LATENCY = 0,
+    /*! A filter suitable for most telephony purposes. */
+    RESAMPLE_STANDARD,
+    /*! A long filter, for the best fidelity. */
+    RESAMPLE_HIGH_QUALITY
+};
+
+/*!
+    Resampler descriptor. This defines the working state for a single instance of
+    a sample rate converter.
+*/
+typedef struct resample_state_s resample_state_t;
+
+#if defined(__cplusplus)
+extern "C"
+{
+#endif
+
+/*! \brief Find the exact number of samples a resampler will produce from a specified
+           number of input samples, given its current position.
+    \param s The resampler context.
+    \param len The number of input samples.
+    \return The number of output samples. */
+SPAN_DECLARE(int) resample_max_output(resample_state_t *s, int len);
+
+/*! \brief Find the delay through a resampler.
+    \param s The resampler context.
+    \return The delay, in samples at the output rate, rounded to the nearest sample. */
+SPAN_DECLARE(int) resample_delay(resample_state_t *s);
+
+/*! \brief Resample a block of 16 bit integer samples.
+    \param s The resampler context.
+    \param out The buffer for the resampled audio. This must be at least as long as
+           resample_max_output() says is needed.
+    \param in The audio to be resampled.
+    \param len The number of samples to be resampled.
+    \return The number of samples produced. */
+SPAN_DECLARE(int) resample(resample_state_t *s, int16_t out[], const int16_t in[], int len);
+
+/*! \brief Resample a block of floating point samples. A context should only be used with
+           one of resample() and resamplef().
+    \param s The resampler context.
+    \param out The buffer for the resampled audio. This must be at least as long as
+           resample_max_output() says is needed.
+    \param in The audio to be resampled.
+    \param len The number of samples to be resampled.
+    \return The number of samples produced. */
+SPAN_DECLARE(int) resamplef(resample_state_t *s, float out[], const float in[], int len);
+
+/*! \brief Clear the history of a resampler, so it restarts as though newly initialised.
+    \param s The resampler context.
+    \return 0 for OK, else -1. */
+SPAN_DECLARE(int) resample_restart(resample_state_t *s);
+
+/*! \brief Initialise a resampler context.
+    \param s The resampler context. If NULL, a context is allocated.
+    \param in_rate The sample rate of the input, in samples/second.
+    \param out_rate The sample rate of the output, in samples/second.
+    \param quality The choice of filter - one of the RESAMPLE_xxx values.
+    \return A pointer to the resampler context, or NULL for an error. */
+SPAN_DECLARE(resample_state_t *) resample_init(resample_state_t *s, int in_rate, int out_rate, int quality);
+
+/*! \brief Release a resampler context.
+    \param s The resampler context.
+    \return 0 for OK, else -1. */
+SPAN_DECLARE(int) resample_release(resample_state_t *s);
+
+/*! \brief Free a resampler context.
+    \param s The resampler context.
+    \return 0 for OK, else -1. */
+SPAN_DECLARE(int) resample_free(resample_state_t *s);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif
+/*- End of file ------------------------------------------------------------*/
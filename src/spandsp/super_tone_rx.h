@@ -146,6 +146,14 @@ SPAN_DECLARE(void) super_tone_rx_tone_callback(super_tone_rx_state_t *s,
 SPAN_DECLARE(void) super_tone_rx_segment_callback(super_tone_rx_state_t *s,
                                                   tone_segment_func_t callback);
 
+/*! Get the power gate associated with a supervisory tone detector. Blocks of audio the
+    gate finds to be quiet are not passed through the Goertzel filters.
+    \brief Get the power gate associated with a supervisory tone detector.
+    \param s The supervisory tone context.
+    \return A pointer to the power gate context.
+*/
+SPAN_DECLARE(power_gate_t *) super_tone_rx_get_power_gate(super_tone_rx_state_t *s);
+
 /*! Apply supervisory tone detection processing to a block of audio samples.
     \brief Apply supervisory tone detection processing to a block of audio samples.
     \param super The supervisory tone context.
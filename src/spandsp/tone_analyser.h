@@ -0,0 +1,140 @@
+/*
+ * SpanDSP - a series of DSP components for telephony
+ *
+ * tone_analyser.h - A combined set of tone detectors, sharing the work of
+ *                   analysing one audio stream.
+ *
+ * Written by Steve Underwood <steveu@coppice.org>
+ *
+ * Copyright (C) 2026 Steve Underwood
+ *
+ * All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License version 2.1,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+/*! \file */
+
+#if !defined(_SPANDSP_TONE_ANALYSER_H_)
+#define _SPANDSP_TONE_ANALYSER_H_
+
+/*! \page tone_analyser_page Combined tone analysis
+\section tone_analyser_page_sec_1 What does it do?
+A call leg commonly needs a DTMF receiver, one or more modem connect tone receivers
+(e.g. for CNG and ANSam), and a supervisory tone receiver for call progress, all
+looking at the same audio. The tone analyser bundles these detectors together, so
+one call feeds the audio to all the enabled detectors, and the work they have in
+common is only done once. Each detector makes exactly the same decisions, and reports
+them through the same callbacks, as it would if it were used on its own.
+
+\section tone_analyser_page_sec_2 How does it work?
+The Goertzel filters the detectors need are gathered into banks, one for each Goertzel
+block length. A Goertzel wanted by more than one detector appears only once in a bank.
+The audio is scaled, and its energy measured, in a single pass, and the results are
+shared by all the banks. At the end of each block the bank's Goertzels are run over
+the block, and the results are passed to the detectors' decision logic. A bank is not
+run at all for a block in which none of its detectors could find a tone.
+
+The modem connect tone detectors use notch filters, rather than Goertzels, so they are
+simply passed the audio.
+
+A DTMF receiver with its dialtone filter enabled needs the Goertzels to see filtered
+audio, so it cannot share a bank. It is passed the audio, and works as it would on its
+own. The dialtone filter should be set up before any audio is analysed.
+*/
+
+/*! The maximum number of modem connect tone receivers a tone analyser may run. */
+#define TONE_ANALYSER_MAX_MODEM_CONNECT_TONES   3
+
+/*!
+    Tone analyser descriptor. This defines the working state for a single
+    instance of a combined set of tone detectors.
+*/
+typedef struct tone_analyser_state_s tone_analyser_state_t;
+
+#if defined(__cplusplus)
+extern "C"
+{
+#endif
+
+/*! \brief Enable DTMF detection in a tone analyser.
+    \param s The tone analyser context.
+    \param callback An optional callback routine, used to report received digits.
+    \param user_data An opaque pointer passed to the callback routine.
+    \return The DTMF receiver context, which may be used to adjust its parameters, and
+            to collect digits. NULL if DTMF detection is already enabled. */
+SPAN_DECLARE(dtmf_rx_state_t *) tone_analyser_enable_dtmf(tone_analyser_state_t *s,
+                                                          digits_rx_callback_t callback,
+                                                          void *user_data);
+
+/*! \brief Enable the detection of one type of modem connect tone in a tone analyser.
+           This may be called up to TONE_ANALYSER_MAX_MODEM_CONNECT_TONES times, for
+           different tones.
+    \param s The tone analyser context.
+    \param tone_type The type of tone to be detected, as for modem_connect_tones_rx_init().
+    \param callback An optional callback routine, used to report tones.
+    \param user_data An opaque pointer passed to the callback routine.
+    \return The modem connect tone receiver context. NULL if no more receivers can be added. */
+SPAN_DECLARE(modem_connect_tones_rx_state_t *) tone_analyser_enable_modem_connect_tones(tone_analyser_state_t *s,
+                                                                                         int tone_type,
+                                                                                         span_tone_report_func_t callback,
+                                                                                         void *user_data);
+
+/*! \brief Enable supervisory tone detection in a tone analyser.
+    \param s The tone analyser context.
+    \param desc The supervisory tone descriptor. This must remain valid for the life of
+           the tone analyser.
+    \param callback The callback routine, used to report tones.
+    \param user_data An opaque pointer passed to the callback routine.
+    \return The supervisory tone receiver context. NULL if supervisory tone detection
+            is already enabled, or the receiver could not be created. */
+SPAN_DECLARE(super_tone_rx_state_t *) tone_analyser_enable_super_tone(tone_analyser_state_t *s,
+                                                                      super_tone_rx_descriptor_t *desc,
+                                                                      span_tone_report_func_t callback,
+                                                                      void *user_data);
+
+/*! \brief Process a block of received audio samples through all the enabled detectors.
+    \param s The tone analyser context.
+    \param amp The audio sample buffer.
+    \param samples The number of samples in the buffer.
+    \return The number of samples unprocessed. */
+SPAN_DECLARE(int) tone_analyser_rx(tone_analyser_state_t *s, const int16_t amp[], int samples);
+
+/*! \brief Get the number of Goertzel filters a tone analyser runs, across all its banks.
+    \param s The tone analyser context.
+    \return The number of Goertzel filters. */
+SPAN_DECLARE(int) tone_analyser_get_goertzels(tone_analyser_state_t *s);
+
+/*! \brief Initialise a tone analyser context. No detectors are enabled until one of the
+           tone_analyser_enable_xxx() functions is called.
+    \param s The tone analyser context. If NULL, a context is allocated.
+    \return A pointer to the tone analyser context, or NULL for an error. */
+SPAN_DECLARE(tone_analyser_state_t *) tone_analyser_init(tone_analyser_state_t *s);
+
+/*! \brief Release a tone analyser context.
+    \param s The tone analyser context.
+    \return 0 for OK, else -1. */
+SPAN_DECLARE(int) tone_analyser_release(tone_analyser_state_t *s);
+
+/*! \brief Free a tone analyser context.
+    \param s The tone analyser context.
+    \return 0 for OK, else -1. */
+SPAN_DECLARE(int) tone_analyser_free(tone_analyser_state_t *s);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif
+/*- End of file ------------------------------------------------------------*/
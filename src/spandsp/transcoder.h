@@ -0,0 +1,157 @@
+/*
+ * SpanDSP - a series of DSP components for telephony
+ *
+ * transcoder.h - Transcode a stream of audio between any of the speech codecs.
+ *
+ * Written by Steve Underwood <steveu@coppice.org>
+ *
+ * Copyright (C) 2026 Steve Underwood
+ *
+ * All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License version 2.1,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+/*! \file */
+
+#if !defined(_SPANDSP_TRANSCODER_H_)
+#define _SPANDSP_TRANSCODER_H_
+
+/*! \page transcoder_page Speech codec transcoding
+\section transcoder_page_sec_1 What does it do?
+A transcoder converts a stream of audio from one coding format to another, such as
+from A-law to G.726, or from G.722 to GSM 06.10. Any of the speech codecs in spandsp
+may be used at either end, as well as plain 16 bit linear audio at 8000 or 16000
+samples/second. Where the sample rates of the two ends differ, the audio is resampled.
+
+Many streams may be handled in one call, with transcoder_batch().
+
+\section transcoder_page_sec_2 How does it work?
+The data passed to the transcoder may be of any length. Only whole frames of the input
+format are decoded, and any partial frame is kept until the rest of it arrives. The
+decoder writes directly into the buffer the encoder works from, unless the audio needs
+resampling on the way, and the encoder writes directly to the caller's buffer. All the
+working storage is part of the transcoder context, so nothing is allocated while audio
+is being processed.
+
+When both ends use the same format, the data is simply copied. A-law and u-law are
+converted directly, using the G.711 transcoding tables, without passing through linear.
+
+Resampling between 8000 and 16000 samples/second is done by a resampler (see resample.h),
+using its RESAMPLE_STANDARD filter.
+
+The framing used for each format is:
+    - linear audio is 16 bit samples, in the machine's byte order.
+    - G.722 at 48000 and 56000 bits/second is packed.
+    - G.726 is packed as in RFC3551.
+    - GSM 06.10 is packed for VoIP, in 33 byte frames.
+    - IMA ADPCM is DVI4, as used for VoIP, with a 4 byte header at the start of each
+      frame of 160 samples.
+    - LPC10 is packed into 7 bytes per 180 sample frame.
+*/
+
+/*! The coding formats a transcoder may convert between. */
+enum
+{
+    TRANSCODER_LINEAR_8000 = 0,
+    TRANSCODER_LINEAR_16000,
+    TRANSCODER_ALAW,
+    TRANSCODER_ULAW,
+    TRANSCODER_G722_64000,
+    TRANSCODER_G722_56000,
+    TRANSCODER_G722_48000,
+    TRANSCODER_G726_16000,
+    TRANSCODER_G726_24000,
+    TRANSCODER_G726_32000,
+    TRANSCODER_G726_40000,
+    TRANSCODER_GSM0610,
+    TRANSCODER_IMA_ADPCM,
+    TRANSCODER_OKI_ADPCM_24000,
+    TRANSCODER_OKI_ADPCM_32000,
+    TRANSCODER_LPC10,
+    TRANSCODER_FORMATS
+};
+
+/*!
+    Transcoder descriptor. This defines the working state for a single instance of
+    a transcoder, converting one stream of audio.
+*/
+typedef struct transcoder_state_s transcoder_state_t;
+
+#if defined(__cplusplus)
+extern "C"
+{
+#endif
+
+/*! \brief Get the sample rate of a transcoder format.
+    \param format The format - one of the TRANSCODER_xxx values.
+    \return The sample rate, in samples/second, or -1 for an invalid format. */
+SPAN_DECLARE(int) transcoder_format_sample_rate(int format);
+
+/*! \brief Find the largest number of bytes a transcoder could produce from a
+           specified amount of input, allowing for any data it holds from earlier calls.
+    \param s The transcoder context.
+    \param len The number of bytes of input data.
+    \return The maximum number of bytes of output data. */
+SPAN_DECLARE(int) transcoder_max_output(transcoder_state_t *s, int len);
+
+/*! \brief Transcode a block of data. All the data is consumed, although a partial frame
+           at the end may be held until the next call.
+    \param s The transcoder context.
+    \param out The buffer for the transcoded data. This must be at least as long as
+           transcoder_max_output() says is needed for the input data.
+    \param in The data to be transcoded.
+    \param len The number of bytes of data to be transcoded.
+    \return The number of bytes of transcoded data produced. */
+SPAN_DECLARE(int) transcoder_transcode(transcoder_state_t *s, uint8_t out[], const uint8_t in[], int len);
+
+/*! \brief Transcode a block of data for each of a number of streams.
+    \param s The transcoder contexts, one for each stream.
+    \param out The buffers for the transcoded data, one for each stream. Each must be at
+           least as long as transcoder_max_output() says is needed for its input data.
+    \param out_len The number of bytes of transcoded data produced for each stream.
+    \param in The data to be transcoded, for each stream.
+    \param in_len The number of bytes of data to be transcoded, for each stream.
+    \param streams The number of streams.
+    \return The total number of bytes of transcoded data produced. */
+SPAN_DECLARE(int) transcoder_batch(transcoder_state_t *s[],
+                                   uint8_t *out[],
+                                   int out_len[],
+                                   const uint8_t *in[],
+                                   const int in_len[],
+                                   int streams);
+
+/*! \brief Initialise a transcoder context.
+    \param s The transcoder context. If NULL, a context is allocated.
+    \param in_format The format of the data to be transcoded - one of the TRANSCODER_xxx values.
+    \param out_format The format of the transcoded data - one of the TRANSCODER_xxx values.
+    \return A pointer to the transcoder context, or NULL for an error. */
+SPAN_DECLARE(transcoder_state_t *) transcoder_init(transcoder_state_t *s, int in_format, int out_format);
+
+/*! \brief Release a transcoder context.
+    \param s The transcoder context.
+    \return 0 for OK, else -1. */
+SPAN_DECLARE(int) transcoder_release(transcoder_state_t *s);
+
+/*! \brief Free a transcoder context.
+    \param s The transcoder context.
+    \return 0 for OK, else -1. */
+SPAN_DECLARE(int) transcoder_free(transcoder_state_t *s);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif
+/*- End of file ------------------------------------------------------------*/
@@ -217,6 +217,33 @@ SPAN_DECLARE(int) v29_rx_equalizer_state(v29_rx_state_t *s, complexi16_t **coeff
 SPAN_DECLARE(int) v29_rx_equalizer_state(v29_rx_state_t *s, complexf_t **coeffs);
 #endif
 
+/*! Export the results of the last successful training, so they can be reused by a later
+    call over the same route. Symbol timing is not included, as it is always reacquired at
+    the start of a training sequence.
+    \brief Export the results of the last successful training.
+    \param s The modem context.
+    \param route_id The caller's identifier for the route (e.g. the trunk) in use.
+    \param buf The buffer for the exported training. If this is NULL, only the length
+           required is returned.
+    \param max_len The length of buf.
+    \return The length of the exported training, or -1 if there is no successful training
+            to export, or buf is too short. */
+SPAN_DECLARE(int) v29_rx_export_training(v29_rx_state_t *s, uint32_t route_id, uint8_t buf[], int max_len);
+
+/*! Import training exported by v29_rx_export_training(), perhaps during an earlier call.
+    The receiver is left as though it had just trained successfully, so the next restart
+    reusing the old training starts from the imported equalizer, carrier frequency and AGC
+    setting.
+    \brief Import the results of an earlier training.
+    \param s The modem context.
+    \param route_id The caller's identifier for the route (e.g. the trunk) in use. This must
+           match the route for which the training was exported.
+    \param buf The exported training.
+    \param len The length of buf.
+    \return 0 for OK, or -1 if the training does not match this route, or this build of
+            the modem. */
+SPAN_DECLARE(int) v29_rx_import_training(v29_rx_state_t *s, uint32_t route_id, const uint8_t buf[], int len);
+
 /*! Get the current received carrier frequency.
     \param s The modem context.
     \return The frequency, in Hertz. */
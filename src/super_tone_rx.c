@@ -42,26 +42,40 @@
 #if defined(HAVE_MATH_H)
 #include <math.h>
 #endif
+#if defined(HAVE_STDBOOL_H)
+#include <stdbool.h>
+#else
+#include "spandsp/stdbool.h"
+#endif
 #include "floating_fudge.h"
 
 #include "spandsp/telephony.h"
 #include "spandsp/alloc.h"
+#include "spandsp/logging.h"
 #include "spandsp/fast_convert.h"
+#include "spandsp/power_meter.h"
 #include "spandsp/complex.h"
 #include "spandsp/vector_float.h"
 #include "spandsp/complex_vector_float.h"
 #include "spandsp/tone_detect.h"
 #include "spandsp/tone_generate.h"
 #include "spandsp/super_tone_rx.h"
+#include "spandsp/dtmf.h"
 
+#include "spandsp/private/power_meter.h"
 #include "spandsp/private/super_tone_rx.h"
 
+#include "tone_analyser_local.h"
+
+/* The lowest level, in dBm0, of any tone which is reported */
+#define SUPER_TONE_RX_THRESHOLD     -42
+
 #if defined(SPANDSP_USE_FIXED_POINT)
-static const int detection_threshold        = energy_threshold_dbm0(SUPER_TONE_BINS, -42);
+static const int detection_threshold        = energy_threshold_dbm0(SUPER_TONE_BINS, SUPER_TONE_RX_THRESHOLD);
 static const int tone_twist                 = 4;
 static const int tone_to_total_energy       = SUPER_TONE_BINS*64;
 #else
-static const float detection_threshold      = energy_threshold_dbm0(SUPER_TONE_BINS, -42);
+static const float detection_threshold      = energy_threshold_dbm0(SUPER_TONE_BINS, SUPER_TONE_RX_THRESHOLD);
 static const float tone_twist               = db_to_power_ratio(6.0f);
 static const float tone_to_total_energy     = SUPER_TONE_BINS*db_to_power_ratio(-3.0f);
 #endif
@@ -274,26 +288,21 @@ SPAN_DECLARE(void) super_tone_rx_tone_callback(super_tone_rx_state_t *s,
 }
 /*- End of function --------------------------------------------------------*/
 
-static void super_tone_chunk(super_tone_rx_state_t *s)
+#if defined(SPANDSP_USE_FIXED_POINT)
+static void super_tone_chunk(super_tone_rx_state_t *s, const int32_t res[])
+#else
+static void super_tone_chunk(super_tone_rx_state_t *s, const float res[])
+#endif
 {
-    int i;
     int j;
     int k1;
     int k2;
-#if defined(SPANDSP_USE_FIXED_POINT)
-    int32_t res[SUPER_TONE_BINS/2];
-#else
-    float res[SUPER_TONE_BINS/2];
-#endif
 
     if (s->energy < detection_threshold)
     {
         /* The total energy is too low to be considered a tone detection. */
         k1 = -1;
         k2 = -1;
-        for (i = 0;  i < s->desc->monitored_frequencies;  i++)
-            goertzel_reset(&s->state[i]);
-        /*endfor*/
     }
     else
     {
@@ -305,9 +314,6 @@ static void super_tone_chunk(super_tone_rx_state_t *s)
         else
         {
             /* Find our two best monitored frequencies, which also have adequate energy. */
-            for (i = 0;  i < s->desc->monitored_frequencies;  i++)
-                res[i] = goertzel_result(&s->state[i]);
-            /*endfor*/
             if (res[0] > res[1])
             {
                 k1 = 0;
@@ -439,6 +445,17 @@ static void super_tone_chunk(super_tone_rx_state_t *s)
 }
 /*- End of function --------------------------------------------------------*/
 
+#if defined(SPANDSP_USE_FIXED_POINT)
+void super_tone_rx_goertzel_block(super_tone_rx_state_t *s, const int32_t res[], float energy)
+#else
+void super_tone_rx_goertzel_block(super_tone_rx_state_t *s, const float res[], float energy)
+#endif
+{
+    s->energy = energy;
+    super_tone_chunk(s, res);
+}
+/*- End of function --------------------------------------------------------*/
+
 SPAN_DECLARE(int) super_tone_rx(super_tone_rx_state_t *s, const int16_t amp[], int samples)
 {
     int i;
@@ -446,16 +463,19 @@ SPAN_DECLARE(int) super_tone_rx(super_tone_rx_state_t *s, const int16_t amp[], i
     int sample;
 #if defined(SPANDSP_USE_FIXED_POINT)
     int16_t xamp;
+    int32_t res[SUPER_TONE_BINS/2];
 #else
     float xamp;
+    float res[SUPER_TONE_BINS/2];
 #endif
 
-    x = 0;
     for (sample = 0;  sample < samples;  sample += x)
     {
-        for (i = 0;  i < s->desc->monitored_frequencies;  i++)
-            x = goertzel_update(&s->state[i], &amp[sample], samples - sample);
-        /*endfor*/
+        x = SUPER_TONE_BINS - s->current_sample;
+        if (x > samples - sample)
+            x = samples - sample;
+        /*endif*/
+        memcpy(&s->block[s->current_sample], &amp[sample], x*sizeof(amp[0]));
         for (i = 0;  i < x;  i++)
         {
             xamp = goertzel_preadjust_amp(amp[sample + i]);
@@ -466,10 +486,31 @@ SPAN_DECLARE(int) super_tone_rx(super_tone_rx_state_t *s, const int16_t amp[], i
 #endif
         }
         /*endfor*/
-        if (s->state[0].current_sample >= SUPER_TONE_BINS)
+        power_gate_update(&s->gate, &amp[sample], x);
+        s->current_sample += x;
+        if (s->current_sample >= SUPER_TONE_BINS)
         {
-            /* We have finished a Goertzel block. */
-            super_tone_chunk(s);
+            /* We have finished a Goertzel block. Most of the time there is nothing on the
+               line, and the block is too quiet for any tone to be reported, so only run
+               the Goertzels if the power gate says the result might be needed. */
+            if (!power_gate_block_end(&s->gate, SUPER_TONE_BINS))
+            {
+                for (i = 0;  i < s->desc->monitored_frequencies;  i++)
+                {
+                    goertzel_update(&s->state[i], s->block, SUPER_TONE_BINS);
+                    res[i] = goertzel_result(&s->state[i]);
+                }
+                /*endfor*/
+            }
+            else
+            {
+                for (i = 0;  i < s->desc->monitored_frequencies;  i++)
+                    res[i] = 0;
+                /*endfor*/
+            }
+            /*endif*/
+            super_tone_chunk(s, res);
+            s->current_sample = 0;
         }
         /*endif*/
     }
@@ -492,6 +533,12 @@ SPAN_DECLARE(void) super_tone_rx_segment_callback(super_tone_rx_state_t *s,
 }
 /*- End of function --------------------------------------------------------*/
 
+SPAN_DECLARE(power_gate_t *) super_tone_rx_get_power_gate(super_tone_rx_state_t *s)
+{
+    return &s->gate;
+}
+/*- End of function --------------------------------------------------------*/
+
 SPAN_DECLARE(super_tone_rx_state_t *) super_tone_rx_init(super_tone_rx_state_t *s,
                                                          super_tone_rx_descriptor_t *desc,
                                                          span_tone_report_func_t callback,
@@ -527,6 +574,8 @@ SPAN_DECLARE(super_tone_rx_state_t *) super_tone_rx_init(super_tone_rx_state_t *
         s->desc = desc;
     /*endif*/
     s->detected_tone = -1;
+    s->current_sample = 0;
+    power_gate_init(&s->gate, SUPER_TONE_RX_THRESHOLD - POWER_GATE_GOERTZEL_MARGIN);
 #if defined(SPANDSP_USE_FIXED_POINT)
     s->energy = 0;
 #else
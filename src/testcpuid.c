@@ -31,179 +31,211 @@
 #endif
 
 #include <inttypes.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#if defined(HAVE_STDBOOL_H)
+#include <stdbool.h>
+#else
+#include "spandsp/stdbool.h"
+#endif
 
-/* Make this file just disappear if we are not on an x86 machine */
-#if defined(__i386__) //  ||  defined(__x86_64__)
-
-enum
-{
-    X86_EFLAGS_CF   = 0x00000001,   /* Carry Flag */
-    X86_EFLAGS_PF   = 0x00000004,   /* Parity Flag */
-    X86_EFLAGS_AF   = 0x00000010,   /* Auxillary carry Flag */
-    X86_EFLAGS_ZF   = 0x00000040,   /* Zero Flag */
-    X86_EFLAGS_SF   = 0x00000080,   /* Sign Flag */
-    X86_EFLAGS_TF   = 0x00000100,   /* Trap Flag */
-    X86_EFLAGS_IF   = 0x00000200,   /* Interrupt Flag */
-    X86_EFLAGS_DF   = 0x00000400,   /* Direction Flag */
-    X86_EFLAGS_OF   = 0x00000800,   /* Overflow Flag */
-    X86_EFLAGS_IOPL = 0x00003000,   /* IOPL mask */
-    X86_EFLAGS_NT   = 0x00004000,   /* Nested Task */
-    X86_EFLAGS_RF   = 0x00010000,   /* Resume Flag */
-    X86_EFLAGS_VM   = 0x00020000,   /* Virtual Mode */
-    X86_EFLAGS_AC   = 0x00040000,   /* Alignment Check */
-    X86_EFLAGS_VIF  = 0x00080000,   /* Virtual Interrupt Flag */
-    X86_EFLAGS_VIP  = 0x00100000,   /* Virtual Interrupt Pending */
-    X86_EFLAGS_ID   = 0x00200000    /* CPUID detection flag */
-};
-
-/* Standard macro to see if a specific flag is changeable */
-static __inline__ int flag_is_changeable_p(uint32_t flag)
+#include "mmx_sse_decs.h"
+
+#include "spandsp/telephony.h"
+#include "spandsp/cpu_features.h"
+
+#if defined(SPANDSP_USE_RUNTIME_DISPATCH)
+#include <cpuid.h>
+
+/* CPUID leaf 1, ECX */
+#define CPUID1_ECX_SSE3         0x00000001
+#define CPUID1_ECX_SSSE3        0x00000200
+#define CPUID1_ECX_FMA          0x00001000
+#define CPUID1_ECX_SSE4_1       0x00080000
+#define CPUID1_ECX_SSE4_2       0x00100000
+#define CPUID1_ECX_OSXSAVE      0x08000000
+#define CPUID1_ECX_AVX          0x10000000
+/* CPUID leaf 1, EDX */
+#define CPUID1_EDX_MMX          0x00800000
+#define CPUID1_EDX_SSE          0x02000000
+#define CPUID1_EDX_SSE2         0x04000000
+/* CPUID leaf 7, sub-leaf 0, EBX */
+#define CPUID7_EBX_AVX2         0x00000020
+#define CPUID7_EBX_AVX512F      0x00010000
+#define CPUID7_EBX_AVX512BW     0x40000000
+
+/* XCR0 bits showing which register sets the OS saves across context switches */
+#define XCR0_SSE_AVX            0x00000006
+#define XCR0_AVX512             0x000000E0
+
+/* The features used to select code paths. This is only written when the library is loaded,
+   or when an application restricts the features in use. */
+uint32_t span_cpu_dispatch_features = 0;
+
+static uint32_t cpu_features = 0;
+static int cpu_features_probed = false;
+
+static uint32_t xgetbv0(void)
 {
-    uint32_t f1;
-    uint32_t f2;
+    uint32_t eax;
+    uint32_t edx;
 
+    /* The XGETBV instruction is written as raw bytes, so we don't need to tell the
+       compiler we are using XSAVE features. */
     __asm__ __volatile__(
-        " pushfl\n"
-        " pushfl\n"
-        " popl %0\n"
-        " movl %0,%1\n"
-        " xorl %2,%0\n"
-        " pushl %0\n"
-        " popfl\n"
-        " pushfl\n"
-        " popl %0\n"
-        " popfl\n"
-        : "=&r" (f1), "=&r" (f2)
-        : "ir" (flag));
-    return ((f1^f2) & flag) != 0;
+        " .byte 0x0F,0x01,0xD0;\n"
+        : "=a" (eax), "=d" (edx)
+        : "c" (0));
+    return eax;
 }
 /*- End of function --------------------------------------------------------*/
 
-/* Probe for the CPUID instruction */
-static int have_cpuid_p(void)
+static uint32_t probe_cpu_features(void)
 {
-    return flag_is_changeable_p(X86_EFLAGS_ID);
+    unsigned int eax;
+    unsigned int ebx;
+    unsigned int ecx;
+    unsigned int edx;
+    unsigned int max_leaf;
+    uint32_t xcr0;
+    uint32_t features;
+
+    features = 0;
+    /* __get_cpuid_max() also checks the CPUID instruction exists, on old i386 machines */
+    if ((max_leaf = __get_cpuid_max(0, NULL)) < 1)
+        return 0;
+    /*endif*/
+    __cpuid(1, eax, ebx, ecx, edx);
+    if ((edx & CPUID1_EDX_MMX))
+        features |= SPAN_CPU_FEATURE_MMX;
+    /*endif*/
+    if ((edx & CPUID1_EDX_SSE))
+        features |= SPAN_CPU_FEATURE_SSE;
+    /*endif*/
+    if ((edx & CPUID1_EDX_SSE2))
+        features |= SPAN_CPU_FEATURE_SSE2;
+    /*endif*/
+    if ((ecx & CPUID1_ECX_SSE3))
+        features |= SPAN_CPU_FEATURE_SSE3;
+    /*endif*/
+    if ((ecx & CPUID1_ECX_SSSE3))
+        features |= SPAN_CPU_FEATURE_SSSE3;
+    /*endif*/
+    if ((ecx & CPUID1_ECX_SSE4_1))
+        features |= SPAN_CPU_FEATURE_SSE4_1;
+    /*endif*/
+    if ((ecx & CPUID1_ECX_SSE4_2))
+        features |= SPAN_CPU_FEATURE_SSE4_2;
+    /*endif*/
+    /* The AVX family is only usable if the OS saves the YMM (and ZMM) registers */
+    if ((ecx & CPUID1_ECX_OSXSAVE) == 0)
+        return features;
+    /*endif*/
+    xcr0 = xgetbv0();
+    if ((xcr0 & XCR0_SSE_AVX) != XCR0_SSE_AVX)
+        return features;
+    /*endif*/
+    if ((ecx & CPUID1_ECX_AVX))
+        features |= SPAN_CPU_FEATURE_AVX;
+    /*endif*/
+    if ((ecx & CPUID1_ECX_FMA))
+        features |= SPAN_CPU_FEATURE_FMA;
+    /*endif*/
+    if (max_leaf < 7)
+        return features;
+    /*endif*/
+    __cpuid_count(7, 0, eax, ebx, ecx, edx);
+    if ((ebx & CPUID7_EBX_AVX2)  &&  (features & SPAN_CPU_FEATURE_AVX))
+        features |= SPAN_CPU_FEATURE_AVX2;
+    /*endif*/
+    if ((xcr0 & XCR0_AVX512) == XCR0_AVX512)
+    {
+        if ((ebx & CPUID7_EBX_AVX512F))
+            features |= SPAN_CPU_FEATURE_AVX512F;
+        /*endif*/
+        if ((ebx & CPUID7_EBX_AVX512BW)  &&  (features & SPAN_CPU_FEATURE_AVX512F))
+            features |= SPAN_CPU_FEATURE_AVX512BW;
+        /*endif*/
+    }
+    /*endif*/
+    return features;
 }
 /*- End of function --------------------------------------------------------*/
 
-int has_MMX(void)
+static void __attribute__((constructor)) span_cpu_features_init(void)
 {
-    int result;
-
-    if (!have_cpuid_p())
-        return 0;
+    if (!cpu_features_probed)
+    {
+        cpu_features = probe_cpu_features();
+        cpu_features_probed = true;
+        span_cpu_dispatch_features = cpu_features;
+    }
     /*endif*/
-    __asm__ __volatile__(
-        " push  %%ebx;\n"
-        " mov   $1,%%eax;\n"
-        " cpuid;\n"
-        " xor   %%eax,%%eax;\n"
-        " test  $0x800000,%%edx;\n"
-        " jz    1f;\n"                  /* no MMX support */
-        " inc   %%eax;\n"               /* MMX support */
-        "1:\n"
-        " pop   %%ebx;\n"
-        : "=a" (result)
-        :
-        : "ecx", "edx");
-    return result;
 }
 /*- End of function --------------------------------------------------------*/
 
-int has_SIMD(void)
+SPAN_DECLARE(uint32_t) span_cpu_features(void)
 {
-    int result;
-
-    if (!have_cpuid_p())
-        return 0;
-    /*endif*/
-    __asm__ __volatile__(
-        " push  %%ebx;\n"
-        " mov   $1,%%eax;\n"
-        " cpuid;\n"
-        " xor   %%eax,%%eax;\n"
-        " test  $0x02000000,%%edx;\n"
-        " jz    1f;\n"                  /* no SIMD support */
-        " inc   %%eax;\n"               /* SIMD support */
-        "1:\n"
-        " pop   %%ebx;\n"
-        : "=a" (result)
-        :
-        : "ecx", "edx");
-    return result;
+    span_cpu_features_init();
+    return cpu_features;
 }
 /*- End of function --------------------------------------------------------*/
 
-int has_SIMD2(void)
+SPAN_DECLARE(uint32_t) span_cpu_features_in_use(void)
 {
-    int result;
+    span_cpu_features_init();
+    return span_cpu_dispatch_features;
+}
+/*- End of function --------------------------------------------------------*/
 
-    if (!have_cpuid_p())
-        return 0;
-    /*endif*/
-    __asm__ __volatile__(
-        " push  %%ebx;\n"
-        " mov   $1,%%eax;\n"
-        " cpuid;\n"
-        " xor   %%eax,%%eax;\n"
-        " test  $0x04000000,%%edx;\n"
-        " jz    1f;\n"                  /* no SIMD2 support */
-        " inc   %%eax;\n"               /* SIMD2 support */
-        "1:\n"
-        " pop   %%ebx;\n"
-        : "=a" (result)
-        :
-        : "ecx", "edx");
-    return result;
+SPAN_DECLARE(uint32_t) span_cpu_features_restrict(uint32_t mask)
+{
+    span_cpu_features_init();
+    span_cpu_dispatch_features = cpu_features & mask;
+    return span_cpu_dispatch_features;
+}
+/*- End of function --------------------------------------------------------*/
+#else
+SPAN_DECLARE(uint32_t) span_cpu_features(void)
+{
+    return 0;
 }
 /*- End of function --------------------------------------------------------*/
 
-int has_3DNow(void)
+SPAN_DECLARE(uint32_t) span_cpu_features_in_use(void)
 {
-    int result;
+    return 0;
+}
+/*- End of function --------------------------------------------------------*/
 
-    if (!have_cpuid_p())
-        return 0;
-    /*endif*/
-    __asm__ __volatile__(
-        " push  %%ebx;\n"
-        " mov   $0x80000000,%%eax;\n"
-        " cpuid;\n"
-        " xor   %%ecx,%%ecx;\n"
-        " cmp   $0x80000000,%%eax;\n"
-        " jbe   1f;\n"                  /* no extended MSR(1), so no 3DNow! */
-        " mov   $0x80000001,%%eax;\n"
-        " cpuid;\n"
-        " xor   %%ecx,%%ecx;\n"
-        " test  $0x80000000,%%edx;\n"
-        " jz    1f;\n"                  /* no 3DNow! support */
-        " inc   %%ecx;\n"               /* 3DNow! support */
-        "1:\n"
-        " pop   %%ebx;\n"
-        : "=c" (result)
-        :
-        : "eax", "edx");
-    return result;
+SPAN_DECLARE(uint32_t) span_cpu_features_restrict(uint32_t mask)
+{
+    return 0;
 }
 /*- End of function --------------------------------------------------------*/
+#endif
 
 #if defined(TESTBED)
 int main(int argc, char *argv[])
 {
-    int result;
-
-    result = has_MMX();
-    printf("MMX is %x\n", result);
-    result = has_SIMD();
-    printf("SIMD is %x\n", result);
-    result = has_SIMD2();
-    printf("SIMD2 is %x\n", result);
-    result = has_3DNow();
-    printf("3DNow is %x\n", result);
+    uint32_t features;
+
+    features = span_cpu_features();
+    printf("MMX is %x\n", (features & SPAN_CPU_FEATURE_MMX)  ?  1  :  0);
+    printf("SSE is %x\n", (features & SPAN_CPU_FEATURE_SSE)  ?  1  :  0);
+    printf("SSE2 is %x\n", (features & SPAN_CPU_FEATURE_SSE2)  ?  1  :  0);
+    printf("SSE3 is %x\n", (features & SPAN_CPU_FEATURE_SSE3)  ?  1  :  0);
+    printf("SSSE3 is %x\n", (features & SPAN_CPU_FEATURE_SSSE3)  ?  1  :  0);
+    printf("SSE4.1 is %x\n", (features & SPAN_CPU_FEATURE_SSE4_1)  ?  1  :  0);
+    printf("SSE4.2 is %x\n", (features & SPAN_CPU_FEATURE_SSE4_2)  ?  1  :  0);
+    printf("AVX is %x\n", (features & SPAN_CPU_FEATURE_AVX)  ?  1  :  0);
+    printf("FMA is %x\n", (features & SPAN_CPU_FEATURE_FMA)  ?  1  :  0);
+    printf("AVX2 is %x\n", (features & SPAN_CPU_FEATURE_AVX2)  ?  1  :  0);
+    printf("AVX-512F is %x\n", (features & SPAN_CPU_FEATURE_AVX512F)  ?  1  :  0);
+    printf("AVX-512BW is %x\n", (features & SPAN_CPU_FEATURE_AVX512BW)  ?  1  :  0);
     return 0;
 }
 /*- End of function --------------------------------------------------------*/
-#endif
-
 #endif
 /*- End of file ------------------------------------------------------------*/
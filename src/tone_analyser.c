@@ -0,0 +1,420 @@
+/*
+ * SpanDSP - a series of DSP components for telephony
+ *
+ * tone_analyser.c - A combined set of tone detectors, sharing the work of
+ *                   analysing one audio stream.
+ *
+ * Written by Steve Underwood <steveu@coppice.org>
+ *
+ * Copyright (C) 2026 Steve Underwood
+ *
+ * All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License version 2.1,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+/*! \file */
+
+#if defined(HAVE_CONFIG_H)
+#include "config.h"
+#endif
+
+#include <stdlib.h>
+#include <inttypes.h>
+#include <string.h>
+#include <limits.h>
+#if defined(HAVE_TGMATH_H)
+#include <tgmath.h>
+#endif
+#if defined(HAVE_MATH_H)
+#include <math.h>
+#endif
+#if defined(HAVE_STDBOOL_H)
+#include <stdbool.h>
+#else
+#include "spandsp/stdbool.h"
+#endif
+#include "floating_fudge.h"
+
+#include "spandsp/telephony.h"
+#include "spandsp/alloc.h"
+#include "spandsp/logging.h"
+#include "spandsp/fast_convert.h"
+#include "spandsp/queue.h"
+#include "spandsp/power_meter.h"
+#include "spandsp/complex.h"
+#include "spandsp/dds.h"
+#include "spandsp/tone_detect.h"
+#include "spandsp/tone_generate.h"
+#include "spandsp/super_tone_rx.h"
+#include "spandsp/dtmf.h"
+#include "spandsp/async.h"
+#include "spandsp/fsk.h"
+#include "spandsp/modem_connect_tones.h"
+#include "spandsp/tone_analyser.h"
+
+#include "spandsp/private/logging.h"
+#include "spandsp/private/queue.h"
+#include "spandsp/private/power_meter.h"
+#include "spandsp/private/tone_generate.h"
+#include "spandsp/private/dtmf.h"
+#include "spandsp/private/fsk.h"
+#include "spandsp/private/modem_connect_tones.h"
+#include "spandsp/private/super_tone_rx.h"
+#include "spandsp/private/tone_analyser.h"
+
+#include "tone_analyser_local.h"
+
+static int find_bank(tone_analyser_state_t *s, int samples)
+{
+    int i;
+
+    for (i = 0;  i < s->banks;  i++)
+    {
+        if (s->bank[i].samples == samples)
+            return i;
+        /*endif*/
+    }
+    /*endfor*/
+    if (s->banks >= TONE_ANALYSER_MAX_BANKS)
+        return -1;
+    /*endif*/
+    /* Start a new bank. Its blocks are aligned to the audio from here on. */
+    memset(&s->bank[i], 0, sizeof(s->bank[i]));
+    s->bank[i].samples = samples;
+    s->banks++;
+    return i;
+}
+/*- End of function --------------------------------------------------------*/
+
+static int add_goertzel(tone_analyser_bank_t *bank, goertzel_descriptor_t *desc)
+{
+    int i;
+
+    /* A Goertzel wanted by more than one detector is only run once. */
+    for (i = 0;  i < bank->goertzels;  i++)
+    {
+        if (bank->goertzel[i].fac == desc->fac)
+            return i;
+        /*endif*/
+    }
+    /*endfor*/
+    if (bank->goertzels >= TONE_ANALYSER_MAX_GOERTZELS)
+        return -1;
+    /*endif*/
+    goertzel_init(&bank->goertzel[i], desc);
+    bank->goertzels++;
+    return i;
+}
+/*- End of function --------------------------------------------------------*/
+
+static void run_bank(tone_analyser_bank_t *bank)
+{
+    int i;
+    int j;
+
+    for (j = 0;  j < bank->samples;  j++)
+    {
+        for (i = 0;  i < bank->goertzels;  i++)
+            goertzel_samplex(&bank->goertzel[i], bank->block[j]);
+        /*endfor*/
+    }
+    /*endfor*/
+    for (i = 0;  i < bank->goertzels;  i++)
+        bank->result[i] = goertzel_result(&bank->goertzel[i]);
+    /*endfor*/
+}
+/*- End of function --------------------------------------------------------*/
+
+static __inline__ bool dtmf_uses_bank(tone_analyser_state_t *s, int k)
+{
+    /* With its dialtone filter enabled, the DTMF receiver is passed the raw audio instead. */
+    return (s->dtmf_enabled  &&  s->dtmf_bank == k  &&  !s->dtmf.filter_dialtone);
+}
+/*- End of function --------------------------------------------------------*/
+
+static void bank_block_end(tone_analyser_state_t *s, int k)
+{
+    tone_analyser_bank_t *bank;
+    bool dtmf_wanted;
+    bool super_tone_wanted;
+    int i;
+#if defined(SPANDSP_USE_FIXED_POINT)
+    int32_t row_energy[4];
+    int32_t col_energy[4];
+    int32_t res[SUPER_TONE_BINS/2];
+#else
+    float row_energy[4];
+    float col_energy[4];
+    float res[SUPER_TONE_BINS/2];
+#endif
+
+    bank = &s->bank[k];
+    dtmf_wanted = false;
+    if (dtmf_uses_bank(s, k))
+        dtmf_wanted = !power_gate_block_end(&s->dtmf.gate, DTMF_SAMPLES_PER_BLOCK);
+    /*endif*/
+    super_tone_wanted = false;
+    if (s->super_tone  &&  s->super_tone_bank == k)
+        super_tone_wanted = !power_gate_block_end(&s->super_tone->gate, SUPER_TONE_BINS);
+    /*endif*/
+    /* Only run the Goertzels if at least one detector will look at their results */
+    if (dtmf_wanted  ||  super_tone_wanted)
+        run_bank(bank);
+    /*endif*/
+    if (dtmf_uses_bank(s, k))
+    {
+        for (i = 0;  i < 4;  i++)
+        {
+            if (dtmf_wanted)
+            {
+                row_energy[i] = bank->result[s->dtmf_row[i]];
+                col_energy[i] = bank->result[s->dtmf_col[i]];
+            }
+            else
+            {
+                row_energy[i] = 0;
+                col_energy[i] = 0;
+            }
+            /*endif*/
+        }
+        /*endfor*/
+        dtmf_rx_goertzel_block(&s->dtmf, row_energy, col_energy, bank->energy);
+    }
+    /*endif*/
+    if (s->super_tone  &&  s->super_tone_bank == k)
+    {
+        for (i = 0;  i < s->super_tone->desc->monitored_frequencies;  i++)
+            res[i] = (super_tone_wanted)  ?  bank->result[s->super_tone_map[i]]  :  0;
+        /*endfor*/
+        super_tone_rx_goertzel_block(s->super_tone, res, bank->energy);
+    }
+    /*endif*/
+    bank->energy = 0;
+    bank->current_sample = 0;
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_DECLARE(int) tone_analyser_rx(tone_analyser_state_t *s, const int16_t amp[], int samples)
+{
+    tone_analyser_bank_t *bank;
+    int sample;
+    int len;
+    int i;
+    int j;
+    int k;
+#if defined(SPANDSP_USE_FIXED_POINT)
+    int16_t xamp;
+    int32_t energy;
+#else
+    float xamp;
+    float energy;
+#endif
+
+    for (i = 0;  i < s->modem_connect_tones;  i++)
+        modem_connect_tones_rx(&s->modem_connect_tones_rx[i], amp, samples);
+    /*endfor*/
+    if (s->dtmf_enabled  &&  s->dtmf.filter_dialtone)
+        dtmf_rx(&s->dtmf, amp, samples);
+    /*endif*/
+    if (s->banks == 0)
+        return 0;
+    /*endif*/
+    for (sample = 0;  sample < samples;  sample += len)
+    {
+        /* Work up to the next block end in any of the banks */
+        len = samples - sample;
+        for (k = 0;  k < s->banks;  k++)
+        {
+            if (len > s->bank[k].samples - s->bank[k].current_sample)
+                len = s->bank[k].samples - s->bank[k].current_sample;
+            /*endif*/
+        }
+        /*endfor*/
+        /* Scale each sample, and find its energy, once for all the banks */
+        for (j = 0;  j < len;  j++)
+        {
+            xamp = goertzel_preadjust_amp(amp[sample + j]);
+#if defined(SPANDSP_USE_FIXED_POINT)
+            energy = (int32_t) xamp*xamp;
+#else
+            energy = xamp*xamp;
+#endif
+            for (k = 0;  k < s->banks;  k++)
+            {
+                bank = &s->bank[k];
+                bank->block[bank->current_sample + j] = xamp;
+                bank->energy += energy;
+            }
+            /*endfor*/
+        }
+        /*endfor*/
+        if (dtmf_uses_bank(s, s->dtmf_bank))
+            power_gate_update(&s->dtmf.gate, &amp[sample], len);
+        /*endif*/
+        if (s->super_tone)
+            power_gate_update(&s->super_tone->gate, &amp[sample], len);
+        /*endif*/
+        for (k = 0;  k < s->banks;  k++)
+        {
+            s->bank[k].current_sample += len;
+            if (s->bank[k].current_sample >= s->bank[k].samples)
+                bank_block_end(s, k);
+            /*endif*/
+        }
+        /*endfor*/
+    }
+    /*endfor*/
+    return 0;
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_DECLARE(dtmf_rx_state_t *) tone_analyser_enable_dtmf(tone_analyser_state_t *s,
+                                                          digits_rx_callback_t callback,
+                                                          void *user_data)
+{
+    goertzel_descriptor_t desc;
+    int k;
+    int i;
+
+    if (s->dtmf_enabled)
+        return NULL;
+    /*endif*/
+    if ((k = find_bank(s, DTMF_SAMPLES_PER_BLOCK)) < 0)
+        return NULL;
+    /*endif*/
+    dtmf_rx_init(&s->dtmf, callback, user_data);
+    /* Pick up the receiver's own Goertzels, so the bank runs exactly the same filters */
+    for (i = 0;  i < 4;  i++)
+    {
+        desc.fac = s->dtmf.row_out[i].fac;
+        desc.samples = s->dtmf.row_out[i].samples;
+        s->dtmf_row[i] = add_goertzel(&s->bank[k], &desc);
+        desc.fac = s->dtmf.col_out[i].fac;
+        desc.samples = s->dtmf.col_out[i].samples;
+        s->dtmf_col[i] = add_goertzel(&s->bank[k], &desc);
+    }
+    /*endfor*/
+    s->dtmf_bank = k;
+    s->dtmf_enabled = true;
+    return &s->dtmf;
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_DECLARE(modem_connect_tones_rx_state_t *) tone_analyser_enable_modem_connect_tones(tone_analyser_state_t *s,
+                                                                                         int tone_type,
+                                                                                         span_tone_report_func_t callback,
+                                                                                         void *user_data)
+{
+    modem_connect_tones_rx_state_t *rx;
+
+    if (s->modem_connect_tones >= TONE_ANALYSER_MAX_MODEM_CONNECT_TONES)
+        return NULL;
+    /*endif*/
+    rx = &s->modem_connect_tones_rx[s->modem_connect_tones];
+    if (modem_connect_tones_rx_init(rx, tone_type, callback, user_data) == NULL)
+        return NULL;
+    /*endif*/
+    s->modem_connect_tones++;
+    return rx;
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_DECLARE(super_tone_rx_state_t *) tone_analyser_enable_super_tone(tone_analyser_state_t *s,
+                                                                      super_tone_rx_descriptor_t *desc,
+                                                                      span_tone_report_func_t callback,
+                                                                      void *user_data)
+{
+    int k;
+    int i;
+
+    if (s->super_tone)
+        return NULL;
+    /*endif*/
+    if ((k = find_bank(s, SUPER_TONE_BINS)) < 0)
+        return NULL;
+    /*endif*/
+    if (s->bank[k].goertzels + desc->monitored_frequencies > TONE_ANALYSER_MAX_GOERTZELS)
+        return NULL;
+    /*endif*/
+    if ((s->super_tone = super_tone_rx_init(NULL, desc, callback, user_data)) == NULL)
+        return NULL;
+    /*endif*/
+    for (i = 0;  i < desc->monitored_frequencies;  i++)
+        s->super_tone_map[i] = add_goertzel(&s->bank[k], &desc->desc[i]);
+    /*endfor*/
+    s->super_tone_bank = k;
+    return s->super_tone;
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_DECLARE(int) tone_analyser_get_goertzels(tone_analyser_state_t *s)
+{
+    int goertzels;
+    int k;
+
+    goertzels = 0;
+    for (k = 0;  k < s->banks;  k++)
+        goertzels += s->bank[k].goertzels;
+    /*endfor*/
+    return goertzels;
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_DECLARE(tone_analyser_state_t *) tone_analyser_init(tone_analyser_state_t *s)
+{
+    if (s == NULL)
+    {
+        if ((s = (tone_analyser_state_t *) span_alloc(sizeof(*s))) == NULL)
+            return NULL;
+        /*endif*/
+    }
+    /*endif*/
+    memset(s, 0, sizeof(*s));
+    return s;
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_DECLARE(int) tone_analyser_release(tone_analyser_state_t *s)
+{
+    int i;
+
+    if (s->dtmf_enabled)
+        dtmf_rx_release(&s->dtmf);
+    /*endif*/
+    for (i = 0;  i < s->modem_connect_tones;  i++)
+        modem_connect_tones_rx_release(&s->modem_connect_tones_rx[i]);
+    /*endfor*/
+    if (s->super_tone)
+    {
+        super_tone_rx_free(s->super_tone);
+        s->super_tone = NULL;
+    }
+    /*endif*/
+    return 0;
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_DECLARE(int) tone_analyser_free(tone_analyser_state_t *s)
+{
+    if (s)
+    {
+        tone_analyser_release(s);
+        span_free(s);
+    }
+    /*endif*/
+    return 0;
+}
+/*- End of function --------------------------------------------------------*/
+/*- End of file ------------------------------------------------------------*/
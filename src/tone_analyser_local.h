@@ -0,0 +1,60 @@
+/*
+ * SpanDSP - a series of DSP components for telephony
+ *
+ * tone_analyser_local.h - definitions shared between the tone analyser and
+ *                         the detectors it feeds.
+ *
+ * Written by Steve Underwood <steveu@coppice.org>
+ *
+ * Copyright (C) 2026 Steve Underwood
+ *
+ * All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License version 2.1,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+/*! \file */
+
+#if !defined(_TONE_ANALYSER_LOCAL_H_)
+#define _TONE_ANALYSER_LOCAL_H_
+
+#if defined(__cplusplus)
+extern "C"
+{
+#endif
+
+/* Complete a DTMF receiver block, using Goertzel results and a total energy worked
+   out by the caller over DTMF_SAMPLES_PER_BLOCK samples. */
+#if defined(SPANDSP_USE_FIXED_POINT)
+void dtmf_rx_goertzel_block(dtmf_rx_state_t *s, const int32_t row_energy[4], const int32_t col_energy[4], int32_t energy);
+#else
+void dtmf_rx_goertzel_block(dtmf_rx_state_t *s, const float row_energy[4], const float col_energy[4], float energy);
+#endif
+
+/* Complete a supervisory tone receiver block, using Goertzel results and a total energy
+   worked out by the caller over SUPER_TONE_BINS samples. The results are only examined
+   if the total energy is high enough for a tone to be reported, so the caller may skip
+   the Goertzels for blocks the receiver's power gate finds to be quiet. */
+#if defined(SPANDSP_USE_FIXED_POINT)
+void super_tone_rx_goertzel_block(super_tone_rx_state_t *s, const int32_t res[], float energy);
+#else
+void super_tone_rx_goertzel_block(super_tone_rx_state_t *s, const float res[], float energy);
+#endif
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif
+/*- End of file ------------------------------------------------------------*/
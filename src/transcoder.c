@@ -0,0 +1,452 @@
+/*
+ * SpanDSP - a series of DSP components for telephony
+ *
+ * transcoder.c - Transcode a stream of audio between any of the speech codecs.
+ *
+ * Written by Steve Underwood <steveu@coppice.org>
+ *
+ * Copyright (C) 2026 Steve Underwood
+ *
+ * All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License version 2.1,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+/*! \file */
+
+#if defined(HAVE_CONFIG_H)
+#include "config.h"
+#endif
+
+#include <stdlib.h>
+#include <inttypes.h>
+#include <string.h>
+#if defined(HAVE_TGMATH_H)
+#include <tgmath.h>
+#endif
+#if defined(HAVE_MATH_H)
+#include <math.h>
+#endif
+#if defined(HAVE_STDBOOL_H)
+#include <stdbool.h>
+#else
+#include "spandsp/stdbool.h"
+#endif
+#include "floating_fudge.h"
+
+#include "spandsp/telephony.h"
+#include "spandsp/alloc.h"
+#include "spandsp/fast_convert.h"
+#include "spandsp/saturated.h"
+#include "spandsp/bitstream.h"
+#include "spandsp/bit_operations.h"
+#include "spandsp/g711.h"
+#include "spandsp/g722.h"
+#include "spandsp/g726.h"
+#include "spandsp/gsm0610.h"
+#include "spandsp/ima_adpcm.h"
+#include "spandsp/oki_adpcm.h"
+#include "spandsp/lpc10.h"
+#include "spandsp/resample.h"
+#include "spandsp/transcoder.h"
+
+#include "spandsp/private/bitstream.h"
+#include "spandsp/private/g711.h"
+#include "spandsp/private/g722.h"
+#include "spandsp/private/g726.h"
+#include "spandsp/private/gsm0610.h"
+#include "spandsp/private/ima_adpcm.h"
+#include "spandsp/private/oki_adpcm.h"
+#include "spandsp/private/lpc10.h"
+#include "spandsp/private/resample.h"
+#include "spandsp/private/transcoder.h"
+
+typedef struct
+{
+    /*! The sample rate, in samples/second. */
+    int sample_rate;
+    /*! The number of samples in the smallest whole unit of data. */
+    int frame_samples;
+    /*! The number of bytes in the smallest whole unit of data. */
+    int frame_bytes;
+    /*! True if the codec needs to be passed exactly one frame at a time. */
+    bool one_frame_per_call;
+} transcoder_format_t;
+
+static const transcoder_format_t formats[TRANSCODER_FORMATS] =
+{
+    { 8000,   1,  2, false},            /* TRANSCODER_LINEAR_8000 */
+    {16000,   1,  2, false},            /* TRANSCODER_LINEAR_16000 */
+    { 8000,   1,  1, false},            /* TRANSCODER_ALAW */
+    { 8000,   1,  1, false},            /* TRANSCODER_ULAW */
+    {16000,   2,  1, false},            /* TRANSCODER_G722_64000 */
+    {16000,  16,  7, false},            /* TRANSCODER_G722_56000 */
+    {16000,  16,  6, false},            /* TRANSCODER_G722_48000 */
+    { 8000,   4,  1, false},            /* TRANSCODER_G726_16000 */
+    { 8000,   8,  3, false},            /* TRANSCODER_G726_24000 */
+    { 8000,   2,  1, false},            /* TRANSCODER_G726_32000 */
+    { 8000,   8,  5, false},            /* TRANSCODER_G726_40000 */
+    { 8000, 160, 33, false},            /* TRANSCODER_GSM0610 */
+    { 8000, 160, 84, true},             /* TRANSCODER_IMA_ADPCM */
+    { 8000,   8,  3, false},            /* TRANSCODER_OKI_ADPCM_24000 */
+    { 8000,   2,  1, false},            /* TRANSCODER_OKI_ADPCM_32000 */
+    { 8000, 180,  7, false}             /* TRANSCODER_LPC10 */
+};
+
+static int decode(transcoder_state_t *s, int16_t amp[], const uint8_t data[], int len)
+{
+    switch (s->in_format)
+    {
+    case TRANSCODER_LINEAR_8000:
+    case TRANSCODER_LINEAR_16000:
+        memcpy(amp, data, len);
+        return len/sizeof(int16_t);
+    case TRANSCODER_ALAW:
+    case TRANSCODER_ULAW:
+        return g711_decode(&s->dec.g711, amp, data, len);
+    case TRANSCODER_G722_64000:
+    case TRANSCODER_G722_56000:
+    case TRANSCODER_G722_48000:
+        return g722_decode(&s->dec.g722, amp, data, len);
+    case TRANSCODER_G726_16000:
+    case TRANSCODER_G726_24000:
+    case TRANSCODER_G726_32000:
+    case TRANSCODER_G726_40000:
+        return g726_decode(&s->dec.g726, amp, data, len);
+    case TRANSCODER_GSM0610:
+        return gsm0610_decode(&s->dec.gsm0610, amp, data, len);
+    case TRANSCODER_IMA_ADPCM:
+        return ima_adpcm_decode(&s->dec.ima_adpcm, amp, data, len);
+    case TRANSCODER_OKI_ADPCM_24000:
+    case TRANSCODER_OKI_ADPCM_32000:
+        return oki_adpcm_decode(&s->dec.oki_adpcm, amp, data, len);
+    case TRANSCODER_LPC10:
+        return lpc10_decode(&s->dec.lpc10, amp, data, len);
+    }
+    /*endswitch*/
+    return 0;
+}
+/*- End of function --------------------------------------------------------*/
+
+static int encode(transcoder_state_t *s, uint8_t data[], const int16_t amp[], int len)
+{
+    switch (s->out_format)
+    {
+    case TRANSCODER_LINEAR_8000:
+    case TRANSCODER_LINEAR_16000:
+        memcpy(data, amp, len*sizeof(int16_t));
+        return len*sizeof(int16_t);
+    case TRANSCODER_ALAW:
+    case TRANSCODER_ULAW:
+        return g711_encode(&s->enc.g711, data, amp, len);
+    case TRANSCODER_G722_64000:
+    case TRANSCODER_G722_56000:
+    case TRANSCODER_G722_48000:
+        return g722_encode(&s->enc.g722, data, amp, len);
+    case TRANSCODER_G726_16000:
+    case TRANSCODER_G726_24000:
+    case TRANSCODER_G726_32000:
+    case TRANSCODER_G726_40000:
+        return g726_encode(&s->enc.g726, data, amp, len);
+    case TRANSCODER_GSM0610:
+        return gsm0610_encode(&s->enc.gsm0610, data, amp, len);
+    case TRANSCODER_IMA_ADPCM:
+        return ima_adpcm_encode(&s->enc.ima_adpcm, data, amp, len);
+    case TRANSCODER_OKI_ADPCM_24000:
+    case TRANSCODER_OKI_ADPCM_32000:
+        return oki_adpcm_encode(&s->enc.oki_adpcm, data, amp, len);
+    case TRANSCODER_LPC10:
+        return lpc10_encode(&s->enc.lpc10, data, amp, len);
+    }
+    /*endswitch*/
+    return 0;
+}
+/*- End of function --------------------------------------------------------*/
+
+static int decode_frames(transcoder_state_t *s, uint8_t out[], const uint8_t in[], int frames)
+{
+    const transcoder_format_t *in_fmt;
+    const transcoder_format_t *out_fmt;
+    int16_t *amp;
+    int samples;
+    int step;
+    int i;
+    int j;
+    int n;
+    int len;
+
+    in_fmt = &formats[s->in_format];
+    out_fmt = &formats[s->out_format];
+    /* When the rates match, decode straight into the encoder's buffer. */
+    amp = (in_fmt->sample_rate == out_fmt->sample_rate)  ?  &s->linear[s->linear_len]  :  s->decoded;
+    samples = 0;
+    step = (in_fmt->one_frame_per_call)  ?  1  :  frames;
+    for (i = 0;  i < frames;  i += step)
+        samples += decode(s, &amp[samples], &in[i*in_fmt->frame_bytes], step*in_fmt->frame_bytes);
+    /*endfor*/
+    if (in_fmt->sample_rate == out_fmt->sample_rate)
+        s->linear_len += samples;
+    else
+        s->linear_len += resample(&s->resampler, &s->linear[s->linear_len], amp, samples);
+    /*endif*/
+
+    /* Encode all the whole frames now available, straight into the caller's buffer. */
+    frames = s->linear_len/out_fmt->frame_samples;
+    step = (out_fmt->one_frame_per_call)  ?  1  :  frames;
+    len = 0;
+    for (i = 0, j = 0;  i < frames;  i += step, j += n)
+    {
+        n = step*out_fmt->frame_samples;
+        len += encode(s, &out[len], &s->linear[j], n);
+    }
+    /*endfor*/
+    if (j < s->linear_len)
+        memmove(s->linear, &s->linear[j], (s->linear_len - j)*sizeof(int16_t));
+    /*endif*/
+    s->linear_len -= j;
+    return len;
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_DECLARE(int) transcoder_format_sample_rate(int format)
+{
+    if (format < 0  ||  format >= TRANSCODER_FORMATS)
+        return -1;
+    /*endif*/
+    return formats[format].sample_rate;
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_DECLARE(int) transcoder_max_output(transcoder_state_t *s, int len)
+{
+    const transcoder_format_t *in_fmt;
+    const transcoder_format_t *out_fmt;
+    int samples;
+
+    if (s->in_format == s->out_format
+        ||
+        ((s->in_format == TRANSCODER_ALAW  ||  s->in_format == TRANSCODER_ULAW)
+         &&
+         (s->out_format == TRANSCODER_ALAW  ||  s->out_format == TRANSCODER_ULAW)))
+    {
+        return len;
+    }
+    /*endif*/
+    in_fmt = &formats[s->in_format];
+    out_fmt = &formats[s->out_format];
+    samples = (s->frame_len + len)/in_fmt->frame_bytes*in_fmt->frame_samples;
+    if (in_fmt->sample_rate != out_fmt->sample_rate)
+        samples = resample_max_output(&s->resampler, samples);
+    /*endif*/
+    samples += s->linear_len;
+    return samples/out_fmt->frame_samples*out_fmt->frame_bytes;
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_DECLARE(int) transcoder_transcode(transcoder_state_t *s, uint8_t out[], const uint8_t in[], int len)
+{
+    const transcoder_format_t *in_fmt;
+    int outlen;
+    int frames;
+    int max_frames;
+    int n;
+    int i;
+
+    if (s->in_format == s->out_format)
+    {
+        memcpy(out, in, len);
+        return len;
+    }
+    /*endif*/
+    if ((s->in_format == TRANSCODER_ALAW  &&  s->out_format == TRANSCODER_ULAW)
+        ||
+        (s->in_format == TRANSCODER_ULAW  &&  s->out_format == TRANSCODER_ALAW))
+    {
+        return g711_transcode(&s->dec.g711, out, in, len);
+    }
+    /*endif*/
+
+    in_fmt = &formats[s->in_format];
+    outlen = 0;
+    i = 0;
+    if (s->frame_len > 0)
+    {
+        /* Complete the partial frame held from the last call */
+        n = in_fmt->frame_bytes - s->frame_len;
+        if (n > len)
+            n = len;
+        /*endif*/
+        memcpy(&s->frame[s->frame_len], in, n);
+        s->frame_len += n;
+        i = n;
+        if (s->frame_len < in_fmt->frame_bytes)
+            return 0;
+        /*endif*/
+        outlen += decode_frames(s, &out[outlen], s->frame, 1);
+        s->frame_len = 0;
+    }
+    /*endif*/
+    /* Decode as many frames at a time as the buffers allow, straight from the caller's buffer */
+    max_frames = TRANSCODER_CHUNK_SAMPLES/in_fmt->frame_samples;
+    while ((frames = (len - i)/in_fmt->frame_bytes) > 0)
+    {
+        if (frames > max_frames)
+            frames = max_frames;
+        /*endif*/
+        outlen += decode_frames(s, &out[outlen], &in[i], frames);
+        i += frames*in_fmt->frame_bytes;
+    }
+    /*endwhile*/
+    /* Keep any partial frame for next time */
+    if (i < len)
+    {
+        s->frame_len = len - i;
+        memcpy(s->frame, &in[i], s->frame_len);
+    }
+    /*endif*/
+    return outlen;
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_DECLARE(int) transcoder_batch(transcoder_state_t *s[],
+                                   uint8_t *out[],
+                                   int out_len[],
+                                   const uint8_t *in[],
+                                   const int in_len[],
+                                   int streams)
+{
+    int total;
+    int i;
+
+    total = 0;
+    for (i = 0;  i < streams;  i++)
+    {
+        out_len[i] = transcoder_transcode(s[i], out[i], in[i], in_len[i]);
+        total += out_len[i];
+    }
+    /*endfor*/
+    return total;
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_DECLARE(transcoder_state_t *) transcoder_init(transcoder_state_t *s, int in_format, int out_format)
+{
+    static const int g722_rates[3] = {64000, 56000, 48000};
+    static const int g726_rates[4] = {16000, 24000, 32000, 40000};
+
+    if (in_format < 0  ||  in_format >= TRANSCODER_FORMATS  ||  out_format < 0  ||  out_format >= TRANSCODER_FORMATS)
+        return NULL;
+    /*endif*/
+    if (s == NULL)
+    {
+        if ((s = (transcoder_state_t *) span_alloc(sizeof(*s))) == NULL)
+            return NULL;
+        /*endif*/
+    }
+    /*endif*/
+    memset(s, 0, sizeof(*s));
+    s->in_format = in_format;
+    s->out_format = out_format;
+    switch (in_format)
+    {
+    case TRANSCODER_ALAW:
+        g711_init(&s->dec.g711, G711_ALAW);
+        break;
+    case TRANSCODER_ULAW:
+        g711_init(&s->dec.g711, G711_ULAW);
+        break;
+    case TRANSCODER_G722_64000:
+    case TRANSCODER_G722_56000:
+    case TRANSCODER_G722_48000:
+        g722_decode_init(&s->dec.g722, g722_rates[in_format - TRANSCODER_G722_64000], G722_PACKED);
+        break;
+    case TRANSCODER_G726_16000:
+    case TRANSCODER_G726_24000:
+    case TRANSCODER_G726_32000:
+    case TRANSCODER_G726_40000:
+        g726_init(&s->dec.g726, g726_rates[in_format - TRANSCODER_G726_16000], G726_ENCODING_LINEAR, G726_PACKING_RIGHT);
+        break;
+    case TRANSCODER_GSM0610:
+        gsm0610_init(&s->dec.gsm0610, GSM0610_PACKING_VOIP);
+        break;
+    case TRANSCODER_IMA_ADPCM:
+        ima_adpcm_init(&s->dec.ima_adpcm, IMA_ADPCM_DVI4, 0);
+        break;
+    case TRANSCODER_OKI_ADPCM_24000:
+        oki_adpcm_init(&s->dec.oki_adpcm, 24000);
+        break;
+    case TRANSCODER_OKI_ADPCM_32000:
+        oki_adpcm_init(&s->dec.oki_adpcm, 32000);
+        break;
+    case TRANSCODER_LPC10:
+        lpc10_decode_init(&s->dec.lpc10, false);
+        break;
+    }
+    /*endswitch*/
+    switch (out_format)
+    {
+    case TRANSCODER_ALAW:
+        g711_init(&s->enc.g711, G711_ALAW);
+        break;
+    case TRANSCODER_ULAW:
+        g711_init(&s->enc.g711, G711_ULAW);
+        break;
+    case TRANSCODER_G722_64000:
+    case TRANSCODER_G722_56000:
+    case TRANSCODER_G722_48000:
+        g722_encode_init(&s->enc.g722, g722_rates[out_format - TRANSCODER_G722_64000], G722_PACKED);
+        break;
+    case TRANSCODER_G726_16000:
+    case TRANSCODER_G726_24000:
+    case TRANSCODER_G726_32000:
+    case TRANSCODER_G726_40000:
+        g726_init(&s->enc.g726, g726_rates[out_format - TRANSCODER_G726_16000], G726_ENCODING_LINEAR, G726_PACKING_RIGHT);
+        break;
+    case TRANSCODER_GSM0610:
+        gsm0610_init(&s->enc.gsm0610, GSM0610_PACKING_VOIP);
+        break;
+    case TRANSCODER_IMA_ADPCM:
+        ima_adpcm_init(&s->enc.ima_adpcm, IMA_ADPCM_DVI4, 0);
+        break;
+    case TRANSCODER_OKI_ADPCM_24000:
+        oki_adpcm_init(&s->enc.oki_adpcm, 24000);
+        break;
+    case TRANSCODER_OKI_ADPCM_32000:
+        oki_adpcm_init(&s->enc.oki_adpcm, 32000);
+        break;
+    case TRANSCODER_LPC10:
+        lpc10_encode_init(&s->enc.lpc10, false);
+        break;
+    }
+    /*endswitch*/
+    if (formats[in_format].sample_rate != formats[out_format].sample_rate)
+        resample_init(&s->resampler, formats[in_format].sample_rate, formats[out_format].sample_rate, RESAMPLE_STANDARD);
+    /*endif*/
+    return s;
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_DECLARE(int) transcoder_release(transcoder_state_t *s)
+{
+    return 0;
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_DECLARE(int) transcoder_free(transcoder_state_t *s)
+{
+    span_free(s);
+    return 0;
+}
+/*- End of function --------------------------------------------------------*/
+/*- End of file ------------------------------------------------------------*/
@@ -46,8 +46,10 @@
 #include "spandsp/stdbool.h"
 #endif
 #include "floating_fudge.h"
+#include "mmx_sse_decs.h"
 
 #include "spandsp/telephony.h"
+#include "spandsp/cpu_features.h"
 #include "spandsp/alloc.h"
 #include "spandsp/logging.h"
 #include "spandsp/fast_convert.h"
@@ -226,6 +228,61 @@ SPAN_DECLARE(int) v17_rx_equalizer_state(v17_rx_state_t *s, complexf_t **coeffs)
 }
 /*- End of function --------------------------------------------------------*/
 
+SPAN_DECLARE(int) v17_rx_export_training(v17_rx_state_t *s, uint32_t route_id, uint8_t buf[], int max_len)
+{
+    v17_rx_training_record_t rec;
+
+    if (buf == NULL)
+        return sizeof(rec);
+    /*endif*/
+    if (max_len < (int) sizeof(rec))
+        return -1;
+    /*endif*/
+    /* The saved values only hold a usable training after a successful training, or an import */
+    if (!s->short_train  ||  s->agc_scaling_save == FP_SCALE(0.0f))
+        return -1;
+    /*endif*/
+    memset(&rec, 0, sizeof(rec));
+    rec.route_id = route_id;
+    rec.bit_rate = s->bit_rate;
+    rec.carrier_phase_rate = s->carrier_phase_rate_save;
+    rec.agc_scaling = s->agc_scaling_save;
+#if defined(SPANDSP_USE_FIXED_POINTx)
+    cvec_copyi16(rec.eq_coeff, s->eq_coeff_save, V17_EQUALIZER_LEN);
+#else
+    cvec_copyf(rec.eq_coeff, s->eq_coeff_save, V17_EQUALIZER_LEN);
+#endif
+    memcpy(buf, &rec, sizeof(rec));
+    return sizeof(rec);
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_DECLARE(int) v17_rx_import_training(v17_rx_state_t *s, uint32_t route_id, const uint8_t buf[], int len)
+{
+    v17_rx_training_record_t rec;
+
+    /* The length check also rejects training exported by a fixed point build into a floating
+       point one, or vice versa. */
+    if (len != (int) sizeof(rec))
+        return -1;
+    /*endif*/
+    memcpy(&rec, buf, sizeof(rec));
+    if (rec.route_id != route_id  ||  rec.agc_scaling == FP_SCALE(0.0f))
+        return -1;
+    /*endif*/
+    span_log(&s->logging, SPAN_LOG_FLOW, "Importing training for route %u, obtained at %dbps\n", (unsigned int) route_id, rec.bit_rate);
+#if defined(SPANDSP_USE_FIXED_POINTx)
+    cvec_copyi16(s->eq_coeff_save, rec.eq_coeff, V17_EQUALIZER_LEN);
+#else
+    cvec_copyf(s->eq_coeff_save, rec.eq_coeff, V17_EQUALIZER_LEN);
+#endif
+    s->carrier_phase_rate_save = rec.carrier_phase_rate;
+    s->agc_scaling_save = rec.agc_scaling;
+    s->short_train = true;
+    return 0;
+}
+/*- End of function --------------------------------------------------------*/
+
 static void equalizer_save(v17_rx_state_t *s)
 {
 #if defined(SPANDSP_USE_FIXED_POINTx)
@@ -406,6 +463,104 @@ static __inline__ float dist_sq(const complexf_t *x, const complexf_t *y)
 /*- End of function --------------------------------------------------------*/
 #endif
 
+/* The trellis paths, arranged by candidate rather than by state. For state i, and
+   candidate j, the branch into the state is from the candidate constellation point
+   trellis_branch[j][i], and the past state is trellis_past_state[j][i]. Each row is a
+   complete set of SIMD permutation indices for the 8 states. */
+static const int32_t trellis_branch[4][8] =
+{
+    {0, 6, 2, 4, 1, 5, 7, 3},
+    {6, 0, 4, 2, 3, 7, 5, 1},
+    {2, 4, 0, 6, 7, 3, 1, 5},
+    {4, 2, 6, 0, 5, 1, 3, 7}
+};
+static const int32_t trellis_past_state[4][8] =
+{
+    {0, 0, 0, 0, 1, 1, 1, 1},
+    {2, 2, 2, 2, 3, 3, 3, 3},
+    {4, 4, 4, 4, 5, 5, 5, 5},
+    {6, 6, 6, 6, 7, 7, 7, 7}
+};
+
+#if defined(SPANDSP_USE_RUNTIME_DISPATCH)  &&  !defined(SPANDSP_USE_FIXED_POINTx)
+/* The 8 branch distances, and the add-compare-select for the 8 trellis states, are each
+   done as one pass across 8 lanes. Multiplies and adds are kept separate, and the
+   candidates are compared in the same order as the scalar code, so the results are
+   exactly the same. */
+SPAN_TARGET("avx2") static void branch_distances_avx2(float distances[8],
+                                                      const complexf_t constellation[],
+                                                      const uint8_t candidates[8],
+                                                      const complexf_t *z)
+{
+    __m256i idx;
+    __m256 re;
+    __m256 im;
+
+    idx = _mm256_slli_epi32(_mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i *) candidates)), 1);
+    re = _mm256_i32gather_ps(&constellation[0].re, idx, 4);
+    im = _mm256_i32gather_ps(&constellation[0].im, idx, 4);
+    re = _mm256_sub_ps(re, _mm256_set1_ps(z->re));
+    im = _mm256_sub_ps(im, _mm256_set1_ps(z->im));
+    _mm256_storeu_ps(distances, _mm256_add_ps(_mm256_mul_ps(re, re), _mm256_mul_ps(im, im)));
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_TARGET("avx2") static void trellis_acs_avx2(v17_rx_state_t *s,
+                                                 const uint8_t candidates[8],
+                                                 const float distances[8])
+{
+    __m256 branch_distances;
+    __m256 past_distances;
+    __m256 branch;
+    __m256 past;
+    __m256 sum;
+    __m256 lt;
+    __m256 best_branch;
+    __m256 best_past;
+    __m256 best_sum;
+    __m256i path;
+    __m256i state;
+    __m256i best_path;
+    __m256i best_state;
+    __m256i points;
+    int j;
+
+    branch_distances = _mm256_loadu_ps(distances);
+    past_distances = _mm256_loadu_ps(s->distances);
+    best_path = _mm256_loadu_si256((const __m256i *) trellis_branch[0]);
+    best_state = _mm256_loadu_si256((const __m256i *) trellis_past_state[0]);
+    best_branch = _mm256_permutevar8x32_ps(branch_distances, best_path);
+    best_past = _mm256_permutevar8x32_ps(past_distances, best_state);
+    best_sum = _mm256_add_ps(best_branch, best_past);
+    for (j = 1;  j < 4;  j++)
+    {
+        path = _mm256_loadu_si256((const __m256i *) trellis_branch[j]);
+        state = _mm256_loadu_si256((const __m256i *) trellis_past_state[j]);
+        branch = _mm256_permutevar8x32_ps(branch_distances, path);
+        past = _mm256_permutevar8x32_ps(past_distances, state);
+        sum = _mm256_add_ps(branch, past);
+        /* Only a strictly smaller distance replaces the current best, so the earliest
+           candidate wins a tie, as in the scalar code. */
+        lt = _mm256_cmp_ps(sum, best_sum, _CMP_LT_OQ);
+        best_sum = _mm256_blendv_ps(best_sum, sum, lt);
+        best_branch = _mm256_blendv_ps(best_branch, branch, lt);
+        best_past = _mm256_blendv_ps(best_past, past, lt);
+        best_path = _mm256_castps_si256(_mm256_blendv_ps(_mm256_castsi256_ps(best_path), _mm256_castsi256_ps(path), lt));
+        best_state = _mm256_castps_si256(_mm256_blendv_ps(_mm256_castsi256_ps(best_state), _mm256_castsi256_ps(state), lt));
+    }
+    /*endfor*/
+    /* Use an elementary IIR filter to track the distance to date. */
+    _mm256_storeu_ps(s->distances,
+                     _mm256_add_ps(_mm256_mul_ps(best_past, _mm256_set1_ps(0.9f)),
+                                   _mm256_mul_ps(best_branch, _mm256_set1_ps(0.1f))));
+    points = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i *) candidates));
+    _mm256_storeu_si256((__m256i *) s->full_path_to_past_state_locations[s->trellis_ptr],
+                        _mm256_permutevar8x32_epi32(points, best_path));
+    _mm256_storeu_si256((__m256i *) s->past_state_locations[s->trellis_ptr], best_state);
+}
+/*- End of function --------------------------------------------------------*/
+#endif
+
 #if defined(SPANDSP_USE_FIXED_POINTx)
 static int decode_baud(v17_rx_state_t *s, complexi16_t *z)
 #else
@@ -426,17 +581,6 @@ static int decode_baud(v17_rx_state_t *s, complexf_t *z)
         {2, 3, 0, 1},
         {1, 2, 3, 0}
     };
-    static const uint8_t tcm_paths[8][4] =
-    {
-        {0, 6, 2, 4},
-        {6, 0, 4, 2},
-        {2, 4, 0, 6},
-        {4, 2, 6, 0},
-        {1, 3, 7, 5},
-        {5, 7, 3, 1},
-        {7, 5, 1, 3},
-        {3, 1, 5, 7}
-    };
     int nearest;
     int i;
     int j;
@@ -445,8 +589,8 @@ static int decode_baud(v17_rx_state_t *s, complexf_t *z)
     int im;
     int raw;
     int min_index;
-    int set;
     int constellation_state;
+    const uint8_t *candidates;
 #if defined(SPANDSP_USE_FIXED_POINTx)
 #define DIST_FACTOR 1024    /* Something less than sqrt(0xFFFFFFFF/10)/10 */
     complexi32_t zi;
@@ -497,17 +641,32 @@ static int decode_baud(v17_rx_state_t *s, complexf_t *z)
 #else
     min = 9999999.0f;
 #endif
-    min_index = 0;
-    for (i = 0;  i < 8;  i++)
+    candidates = constel_maps[s->space_map][re][im];
+#if defined(SPANDSP_USE_RUNTIME_DISPATCH)  &&  !defined(SPANDSP_USE_FIXED_POINTx)
+    if ((span_cpu_dispatch_features & SPAN_CPU_FEATURE_AVX2))
+    {
+        branch_distances_avx2(distances, s->constellation, candidates, z);
+    }
+    else
+#endif
     {
-        nearest = constel_maps[s->space_map][re][im][i];
+        for (i = 0;  i < 8;  i++)
+        {
+            nearest = candidates[i];
 #if defined(SPANDSP_USE_FIXED_POINTx)
-        ci = complex_seti32(s->constellation[nearest].re*DIST_FACTOR,
-                            s->constellation[nearest].im*DIST_FACTOR);
-        distances[i] = dist_sq(&ci, &zi);
+            ci = complex_seti32(s->constellation[nearest].re*DIST_FACTOR,
+                                s->constellation[nearest].im*DIST_FACTOR);
+            distances[i] = dist_sq(&ci, &zi);
 #else
-        distances[i] = dist_sq(&s->constellation[nearest], z);
+            distances[i] = dist_sq(&s->constellation[nearest], z);
 #endif
+        }
+        /*endfor*/
+    }
+    /*endif*/
+    min_index = 0;
+    for (i = 0;  i < 8;  i++)
+    {
         if (min > distances[i])
         {
             min = distances[i];
@@ -520,47 +679,53 @@ static int decode_baud(v17_rx_state_t *s, complexf_t *z)
        tracking. This is a compromise. It means we will use the correct error
        less often, but using the output of the traceback would put more lag
        into the feedback path. */
-    constellation_state = constel_maps[s->space_map][re][im][min_index];
+    constellation_state = candidates[min_index];
     track_carrier(s, z, &s->constellation[constellation_state]);
     //tune_equalizer(s, z, &s->constellation[constellation_state]);
 
     /* Now do the trellis decoding */
 
-    /* TODO: change to processing blocks of stored symbols here, instead of processing
-             one symbol at a time, to speed up the processing. */
-
     /* Update the minimum accumulated distance to each of the 8 states */
     if (++s->trellis_ptr >= V17_TRELLIS_STORAGE_DEPTH)
         s->trellis_ptr = 0;
     /*endif*/
-    for (i = 0;  i < 8;  i++)
+#if defined(SPANDSP_USE_RUNTIME_DISPATCH)  &&  !defined(SPANDSP_USE_FIXED_POINTx)
+    if ((span_cpu_dispatch_features & SPAN_CPU_FEATURE_AVX2))
+    {
+        trellis_acs_avx2(s, candidates, distances);
+    }
+    else
+#endif
     {
-        set = i >> 2;
-        min = distances[tcm_paths[i][0]] + s->distances[set];
-        min_index = 0;
-        for (j = 1;  j < 4;  j++)
+        for (i = 0;  i < 8;  i++)
         {
-            k = (j << 1) + set;
-            if (min > distances[tcm_paths[i][j]] + s->distances[k])
+            min = distances[trellis_branch[0][i]] + s->distances[trellis_past_state[0][i]];
+            min_index = 0;
+            for (j = 1;  j < 4;  j++)
             {
-                min = distances[tcm_paths[i][j]] + s->distances[k];
-                min_index = j;
+                k = trellis_past_state[j][i];
+                if (min > distances[trellis_branch[j][i]] + s->distances[k])
+                {
+                    min = distances[trellis_branch[j][i]] + s->distances[k];
+                    min_index = j;
+                }
+                /*endif*/
             }
-            /*endif*/
-        }
-        /*endfor*/
-        k = (min_index << 1) + set;
-        /* Use an elementary IIR filter to track the distance to date. */
+            /*endfor*/
+            k = trellis_past_state[min_index][i];
+            /* Use an elementary IIR filter to track the distance to date. */
 #if defined(SPANDSP_USE_FIXED_POINTx)
-        new_distances[i] = s->distances[k]*9/10 + distances[tcm_paths[i][min_index]]*1/10;
+            new_distances[i] = s->distances[k]*9/10 + distances[trellis_branch[min_index][i]]*1/10;
 #else
-        new_distances[i] = s->distances[k]*0.9f + distances[tcm_paths[i][min_index]]*0.1f;
+            new_distances[i] = s->distances[k]*0.9f + distances[trellis_branch[min_index][i]]*0.1f;
 #endif
-        s->full_path_to_past_state_locations[s->trellis_ptr][i] = constel_maps[s->space_map][re][im][tcm_paths[i][min_index]];
-        s->past_state_locations[s->trellis_ptr][i] = k;
+            s->full_path_to_past_state_locations[s->trellis_ptr][i] = candidates[trellis_branch[min_index][i]];
+            s->past_state_locations[s->trellis_ptr][i] = k;
+        }
+        /*endfor*/
+        memcpy(s->distances, new_distances, sizeof(s->distances));
     }
-    /*endfor*/
-    memcpy(s->distances, new_distances, sizeof(s->distances));
+    /*endif*/
 
     /* Find the minimum distance to date. This is the start of the path back to the result. */
     min = s->distances[0];
@@ -1152,7 +1317,6 @@ static void process_half_baud(v17_rx_state_t *s, const complexf_t *sample)
                 span_log(&s->logging, SPAN_LOG_FLOW, "Training succeeded at %dbps (constellation mismatch %f)\n", s->bit_rate, s->training_error);
 #endif
                 /* We are up and running */
-                report_status_change(s, SIG_STATUS_TRAINING_SUCCEEDED);
                 /* Apply some lag to the carrier off condition, to ensure the last few bits get pushed through
                    the processing. */
                 s->signal_present = 60;
@@ -1160,6 +1324,8 @@ static void process_half_baud(v17_rx_state_t *s, const complexf_t *sample)
                 s->carrier_phase_rate_save = s->carrier_phase_rate;
                 s->short_train = true;
                 s->training_stage = TRAINING_STAGE_NORMAL_OPERATION;
+                /* The training is saved before this is reported, so the status handler may export it */
+                report_status_change(s, SIG_STATUS_TRAINING_SUCCEEDED);
             }
             else
             {
@@ -1305,6 +1471,7 @@ SPAN_DECLARE(int) v17_rx(v17_rx_state_t *s, const int16_t amp[], int len)
     for (i = 0;  i < len;  i++)
     {
         s->rrc_filter[s->rrc_filter_step] = amp[i];
+        s->rrc_filter[s->rrc_filter_step + V17_RX_FILTER_STEPS] = amp[i];
         if (++s->rrc_filter_step >= V17_RX_FILTER_STEPS)
             s->rrc_filter_step = 0;
         /*endif*/
@@ -1328,7 +1495,7 @@ SPAN_DECLARE(int) v17_rx(v17_rx_state_t *s, const int16_t amp[], int len)
             step = RX_PULSESHAPER_COEFF_SETS - 1;
         /*endif*/
 #if defined(SPANDSP_USE_FIXED_POINTx)
-        v = vec_circular_dot_prodi16(s->rrc_filter, rx_pulseshaper_re[step], V17_RX_FILTER_STEPS, s->rrc_filter_step) >> 15;
+        v = vec_dot_prodi16(&s->rrc_filter[s->rrc_filter_step], rx_pulseshaper_re[step], V17_RX_FILTER_STEPS) >> 15;
         sample.re = (v*s->agc_scaling) >> 10;
         /* Symbol timing synchronisation band edge filters */
         /* Low Nyquist band edge filter */
@@ -1344,7 +1511,7 @@ SPAN_DECLARE(int) v17_rx(v17_rx_state_t *s, const int16_t amp[], int len)
         s->symbol_sync_high[1] = s->symbol_sync_high[0];
         s->symbol_sync_high[0] = v;
 #else
-        v = vec_circular_dot_prodf(s->rrc_filter, rx_pulseshaper_re[step], V17_RX_FILTER_STEPS, s->rrc_filter_step);
+        v = vec_dot_prodf(&s->rrc_filter[s->rrc_filter_step], rx_pulseshaper_re[step], V17_RX_FILTER_STEPS);
         sample.re = v*s->agc_scaling;
         /* Symbol timing synchronisation band edge filters */
         /* Low Nyquist band edge filter */
@@ -1378,13 +1545,13 @@ SPAN_DECLARE(int) v17_rx(v17_rx_state_t *s, const int16_t amp[], int len)
                signal, which can be brought directly to baseband by complex mixing.
                No further filtering, to remove mixer harmonics, is needed. */
 #if defined(SPANDSP_USE_FIXED_POINTx)
-            v = vec_circular_dot_prodi16(s->rrc_filter, rx_pulseshaper_im[step], V17_RX_FILTER_STEPS, s->rrc_filter_step) >> 15;
+            v = vec_dot_prodi16(&s->rrc_filter[s->rrc_filter_step], rx_pulseshaper_im[step], V17_RX_FILTER_STEPS) >> 15;
             sample.im = (v*s->agc_scaling) >> 10;
             z = dds_lookup_complexi16(s->carrier_phase);
             zz.re = ((int32_t) sample.re*z.re - (int32_t) sample.im*z.im) >> 15;
             zz.im = ((int32_t) -sample.re*z.im - (int32_t) sample.im*z.re) >> 15;
 #else
-            v = vec_circular_dot_prodf(s->rrc_filter, rx_pulseshaper_im[step], V17_RX_FILTER_STEPS, s->rrc_filter_step);
+            v = vec_dot_prodf(&s->rrc_filter[s->rrc_filter_step], rx_pulseshaper_im[step], V17_RX_FILTER_STEPS);
             sample.im = v*s->agc_scaling;
             z = dds_lookup_complexf(s->carrier_phase);
             zz.re = sample.re*z.re - sample.im*z.im;
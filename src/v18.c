@@ -58,8 +58,8 @@
 #include "spandsp/dds.h"
 #include "spandsp/tone_detect.h"
 #include "spandsp/tone_generate.h"
-#include "spandsp/super_tone_rx.h"
 #include "spandsp/power_meter.h"
+#include "spandsp/super_tone_rx.h"
 #include "spandsp/fsk.h"
 #include "spandsp/dtmf.h"
 #include "spandsp/modem_connect_tones.h"
@@ -802,6 +802,7 @@ SPAN_DECLARE(int) v22bis_rx(v22bis_state_t *s, const int16_t amp[], int len)
            to centre at 1200Hz or 2400Hz. The filters support 12 fractional phase shifts, to
            permit signal extraction very close to the middle of a symbol. */
         s->rx.rrc_filter[s->rx.rrc_filter_step] = amp[i];
+        s->rx.rrc_filter[s->rx.rrc_filter_step + V22BIS_RX_FILTER_STEPS] = amp[i];
         if (++s->rx.rrc_filter_step >= V22BIS_RX_FILTER_STEPS)
             s->rx.rrc_filter_step = 0;
 
@@ -811,17 +812,17 @@ SPAN_DECLARE(int) v22bis_rx(v22bis_state_t *s, const int16_t amp[], int len)
         if (s->calling_party)
         {
 #if defined(SPANDSP_USE_FIXED_POINT)
-            ii = vec_circular_dot_prodi16(s->rx.rrc_filter, rx_pulseshaper_2400_re[6], V22BIS_RX_FILTER_STEPS, s->rx.rrc_filter_step) >> 15;
+            ii = vec_dot_prodi16(&s->rx.rrc_filter[s->rx.rrc_filter_step], rx_pulseshaper_2400_re[6], V22BIS_RX_FILTER_STEPS) >> 15;
 #else
-            ii = vec_circular_dot_prodf(s->rx.rrc_filter, rx_pulseshaper_2400_re[6], V22BIS_RX_FILTER_STEPS, s->rx.rrc_filter_step);
+            ii = vec_dot_prodf(&s->rx.rrc_filter[s->rx.rrc_filter_step], rx_pulseshaper_2400_re[6], V22BIS_RX_FILTER_STEPS);
 #endif
         }
         else
         {
 #if defined(SPANDSP_USE_FIXED_POINT)
-            ii = vec_circular_dot_prodi16(s->rx.rrc_filter, rx_pulseshaper_1200_re[6], V22BIS_RX_FILTER_STEPS, s->rx.rrc_filter_step) >> 15;
+            ii = vec_dot_prodi16(&s->rx.rrc_filter[s->rx.rrc_filter_step], rx_pulseshaper_1200_re[6], V22BIS_RX_FILTER_STEPS) >> 15;
 #else
-            ii = vec_circular_dot_prodf(s->rx.rrc_filter, rx_pulseshaper_1200_re[6], V22BIS_RX_FILTER_STEPS, s->rx.rrc_filter_step);
+            ii = vec_dot_prodf(&s->rx.rrc_filter[s->rx.rrc_filter_step], rx_pulseshaper_1200_re[6], V22BIS_RX_FILTER_STEPS);
 #endif
         }
         power = power_meter_update(&s->rx.rx_power, (int16_t) ii);
@@ -873,21 +874,21 @@ SPAN_DECLARE(int) v22bis_rx(v22bis_state_t *s, const int16_t amp[], int len)
             if (s->calling_party)
             {
 #if defined(SPANDSP_USE_FIXED_POINT)
-                ii = vec_circular_dot_prodi16(s->rx.rrc_filter, rx_pulseshaper_2400_re[step], V22BIS_RX_FILTER_STEPS, s->rx.rrc_filter_step) >> 15;
-                qq = vec_circular_dot_prodi16(s->rx.rrc_filter, rx_pulseshaper_2400_im[step], V22BIS_RX_FILTER_STEPS, s->rx.rrc_filter_step) >> 15;
+                ii = vec_dot_prodi16(&s->rx.rrc_filter[s->rx.rrc_filter_step], rx_pulseshaper_2400_re[step], V22BIS_RX_FILTER_STEPS) >> 15;
+                qq = vec_dot_prodi16(&s->rx.rrc_filter[s->rx.rrc_filter_step], rx_pulseshaper_2400_im[step], V22BIS_RX_FILTER_STEPS) >> 15;
 #else
-                ii = vec_circular_dot_prodf(s->rx.rrc_filter, rx_pulseshaper_2400_re[step], V22BIS_RX_FILTER_STEPS, s->rx.rrc_filter_step);
-                qq = vec_circular_dot_prodf(s->rx.rrc_filter, rx_pulseshaper_2400_im[step], V22BIS_RX_FILTER_STEPS, s->rx.rrc_filter_step);
+                ii = vec_dot_prodf(&s->rx.rrc_filter[s->rx.rrc_filter_step], rx_pulseshaper_2400_re[step], V22BIS_RX_FILTER_STEPS);
+                qq = vec_dot_prodf(&s->rx.rrc_filter[s->rx.rrc_filter_step], rx_pulseshaper_2400_im[step], V22BIS_RX_FILTER_STEPS);
 #endif
             }
             else
             {
 #if defined(SPANDSP_USE_FIXED_POINT)
-                ii = vec_circular_dot_prodi16(s->rx.rrc_filter, rx_pulseshaper_1200_re[step], V22BIS_RX_FILTER_STEPS, s->rx.rrc_filter_step) >> 15;
-                qq = vec_circular_dot_prodi16(s->rx.rrc_filter, rx_pulseshaper_1200_im[step], V22BIS_RX_FILTER_STEPS, s->rx.rrc_filter_step) >> 15;
+                ii = vec_dot_prodi16(&s->rx.rrc_filter[s->rx.rrc_filter_step], rx_pulseshaper_1200_re[step], V22BIS_RX_FILTER_STEPS) >> 15;
+                qq = vec_dot_prodi16(&s->rx.rrc_filter[s->rx.rrc_filter_step], rx_pulseshaper_1200_im[step], V22BIS_RX_FILTER_STEPS) >> 15;
 #else
-                ii = vec_circular_dot_prodf(s->rx.rrc_filter, rx_pulseshaper_1200_re[step], V22BIS_RX_FILTER_STEPS, s->rx.rrc_filter_step);
-                qq = vec_circular_dot_prodf(s->rx.rrc_filter, rx_pulseshaper_1200_im[step], V22BIS_RX_FILTER_STEPS, s->rx.rrc_filter_step);
+                ii = vec_dot_prodf(&s->rx.rrc_filter[s->rx.rrc_filter_step], rx_pulseshaper_1200_re[step], V22BIS_RX_FILTER_STEPS);
+                qq = vec_dot_prodf(&s->rx.rrc_filter[s->rx.rrc_filter_step], rx_pulseshaper_1200_im[step], V22BIS_RX_FILTER_STEPS);
 #endif
             }
             /* Shift to baseband - since this is done in a full complex form, the
@@ -851,6 +851,7 @@ SPAN_DECLARE(int) v27ter_rx(v27ter_rx_state_t *s, const int16_t amp[], int len)
         for (i = 0;  i < len;  i++)
         {
             s->rrc_filter[s->rrc_filter_step] = amp[i];
+            s->rrc_filter[s->rrc_filter_step + V27TER_RX_4800_FILTER_STEPS] = amp[i];
             if (++s->rrc_filter_step >= V27TER_RX_4800_FILTER_STEPS)
                 s->rrc_filter_step = 0;
 
@@ -884,17 +885,17 @@ SPAN_DECLARE(int) v27ter_rx(v27ter_rx_state_t *s, const int16_t amp[], int len)
                 if (step > RX_PULSESHAPER_4800_COEFF_SETS - 1)
                     step = RX_PULSESHAPER_4800_COEFF_SETS - 1;
 #if defined(SPANDSP_USE_FIXED_POINT)
-                v = vec_circular_dot_prodi16(s->rrc_filter, rx_pulseshaper_4800_re[step], V27TER_RX_FILTER_STEPS, s->rrc_filter_step) >> 15;
+                v = vec_dot_prodi16(&s->rrc_filter[s->rrc_filter_step], rx_pulseshaper_4800_re[step], V27TER_RX_FILTER_STEPS) >> 15;
                 sample.re = (v*s->agc_scaling) >> 10;
-                v = vec_circular_dot_prodi16(s->rrc_filter, rx_pulseshaper_4800_im[step], V27TER_RX_FILTER_STEPS, s->rrc_filter_step) >> 15;
+                v = vec_dot_prodi16(&s->rrc_filter[s->rrc_filter_step], rx_pulseshaper_4800_im[step], V27TER_RX_FILTER_STEPS) >> 15;
                 sample.im = (v*s->agc_scaling) >> 10;
                 z = dds_lookup_complexi16(s->carrier_phase);
                 zz.re = ((int32_t) sample.re*z.re - (int32_t) sample.im*z.im) >> 15;
                 zz.im = ((int32_t) -sample.re*z.im - (int32_t) sample.im*z.re) >> 15;
 #else
-                v = vec_circular_dot_prodf(s->rrc_filter, rx_pulseshaper_4800_re[step], V27TER_RX_FILTER_STEPS, s->rrc_filter_step);
+                v = vec_dot_prodf(&s->rrc_filter[s->rrc_filter_step], rx_pulseshaper_4800_re[step], V27TER_RX_FILTER_STEPS);
                 sample.re = v*s->agc_scaling;
-                v = vec_circular_dot_prodf(s->rrc_filter, rx_pulseshaper_4800_im[step], V27TER_RX_FILTER_STEPS, s->rrc_filter_step);
+                v = vec_dot_prodf(&s->rrc_filter[s->rrc_filter_step], rx_pulseshaper_4800_im[step], V27TER_RX_FILTER_STEPS);
                 sample.im = v*s->agc_scaling;
                 z = dds_lookup_complexf(s->carrier_phase);
                 zz.re = sample.re*z.re - sample.im*z.im;
@@ -915,6 +916,7 @@ SPAN_DECLARE(int) v27ter_rx(v27ter_rx_state_t *s, const int16_t amp[], int len)
         for (i = 0;  i < len;  i++)
         {
             s->rrc_filter[s->rrc_filter_step] = amp[i];
+            s->rrc_filter[s->rrc_filter_step + V27TER_RX_2400_FILTER_STEPS] = amp[i];
             if (++s->rrc_filter_step >= V27TER_RX_2400_FILTER_STEPS)
                 s->rrc_filter_step = 0;
 
@@ -948,17 +950,17 @@ SPAN_DECLARE(int) v27ter_rx(v27ter_rx_state_t *s, const int16_t amp[], int len)
                 if (step > RX_PULSESHAPER_2400_COEFF_SETS - 1)
                     step = RX_PULSESHAPER_2400_COEFF_SETS - 1;
 #if defined(SPANDSP_USE_FIXED_POINT)
-                v = vec_circular_dot_prodi16(s->rrc_filter, rx_pulseshaper_2400_re[step], V27TER_RX_FILTER_STEPS, s->rrc_filter_step) >> 15;
+                v = vec_dot_prodi16(&s->rrc_filter[s->rrc_filter_step], rx_pulseshaper_2400_re[step], V27TER_RX_FILTER_STEPS) >> 15;
                 sample.re = (v*s->agc_scaling) >> 10;
-                v = vec_circular_dot_prodi16(s->rrc_filter, rx_pulseshaper_2400_im[step], V27TER_RX_FILTER_STEPS, s->rrc_filter_step) >> 15;
+                v = vec_dot_prodi16(&s->rrc_filter[s->rrc_filter_step], rx_pulseshaper_2400_im[step], V27TER_RX_FILTER_STEPS) >> 15;
                 sample.im = (v*s->agc_scaling) >> 10;
                 z = dds_lookup_complexi16(s->carrier_phase);
                 zz.re = ((int32_t) sample.re*z.re - (int32_t) sample.im*z.im) >> 15;
                 zz.im = ((int32_t) -sample.re*z.im - (int32_t) sample.im*z.re) >> 15;
 #else
-                v = vec_circular_dot_prodf(s->rrc_filter, rx_pulseshaper_2400_re[step], V27TER_RX_FILTER_STEPS, s->rrc_filter_step);
+                v = vec_dot_prodf(&s->rrc_filter[s->rrc_filter_step], rx_pulseshaper_2400_re[step], V27TER_RX_FILTER_STEPS);
                 sample.re = v*s->agc_scaling;
-                v = vec_circular_dot_prodf(s->rrc_filter, rx_pulseshaper_2400_im[step], V27TER_RX_FILTER_STEPS, s->rrc_filter_step);
+                v = vec_dot_prodf(&s->rrc_filter[s->rrc_filter_step], rx_pulseshaper_2400_im[step], V27TER_RX_FILTER_STEPS);
                 sample.im = v*s->agc_scaling;
                 z = dds_lookup_complexf(s->carrier_phase);
                 zz.re = sample.re*z.re - sample.im*z.im;
@@ -217,6 +217,60 @@ SPAN_DECLARE(int) v29_rx_equalizer_state(v29_rx_state_t *s, complexf_t **coeffs)
 }
 /*- End of function --------------------------------------------------------*/
 
+SPAN_DECLARE(int) v29_rx_export_training(v29_rx_state_t *s, uint32_t route_id, uint8_t buf[], int max_len)
+{
+    v29_rx_training_record_t rec;
+
+    if (buf == NULL)
+        return sizeof(rec);
+    /*endif*/
+    if (max_len < (int) sizeof(rec))
+        return -1;
+    /*endif*/
+    if (!s->old_train_valid  ||  s->agc_scaling_save == FP_SCALE(0.0f))
+        return -1;
+    /*endif*/
+    memset(&rec, 0, sizeof(rec));
+    rec.route_id = route_id;
+    rec.bit_rate = s->bit_rate;
+    rec.carrier_phase_rate = s->carrier_phase_rate_save;
+    rec.agc_scaling = s->agc_scaling_save;
+#if defined(SPANDSP_USE_FIXED_POINT)
+    cvec_copyi16(rec.eq_coeff, s->eq_coeff_save, V29_EQUALIZER_LEN);
+#else
+    cvec_copyf(rec.eq_coeff, s->eq_coeff_save, V29_EQUALIZER_LEN);
+#endif
+    memcpy(buf, &rec, sizeof(rec));
+    return sizeof(rec);
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_DECLARE(int) v29_rx_import_training(v29_rx_state_t *s, uint32_t route_id, const uint8_t buf[], int len)
+{
+    v29_rx_training_record_t rec;
+
+    /* The length check also rejects training exported by a fixed point build into a floating
+       point one, or vice versa. */
+    if (len != (int) sizeof(rec))
+        return -1;
+    /*endif*/
+    memcpy(&rec, buf, sizeof(rec));
+    if (rec.route_id != route_id  ||  rec.agc_scaling == FP_SCALE(0.0f))
+        return -1;
+    /*endif*/
+    span_log(&s->logging, SPAN_LOG_FLOW, "Importing training for route %u, obtained at %dbps\n", (unsigned int) route_id, rec.bit_rate);
+#if defined(SPANDSP_USE_FIXED_POINT)
+    cvec_copyi16(s->eq_coeff_save, rec.eq_coeff, V29_EQUALIZER_LEN);
+#else
+    cvec_copyf(s->eq_coeff_save, rec.eq_coeff, V29_EQUALIZER_LEN);
+#endif
+    s->carrier_phase_rate_save = rec.carrier_phase_rate;
+    s->agc_scaling_save = rec.agc_scaling;
+    s->old_train_valid = true;
+    return 0;
+}
+/*- End of function --------------------------------------------------------*/
+
 static void equalizer_save(v29_rx_state_t *s)
 {
 #if defined(SPANDSP_USE_FIXED_POINT)
@@ -814,7 +868,6 @@ static void process_half_baud(v29_rx_state_t *s, complexf_t *sample)
 #else
                 span_log(&s->logging, SPAN_LOG_FLOW, "Training succeeded at %dbps (constellation mismatch %f)\n", s->bit_rate, s->training_error);
 #endif
-                report_status_change(s, SIG_STATUS_TRAINING_SUCCEEDED);
                 /* Apply some lag to the carrier off condition, to ensure the last few bits get pushed through
                    the processing. */
                 s->signal_present = 60;
@@ -822,6 +875,9 @@ static void process_half_baud(v29_rx_state_t *s, complexf_t *sample)
                 equalizer_save(s);
                 s->carrier_phase_rate_save = s->carrier_phase_rate;
                 s->agc_scaling_save = s->agc_scaling;
+                s->old_train_valid = true;
+                /* The training is saved before this is reported, so the status handler may export it */
+                report_status_change(s, SIG_STATUS_TRAINING_SUCCEEDED);
             }
             else
             {
@@ -832,6 +888,7 @@ static void process_half_baud(v29_rx_state_t *s, complexf_t *sample)
                 span_log(&s->logging, SPAN_LOG_FLOW, "Training failed (constellation mismatch %f)\n", s->training_error);
 #endif
                 s->agc_scaling_save = FP_SCALE(0.0f);
+                s->old_train_valid = false;
                 s->training_stage = TRAINING_STAGE_PARKED;
                 report_status_change(s, SIG_STATUS_TRAINING_FAILED);
             }
@@ -966,6 +1023,7 @@ SPAN_DECLARE(int) v29_rx(v29_rx_state_t *s, const int16_t amp[], int len)
     for (i = 0;  i < len;  i++)
     {
         s->rrc_filter[s->rrc_filter_step] = amp[i];
+        s->rrc_filter[s->rrc_filter_step + V29_RX_FILTER_STEPS] = amp[i];
         if (++s->rrc_filter_step >= V29_RX_FILTER_STEPS)
             s->rrc_filter_step = 0;
         /*endif*/
@@ -989,7 +1047,7 @@ SPAN_DECLARE(int) v29_rx(v29_rx_state_t *s, const int16_t amp[], int len)
             step = RX_PULSESHAPER_COEFF_SETS - 1;
         /*endif*/
 #if defined(SPANDSP_USE_FIXED_POINT)
-        v = vec_circular_dot_prodi16(s->rrc_filter, rx_pulseshaper_re[step], V29_RX_FILTER_STEPS, s->rrc_filter_step) >> 15;
+        v = vec_dot_prodi16(&s->rrc_filter[s->rrc_filter_step], rx_pulseshaper_re[step], V29_RX_FILTER_STEPS) >> 15;
         sample.re = (v*s->agc_scaling) >> 10;
         /* Symbol timing synchronisation band edge filters */
         /* Low Nyquist band edge filter */
@@ -1005,7 +1063,7 @@ SPAN_DECLARE(int) v29_rx(v29_rx_state_t *s, const int16_t amp[], int len)
         s->symbol_sync_high[1] = s->symbol_sync_high[0];
         s->symbol_sync_high[0] = v;
 #else
-        v = vec_circular_dot_prodf(s->rrc_filter, rx_pulseshaper_re[step], V29_RX_FILTER_STEPS, s->rrc_filter_step);
+        v = vec_dot_prodf(&s->rrc_filter[s->rrc_filter_step], rx_pulseshaper_re[step], V29_RX_FILTER_STEPS);
         sample.re = v*s->agc_scaling;
         /* Symbol timing synchronisation band edge filters */
         /* Low Nyquist band edge filter */
@@ -1043,13 +1101,13 @@ SPAN_DECLARE(int) v29_rx(v29_rx_state_t *s, const int16_t amp[], int len)
                signal, which can be brought directly to baseband by complex mixing.
                No further filtering, to remove mixer harmonics, is needed. */
 #if defined(SPANDSP_USE_FIXED_POINT)
-            v = vec_circular_dot_prodi16(s->rrc_filter, rx_pulseshaper_im[step], V29_RX_FILTER_STEPS, s->rrc_filter_step) >> 15;
+            v = vec_dot_prodi16(&s->rrc_filter[s->rrc_filter_step], rx_pulseshaper_im[step], V29_RX_FILTER_STEPS) >> 15;
             sample.im = (v*s->agc_scaling) >> 10;
             z = dds_lookup_complexi16(s->carrier_phase);
             zz.re = ((int32_t) sample.re*z.re - (int32_t) sample.im*z.im) >> 15;
             zz.im = ((int32_t) -sample.re*z.im - (int32_t) sample.im*z.re) >> 15;
 #else
-            v = vec_circular_dot_prodf(s->rrc_filter, rx_pulseshaper_im[step], V29_RX_FILTER_STEPS, s->rrc_filter_step);
+            v = vec_dot_prodf(&s->rrc_filter[s->rrc_filter_step], rx_pulseshaper_im[step], V29_RX_FILTER_STEPS);
             sample.im = v*s->agc_scaling;
             z = dds_lookup_complexf(s->carrier_phase);
             zz.re = sample.re*z.re - sample.im*z.im;
@@ -1180,6 +1238,7 @@ SPAN_DECLARE(int) v29_rx_restart(v29_rx_state_t *s, int bit_rate, bool old_train
         s->carrier_phase_rate = DDS_PHASE_RATE(CARRIER_NOMINAL_FREQ);
         equalizer_reset(s);
         s->agc_scaling_save = FP_SCALE(0.0f);
+        s->old_train_valid = false;
 #if defined(SPANDSP_USE_FIXED_POINT)
         s->agc_scaling = (float) (FP_SCALE(1.25f)*1024.0f)/735.0f;
 #else
@@ -60,6 +60,7 @@
 #include "spandsp/dds.h"
 #include "spandsp/complex_filters.h"
 
+#include "spandsp/vector_int.h"
 #include "spandsp/modem_echo.h"
 #include "spandsp/v29rx.h"
 #include "spandsp/v17tx.h"
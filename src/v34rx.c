@@ -48,8 +48,10 @@
 #include "spandsp/stdbool.h"
 #endif
 #include "floating_fudge.h"
+#include "mmx_sse_decs.h"
 
 #include "spandsp/telephony.h"
+#include "spandsp/cpu_features.h"
 #include "spandsp/fast_convert.h"
 #include "spandsp/logging.h"
 #include "spandsp/bit_operations.h"
@@ -294,6 +296,57 @@ static void pack_output_bitstream(v34_rx_state_t *s)
 }
 /*- End of function --------------------------------------------------------*/
 
+#if defined(SPANDSP_USE_RUNTIME_DISPATCH)
+SPAN_TARGET("avx2") static int32_t shell_convolve_avx2(const uint32_t g[], int w, int n)
+{
+    __m256i reverse;
+    __m256i sum;
+    __m256i x;
+    __m256i y;
+    int32_t n32;
+    int k;
+
+    /* 32 bit products and sums wrap around just like the scalar code, so the result is the same. */
+    reverse = _mm256_setr_epi32(7, 6, 5, 4, 3, 2, 1, 0);
+    sum = _mm256_setzero_si256();
+    for (k = 0;  k + 8 <= n;  k += 8)
+    {
+        x = _mm256_loadu_si256((const __m256i *) &g[k]);
+        y = _mm256_permutevar8x32_epi32(_mm256_loadu_si256((const __m256i *) &g[w - k - 7]), reverse);
+        sum = _mm256_add_epi32(sum, _mm256_mullo_epi32(x, y));
+    }
+    /*endfor*/
+    sum = _mm256_add_epi32(sum, _mm256_permute2x128_si256(sum, sum, 0x01));
+    sum = _mm256_add_epi32(sum, _mm256_shuffle_epi32(sum, 0x4E));
+    sum = _mm256_add_epi32(sum, _mm256_shuffle_epi32(sum, 0xB1));
+    n32 = _mm256_cvtsi256_si32(sum);
+    for (  ;  k < n;  k++)
+        n32 += g[k]*g[w - k];
+    /*endfor*/
+    return n32;
+}
+/*- End of function --------------------------------------------------------*/
+#endif
+
+static __inline__ int32_t shell_convolve(const uint32_t g[], int w, int n)
+{
+    int32_t n32;
+    int k;
+
+    /* Find the sum of g[k]*g[w - k], for k from 0 to n - 1 */
+#if defined(SPANDSP_USE_RUNTIME_DISPATCH)
+    if ((span_cpu_dispatch_features & SPAN_CPU_FEATURE_AVX2))
+        return shell_convolve_avx2(g, w, n);
+    /*endif*/
+#endif
+    n32 = 0;
+    for (k = 0;  k < n;  k++)
+        n32 += g[k]*g[w - k];
+    /*endfor*/
+    return n32;
+}
+/*- End of function --------------------------------------------------------*/
+
 static void shell_unmap(v34_rx_state_t *s)
 {
     int n21;
@@ -303,7 +356,6 @@ static void shell_unmap(v34_rx_state_t *s)
     int n41;
     int n42;
     int32_t n8;
-    int k;
     int w41;
     int w42;
     int w2;
@@ -324,27 +376,18 @@ static void shell_unmap(v34_rx_state_t *s)
 
     w2 = s->mjk[4] + s->mjk[5];
     w41 = w2 + s->mjk[6] + s->mjk[7];
-    n41 = 0;
-    for (k = 0;  k < w2;  k++)
-        n41 += g2[k]*g2[w41 - k];
-    /*endfor*/
+    n41 = shell_convolve(g2, w41, w2);
     n41 += n21*g2[w2];
     n41 += n22;
 
     w2 = s->mjk[0] + s->mjk[1];
     w42 = w2 + s->mjk[2] + s->mjk[3];
-    n42 = 0;
-    for (k = 0;  k < w2;  k++)
-        n42 += g2[k]*g2[w42 - k];
-    /*endfor*/
+    n42 = shell_convolve(g2, w42, w2);
     n42 += n23*g2[w2];
     n42 += n24;
 
     w8 = w41 + w42;
-    n8 = 0;
-    for (k = 0;  k < w42;  k++)
-        n8 += g4[k]*g4[w8 - k];
-    /*endfor*/
+    n8 = shell_convolve(g4, w8, w42);
     n8 += n41*g4[w42];
     n8 += n42;
 
@@ -572,6 +615,26 @@ static void quantize_n_ways(complexi16_t xy[], complexi16_t *yt)
 }
 /*- End of function --------------------------------------------------------*/
 
+static void viterbi_init(viterbi_t *s, const conv_decode_table_t *conv_decode_table)
+{
+    int i;
+    int j;
+
+    s->conv_decode_table = conv_decode_table;
+    /* Split the decode table into the previous states and 4D subsets, arranged by branch */
+    for (i = 0;  i < 16;  i++)
+    {
+        for (j = 0;  j < 4;  j++)
+        {
+            s->acs_past_state[j][i] = (*conv_decode_table)[i][j] >> 3;
+            s->acs_subset[j][i] = (*conv_decode_table)[i][j] & 0x7;
+        }
+        /*endfor*/
+    }
+    /*endfor*/
+}
+/*- End of function --------------------------------------------------------*/
+
 static void viterbi_calculate_candidate_errors(int16_t error[4], complexi16_t xy[4], complexi16_t *yt)
 {
     int i;
@@ -642,6 +705,84 @@ static void viterbi_calculate_branch_errors(viterbi_t *s, complexi16_t xy[2][4],
 }
 /*- End of function --------------------------------------------------------*/
 
+#if defined(SPANDSP_USE_RUNTIME_DISPATCH)
+/* The add-compare-select for the 16 states is done as two sets of 8 lanes. The path metrics
+   are unsigned, so they are offset by 0x80000000 for the signed compares. Only a strictly
+   smaller metric replaces the current best, so the results are exactly the same as the
+   scalar code. */
+SPAN_TARGET("avx2") static void viterbi_update_path_metrics_avx2(viterbi_t *s)
+{
+    __m256i past_lo;
+    __m256i past_hi;
+    __m256i branch_errors;
+    __m256i sign;
+    __m256i state;
+    __m256i subset;
+    __m256i metric;
+    __m256i lt;
+    __m256i min;
+    __m256i best_metric[2];
+    __m256i best_state[2];
+    __m256i best_subset[2];
+    uint32_t curr_min_metric;
+    int prev_ptr;
+    int mask;
+    int j;
+    int k;
+
+    prev_ptr = (s->ptr - 1) & 0xF;
+    past_lo = _mm256_loadu_si256((const __m256i *) &s->cumulative_path_metric[prev_ptr][0]);
+    past_hi = _mm256_loadu_si256((const __m256i *) &s->cumulative_path_metric[prev_ptr][8]);
+    branch_errors = _mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i *) s->branch_error));
+    sign = _mm256_set1_epi32(0x80000000);
+    for (k = 0;  k < 2;  k++)
+    {
+        best_metric[k] = _mm256_set1_epi32(-1);
+        best_state[k] = _mm256_setzero_si256();
+        best_subset[k] = _mm256_setzero_si256();
+    }
+    /*endfor*/
+    for (j = 0;  j < 4;  j++)
+    {
+        for (k = 0;  k < 2;  k++)
+        {
+            state = _mm256_loadu_si256((const __m256i *) &s->acs_past_state[j][8*k]);
+            subset = _mm256_loadu_si256((const __m256i *) &s->acs_subset[j][8*k]);
+            metric = _mm256_blendv_epi8(_mm256_permutevar8x32_epi32(past_lo, state),
+                                        _mm256_permutevar8x32_epi32(past_hi, state),
+                                        _mm256_cmpgt_epi32(state, _mm256_set1_epi32(7)));
+            metric = _mm256_add_epi32(metric, _mm256_permutevar8x32_epi32(branch_errors, subset));
+            lt = _mm256_cmpgt_epi32(_mm256_xor_si256(best_metric[k], sign), _mm256_xor_si256(metric, sign));
+            best_metric[k] = _mm256_blendv_epi8(best_metric[k], metric, lt);
+            best_state[k] = _mm256_blendv_epi8(best_state[k], state, lt);
+            best_subset[k] = _mm256_blendv_epi8(best_subset[k], subset, lt);
+        }
+        /*endfor*/
+    }
+    /*endfor*/
+    min = _mm256_min_epu32(best_metric[0], best_metric[1]);
+    min = _mm256_min_epu32(min, _mm256_permute2x128_si256(min, min, 0x01));
+    min = _mm256_min_epu32(min, _mm256_shuffle_epi32(min, 0x4E));
+    min = _mm256_min_epu32(min, _mm256_shuffle_epi32(min, 0xB1));
+    curr_min_metric = (uint32_t) _mm256_cvtsi256_si32(min);
+    if (curr_min_metric != UINT32_MAX)
+    {
+        /* The first state with the minimum metric */
+        mask = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(best_metric[0], min)))
+             | (_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(best_metric[1], min))) << 8);
+        s->curr_min_state = bottom_bit(mask);
+    }
+    /*endif*/
+    _mm256_storeu_si256((__m256i *) &s->cumulative_path_metric[s->ptr][0], _mm256_sub_epi32(best_metric[0], min));
+    _mm256_storeu_si256((__m256i *) &s->cumulative_path_metric[s->ptr][8], _mm256_sub_epi32(best_metric[1], min));
+    _mm256_storeu_si256((__m256i *) s->previous_path_ptr[s->ptr],
+                        _mm256_permute4x64_epi64(_mm256_packus_epi32(best_state[0], best_state[1]), 0xD8));
+    _mm256_storeu_si256((__m256i *) s->pts[s->ptr],
+                        _mm256_permute4x64_epi64(_mm256_packus_epi32(best_subset[0], best_subset[1]), 0xD8));
+}
+/*- End of function --------------------------------------------------------*/
+#endif
+
 static void viterbi_update_path_metrics(viterbi_t *s)
 {
     int16_t i;
@@ -655,6 +796,14 @@ static void viterbi_update_path_metrics(viterbi_t *s)
     uint16_t min_branch;
     int prev_ptr;
 
+#if defined(SPANDSP_USE_RUNTIME_DISPATCH)
+    if ((span_cpu_dispatch_features & SPAN_CPU_FEATURE_AVX2))
+    {
+        viterbi_update_path_metrics_avx2(s);
+        return;
+    }
+    /*endif*/
+#endif
     curr_min_metric = UINT32_MAX;
     /* Loop through each state */
     prev_ptr = (s->ptr - 1) & 0xF;
@@ -666,8 +815,8 @@ static void viterbi_update_path_metrics(viterbi_t *s)
         /* Loop through each possible branch from the previous state */
         for (j = 0;  j < 4;  j++)
         {
-            prev_state = (*s->conv_decode_table)[i][j] >> 3;
-            branch = (*s->conv_decode_table)[i][j] & 0x7;
+            prev_state = s->acs_past_state[j][i];
+            branch = s->acs_subset[j][i];
             metric = s->cumulative_path_metric[prev_ptr][prev_state] + s->branch_error[branch];
 
 //if (metric == 0)
@@ -724,15 +873,6 @@ static void viterbi_trace_back(viterbi_t *s, complexi16_t y[2])
 //printf(" %2d", next_state);
     }
     /*endfor*/
-    for (i = 0;  i < 8;  i++)
-    {
-        if (s->branch_error_x[last_baud][i] == 0)
-        {
-            branch = i;
-            break;
-        }
-    }
-    /*endfor*/
     branch = s->pts[last_baud][next_state];
 //printf(" (%d)\n", branch);
 
@@ -1151,7 +1291,7 @@ static int process_rx_mph(v34_rx_state_t *s, mph_t *mph, uint8_t buf[])
 static void put_info_bit(v34_rx_state_t *s, int bit)
 {
     /* Put info0, info1, tone A or tone B bits */
-    printf("Rx bit = %d\n", bit);
+    //printf("Rx bit = %d\n", bit);
     s->bitstream = (s->bitstream << 1) | bit;
     switch (s->stage)
     {
@@ -1378,27 +1518,28 @@ span_log(s->logging, SPAN_LOG_FLOW, "Signal up\n");
         }
         /*endif*/
         s->rrc_filter[s->rrc_filter_step] = amp[i];
+        s->rrc_filter[s->rrc_filter_step + V34_RX_FILTER_STEPS] = amp[i];
         if (++s->rrc_filter_step >= V34_RX_FILTER_STEPS)
             s->rrc_filter_step = 0;
         /*endif*/
         if (s->calling_party)
         {
 #if defined(SPANDSP_USE_FIXED_POINT)
-            ii = vec_circular_dot_prodi16(s->rrc_filter, rx_pulseshaper_2400_re[step], V34_RX_FILTER_STEPS, s->rrc_filter_step);
-            qq = vec_circular_dot_prodi16(s->rrc_filter, rx_pulseshaper_2400_im[step], V34_RX_FILTER_STEPS, s->rrc_filter_step);
+            ii = vec_dot_prodi16(&s->rrc_filter[s->rrc_filter_step], rx_pulseshaper_2400_re[step], V34_RX_FILTER_STEPS);
+            qq = vec_dot_prodi16(&s->rrc_filter[s->rrc_filter_step], rx_pulseshaper_2400_im[step], V34_RX_FILTER_STEPS);
 #else
-            ii = vec_circular_dot_prodf(s->rrc_filter, rx_pulseshaper_2400_re[step], V34_RX_FILTER_STEPS, s->rrc_filter_step);
-            qq = vec_circular_dot_prodf(s->rrc_filter, rx_pulseshaper_2400_im[step], V34_RX_FILTER_STEPS, s->rrc_filter_step);
+            ii = vec_dot_prodf(&s->rrc_filter[s->rrc_filter_step], rx_pulseshaper_2400_re[step], V34_RX_FILTER_STEPS);
+            qq = vec_dot_prodf(&s->rrc_filter[s->rrc_filter_step], rx_pulseshaper_2400_im[step], V34_RX_FILTER_STEPS);
 #endif
         }
         else
         {
 #if defined(SPANDSP_USE_FIXED_POINT)
-            ii = vec_circular_dot_prodi16(s->rrc_filter, rx_pulseshaper_1200_re[step], V34_RX_FILTER_STEPS, s->rrc_filter_step);
-            qq = vec_circular_dot_prodi16(s->rrc_filter, rx_pulseshaper_1200_im[step], V34_RX_FILTER_STEPS, s->rrc_filter_step);
+            ii = vec_dot_prodi16(&s->rrc_filter[s->rrc_filter_step], rx_pulseshaper_1200_re[step], V34_RX_FILTER_STEPS);
+            qq = vec_dot_prodi16(&s->rrc_filter[s->rrc_filter_step], rx_pulseshaper_1200_im[step], V34_RX_FILTER_STEPS);
 #else
-            ii = vec_circular_dot_prodf(s->rrc_filter, rx_pulseshaper_1200_re[step], V34_RX_FILTER_STEPS, s->rrc_filter_step);
-            qq = vec_circular_dot_prodf(s->rrc_filter, rx_pulseshaper_1200_im[step], V34_RX_FILTER_STEPS, s->rrc_filter_step);
+            ii = vec_dot_prodf(&s->rrc_filter[s->rrc_filter_step], rx_pulseshaper_1200_re[step], V34_RX_FILTER_STEPS);
+            qq = vec_dot_prodf(&s->rrc_filter[s->rrc_filter_step], rx_pulseshaper_1200_im[step], V34_RX_FILTER_STEPS);
 #endif
         }
         /*endif*/
@@ -1409,7 +1550,7 @@ span_log(s->logging, SPAN_LOG_FLOW, "Signal up\n");
         zz.re = sample.re*z.re - sample.im*z.im;
         zz.im = -sample.re*z.im - sample.im*z.re;
         angle = arctan2(zz.im, zz.re);
-        printf("XXX%d, %7d, %f, %f, 0x%08X, %d\n", s->calling_party, amp[i], zz.re, zz.im, angle, angle);
+        //printf("XXX%d, %7d, %f, %f, 0x%08X, %d\n", s->calling_party, amp[i], zz.re, zz.im, angle, angle);
         if (abs(angle - s->last_angles[1]) > DDS_PHASE(90.0f)  &&  s->blip_duration > 3)
         {
             put_info_bit(s, 1);
@@ -2178,10 +2319,11 @@ static int cc_rx(v34_rx_state_t *s, const int16_t amp[], int len)
     float v;
 
     step = 6;
-printf("XYX0 %d\n", len);
+//printf("XYX0 %d\n", len);
     for (i = 0;  i < len;  i++)
     {
         s->rrc_filter[s->rrc_filter_step] = amp[i];
+        s->rrc_filter[s->rrc_filter_step + V34_RX_FILTER_STEPS] = amp[i];
         if (++s->rrc_filter_step >= V34_RX_FILTER_STEPS)
             s->rrc_filter_step = 0;
         /*endif*/
@@ -2205,17 +2347,17 @@ printf("XYX0 %d\n", len);
         if (s->calling_party)
         {
 #if defined(SPANDSP_USE_FIXED_POINT)
-            ii = vec_circular_dot_prodi16(s->rrc_filter, rx_pulseshaper_2400_re[step], V34_RX_FILTER_STEPS, s->rrc_filter_step);
+            ii = vec_dot_prodi16(&s->rrc_filter[s->rrc_filter_step], rx_pulseshaper_2400_re[step], V34_RX_FILTER_STEPS);
 #else
-            ii = vec_circular_dot_prodf(s->rrc_filter, rx_pulseshaper_2400_re[step], V34_RX_FILTER_STEPS, s->rrc_filter_step);
+            ii = vec_dot_prodf(&s->rrc_filter[s->rrc_filter_step], rx_pulseshaper_2400_re[step], V34_RX_FILTER_STEPS);
 #endif
         }
         else
         {
 #if defined(SPANDSP_USE_FIXED_POINT)
-            ii = vec_circular_dot_prodi16(s->rrc_filter, rx_pulseshaper_1200_re[step], V34_RX_FILTER_STEPS, s->rrc_filter_step);
+            ii = vec_dot_prodi16(&s->rrc_filter[s->rrc_filter_step], rx_pulseshaper_1200_re[step], V34_RX_FILTER_STEPS);
 #else
-            ii = vec_circular_dot_prodf(s->rrc_filter, rx_pulseshaper_1200_re[step], V34_RX_FILTER_STEPS, s->rrc_filter_step);
+            ii = vec_dot_prodf(&s->rrc_filter[s->rrc_filter_step], rx_pulseshaper_1200_re[step], V34_RX_FILTER_STEPS);
 #endif
         }
         /*endif*/
@@ -2250,17 +2392,17 @@ printf("XYX0 %d\n", len);
             if (s->calling_party)
             {
 #if defined(SPANDSP_USE_FIXED_POINT)
-                qq = vec_circular_dot_prodi16(s->rrc_filter, rx_pulseshaper_2400_im[step], V34_RX_FILTER_STEPS, s->rrc_filter_step);
+                qq = vec_dot_prodi16(&s->rrc_filter[s->rrc_filter_step], rx_pulseshaper_2400_im[step], V34_RX_FILTER_STEPS);
 #else
-                qq = vec_circular_dot_prodf(s->rrc_filter, rx_pulseshaper_2400_im[step], V34_RX_FILTER_STEPS, s->rrc_filter_step);
+                qq = vec_dot_prodf(&s->rrc_filter[s->rrc_filter_step], rx_pulseshaper_2400_im[step], V34_RX_FILTER_STEPS);
 #endif
             }
             else
             {
 #if defined(SPANDSP_USE_FIXED_POINT)
-                qq = vec_circular_dot_prodi16(s->rrc_filter, rx_pulseshaper_1200_im[step], V34_RX_FILTER_STEPS, s->rrc_filter_step);
+                qq = vec_dot_prodi16(&s->rrc_filter[s->rrc_filter_step], rx_pulseshaper_1200_im[step], V34_RX_FILTER_STEPS);
 #else
-                qq = vec_circular_dot_prodf(s->rrc_filter, rx_pulseshaper_1200_im[step], V34_RX_FILTER_STEPS, s->rrc_filter_step);
+                qq = vec_dot_prodf(&s->rrc_filter[s->rrc_filter_step], rx_pulseshaper_1200_im[step], V34_RX_FILTER_STEPS);
 #endif
             }
             /*endif*/
@@ -2278,7 +2420,7 @@ printf("XYX0 %d\n", len);
 
             //angle = arctan2(zz.im, zz.re);
             //printf("XYX1 %10.5f %10.5f\n", atan2(zz.re, zz.im), sqrt(zz.re*zz.re + zz.im*zz.im));
-            printf("XYX2 %10.5f %10.5f\n", zz.re, zz.im);
+            //printf("XYX2 %10.5f %10.5f\n", zz.re, zz.im);
         }
         /*endif*/
 #if defined(SPANDSP_USE_FIXED_POINT)
@@ -2384,10 +2526,11 @@ static int primary_channel_rx(v34_rx_state_t *s, const int16_t amp[], int len)
     s->shaper_im = v34_rx_shapers_im[s->baud_rate][s->high_carrier];
     s->shaper_sets = steps_per_baud[s->baud_rate];
     s->v34_carrier_phase_rate = dds_phase_ratef(carrier_frequency(s->baud_rate, 0));
-printf("XYX0 %d\n", len);
+//printf("XYX0 %d\n", len);
     for (i = 0;  i < len;  i++)
     {
         s->rrc_filter[s->rrc_filter_step] = amp[i];
+        s->rrc_filter[s->rrc_filter_step + V34_RX_FILTER_STEPS] = amp[i];
         if (++s->rrc_filter_step >= V34_RX_FILTER_STEPS)
             s->rrc_filter_step = 0;
         /*endif*/
@@ -2407,9 +2550,9 @@ printf("XYX0 %d\n", len);
             step += V34_RX_PULSESHAPER_COEFF_SETS;
         /*endwhile*/
 #if defined(SPANDSP_USE_FIXED_POINT)
-        ii = vec_circular_dot_prodi16(s->rrc_filter, (*s->shaper_re)[step], V34_RX_FILTER_STEPS, s->rrc_filter_step);
+        ii = vec_dot_prodi16(&s->rrc_filter[s->rrc_filter_step], (*s->shaper_re)[step], V34_RX_FILTER_STEPS);
 #else
-        ii = vec_circular_dot_prodf(s->rrc_filter, (*s->shaper_re)[step], V34_RX_FILTER_STEPS, s->rrc_filter_step);
+        ii = vec_dot_prodf(&s->rrc_filter[s->rrc_filter_step], (*s->shaper_re)[step], V34_RX_FILTER_STEPS);
 #endif
 #if defined(SPANDSP_USE_FIXED_POINT)
         //sample.re = (ii*(int32_t) s->agc_scaling) >> 15;
@@ -2443,9 +2586,9 @@ printf("XYX0 %d\n", len);
 #endif
             s->eq_put_step += s->shaper_sets;
 #if defined(SPANDSP_USE_FIXED_POINT)
-            qq = vec_circular_dot_prodi16(s->rrc_filter, (*s->shaper_im)[step], V34_RX_FILTER_STEPS, s->rrc_filter_step);
+            qq = vec_dot_prodi16(&s->rrc_filter[s->rrc_filter_step], (*s->shaper_im)[step], V34_RX_FILTER_STEPS);
 #else
-            qq = vec_circular_dot_prodf(s->rrc_filter, (*s->shaper_im)[step], V34_RX_FILTER_STEPS, s->rrc_filter_step);
+            qq = vec_dot_prodf(&s->rrc_filter[s->rrc_filter_step], (*s->shaper_im)[step], V34_RX_FILTER_STEPS);
 #endif
 #if defined(SPANDSP_USE_FIXED_POINT)
             //sample.im = (qq*(int32_t) s->agc_scaling) >> 15;
@@ -2460,8 +2603,8 @@ printf("XYX0 %d\n", len);
             process_primary_half_baud(s, &zz);
 
             //angle = arctan2(zz.im, zz.re);
-            printf("XYX1 %10.5f %10.5f\n", atan2(zz.re, zz.im), sqrt(zz.re*zz.re + zz.im*zz.im));
-            printf("XYX2 %10.5f %10.5f\n", zz.re, zz.im);
+            //printf("XYX1 %10.5f %10.5f\n", atan2(zz.re, zz.im), sqrt(zz.re*zz.re + zz.im*zz.im));
+            //printf("XYX2 %10.5f %10.5f\n", zz.re, zz.im);
         }
         /*endif*/
 #if defined(SPANDSP_USE_FIXED_POINT)
@@ -2774,7 +2917,7 @@ int v34_rx_restart(v34_state_t *s, int baud_rate, int bit_rate, int high_carrier
     s->rx.scramble_reg = 0;
 
     s->rx.current_demodulator = V34_MODULATION_TONES;
-    s->rx.viterbi.conv_decode_table = v34_conv16_decode_table;
+    viterbi_init(&s->rx.viterbi, &v34_conv16_decode_table);
 
     s->rx.super_frame = 0;
     s->rx.data_frame = 0;
@@ -45,6 +45,7 @@
 #include "mmx_sse_decs.h"
 
 #include "spandsp/telephony.h"
+#include "spandsp/cpu_features.h"
 #include "spandsp/vector_float.h"
 
 #if defined(__GNUC__)  &&  defined(SPANDSP_USE_SSE2)
@@ -772,8 +773,68 @@ SPAN_DECLARE(void) vec_mull(long double z[], const long double x[], const long d
 /*- End of function --------------------------------------------------------*/
 #endif
 
+#if defined(SPANDSP_USE_RUNTIME_DISPATCH)
+SPAN_TARGET("avx") static float vec_dot_prodf_avx(const float x[], const float y[], int n)
+{
+    int i;
+    float z;
+    __m256 n1;
+    __m256 n2;
+    __m256 n3;
+    __m128 n4;
+
+    z = 0.0f;
+    if ((i = n & ~7))
+    {
+        n3 = _mm256_setzero_ps();
+        for (i -= 8;  i >= 0;  i -= 8)
+        {
+            n1 = _mm256_loadu_ps(x + i);
+            n2 = _mm256_loadu_ps(y + i);
+            n3 = _mm256_add_ps(n3, _mm256_mul_ps(n1, n2));
+        }
+        n4 = _mm_add_ps(_mm256_castps256_ps128(n3), _mm256_extractf128_ps(n3, 1));
+        n4 = _mm_add_ps(_mm_movehl_ps(n4, n4), n4);
+        n4 = _mm_add_ss(_mm_shuffle_ps(n4, n4, 1), n4);
+        _mm_store_ss(&z, n4);
+    }
+    /* Now deal with the last 1 to 7 elements, which don't fill an AVX register */
+    for (i = n & ~7;  i < n;  i++)
+        z += x[i]*y[i];
+    return z;
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_TARGET("avx512f") static float vec_dot_prodf_avx512(const float x[], const float y[], int n)
+{
+    int i;
+    __m512 n1;
+    __m512 n2;
+    __m512 n3;
+    __mmask16 mask;
+
+    n3 = _mm512_setzero_ps();
+    for (i = 0;  i + 16 <= n;  i += 16)
+    {
+        n1 = _mm512_loadu_ps(x + i);
+        n2 = _mm512_loadu_ps(y + i);
+        n3 = _mm512_add_ps(n3, _mm512_mul_ps(n1, n2));
+    }
+    /* AVX-512 lets us mop up the last 1 to 15 elements with a masked load */
+    if (i < n)
+    {
+        mask = (__mmask16) ((1U << (n - i)) - 1);
+        n1 = _mm512_maskz_loadu_ps(mask, x + i);
+        n2 = _mm512_maskz_loadu_ps(mask, y + i);
+        n3 = _mm512_add_ps(n3, _mm512_mul_ps(n1, n2));
+    }
+    return _mm512_reduce_add_ps(n3);
+}
+/*- End of function --------------------------------------------------------*/
+#endif
+
 #if defined(__GNUC__)  &&  defined(SPANDSP_USE_SSE2)
-SPAN_DECLARE(float) vec_dot_prodf(const float x[], const float y[], int n)
+static float vec_dot_prodf_base(const float x[], const float y[], int n)
 {
     int i;
     float z;
@@ -810,7 +871,7 @@ SPAN_DECLARE(float) vec_dot_prodf(const float x[], const float y[], int n)
     return z;
 }
 #else
-SPAN_DECLARE(float) vec_dot_prodf(const float x[], const float y[], int n)
+static float vec_dot_prodf_base(const float x[], const float y[], int n)
 {
     int i;
     float z;
@@ -820,8 +881,22 @@ SPAN_DECLARE(float) vec_dot_prodf(const float x[], const float y[], int n)
         z += x[i]*y[i];
     return z;
 }
+#endif
 /*- End of function --------------------------------------------------------*/
+
+SPAN_DECLARE(float) vec_dot_prodf(const float x[], const float y[], int n)
+{
+#if defined(SPANDSP_USE_RUNTIME_DISPATCH)
+    if ((span_cpu_dispatch_features & SPAN_CPU_FEATURE_AVX512F))
+        return vec_dot_prodf_avx512(x, y, n);
+    /*endif*/
+    if ((span_cpu_dispatch_features & SPAN_CPU_FEATURE_AVX))
+        return vec_dot_prodf_avx(x, y, n);
+    /*endif*/
 #endif
+    return vec_dot_prodf_base(x, y, n);
+}
+/*- End of function --------------------------------------------------------*/
 
 SPAN_DECLARE(double) vec_dot_prod(const double x[], const double y[], int n)
 {
@@ -861,8 +936,67 @@ SPAN_DECLARE(float) vec_circular_dot_prodf(const float x[], const float y[], int
 
 #define LMS_LEAK_RATE   0.9999f
 
+#if defined(SPANDSP_USE_RUNTIME_DISPATCH)
+SPAN_TARGET("avx") static void vec_lmsf_avx(const float x[], float y[], int n, float error)
+{
+    int i;
+    __m256 n1;
+    __m256 n2;
+    __m256 n3;
+    __m256 n4;
+
+    if ((i = n & ~7))
+    {
+        n3 = _mm256_set1_ps(error);
+        n4 = _mm256_set1_ps(LMS_LEAK_RATE);
+        for (i -= 8;  i >= 0;  i -= 8)
+        {
+            n1 = _mm256_loadu_ps(x + i);
+            n2 = _mm256_loadu_ps(y + i);
+            n1 = _mm256_mul_ps(n1, n3);
+            n2 = _mm256_mul_ps(n2, n4);
+            n1 = _mm256_add_ps(n1, n2);
+            _mm256_storeu_ps(y + i, n1);
+        }
+    }
+    /* Now deal with the last 1 to 7 elements, which don't fill an AVX register */
+    for (i = n & ~7;  i < n;  i++)
+        y[i] = y[i]*LMS_LEAK_RATE + x[i]*error;
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_TARGET("avx512f") static void vec_lmsf_avx512(const float x[], float y[], int n, float error)
+{
+    int i;
+    __m512 n1;
+    __m512 n2;
+    __m512 n3;
+    __m512 n4;
+    __mmask16 mask;
+
+    n3 = _mm512_set1_ps(error);
+    n4 = _mm512_set1_ps(LMS_LEAK_RATE);
+    for (i = 0;  i + 16 <= n;  i += 16)
+    {
+        n1 = _mm512_loadu_ps(x + i);
+        n2 = _mm512_loadu_ps(y + i);
+        n1 = _mm512_add_ps(_mm512_mul_ps(n1, n3), _mm512_mul_ps(n2, n4));
+        _mm512_storeu_ps(y + i, n1);
+    }
+    if (i < n)
+    {
+        mask = (__mmask16) ((1U << (n - i)) - 1);
+        n1 = _mm512_maskz_loadu_ps(mask, x + i);
+        n2 = _mm512_maskz_loadu_ps(mask, y + i);
+        n1 = _mm512_add_ps(_mm512_mul_ps(n1, n3), _mm512_mul_ps(n2, n4));
+        _mm512_mask_storeu_ps(y + i, mask, n1);
+    }
+}
+/*- End of function --------------------------------------------------------*/
+#endif
+
 #if defined(__GNUC__)  &&  defined(SPANDSP_USE_SSE2)
-SPAN_DECLARE(void) vec_lmsf(const float x[], float y[], int n, float error)
+static void vec_lmsf_base(const float x[], float y[], int n, float error)
 {
     int i;
     __m128 n1;
@@ -896,7 +1030,7 @@ SPAN_DECLARE(void) vec_lmsf(const float x[], float y[], int n, float error)
     }
 }
 #else
-SPAN_DECLARE(void) vec_lmsf(const float x[], float y[], int n, float error)
+static void vec_lmsf_base(const float x[], float y[], int n, float error)
 {
     int i;
 
@@ -909,6 +1043,26 @@ SPAN_DECLARE(void) vec_lmsf(const float x[], float y[], int n, float error)
 #endif
 /*- End of function --------------------------------------------------------*/
 
+SPAN_DECLARE(void) vec_lmsf(const float x[], float y[], int n, float error)
+{
+#if defined(SPANDSP_USE_RUNTIME_DISPATCH)
+    if ((span_cpu_dispatch_features & SPAN_CPU_FEATURE_AVX512F))
+    {
+        vec_lmsf_avx512(x, y, n, error);
+        return;
+    }
+    /*endif*/
+    if ((span_cpu_dispatch_features & SPAN_CPU_FEATURE_AVX))
+    {
+        vec_lmsf_avx(x, y, n, error);
+        return;
+    }
+    /*endif*/
+#endif
+    vec_lmsf_base(x, y, n, error);
+}
+/*- End of function --------------------------------------------------------*/
+
 SPAN_DECLARE(void) vec_circular_lmsf(const float x[], float y[], int n, int pos, float error)
 {
     vec_lmsf(&x[pos], &y[0], n - pos, error);
@@ -45,9 +45,125 @@
 #include "mmx_sse_decs.h"
 
 #include "spandsp/telephony.h"
+#include "spandsp/cpu_features.h"
 #include "spandsp/vector_int.h"
 
-SPAN_DECLARE(int32_t) vec_dot_prodi16(const int16_t x[], const int16_t y[], int n)
+#if defined(SPANDSP_USE_RUNTIME_DISPATCH)
+SPAN_TARGET("sse2") static int32_t vec_dot_prodi16_sse2(const int16_t x[], const int16_t y[], int n)
+{
+    int i;
+    int32_t z;
+    __m128i n1;
+    __m128i n2;
+    __m128i n3;
+
+    n3 = _mm_setzero_si128();
+    for (i = 0;  i + 8 <= n;  i += 8)
+    {
+        n1 = _mm_loadu_si128((const __m128i *) (x + i));
+        n2 = _mm_loadu_si128((const __m128i *) (y + i));
+        n3 = _mm_add_epi32(n3, _mm_madd_epi16(n1, n2));
+    }
+    n3 = _mm_add_epi32(n3, _mm_shuffle_epi32(n3, _MM_SHUFFLE(1, 0, 3, 2)));
+    n3 = _mm_add_epi32(n3, _mm_shuffle_epi32(n3, _MM_SHUFFLE(2, 3, 0, 1)));
+    z = _mm_cvtsi128_si32(n3);
+    /* Now deal with the last 1 to 7 elements, which don't fill an SSE2 register */
+    for (  ;  i < n;  i++)
+        z += (int32_t) x[i]*(int32_t) y[i];
+    /*endfor*/
+    return z;
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_TARGET("avx2") static int32_t vec_dot_prodi16_avx2(const int16_t x[], const int16_t y[], int n)
+{
+    int i;
+    int32_t z;
+    __m256i n1;
+    __m256i n2;
+    __m256i n3;
+    __m256i n4;
+    __m128i n5;
+
+    n3 = _mm256_setzero_si256();
+    n4 = _mm256_setzero_si256();
+    /* Use two accumulators, to hide the latency of the multiply-adds */
+    for (i = 0;  i + 32 <= n;  i += 32)
+    {
+        n1 = _mm256_loadu_si256((const __m256i *) (x + i));
+        n2 = _mm256_loadu_si256((const __m256i *) (y + i));
+        n3 = _mm256_add_epi32(n3, _mm256_madd_epi16(n1, n2));
+        n1 = _mm256_loadu_si256((const __m256i *) (x + i + 16));
+        n2 = _mm256_loadu_si256((const __m256i *) (y + i + 16));
+        n4 = _mm256_add_epi32(n4, _mm256_madd_epi16(n1, n2));
+    }
+    if (i + 16 <= n)
+    {
+        n1 = _mm256_loadu_si256((const __m256i *) (x + i));
+        n2 = _mm256_loadu_si256((const __m256i *) (y + i));
+        n3 = _mm256_add_epi32(n3, _mm256_madd_epi16(n1, n2));
+        i += 16;
+    }
+    n3 = _mm256_add_epi32(n3, n4);
+    n5 = _mm_add_epi32(_mm256_castsi256_si128(n3), _mm256_extracti128_si256(n3, 1));
+    if (i + 8 <= n)
+    {
+        n5 = _mm_add_epi32(n5, _mm_madd_epi16(_mm_loadu_si128((const __m128i *) (x + i)), _mm_loadu_si128((const __m128i *) (y + i))));
+        i += 8;
+    }
+    n5 = _mm_add_epi32(n5, _mm_shuffle_epi32(n5, _MM_SHUFFLE(1, 0, 3, 2)));
+    n5 = _mm_add_epi32(n5, _mm_shuffle_epi32(n5, _MM_SHUFFLE(2, 3, 0, 1)));
+    z = _mm_cvtsi128_si32(n5);
+    /* Now deal with the last 1 to 7 elements, which don't fill an SSE2 register */
+    for (  ;  i < n;  i++)
+        z += (int32_t) x[i]*(int32_t) y[i];
+    /*endfor*/
+    return z;
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_TARGET("avx512bw") static int32_t vec_dot_prodi16_avx512(const int16_t x[], const int16_t y[], int n)
+{
+    int i;
+    __m512i n1;
+    __m512i n2;
+    __m512i n3;
+    __m512i n4;
+    __mmask32 mask;
+
+    n3 = _mm512_setzero_si512();
+    n4 = _mm512_setzero_si512();
+    for (i = 0;  i + 64 <= n;  i += 64)
+    {
+        n1 = _mm512_loadu_si512((const void *) (x + i));
+        n2 = _mm512_loadu_si512((const void *) (y + i));
+        n3 = _mm512_add_epi32(n3, _mm512_madd_epi16(n1, n2));
+        n1 = _mm512_loadu_si512((const void *) (x + i + 32));
+        n2 = _mm512_loadu_si512((const void *) (y + i + 32));
+        n4 = _mm512_add_epi32(n4, _mm512_madd_epi16(n1, n2));
+    }
+    if (i + 32 <= n)
+    {
+        n1 = _mm512_loadu_si512((const void *) (x + i));
+        n2 = _mm512_loadu_si512((const void *) (y + i));
+        n3 = _mm512_add_epi32(n3, _mm512_madd_epi16(n1, n2));
+        i += 32;
+    }
+    /* AVX-512 lets us mop up the last 1 to 31 elements with a masked load. The
+       zeroed lanes contribute nothing to the sum. */
+    if (i < n)
+    {
+        mask = (__mmask32) ((1U << (n - i)) - 1);
+        n1 = _mm512_maskz_loadu_epi16(mask, x + i);
+        n2 = _mm512_maskz_loadu_epi16(mask, y + i);
+        n4 = _mm512_add_epi32(n4, _mm512_madd_epi16(n1, n2));
+    }
+    return _mm512_reduce_add_epi32(_mm512_add_epi32(n3, n4));
+}
+/*- End of function --------------------------------------------------------*/
+#endif
+
+static int32_t vec_dot_prodi16_base(const int16_t x[], const int16_t y[], int n)
 {
     int32_t z;
 
@@ -259,6 +375,23 @@ SPAN_DECLARE(int32_t) vec_dot_prodi16(const int16_t x[], const int16_t y[], int
 }
 /*- End of function --------------------------------------------------------*/
 
+SPAN_DECLARE(int32_t) vec_dot_prodi16(const int16_t x[], const int16_t y[], int n)
+{
+#if defined(SPANDSP_USE_RUNTIME_DISPATCH)
+    if ((span_cpu_dispatch_features & SPAN_CPU_FEATURE_AVX512BW))
+        return vec_dot_prodi16_avx512(x, y, n);
+    /*endif*/
+    if ((span_cpu_dispatch_features & SPAN_CPU_FEATURE_AVX2))
+        return vec_dot_prodi16_avx2(x, y, n);
+    /*endif*/
+    if ((span_cpu_dispatch_features & SPAN_CPU_FEATURE_SSE2))
+        return vec_dot_prodi16_sse2(x, y, n);
+    /*endif*/
+#endif
+    return vec_dot_prodi16_base(x, y, n);
+}
+/*- End of function --------------------------------------------------------*/
+
 SPAN_DECLARE(int32_t) vec_circular_dot_prodi16(const int16_t x[], const int16_t y[], int n, int pos)
 {
     int32_t z;
@@ -269,10 +402,134 @@ SPAN_DECLARE(int32_t) vec_circular_dot_prodi16(const int16_t x[], const int16_t
 }
 /*- End of function --------------------------------------------------------*/
 
+#if defined(SPANDSP_USE_RUNTIME_DISPATCH)
+SPAN_TARGET("sse2") static void vec_lmsi16_sse2(const int16_t x[], int16_t y[], int n, int16_t error)
+{
+    int i;
+    __m128i n1;
+    __m128i n2;
+    __m128i n3;
+    __m128i err;
+
+    /* The low 16 bits of (x*error) >> 15 are formed from the high and low halves of the
+       32 bit products, so the result exactly matches the scalar code. */
+    err = _mm_set1_epi16(error);
+    for (i = 0;  i + 8 <= n;  i += 8)
+    {
+        n1 = _mm_loadu_si128((const __m128i *) (x + i));
+        n2 = _mm_mulhi_epi16(n1, err);
+        n3 = _mm_mullo_epi16(n1, err);
+        n1 = _mm_or_si128(_mm_slli_epi16(n2, 1), _mm_srli_epi16(n3, 15));
+        n2 = _mm_loadu_si128((const __m128i *) (y + i));
+        _mm_storeu_si128((__m128i *) (y + i), _mm_add_epi16(n2, n1));
+    }
+    /* Now deal with the last 1 to 7 elements, which don't fill an SSE2 register */
+    for (  ;  i < n;  i++)
+        y[i] += (int16_t) (((int32_t) x[i]*(int32_t) error) >> 15);
+    /*endfor*/
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_TARGET("avx2") static void vec_lmsi16_avx2(const int16_t x[], int16_t y[], int n, int16_t error)
+{
+    int i;
+    __m256i n1;
+    __m256i n2;
+    __m256i n3;
+    __m256i err;
+    __m128i n4;
+    __m128i n5;
+    __m128i n6;
+
+    err = _mm256_set1_epi16(error);
+    for (i = 0;  i + 16 <= n;  i += 16)
+    {
+        n1 = _mm256_loadu_si256((const __m256i *) (x + i));
+        n2 = _mm256_mulhi_epi16(n1, err);
+        n3 = _mm256_mullo_epi16(n1, err);
+        n1 = _mm256_or_si256(_mm256_slli_epi16(n2, 1), _mm256_srli_epi16(n3, 15));
+        n2 = _mm256_loadu_si256((const __m256i *) (y + i));
+        _mm256_storeu_si256((__m256i *) (y + i), _mm256_add_epi16(n2, n1));
+    }
+    /* The tail is finished here, rather than by handing off to the SSE2 routine. That
+       would be a call into non-VEX code with the upper halves of the YMM registers dirty. */
+    if (i + 8 <= n)
+    {
+        n4 = _mm_loadu_si128((const __m128i *) (x + i));
+        n5 = _mm_mulhi_epi16(n4, _mm256_castsi256_si128(err));
+        n6 = _mm_mullo_epi16(n4, _mm256_castsi256_si128(err));
+        n4 = _mm_or_si128(_mm_slli_epi16(n5, 1), _mm_srli_epi16(n6, 15));
+        n5 = _mm_loadu_si128((const __m128i *) (y + i));
+        _mm_storeu_si128((__m128i *) (y + i), _mm_add_epi16(n5, n4));
+        i += 8;
+    }
+    /*endif*/
+    _mm256_zeroupper();
+    /* Now deal with the last 1 to 7 elements, which don't fill an SSE2 register */
+    for (  ;  i < n;  i++)
+        y[i] += (int16_t) (((int32_t) x[i]*(int32_t) error) >> 15);
+    /*endfor*/
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_TARGET("avx512bw") static void vec_lmsi16_avx512(const int16_t x[], int16_t y[], int n, int16_t error)
+{
+    int i;
+    __m512i n1;
+    __m512i n2;
+    __m512i n3;
+    __m512i err;
+    __mmask32 mask;
+
+    err = _mm512_set1_epi16(error);
+    for (i = 0;  i + 32 <= n;  i += 32)
+    {
+        n1 = _mm512_loadu_si512((const void *) (x + i));
+        n2 = _mm512_mulhi_epi16(n1, err);
+        n3 = _mm512_mullo_epi16(n1, err);
+        n1 = _mm512_or_si512(_mm512_slli_epi16(n2, 1), _mm512_srli_epi16(n3, 15));
+        n2 = _mm512_loadu_si512((const void *) (y + i));
+        _mm512_storeu_si512((void *) (y + i), _mm512_add_epi16(n2, n1));
+    }
+    if (i < n)
+    {
+        mask = (__mmask32) ((1U << (n - i)) - 1);
+        n1 = _mm512_maskz_loadu_epi16(mask, x + i);
+        n2 = _mm512_mulhi_epi16(n1, err);
+        n3 = _mm512_mullo_epi16(n1, err);
+        n1 = _mm512_or_si512(_mm512_slli_epi16(n2, 1), _mm512_srli_epi16(n3, 15));
+        n2 = _mm512_maskz_loadu_epi16(mask, y + i);
+        _mm512_mask_storeu_epi16(y + i, mask, _mm512_add_epi16(n2, n1));
+    }
+    /*endif*/
+}
+/*- End of function --------------------------------------------------------*/
+#endif
+
 SPAN_DECLARE(void) vec_lmsi16(const int16_t x[], int16_t y[], int n, int16_t error)
 {
     int i;
 
+#if defined(SPANDSP_USE_RUNTIME_DISPATCH)
+    if ((span_cpu_dispatch_features & SPAN_CPU_FEATURE_AVX512BW))
+    {
+        vec_lmsi16_avx512(x, y, n, error);
+        return;
+    }
+    /*endif*/
+    if ((span_cpu_dispatch_features & SPAN_CPU_FEATURE_AVX2))
+    {
+        vec_lmsi16_avx2(x, y, n, error);
+        return;
+    }
+    /*endif*/
+    if ((span_cpu_dispatch_features & SPAN_CPU_FEATURE_SSE2))
+    {
+        vec_lmsi16_sse2(x, y, n, error);
+        return;
+    }
+    /*endif*/
+#endif
     for (i = 0;  i < n;  i++)
         y[i] += (int16_t) (((int32_t) x[i]*(int32_t) error) >> 15);
     /*endfor*/
@@ -0,0 +1,466 @@
+/*
+ * SpanDSP - a series of DSP components for telephony
+ *
+ * codec_bench.c - Throughput benchmarks for the speech codecs.
+ *
+ * Written by Steve Underwood <steveu@coppice.org>
+ *
+ * Copyright (C) 2026 Steve Underwood
+ *
+ * All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2, as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+/*! \page codec_bench_page Speech codec throughput benchmarks
+\section codec_bench_page_sec_1 What does it do?
+codec_bench times the encoder and decoder of each speech codec - G.711, G.722, G.726,
+GSM 06.10, IMA and OKI ADPCM, and LPC-10 - working through real speech, one frame at a
+time. The narrowband codecs use ../test-data/local/short_nb_voice.wav, and G.722 uses
+../test-data/local/short_wb_voice.wav. Each file is processed several times, and the
+fastest pass is reported, so the results are not upset by other activity on the machine.
+
+The results are written to stdout as CSV, with one line for each codec and direction:
+    - the codec, and whether it is encoding or decoding.
+    - the sample rate and frame length.
+    - the CPU features in use, as a mask of SPAN_CPU_FEATURE_xxx values.
+    - the CPU clock ticks, from rdtscll(), and nanoseconds, spent on each sample.
+    - the number of channels one CPU core could handle in real time.
+
+The output is intended to be kept with each release, so changes in speed can be tracked.
+
+\section codec_bench_page_sec_2 How is it used?
+codec_bench [-c <codec>] [-m <CPU feature mask>] [-p <passes>]
+    - -c runs only the codecs whose names start with the given string.
+    - -m restricts the CPU features used, so the speed of each code path may be compared.
+    - -p sets the number of passes through the audio. The default is 5.
+*/
+
+#if defined(HAVE_CONFIG_H)
+#include "config.h"
+#endif
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <string.h>
+#include <sys/time.h>
+#include <sndfile.h>
+
+#include "spandsp.h"
+#include "spandsp-sim.h"
+
+#define NB_IN_FILE_NAME     "../test-data/local/short_nb_voice.wav"
+#define WB_IN_FILE_NAME     "../test-data/local/short_wb_voice.wav"
+
+#define MAX_SAMPLES         (16000*60)
+#define MAX_FRAMES          (MAX_SAMPLES/80)
+
+enum
+{
+    CODEC_G711,
+    CODEC_G722,
+    CODEC_G726,
+    CODEC_GSM0610,
+    CODEC_IMA_ADPCM,
+    CODEC_OKI_ADPCM,
+    CODEC_LPC10
+};
+
+typedef struct
+{
+    const char *name;
+    int codec;
+    /*! The mode or bit rate, as each codec's init routine expects it */
+    int mode;
+    int sample_rate;
+    int frame_len;
+} codec_desc_t;
+
+static const codec_desc_t codecs[] =
+{
+    {"g711_alaw", CODEC_G711, G711_ALAW, 8000, 160},
+    {"g711_ulaw", CODEC_G711, G711_ULAW, 8000, 160},
+    {"g722_64k", CODEC_G722, 64000, 16000, 320},
+    {"g722_56k", CODEC_G722, 56000, 16000, 320},
+    {"g722_48k", CODEC_G722, 48000, 16000, 320},
+    {"g726_16k", CODEC_G726, 16000, 8000, 160},
+    {"g726_24k", CODEC_G726, 24000, 8000, 160},
+    {"g726_32k", CODEC_G726, 32000, 8000, 160},
+    {"g726_40k", CODEC_G726, 40000, 8000, 160},
+    {"gsm0610", CODEC_GSM0610, GSM0610_PACKING_VOIP, 8000, 160},
+    {"ima_adpcm_dvi4", CODEC_IMA_ADPCM, IMA_ADPCM_DVI4, 8000, 160},
+    {"ima_adpcm_vdvi", CODEC_IMA_ADPCM, IMA_ADPCM_VDVI, 8000, 160},
+    {"oki_adpcm_32k", CODEC_OKI_ADPCM, 32000, 8000, 160},
+    {"oki_adpcm_24k", CODEC_OKI_ADPCM, 24000, 8000, 160},
+    {"lpc10", CODEC_LPC10, 0, 8000, LPC10_SAMPLES_PER_FRAME},
+    {NULL, 0, 0, 0, 0}
+};
+
+static int16_t nb_amp[MAX_SAMPLES];
+static int16_t wb_amp[MAX_SAMPLES];
+static int16_t out_amp[2*MAX_SAMPLES];
+static uint8_t code[2*MAX_SAMPLES];
+static int code_len[MAX_FRAMES];
+
+static int nb_samples;
+static int wb_samples;
+
+static int read_file(const char *name, int sample_rate, int16_t amp[])
+{
+    SNDFILE *inhandle;
+    SF_INFO info;
+    int samples;
+
+    memset(&info, 0, sizeof(info));
+    if ((inhandle = sf_open(name, SFM_READ, &info)) == NULL)
+    {
+        fprintf(stderr, "    Cannot open audio file '%s'\n", name);
+        exit(2);
+    }
+    /*endif*/
+    if (info.samplerate != sample_rate)
+    {
+        fprintf(stderr, "    Unexpected sample rate %d in audio file '%s'\n", info.samplerate, name);
+        exit(2);
+    }
+    /*endif*/
+    if (info.channels != 1)
+    {
+        fprintf(stderr, "    Unexpected number of channels in audio file '%s'\n", name);
+        exit(2);
+    }
+    /*endif*/
+    samples = sf_readf_short(inhandle, amp, MAX_SAMPLES);
+    if (sf_close(inhandle))
+    {
+        fprintf(stderr, "    Cannot close audio file '%s'\n", name);
+        exit(2);
+    }
+    /*endif*/
+    return samples;
+}
+/*- End of function --------------------------------------------------------*/
+
+static double now_ns(void)
+{
+    struct timeval tv;
+
+    gettimeofday(&tv, NULL);
+    return tv.tv_sec*1.0e9 + tv.tv_usec*1.0e3;
+}
+/*- End of function --------------------------------------------------------*/
+
+static void *codec_init(const codec_desc_t *desc, int encode)
+{
+    switch (desc->codec)
+    {
+    case CODEC_G711:
+        return g711_init(NULL, desc->mode);
+    case CODEC_G722:
+        if (encode)
+            return g722_encode_init(NULL, desc->mode, 0);
+        /*endif*/
+        return g722_decode_init(NULL, desc->mode, 0);
+    case CODEC_G726:
+        return g726_init(NULL, desc->mode, G726_ENCODING_LINEAR, G726_PACKING_LEFT);
+    case CODEC_GSM0610:
+        return gsm0610_init(NULL, desc->mode);
+    case CODEC_IMA_ADPCM:
+        return ima_adpcm_init(NULL, desc->mode, 0);
+    case CODEC_OKI_ADPCM:
+        return oki_adpcm_init(NULL, desc->mode);
+    case CODEC_LPC10:
+        if (encode)
+            return lpc10_encode_init(NULL, false);
+        /*endif*/
+        return lpc10_decode_init(NULL, false);
+    }
+    /*endswitch*/
+    return NULL;
+}
+/*- End of function --------------------------------------------------------*/
+
+static void codec_free(const codec_desc_t *desc, void *s, int encode)
+{
+    switch (desc->codec)
+    {
+    case CODEC_G711:
+        g711_free((g711_state_t *) s);
+        break;
+    case CODEC_G722:
+        if (encode)
+            g722_encode_free((g722_encode_state_t *) s);
+        else
+            g722_decode_free((g722_decode_state_t *) s);
+        /*endif*/
+        break;
+    case CODEC_G726:
+        g726_free((g726_state_t *) s);
+        break;
+    case CODEC_GSM0610:
+        gsm0610_free((gsm0610_state_t *) s);
+        break;
+    case CODEC_IMA_ADPCM:
+        ima_adpcm_free((ima_adpcm_state_t *) s);
+        break;
+    case CODEC_OKI_ADPCM:
+        oki_adpcm_free((oki_adpcm_state_t *) s);
+        break;
+    case CODEC_LPC10:
+        if (encode)
+            lpc10_encode_free((lpc10_encode_state_t *) s);
+        else
+            lpc10_decode_free((lpc10_decode_state_t *) s);
+        /*endif*/
+        break;
+    }
+    /*endswitch*/
+}
+/*- End of function --------------------------------------------------------*/
+
+static int codec_encode(const codec_desc_t *desc, void *s, uint8_t data[], const int16_t amp[], int len)
+{
+    switch (desc->codec)
+    {
+    case CODEC_G711:
+        return g711_encode((g711_state_t *) s, data, amp, len);
+    case CODEC_G722:
+        return g722_encode((g722_encode_state_t *) s, data, amp, len);
+    case CODEC_G726:
+        return g726_encode((g726_state_t *) s, data, amp, len);
+    case CODEC_GSM0610:
+        return gsm0610_encode((gsm0610_state_t *) s, data, amp, len);
+    case CODEC_IMA_ADPCM:
+        return ima_adpcm_encode((ima_adpcm_state_t *) s, data, amp, len);
+    case CODEC_OKI_ADPCM:
+        return oki_adpcm_encode((oki_adpcm_state_t *) s, data, amp, len);
+    case CODEC_LPC10:
+        return lpc10_encode((lpc10_encode_state_t *) s, data, amp, len);
+    }
+    /*endswitch*/
+    return 0;
+}
+/*- End of function --------------------------------------------------------*/
+
+static int codec_decode(const codec_desc_t *desc, void *s, int16_t amp[], const uint8_t data[], int len)
+{
+    switch (desc->codec)
+    {
+    case CODEC_G711:
+        return g711_decode((g711_state_t *) s, amp, data, len);
+    case CODEC_G722:
+        return g722_decode((g722_decode_state_t *) s, amp, data, len);
+    case CODEC_G726:
+        return g726_decode((g726_state_t *) s, amp, data, len);
+    case CODEC_GSM0610:
+        return gsm0610_decode((gsm0610_state_t *) s, amp, data, len);
+    case CODEC_IMA_ADPCM:
+        return ima_adpcm_decode((ima_adpcm_state_t *) s, amp, data, len);
+    case CODEC_OKI_ADPCM:
+        return oki_adpcm_decode((oki_adpcm_state_t *) s, amp, data, len);
+    case CODEC_LPC10:
+        return lpc10_decode((lpc10_decode_state_t *) s, amp, data, len);
+    }
+    /*endswitch*/
+    return 0;
+}
+/*- End of function --------------------------------------------------------*/
+
+static void report(const codec_desc_t *desc, const char *direction, int samples, uint64_t ticks, double ns)
+{
+    double ns_per_sample;
+    double channels;
+
+    /* A channel needs 1/sample_rate seconds of CPU time, or less, for each sample if it is
+       to keep up with real time. */
+    ns_per_sample = ns/samples;
+    channels = (ns_per_sample > 0.0)  ?  1.0e9/(desc->sample_rate*ns_per_sample)  :  0.0;
+    printf("%s,%s,%d,%d,0x%X,%.2f,%.3f,%.0f\n",
+           desc->name,
+           direction,
+           desc->sample_rate,
+           desc->frame_len,
+           span_cpu_features_in_use(),
+           (double) ticks/samples,
+           ns_per_sample,
+           channels);
+}
+/*- End of function --------------------------------------------------------*/
+
+static void bench_codec(const codec_desc_t *desc, int passes)
+{
+    const int16_t *amp;
+    void *s;
+    uint64_t start;
+    uint64_t ticks;
+    uint64_t best_ticks;
+    double start_ns;
+    double ns;
+    double best_ns;
+    int samples;
+    int frames;
+    int out_samples;
+    int bytes;
+    int pass;
+    int i;
+    int j;
+
+    if (desc->sample_rate == 16000)
+    {
+        amp = wb_amp;
+        samples = wb_samples;
+    }
+    else
+    {
+        amp = nb_amp;
+        samples = nb_samples;
+    }
+    /*endif*/
+    /* Only whole frames are used, so every codec sees the same kind of work */
+    frames = samples/desc->frame_len;
+    samples = frames*desc->frame_len;
+
+    /* Encode, keeping the length of each frame's code for the decode passes. Each pass
+       starts from a fresh context, but the setup is not included in the timing. */
+    best_ticks = 0;
+    best_ns = 0.0;
+    bytes = 0;
+    for (pass = 0;  pass < passes;  pass++)
+    {
+        s = codec_init(desc, true);
+        bytes = 0;
+        start_ns = now_ns();
+        start = rdtscll();
+        for (i = 0;  i < frames;  i++)
+        {
+            code_len[i] = codec_encode(desc, s, &code[bytes], &amp[i*desc->frame_len], desc->frame_len);
+            bytes += code_len[i];
+        }
+        /*endfor*/
+        ticks = rdtscll() - start;
+        ns = now_ns() - start_ns;
+        codec_free(desc, s, true);
+        if (pass == 0  ||  ns < best_ns)
+        {
+            best_ticks = ticks;
+            best_ns = ns;
+        }
+        /*endif*/
+    }
+    /*endfor*/
+    report(desc, "encode", samples, best_ticks, best_ns);
+
+    out_samples = 0;
+    for (pass = 0;  pass < passes;  pass++)
+    {
+        s = codec_init(desc, false);
+        bytes = 0;
+        out_samples = 0;
+        start_ns = now_ns();
+        start = rdtscll();
+        for (i = 0;  i < frames;  i++)
+        {
+            j = codec_decode(desc, s, &out_amp[out_samples], &code[bytes], code_len[i]);
+            out_samples += j;
+            bytes += code_len[i];
+        }
+        /*endfor*/
+        ticks = rdtscll() - start;
+        ns = now_ns() - start_ns;
+        codec_free(desc, s, false);
+        if (pass == 0  ||  ns < best_ns)
+        {
+            best_ticks = ticks;
+            best_ns = ns;
+        }
+        /*endif*/
+    }
+    /*endfor*/
+    /* Rate both directions on the samples of audio handled, which is not always exactly the
+       number which comes out of the decoder. */
+    report(desc, "decode", samples, best_ticks, best_ns);
+}
+/*- End of function --------------------------------------------------------*/
+
+static void usage(void)
+{
+    int i;
+
+    fprintf(stderr, "Usage: codec_bench [-c <codec>] [-m <CPU feature mask>] [-p <passes>]\n");
+    fprintf(stderr, "    -c <codec>  Run only the codecs whose names start with <codec>.\n");
+    fprintf(stderr, "                The codecs are:");
+    for (i = 0;  codecs[i].name;  i++)
+        fprintf(stderr, " %s", codecs[i].name);
+    /*endfor*/
+    fprintf(stderr, "\n");
+    fprintf(stderr, "    -m <mask>   Restrict the CPU features used to those in <mask>, a set of\n");
+    fprintf(stderr, "                SPAN_CPU_FEATURE_xxx bits. Use 0 for the plain C code.\n");
+    fprintf(stderr, "    -p <passes> Set the number of passes through the audio. The fastest pass\n");
+    fprintf(stderr, "                is reported. The default is 5.\n");
+}
+/*- End of function --------------------------------------------------------*/
+
+int main(int argc, char *argv[])
+{
+    const char *select;
+    uint32_t mask;
+    int passes;
+    int opt;
+    int i;
+
+    select = NULL;
+    mask = ~0U;
+    passes = 5;
+    while ((opt = getopt(argc, argv, "c:m:p:")) != -1)
+    {
+        switch (opt)
+        {
+        case 'c':
+            select = optarg;
+            break;
+        case 'm':
+            mask = (uint32_t) strtoul(optarg, NULL, 0);
+            break;
+        case 'p':
+            if ((passes = atoi(optarg)) < 1)
+                passes = 1;
+            /*endif*/
+            break;
+        default:
+            usage();
+            exit(2);
+            break;
+        }
+        /*endswitch*/
+    }
+    /*endwhile*/
+    span_cpu_features_restrict(mask);
+
+    nb_samples = read_file(NB_IN_FILE_NAME, 8000, nb_amp);
+    wb_samples = read_file(WB_IN_FILE_NAME, 16000, wb_amp);
+
+    printf("codec,direction,sample_rate,frame_len,cpu_features,ticks_per_sample,ns_per_sample,channels_per_core\n");
+    for (i = 0;  codecs[i].name;  i++)
+    {
+        if (select  &&  strncmp(codecs[i].name, select, strlen(select)))
+            continue;
+        /*endif*/
+        bench_codec(&codecs[i], passes);
+    }
+    /*endfor*/
+    return 0;
+}
+/*- End of function --------------------------------------------------------*/
+/*- End of file ------------------------------------------------------------*/
@@ -142,10 +142,224 @@ static int test_cvec_dot_prodf(void)
 }
 /*- End of function --------------------------------------------------------*/
 
+static int test_cvec_circular_dot_prodf(void)
+{
+    int i;
+    int j;
+    int pos;
+    int len;
+    complexf_t x[100];
+    complexf_t y[100];
+    complexf_t zsa;
+    complexf_t zsb;
+    complexf_t z1;
+    complexf_t ratio;
+
+    /* Verify that we can do circular sample buffer "dot" linear coefficient buffer
+       operations properly, by doing two sub-dot products. */
+    for (i = 0;  i < 99;  i++)
+    {
+        x[i].re = rand();
+        x[i].im = rand();
+        y[i].re = rand();
+        y[i].im = rand();
+    }
+    /*endfor*/
+
+    len = 95;
+    for (pos = 0;  pos < len;  pos++)
+    {
+        zsa = cvec_circular_dot_prodf(x, y, len, pos);
+        zsb = complex_setf(0.0f, 0.0f);
+        for (i = 0;  i < len;  i++)
+        {
+            j = (pos + i) % len;
+            z1 = complex_mulf(&x[j], &y[i]);
+            zsb = complex_addf(&zsb, &z1);
+        }
+        /*endfor*/
+        ratio.re = zsa.re/zsb.re;
+        ratio.im = zsa.im/zsb.im;
+        if ((ratio.re < 0.9999  ||  ratio.re > 1.0001)
+            ||
+            (ratio.im < 0.9999  ||  ratio.im > 1.0001))
+        {
+            printf("cvec_circular_dot_prodf() - (%f,%f) (%f,%f)\n", zsa.re, zsa.im, zsb.re, zsb.im);
+            printf("Tests failed\n");
+            exit(2);
+        }
+        /*endif*/
+    }
+    /*endfor*/
+    return 0;
+}
+/*- End of function --------------------------------------------------------*/
+
+static void cvec_lmsf_dumb(const complexf_t x[], complexf_t y[], int n, const complexf_t *error)
+{
+    int i;
+
+    for (i = 0;  i < n;  i++)
+    {
+        y[i].re = y[i].re*0.9999f + (x[i].im*error->im + x[i].re*error->re);
+        y[i].im = y[i].im*0.9999f + (x[i].re*error->im - x[i].im*error->re);
+    }
+    /*endfor*/
+}
+/*- End of function --------------------------------------------------------*/
+
+static float frand(void)
+{
+    return 2.0f*rand()/(float) RAND_MAX - 1.0f;
+}
+/*- End of function --------------------------------------------------------*/
+
+static int check_lmsf(const char *name, const complexf_t ya[], const complexf_t yb[], const complexf_t yc[], int n)
+{
+    int i;
+
+    /* ya is from the dispatched code, yb from the scalar code, and yc from the dumb version.
+       The inputs are bounded, so nothing comes from cancelling huge terms, and an absolute
+       error check is meaningful. */
+#if !defined(__FAST_MATH__)
+    /* The dispatched code keeps the scalar code's order of operations, so it should be bit
+       exact, unless the compiler has been allowed to reorder the scalar arithmetic. */
+    if (memcmp(ya, yb, n*sizeof(ya[0])))
+    {
+        printf("%s() - differs from the scalar code\n", name);
+        printf("Tests failed\n");
+        exit(2);
+    }
+    /*endif*/
+#endif
+    for (i = 0;  i < n;  i++)
+    {
+        if (fabsf(ya[i].re - yb[i].re) > 1.0e-6f  ||  fabsf(ya[i].im - yb[i].im) > 1.0e-6f
+            ||
+            fabsf(ya[i].re - yc[i].re) > 1.0e-5f  ||  fabsf(ya[i].im - yc[i].im) > 1.0e-5f)
+        {
+            printf("%s() - %d (%f,%f) (%f,%f) (%f,%f)\n", name, i, ya[i].re, ya[i].im, yb[i].re, yb[i].im, yc[i].re, yc[i].im);
+            printf("Tests failed\n");
+            exit(2);
+        }
+        /*endif*/
+    }
+    /*endfor*/
+    return 0;
+}
+/*- End of function --------------------------------------------------------*/
+
+static int test_cvec_lmsf(void)
+{
+    int i;
+    uint32_t features;
+    complexf_t x[100];
+    complexf_t ya[100];
+    complexf_t yb[100];
+    complexf_t yc[100];
+    complexf_t error;
+
+    for (i = 0;  i < 99;  i++)
+    {
+        x[i].re = frand();
+        x[i].im = frand();
+        ya[i].re =
+        yb[i].re =
+        yc[i].re = frand();
+        ya[i].im =
+        yb[i].im =
+        yc[i].im = frand();
+    }
+    /*endfor*/
+    features = span_cpu_features_in_use();
+    for (i = 1;  i < 99;  i++)
+    {
+        error.re = 0.01f*frand();
+        error.im = 0.01f*frand();
+        cvec_lmsf(x, ya, i, &error);
+        span_cpu_features_restrict(0);
+        cvec_lmsf(x, yb, i, &error);
+        span_cpu_features_restrict(features);
+        cvec_lmsf_dumb(x, yc, i, &error);
+        check_lmsf("cvec_lmsf", ya, yb, yc, 99);
+    }
+    /*endfor*/
+    return 0;
+}
+/*- End of function --------------------------------------------------------*/
+
+static int test_cvec_circular_lmsf(void)
+{
+    int i;
+    int j;
+    int pos;
+    int len;
+    uint32_t features;
+    complexf_t x[100];
+    complexf_t ya[100];
+    complexf_t yb[100];
+    complexf_t yc[100];
+    complexf_t error;
+
+    /* Verify that we can do circular sample buffer LMS updates of a linear coefficient
+       buffer properly. */
+    for (i = 0;  i < 99;  i++)
+    {
+        x[i].re = frand();
+        x[i].im = frand();
+        ya[i].re =
+        yb[i].re =
+        yc[i].re = frand();
+        ya[i].im =
+        yb[i].im =
+        yc[i].im = frand();
+    }
+    /*endfor*/
+
+    features = span_cpu_features_in_use();
+    len = 95;
+    for (pos = 0;  pos < len;  pos++)
+    {
+        error.re = 0.01f*frand();
+        error.im = 0.01f*frand();
+        cvec_circular_lmsf(x, ya, len, pos, &error);
+        span_cpu_features_restrict(0);
+        cvec_circular_lmsf(x, yb, len, pos, &error);
+        span_cpu_features_restrict(features);
+        for (i = 0;  i < len;  i++)
+        {
+            j = (pos + i) % len;
+            cvec_lmsf_dumb(&x[j], &yc[i], 1, &error);
+        }
+        /*endfor*/
+        check_lmsf("cvec_circular_lmsf", ya, yb, yc, 99);
+    }
+    /*endfor*/
+    return 0;
+}
+/*- End of function --------------------------------------------------------*/
+
 int main(int argc, char *argv[])
 {
+    static const uint32_t feature_masks[] =
+    {
+        ~0U,
+        0
+    };
+    int i;
+
     test_cvec_mulf();
-    test_cvec_dot_prodf();
+    /* Check every code path the run time dispatch might select on this machine */
+    for (i = 0;  i < 2;  i++)
+    {
+        printf("Using CPU features 0x%X\n", span_cpu_features_restrict(feature_masks[i]));
+        test_cvec_dot_prodf();
+        test_cvec_circular_dot_prodf();
+        test_cvec_lmsf();
+        test_cvec_circular_lmsf();
+    }
+    /*endfor*/
+    span_cpu_features_restrict(~0U);
 
     printf("Tests passed.\n");
     return 0;
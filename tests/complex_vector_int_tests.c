@@ -66,6 +66,13 @@ static int test_cvec_dot_prodi16(void)
         y[i].im = rand();
     }
     /*endfor*/
+    /* Make sure the extremes of the multiply are exercised */
+    x[0].re = INT16_MIN;
+    x[0].im = INT16_MIN;
+    y[0].re = INT16_MIN;
+    y[0].im = INT16_MAX;
+    x[9].re = INT16_MAX;
+    y[9].im = INT16_MIN;
 
     for (i = 1;  i < 99;  i++)
     {
@@ -83,6 +90,56 @@ static int test_cvec_dot_prodi16(void)
 }
 /*- End of function --------------------------------------------------------*/
 
+static complexi32_t cvec_dot_prodi32_dumb(const complexi32_t x[], const complexi32_t y[], int n)
+{
+    complexi32_t z;
+    int i;
+
+    z = complex_seti32(0, 0);
+    for (i = 0;  i < n;  i++)
+    {
+        z.re += (x[i].re*y[i].re - x[i].im*y[i].im);
+        z.im += (x[i].re*y[i].im + x[i].im*y[i].re);
+    }
+    /*endfor*/
+    return z;
+}
+/*- End of function --------------------------------------------------------*/
+
+static int test_cvec_dot_prodi32(void)
+{
+    int i;
+    complexi32_t za;
+    complexi32_t zb;
+    complexi32_t x[99];
+    complexi32_t y[99];
+
+    /* Keep the values modest, so the sums cannot overflow */
+    for (i = 0;  i < 99;  i++)
+    {
+        x[i].re = rand()%4095 - 2047;
+        x[i].im = rand()%4095 - 2047;
+        y[i].re = rand()%4095 - 2047;
+        y[i].im = rand()%4095 - 2047;
+    }
+    /*endfor*/
+
+    for (i = 1;  i < 99;  i++)
+    {
+        za = cvec_dot_prodi32(x, y, i);
+        zb = cvec_dot_prodi32_dumb(x, y, i);
+        if (za.re != zb.re  ||  za.im != zb.im)
+        {
+            printf("Tests failed\n");
+            exit(2);
+        }
+        /*endif*/
+    }
+    /*endfor*/
+    return 0;
+}
+/*- End of function --------------------------------------------------------*/
+
 static int test_cvec_circular_dot_prodi16(void)
 {
     int i;
@@ -130,10 +187,140 @@ static int test_cvec_circular_dot_prodi16(void)
 }
 /*- End of function --------------------------------------------------------*/
 
+static void cvec_lmsi16_dumb(const complexi16_t x[], complexi16_t y[], int n, const complexi16_t *error)
+{
+    int i;
+
+    for (i = 0;  i < n;  i++)
+    {
+        y[i].re += (int16_t) (((int32_t) x[i].im*(int32_t) error->im + (int32_t) x[i].re*(int32_t) error->re) >> 12);
+        y[i].im += (int16_t) (((int32_t) x[i].re*(int32_t) error->im - (int32_t) x[i].im*(int32_t) error->re) >> 12);
+    }
+    /*endfor*/
+}
+/*- End of function --------------------------------------------------------*/
+
+static int test_cvec_lmsi16(void)
+{
+    int i;
+    int j;
+    complexi16_t x[99];
+    complexi16_t ya[99];
+    complexi16_t yb[99];
+    complexi16_t error;
+
+    for (i = 0;  i < 99;  i++)
+    {
+        x[i].re = rand();
+        x[i].im = rand();
+        ya[i].re =
+        yb[i].re = rand();
+        ya[i].im =
+        yb[i].im = rand();
+    }
+    /*endfor*/
+    /* Make sure the extremes of the multiply are exercised */
+    x[0].re = INT16_MIN;
+    x[0].im = INT16_MIN;
+    x[17].re = INT16_MAX;
+    x[42].im = INT16_MIN;
+
+    for (i = 1;  i < 99;  i++)
+    {
+        error.re = (i == 42)  ?  INT16_MIN  :  rand();
+        error.im = (i == 42)  ?  INT16_MAX  :  rand();
+        cvec_lmsi16(x, ya, i, &error);
+        cvec_lmsi16_dumb(x, yb, i, &error);
+        for (j = 0;  j < 99;  j++)
+        {
+            if (ya[j].re != yb[j].re  ||  ya[j].im != yb[j].im)
+            {
+                printf("Tests failed\n");
+                exit(2);
+            }
+            /*endif*/
+        }
+        /*endfor*/
+    }
+    /*endfor*/
+    return 0;
+}
+/*- End of function --------------------------------------------------------*/
+
+static int test_cvec_circular_lmsi16(void)
+{
+    int i;
+    int j;
+    int pos;
+    int len;
+    complexi16_t x[99];
+    complexi16_t ya[99];
+    complexi16_t yb[99];
+    complexi16_t error;
+
+    /* Verify that we can do circular sample buffer LMS updates of a linear coefficient
+       buffer properly. */
+    for (i = 0;  i < 99;  i++)
+    {
+        x[i].re = rand();
+        x[i].im = rand();
+        ya[i].re =
+        yb[i].re = rand();
+        ya[i].im =
+        yb[i].im = rand();
+    }
+    /*endfor*/
+
+    len = 95;
+    for (pos = 0;  pos < len;  pos++)
+    {
+        error.re = rand();
+        error.im = rand();
+        cvec_circular_lmsi16(x, ya, len, pos, &error);
+        for (i = 0;  i < len;  i++)
+        {
+            j = (pos + i) % len;
+            yb[i].re += (int16_t) (((int32_t) x[j].im*(int32_t) error.im + (int32_t) x[j].re*(int32_t) error.re) >> 12);
+            yb[i].im += (int16_t) (((int32_t) x[j].re*(int32_t) error.im - (int32_t) x[j].im*(int32_t) error.re) >> 12);
+        }
+        /*endfor*/
+        for (i = 0;  i < 99;  i++)
+        {
+            if (ya[i].re != yb[i].re  ||  ya[i].im != yb[i].im)
+            {
+                printf("Tests failed\n");
+                exit(2);
+            }
+            /*endif*/
+        }
+        /*endfor*/
+    }
+    /*endfor*/
+    return 0;
+}
+/*- End of function --------------------------------------------------------*/
+
 int main(int argc, char *argv[])
 {
-    test_cvec_dot_prodi16();
-    test_cvec_circular_dot_prodi16();
+    static const uint32_t feature_masks[] =
+    {
+        ~0U,
+        0
+    };
+    int i;
+
+    /* Check every code path the run time dispatch might select on this machine */
+    for (i = 0;  i < 2;  i++)
+    {
+        printf("Using CPU features 0x%X\n", span_cpu_features_restrict(feature_masks[i]));
+        test_cvec_dot_prodi16();
+        test_cvec_dot_prodi32();
+        test_cvec_circular_dot_prodi16();
+        test_cvec_lmsi16();
+        test_cvec_circular_lmsi16();
+    }
+    /*endfor*/
+    span_cpu_features_restrict(~0U);
 
     printf("Tests passed.\n");
     return 0;
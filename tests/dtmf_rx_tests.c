@@ -115,6 +115,8 @@ they wish to give it away for free.
 
 #define SAMPLES_PER_CHUNK           160
 
+#define BANK_TEST_CHANNELS          10
+
 #define ALL_POSSIBLE_DIGITS         "123A456B789C*0#D"
 
 #define MITEL_DIR                   "../test-data/mitel/"
@@ -893,6 +895,201 @@ static void callback_function_tests(void)
 }
 /*- End of function --------------------------------------------------------*/
 
+static void bank_tests(void)
+{
+    /* Four passes over the digits, with each digit taking up to 1000 samples */
+    static int16_t bank_amp[BANK_TEST_CHANNELS][4*16*1000];
+    char single_digits[BANK_TEST_CHANNELS][MAX_DTMF_DIGITS + 1];
+    char bank_digits[MAX_DTMF_DIGITS + 1];
+    char expected_digits[MAX_DTMF_DIGITS + 1];
+    const int16_t *amps[BANK_TEST_CHANNELS];
+    dtmf_rx_state_t *single[BANK_TEST_CHANNELS];
+    dtmf_rx_bank_state_t *bank;
+    awgn_state_t *noise_source;
+    int len[BANK_TEST_CHANNELS];
+    int max_len;
+    int sample;
+    int chunk;
+    int i;
+    int k;
+
+    /* Check a bank of receivers detects exactly what the same number of separate
+       receivers do, with each channel carrying different digits, at different
+       levels and timings, in noise. The S/N ratio stays well above the 9dB or so
+       the receiver can tolerate, so every digit should be heard. */
+    printf("Test: Receiver bank.\n");
+    if ((bank = dtmf_rx_bank_init(BANK_TEST_CHANNELS, NULL, NULL)) == NULL)
+    {
+        printf("    Failed to create the bank\n");
+        exit(2);
+    }
+    /*endif*/
+    max_len = 0;
+    for (k = 0;  k < BANK_TEST_CHANNELS;  k++)
+    {
+        single[k] = dtmf_rx_init(NULL, NULL, NULL);
+        if (use_dialtone_filter  ||  max_forward_twist >= 0.0f  ||  max_reverse_twist >= 0.0f)
+        {
+            dtmf_rx_parms(single[k], use_dialtone_filter, max_forward_twist, max_reverse_twist, -99.0f);
+            dtmf_rx_parms(dtmf_rx_bank_get_channel(bank, k), use_dialtone_filter, max_forward_twist, max_reverse_twist, -99.0f);
+        }
+        /*endif*/
+        my_dtmf_gen_init(0.0f, -12 - 2*k, 0.0f, -12 - 2*k + (k%5) - 2, 35 + 2*k, 45 + 2*k);
+        len[k] = 0;
+        for (i = 0;  i < 4;  i++)
+            len[k] += my_dtmf_generate(bank_amp[k] + len[k], ALL_POSSIBLE_DIGITS + (k%8));
+        /*endfor*/
+        noise_source = awgn_init_dbm0(NULL, 1234567 + k, -40.0f - k);
+        for (sample = 0;  sample < len[k];  sample++)
+            bank_amp[k][sample] = sat_add16(bank_amp[k][sample], awgn(noise_source));
+        /*endfor*/
+        awgn_free(noise_source);
+        codec_munge(munge, bank_amp[k], len[k]);
+        if (len[k] > max_len)
+            max_len = len[k];
+        /*endif*/
+    }
+    /*endfor*/
+    /* Pad the shorter channels with silence, so every channel is heard in full */
+    for (k = 0;  k < BANK_TEST_CHANNELS;  k++)
+        vec_zeroi16(&bank_amp[k][len[k]], max_len - len[k]);
+    /*endfor*/
+    /* Feed the bank in irregular chunks, to exercise partial blocks */
+    for (sample = 0, chunk = 1;  sample < max_len;  sample += chunk, chunk = (chunk*7 + 3)%317)
+    {
+        if (chunk > max_len - sample)
+            chunk = max_len - sample;
+        /*endif*/
+        for (k = 0;  k < BANK_TEST_CHANNELS;  k++)
+        {
+            dtmf_rx(single[k], &bank_amp[k][sample], chunk);
+            amps[k] = &bank_amp[k][sample];
+        }
+        /*endfor*/
+        dtmf_rx_bank(bank, amps, chunk);
+        for (k = 0;  k < BANK_TEST_CHANNELS;  k++)
+        {
+            if (dtmf_rx_status(single[k]) != dtmf_rx_status(dtmf_rx_bank_get_channel(bank, k)))
+            {
+                printf("    Status mismatch on channel %d at sample %d\n", k, sample);
+                printf("    Failed\n");
+                exit(2);
+            }
+            /*endif*/
+        }
+        /*endfor*/
+    }
+    /*endfor*/
+    for (k = 0;  k < BANK_TEST_CHANNELS;  k++)
+    {
+        dtmf_rx_get(single[k], single_digits[k], MAX_DTMF_DIGITS);
+        dtmf_rx_get(dtmf_rx_bank_get_channel(bank, k), bank_digits, MAX_DTMF_DIGITS);
+        printf("    Channel %d received '%s'\n", k, bank_digits);
+        if (strcmp(single_digits[k], bank_digits))
+        {
+            printf("    Channel %d should have received '%s'\n", k, single_digits[k]);
+            printf("    Failed\n");
+            exit(2);
+        }
+        /*endif*/
+        /* Make sure the bank really heard the digits, rather than just agreeing with the
+           separate receivers */
+        expected_digits[0] = '\0';
+        for (i = 0;  i < 4;  i++)
+            strcat(expected_digits, ALL_POSSIBLE_DIGITS + (k%8));
+        /*endfor*/
+        if (strcmp(expected_digits, bank_digits))
+        {
+            printf("    Channel %d should have received '%s'\n", k, expected_digits);
+            printf("    Failed\n");
+            exit(2);
+        }
+        /*endif*/
+        dtmf_rx_free(single[k]);
+    }
+    /*endfor*/
+    dtmf_rx_bank_free(bank);
+    printf("    Passed\n");
+}
+/*- End of function --------------------------------------------------------*/
+
+static void power_gate_tests(void)
+{
+    char gated_digits[MAX_DTMF_DIGITS + 1];
+    char ungated_digits[MAX_DTMF_DIGITS + 1];
+    dtmf_rx_state_t *gated;
+    dtmf_rx_state_t *ungated;
+    power_gate_t *gate;
+    awgn_state_t *noise_source;
+    int len;
+    int sample;
+    int chunk;
+    int i;
+
+    /* Check the power gate skips the quiet gaps between digits, without changing
+       what is detected. */
+    printf("Test: Power gate.\n");
+    gated = dtmf_rx_init(NULL, NULL, NULL);
+    ungated = dtmf_rx_init(NULL, NULL, NULL);
+    if (use_dialtone_filter  ||  max_forward_twist >= 0.0f  ||  max_reverse_twist >= 0.0f)
+    {
+        dtmf_rx_parms(gated, use_dialtone_filter, max_forward_twist, max_reverse_twist, -99.0f);
+        dtmf_rx_parms(ungated, use_dialtone_filter, max_forward_twist, max_reverse_twist, -99.0f);
+    }
+    /*endif*/
+    power_gate_set_level(dtmf_rx_get_power_gate(ungated), -99.0f);
+    my_dtmf_gen_init(0.0f, -20, 0.0f, -22, 50, 500);
+    len = 0;
+    for (i = 0;  i < 2;  i++)
+        len += my_dtmf_generate(amp + len, ALL_POSSIBLE_DIGITS);
+    /*endfor*/
+    noise_source = awgn_init_dbm0(NULL, 1234567, -70.0f);
+    for (sample = 0;  sample < len;  sample++)
+        amp[sample] = sat_add16(amp[sample], awgn(noise_source));
+    /*endfor*/
+    awgn_free(noise_source);
+    codec_munge(munge, amp, len);
+    for (sample = 0, chunk = 1;  sample < len;  sample += chunk, chunk = (chunk*7 + 3)%317)
+    {
+        if (chunk > len - sample)
+            chunk = len - sample;
+        /*endif*/
+        dtmf_rx(gated, &amp[sample], chunk);
+        dtmf_rx(ungated, &amp[sample], chunk);
+        if (dtmf_rx_status(gated) != dtmf_rx_status(ungated))
+        {
+            printf("    Status mismatch at sample %d\n", sample);
+            printf("    Failed\n");
+            exit(2);
+        }
+        /*endif*/
+    }
+    /*endfor*/
+    dtmf_rx_get(gated, gated_digits, MAX_DTMF_DIGITS);
+    dtmf_rx_get(ungated, ungated_digits, MAX_DTMF_DIGITS);
+    gate = dtmf_rx_get_power_gate(gated);
+    printf("    Received '%s'\n", gated_digits);
+    printf("    %d of %d blocks skipped\n", power_gate_skipped_blocks(gate), power_gate_blocks(gate));
+    if (strcmp(gated_digits, ungated_digits)  ||  power_gate_skipped_blocks(gate) == 0)
+    {
+        printf("    Should have received '%s', with some blocks skipped\n", ungated_digits);
+        printf("    Failed\n");
+        exit(2);
+    }
+    /*endif*/
+    if (power_gate_skipped_blocks(dtmf_rx_get_power_gate(ungated)) != 0)
+    {
+        printf("    The disabled gate skipped some blocks\n");
+        printf("    Failed\n");
+        exit(2);
+    }
+    /*endif*/
+    dtmf_rx_free(gated);
+    dtmf_rx_free(ungated);
+    printf("    Passed\n");
+}
+/*- End of function --------------------------------------------------------*/
+
 static void decode_test(const char *test_file)
 {
     int16_t amp[SAMPLES_PER_CHUNK];
@@ -990,6 +1187,8 @@ int main(int argc, char *argv[])
         dial_tone_tolerance_tests();
         callback_function_tests();
         printf("    Passed\n");
+        bank_tests();
+        power_gate_tests();
         duration = time(NULL) - now;
         printf("Tests passed in %ds\n", duration);
     }
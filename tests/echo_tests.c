@@ -69,6 +69,13 @@ all the tests in G.168 are fully implemented at this time.
 #endif
 
 #define TEST_EC_TAPS            256
+#define BANK_TEST_CHANNELS      4
+#define FD_TEST_EC_TAPS         1024
+#define FD_TEST_SECONDS         10
+#define FD_TEST_LINE_MODEL      1
+#define FD_TEST_ECHO_DELAY      400
+#define FD_TEST_MIN_ERLE        30.0f
+#define SPARSE_TEST_EARLY_SECONDS   2
 
 #define RESIDUE_FILE_NAME       "residue_sound.wav"
 
@@ -1470,6 +1477,461 @@ static int perform_test_15(void)
 }
 /*- End of function --------------------------------------------------------*/
 
+static void make_delayed_echo(int16_t rout[], int16_t sin[], int total, int model, int delay)
+{
+    channel_model_state_t chan;
+    awgn_state_t noise_source;
+    float hoth_noise;
+    int i;
+
+    /* Pass roughly Hoth shaped noise through one of the G.168 hybrid models, behind a
+       bulk delay, with no codec munging and no far end signal. */
+    if (channel_model_create(&chan, model, -12.0f, -1))
+    {
+        fprintf(stderr, "    Failed to create line model\n");
+        exit(2);
+    }
+    /*endif*/
+    awgn_init_dbm0(&noise_source, 1234567, -10.0f);
+    hoth_noise = 0.0f;
+    for (i = 0;  i < total;  i++)
+    {
+        hoth_noise = hoth_noise*0.625f + awgn(&noise_source)*0.375f;
+        rout[i] = (int16_t) hoth_noise;
+        sin[i] = channel_model(&chan, (i >= delay)  ?  rout[i - delay]  :  0, 0);
+    }
+    /*endfor*/
+    fir32_free(&chan.impulse);
+}
+/*- End of function --------------------------------------------------------*/
+
+static float measure_erle(echo_can_state_t *ctx, const int16_t rout[], const int16_t sin[], int start, int end)
+{
+    double sin_energy;
+    double sout_energy;
+    int16_t sout;
+    int i;
+
+    /* Run the canceller from start to end, and return the ERLE it achieves over the
+       last second of that period */
+    sin_energy = 0.0;
+    sout_energy = 0.0;
+    for (i = start;  i < end;  i++)
+    {
+        sout = echo_can_update(ctx, rout[i], sin[i]);
+        if (i >= end - SAMPLE_RATE)
+        {
+            sin_energy += (double) sin[i]*(double) sin[i];
+            sout_energy += (double) sout*(double) sout;
+        }
+        /*endif*/
+    }
+    /*endfor*/
+    return 10.0f*log10f((sin_energy + 1.0)/(sout_energy + 1.0));
+}
+/*- End of function --------------------------------------------------------*/
+
+static int perform_test_fd(void)
+{
+    echo_can_state_t *ctx;
+    int16_t *rout;
+    int16_t *sin;
+    float erle_td;
+    float erle_fd;
+    int total;
+
+    /* Converge a long canceller in frequency domain mode, on an echo well beyond the
+       taps it applies in the time domain, and compare it with the time domain mode on
+       the same echo. The NLP is off, so the ERLE is that of the cancellation itself. */
+    print_test_title("Performing frequency domain mode convergence test\n");
+    total = FD_TEST_SECONDS*SAMPLE_RATE;
+    rout = (int16_t *) malloc(total*sizeof(int16_t));
+    sin = (int16_t *) malloc(total*sizeof(int16_t));
+    if (rout == NULL  ||  sin == NULL)
+    {
+        fprintf(stderr, "    Failed to allocate buffers\n");
+        exit(2);
+    }
+    /*endif*/
+    make_delayed_echo(rout, sin, total, FD_TEST_LINE_MODEL, FD_TEST_ECHO_DELAY);
+
+    ctx = echo_can_init(FD_TEST_EC_TAPS, ECHO_CAN_USE_ADAPTION);
+    erle_td = measure_erle(ctx, rout, sin, 0, total);
+    echo_can_free(ctx);
+    ctx = echo_can_init(FD_TEST_EC_TAPS, ECHO_CAN_USE_ADAPTION | ECHO_CAN_USE_FREQ_DOMAIN);
+    erle_fd = measure_erle(ctx, rout, sin, 0, total);
+    echo_can_free(ctx);
+    printf("ERLE after %ds - time domain %.2fdB, frequency domain %.2fdB\n", FD_TEST_SECONDS, erle_td, erle_fd);
+    if (erle_fd < FD_TEST_MIN_ERLE  ||  erle_fd < erle_td - 3.0f)
+    {
+        printf("Test failed\n");
+        exit(2);
+    }
+    /*endif*/
+    printf("Test passed\n");
+
+    free(rout);
+    free(sin);
+    return 0;
+}
+/*- End of function --------------------------------------------------------*/
+
+static int perform_test_sparse(void)
+{
+    echo_can_state_t *ctx;
+    int16_t *rout;
+    int16_t *sin;
+    float erle_nlms;
+    float erle_early;
+    float erle;
+    int window_start;
+    int window_end;
+    int total;
+
+    /* Converge a long canceller on the sparse echo of the frequency domain test, a short
+       hybrid model behind a long bulk delay, with proportionate adaption and the tail
+       window. The NLP is off, so the ERLE is that of the cancellation itself. Early in
+       the convergence the proportionate adaption should be well ahead of the normal
+       adaption. Once converged, the window should have closed in on the echo. */
+    print_test_title("Performing proportionate adaption and tail window convergence test\n");
+    total = FD_TEST_SECONDS*SAMPLE_RATE;
+    rout = (int16_t *) malloc(total*sizeof(int16_t));
+    sin = (int16_t *) malloc(total*sizeof(int16_t));
+    if (rout == NULL  ||  sin == NULL)
+    {
+        fprintf(stderr, "    Failed to allocate buffers\n");
+        exit(2);
+    }
+    /*endif*/
+    make_delayed_echo(rout, sin, total, FD_TEST_LINE_MODEL, FD_TEST_ECHO_DELAY);
+
+    ctx = echo_can_init(FD_TEST_EC_TAPS, ECHO_CAN_USE_ADAPTION);
+    erle_nlms = measure_erle(ctx, rout, sin, 0, SPARSE_TEST_EARLY_SECONDS*SAMPLE_RATE);
+    echo_can_free(ctx);
+    ctx = echo_can_init(FD_TEST_EC_TAPS, ECHO_CAN_USE_ADAPTION | ECHO_CAN_USE_PNLMS | ECHO_CAN_USE_TAIL_WINDOW);
+    erle_early = measure_erle(ctx, rout, sin, 0, SPARSE_TEST_EARLY_SECONDS*SAMPLE_RATE);
+    erle = measure_erle(ctx, rout, sin, SPARSE_TEST_EARLY_SECONDS*SAMPLE_RATE, total);
+    window_start = ctx->window_start;
+    window_end = ctx->window_start + ctx->window_len;
+    echo_can_free(ctx);
+    printf("ERLE after %ds - normal %.2fdB, proportionate %.2fdB\n", SPARSE_TEST_EARLY_SECONDS, erle_nlms, erle_early);
+    printf("ERLE after %ds - proportionate %.2fdB, with taps %d to %d of %d active\n",
+           FD_TEST_SECONDS,
+           erle,
+           window_start,
+           window_end - 1,
+           FD_TEST_EC_TAPS);
+    /* The echo starts at the bulk delay, and the line model is 64 taps long. The window
+       may extend a little either side of it. */
+    if (erle_early < erle_nlms + 10.0f
+        ||
+        erle < FD_TEST_MIN_ERLE
+        ||
+        window_start < FD_TEST_ECHO_DELAY - 32
+        ||
+        window_end > FD_TEST_ECHO_DELAY + 64 + 96)
+    {
+        printf("Test failed\n");
+        exit(2);
+    }
+    /*endif*/
+    printf("Test passed\n");
+
+    free(rout);
+    free(sin);
+    return 0;
+}
+/*- End of function --------------------------------------------------------*/
+
+static int perform_test_stats(void)
+{
+    echo_can_state_t *ctx;
+    echo_can_stats_t stats;
+
+    /* Check the statistics track what the canceller is doing */
+    print_test_title("Performing statistics test\n");
+    ctx = echo_can_init(TEST_EC_TAPS, 0);
+
+    echo_can_flush(ctx);
+    echo_can_adaption_mode(ctx, ECHO_CAN_USE_ADAPTION);
+
+    /* Converge the canceller */
+    signal_restart(&local_css, 0.0f);
+    run_test(ctx, local_css_signal, silence, 5000);
+    echo_can_get_stats(ctx, &stats);
+    printf("Samples %u, ERL %.2fdB, ERLE %.2fdB, DTD hits %u, adapted %u\n",
+           stats.samples,
+           stats.erl,
+           stats.erle,
+           stats.dtd_hits,
+           stats.adapted_samples);
+    if (stats.samples != 5000*SAMPLE_RATE/1000
+        ||
+        stats.adapted_samples == 0
+        ||
+        stats.erle < 10.0f)
+    {
+        printf("Test failed\n");
+        exit(2);
+    }
+    /*endif*/
+
+    /* Apply double talk */
+    signal_restart(&far_css, 0.0f);
+    run_test(ctx, local_css_signal, far_css_signal, 2000);
+    echo_can_get_stats(ctx, &stats);
+    printf("Samples %u, ERL %.2fdB, ERLE %.2fdB, DTD hits %u, double talk skips %u\n",
+           stats.samples,
+           stats.erl,
+           stats.erle,
+           stats.dtd_hits,
+           stats.skipped_double_talk);
+    if (stats.dtd_hits == 0  ||  stats.skipped_double_talk == 0)
+    {
+        printf("Test failed\n");
+        exit(2);
+    }
+    /*endif*/
+
+    /* A flush should clear the statistics */
+    echo_can_flush(ctx);
+    echo_can_get_stats(ctx, &stats);
+    if (stats.samples != 0  ||  stats.dtd_hits != 0)
+    {
+        printf("Test failed\n");
+        exit(2);
+    }
+    /*endif*/
+    printf("Test passed\n");
+
+    echo_can_free(ctx);
+    return 0;
+}
+/*- End of function --------------------------------------------------------*/
+
+static int perform_test_block(void)
+{
+    static const int block_sizes[] =
+    {
+        1, 7, 80, 160, 161, 240, 0
+    };
+    static const struct
+    {
+        int taps;
+        int mode;
+    } configs[] =
+    {
+        {TEST_EC_TAPS, ECHO_CAN_USE_ADAPTION | ECHO_CAN_USE_NLP | ECHO_CAN_USE_CNG | ECHO_CAN_USE_RX_HPF},
+        {TEST_EC_TAPS, ECHO_CAN_USE_ADAPTION},
+        {64, ECHO_CAN_USE_ADAPTION},
+        {128, ECHO_CAN_USE_ADAPTION | ECHO_CAN_USE_TX_HPF},
+        {200, ECHO_CAN_USE_ADAPTION | ECHO_CAN_USE_RX_HPF},
+        {200, ECHO_CAN_USE_ADAPTION | ECHO_CAN_USE_NLP | ECHO_CAN_USE_CNG},
+        {0, 0}
+    };
+    echo_can_state_t *ctx;
+    echo_can_state_t *ctx_block;
+    int16_t *rout;
+    int16_t *sin;
+    int16_t *sout;
+    int16_t *sout_block;
+    int16_t sgen;
+    int total;
+    int len;
+    int i;
+    int j;
+    int k;
+    int m;
+
+    /* Check the block based processing gives exactly the same results as the
+       sample by sample processing, whatever size of blocks are used. Do this
+       for a range of tail lengths, with and without the NLP, as some paths
+       (e.g. the narrowband detector) are only exercised when adapting
+       without the NLP. Block size 1 repeats the sample by sample run in a
+       fresh canceller, so any dependence on uninitialised memory shows up as
+       a mismatch. */
+    print_test_title("Performing block processing test\n");
+    total = 10*SAMPLE_RATE;
+    rout = (int16_t *) malloc(total*sizeof(int16_t));
+    sin = (int16_t *) malloc(total*sizeof(int16_t));
+    sout = (int16_t *) malloc(total*sizeof(int16_t));
+    sout_block = (int16_t *) malloc(total*sizeof(int16_t));
+    if (rout == NULL  ||  sin == NULL  ||  sout == NULL  ||  sout_block == NULL)
+    {
+        fprintf(stderr, "    Failed to allocate buffers\n");
+        exit(2);
+    }
+    /*endif*/
+    signal_restart(&local_css, 0.0f);
+    signal_restart(&far_css, -15.0f);
+    ctx = echo_can_init(TEST_EC_TAPS, 0);
+    for (i = 0;  i < total;  i++)
+    {
+        rout[i] = echo_can_hpf_tx(ctx, local_css_signal());
+        /* Apply double talk for part of each second */
+        sgen = ((i%SAMPLE_RATE) > 5*SAMPLE_RATE/8)  ?  far_css_signal()  :  0;
+        sin[i] = channel_model(&chan_model, rout[i], sgen);
+    }
+    /*endfor*/
+    echo_can_free(ctx);
+
+    for (m = 0;  configs[m].taps;  m++)
+    {
+        printf("%d taps, mode 0x%X\n", configs[m].taps, configs[m].mode);
+        ctx = echo_can_init(configs[m].taps, configs[m].mode);
+        for (i = 0;  i < total;  i++)
+            sout[i] = echo_can_update(ctx, rout[i], sin[i]);
+        /*endfor*/
+        echo_can_free(ctx);
+        for (k = 0;  block_sizes[k];  k++)
+        {
+            ctx_block = echo_can_init(configs[m].taps, configs[m].mode);
+            for (i = 0;  i < total;  i += len)
+            {
+                len = block_sizes[k];
+                if (len > total - i)
+                    len = total - i;
+                /*endif*/
+                if (echo_can_update_block(ctx_block, &rout[i], &sin[i], &sout_block[i], len) != len)
+                {
+                    printf("Block processing returned the wrong length\n");
+                    printf("Tests failed.\n");
+                    exit(2);
+                }
+                /*endif*/
+            }
+            /*endfor*/
+            for (j = 0;  j < total;  j++)
+            {
+                if (sout[j] != sout_block[j])
+                {
+                    printf("Block size %d - mismatch at sample %d (%d vs %d)\n", block_sizes[k], j, sout[j], sout_block[j]);
+                    printf("Tests failed.\n");
+                    exit(2);
+                }
+                /*endif*/
+            }
+            /*endfor*/
+            printf("    Block size %d OK\n", block_sizes[k]);
+            echo_can_free(ctx_block);
+        }
+        /*endfor*/
+    }
+    /*endfor*/
+    free(rout);
+    free(sin);
+    free(sout);
+    free(sout_block);
+    return 0;
+}
+/*- End of function --------------------------------------------------------*/
+
+static int perform_test_bank(void)
+{
+    echo_can_bank_state_t *bank;
+    echo_can_state_t *ctx[BANK_TEST_CHANNELS];
+    int16_t *rout[BANK_TEST_CHANNELS];
+    int16_t *sin[BANK_TEST_CHANNELS];
+    int16_t *sout[BANK_TEST_CHANNELS];
+    int16_t *sout_bank[BANK_TEST_CHANNELS];
+    const int16_t *tx_frame[BANK_TEST_CHANNELS];
+    const int16_t *rx_frame[BANK_TEST_CHANNELS];
+    int16_t *clean_frame[BANK_TEST_CHANNELS];
+    int16_t sgen;
+    int mode;
+    int total;
+    int len;
+    int i;
+    int j;
+    int k;
+
+    /* Check a bank of cancellers gives exactly the same results as the same number
+       of separate cancellers. */
+    print_test_title("Performing echo canceller bank test\n");
+    total = 5*SAMPLE_RATE;
+    mode = ECHO_CAN_USE_ADAPTION | ECHO_CAN_USE_NLP | ECHO_CAN_USE_CNG | ECHO_CAN_USE_RX_HPF;
+    if ((bank = echo_can_bank_init(BANK_TEST_CHANNELS, TEST_EC_TAPS, mode)) == NULL)
+    {
+        fprintf(stderr, "    Failed to create the echo canceller bank\n");
+        exit(2);
+    }
+    /*endif*/
+    for (k = 0;  k < BANK_TEST_CHANNELS;  k++)
+    {
+        rout[k] = (int16_t *) malloc(total*sizeof(int16_t));
+        sin[k] = (int16_t *) malloc(total*sizeof(int16_t));
+        sout[k] = (int16_t *) malloc(total*sizeof(int16_t));
+        sout_bank[k] = (int16_t *) malloc(total*sizeof(int16_t));
+        if (rout[k] == NULL  ||  sin[k] == NULL  ||  sout[k] == NULL  ||  sout_bank[k] == NULL)
+        {
+            fprintf(stderr, "    Failed to allocate buffers\n");
+            exit(2);
+        }
+        /*endif*/
+        /* Give each channel a different mix of signals, and a different start point
+           for the double talk. */
+        signal_restart(&local_css, -3.0f*k);
+        signal_restart(&far_css, -15.0f);
+        for (i = 0;  i < total;  i++)
+        {
+            rout[k][i] = local_css_signal();
+            sgen = (((i + k*SAMPLE_RATE/4)%SAMPLE_RATE) > 5*SAMPLE_RATE/8)  ?  far_css_signal()  :  0;
+            sin[k][i] = channel_model(&chan_model, rout[k][i], sgen);
+        }
+        /*endfor*/
+        ctx[k] = echo_can_init(TEST_EC_TAPS, mode);
+    }
+    /*endfor*/
+    /* Make one channel different from the rest */
+    echo_can_adaption_mode(ctx[1], ECHO_CAN_USE_ADAPTION);
+    echo_can_adaption_mode(echo_can_bank_get_channel(bank, 1), ECHO_CAN_USE_ADAPTION);
+
+    for (i = 0;  i < total;  i += len)
+    {
+        len = (total - i < 160)  ?  (total - i)  :  160;
+        for (k = 0;  k < BANK_TEST_CHANNELS;  k++)
+        {
+            echo_can_update_block(ctx[k], &rout[k][i], &sin[k][i], &sout[k][i], len);
+            tx_frame[k] = &rout[k][i];
+            rx_frame[k] = &sin[k][i];
+            clean_frame[k] = &sout_bank[k][i];
+        }
+        /*endfor*/
+        if (echo_can_bank_update_block(bank, tx_frame, rx_frame, clean_frame, len) != len)
+        {
+            printf("Bank processing returned the wrong length\n");
+            printf("Tests failed.\n");
+            exit(2);
+        }
+        /*endif*/
+    }
+    /*endfor*/
+    for (k = 0;  k < BANK_TEST_CHANNELS;  k++)
+    {
+        for (j = 0;  j < total;  j++)
+        {
+            if (sout[k][j] != sout_bank[k][j])
+            {
+                printf("Channel %d - mismatch at sample %d (%d vs %d)\n", k, j, sout[k][j], sout_bank[k][j]);
+                printf("Tests failed.\n");
+                exit(2);
+            }
+            /*endif*/
+        }
+        /*endfor*/
+        printf("Channel %d OK\n", k);
+        echo_can_free(ctx[k]);
+        free(rout[k]);
+        free(sin[k]);
+        free(sout[k]);
+        free(sout_bank[k]);
+    }
+    /*endfor*/
+    echo_can_bank_free(bank);
+    return 0;
+}
+/*- End of function --------------------------------------------------------*/
+
 static int match_test_name(const char *name)
 {
     const struct
@@ -1500,6 +1962,11 @@ static int match_test_name(const char *name)
         {"13", perform_test_13},
         {"14", perform_test_14},
         {"15", perform_test_15},
+        {"block", perform_test_block},
+        {"bank", perform_test_bank},
+        {"fd", perform_test_fd},
+        {"sparse", perform_test_sparse},
+        {"stats", perform_test_stats},
         {NULL, NULL}
     };
     int i;
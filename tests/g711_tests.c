@@ -373,6 +373,192 @@ static void compliance_tests(int log_audio)
 }
 /*- End of function --------------------------------------------------------*/
 
+static const uint32_t feature_masks[] =
+{
+    ~0U,
+    ~(SPAN_CPU_FEATURE_AVX512F | SPAN_CPU_FEATURE_AVX512BW | SPAN_CPU_FEATURE_AVX2),
+    0
+};
+
+static void bulk_tests(void)
+{
+    static int16_t bulk_amp[65536 + 7];
+    static uint8_t bulk_data[65536 + 7];
+    static uint8_t bulk_data2[65536 + 7];
+    g711_state_t *alaw_state;
+    g711_state_t *ulaw_state;
+    int i;
+    int j;
+    int k;
+    int len;
+
+    /* The bulk routines may use SIMD code. Check they give exactly the same answers as the
+       single sample routines, for every possible input, using every code path the run time
+       dispatch might select on this machine. Odd starting points and lengths make sure the
+       tails are handled properly. */
+    alaw_state = g711_init(NULL, G711_ALAW);
+    ulaw_state = g711_init(NULL, G711_ULAW);
+    for (k = 0;  k < 3;  k++)
+    {
+        printf("Bulk conversion tests, using CPU features 0x%X\n", span_cpu_features_restrict(feature_masks[k]));
+        for (j = 0;  j < 7;  j += 3)
+        {
+            len = 65536 - j;
+            for (i = 0;  i < len;  i++)
+                bulk_amp[j + i] = i - 32768;
+            /*endfor*/
+            g711_encode(alaw_state, &bulk_data[j], &bulk_amp[j], len);
+            g711_encode(ulaw_state, &bulk_data2[j], &bulk_amp[j], len);
+            for (i = 0;  i < len;  i++)
+            {
+                if (bulk_data[j + i] != linear_to_alaw(i - 32768))
+                {
+                    printf("Bulk A-law encode mismatch at %d - 0x%02X vs 0x%02X\n", i - 32768, bulk_data[j + i], linear_to_alaw(i - 32768));
+                    printf("Tests failed\n");
+                    exit(2);
+                }
+                /*endif*/
+                if (bulk_data2[j + i] != linear_to_ulaw(i - 32768))
+                {
+                    printf("Bulk u-law encode mismatch at %d - 0x%02X vs 0x%02X\n", i - 32768, bulk_data2[j + i], linear_to_ulaw(i - 32768));
+                    printf("Tests failed\n");
+                    exit(2);
+                }
+                /*endif*/
+            }
+            /*endfor*/
+
+            len = 256*5 + j;
+            for (i = 0;  i < len;  i++)
+                bulk_data[j + i] = (uint8_t) i;
+            /*endfor*/
+            g711_decode(alaw_state, &bulk_amp[j], &bulk_data[j], len);
+            for (i = 0;  i < len;  i++)
+            {
+                if (bulk_amp[j + i] != alaw_to_linear((uint8_t) i))
+                {
+                    printf("Bulk A-law decode mismatch at 0x%02X - %d vs %d\n", i & 0xFF, bulk_amp[j + i], alaw_to_linear((uint8_t) i));
+                    printf("Tests failed\n");
+                    exit(2);
+                }
+                /*endif*/
+            }
+            /*endfor*/
+            g711_decode(ulaw_state, &bulk_amp[j], &bulk_data[j], len);
+            for (i = 0;  i < len;  i++)
+            {
+                if (bulk_amp[j + i] != ulaw_to_linear((uint8_t) i))
+                {
+                    printf("Bulk u-law decode mismatch at 0x%02X - %d vs %d\n", i & 0xFF, bulk_amp[j + i], ulaw_to_linear((uint8_t) i));
+                    printf("Tests failed\n");
+                    exit(2);
+                }
+                /*endif*/
+            }
+            /*endfor*/
+            g711_transcode(alaw_state, &bulk_data2[j], &bulk_data[j], len);
+            for (i = 0;  i < len;  i++)
+            {
+                if (bulk_data2[j + i] != alaw_to_ulaw((uint8_t) i))
+                {
+                    printf("Bulk A-law to u-law mismatch at 0x%02X\n", i & 0xFF);
+                    printf("Tests failed\n");
+                    exit(2);
+                }
+                /*endif*/
+            }
+            /*endfor*/
+            g711_transcode(ulaw_state, &bulk_data2[j], &bulk_data[j], len);
+            for (i = 0;  i < len;  i++)
+            {
+                if (bulk_data2[j + i] != ulaw_to_alaw((uint8_t) i))
+                {
+                    printf("Bulk u-law to A-law mismatch at 0x%02X\n", i & 0xFF);
+                    printf("Tests failed\n");
+                    exit(2);
+                }
+                /*endif*/
+            }
+            /*endfor*/
+        }
+        /*endfor*/
+    }
+    /*endfor*/
+    span_cpu_features_restrict(~0U);
+    g711_free(alaw_state);
+    g711_free(ulaw_state);
+    printf("Bulk conversion tests passed.\n");
+}
+/*- End of function --------------------------------------------------------*/
+
+static void benchmark_tests(void)
+{
+    static const char *names[6] =
+    {
+        "A-law encode",
+        "u-law encode",
+        "A-law decode",
+        "u-law decode",
+        "A-law to u-law",
+        "u-law to A-law"
+    };
+    g711_state_t *state[2];
+    uint64_t start;
+    uint64_t ticks[6];
+    int i;
+    int j;
+    int k;
+    int block;
+
+    /* Time the bulk routines, working on frames of a typical size, for each code path.
+       Report the CPU clock ticks each sample takes. */
+    state[0] = g711_init(NULL, G711_ALAW);
+    state[1] = g711_init(NULL, G711_ULAW);
+    for (i = 0;  i < 65536;  i++)
+        amp[i] = (int16_t) (rand() - RAND_MAX/2);
+    /*endfor*/
+    for (i = 0;  i < 65536;  i++)
+        alaw_data[i] = (uint8_t) rand();
+    /*endfor*/
+    for (k = 0;  k < 3;  k++)
+    {
+        printf("Bulk conversion speeds, using CPU features 0x%X\n", span_cpu_features_restrict(feature_masks[k]));
+        for (j = 0;  j < 6;  j++)
+        {
+            start = rdtscll();
+            for (block = 0;  block < 100;  block++)
+            {
+                for (i = 0;  i < 65536;  i += BLOCK_LEN)
+                {
+                    switch (j >> 1)
+                    {
+                    case 0:
+                        g711_encode(state[j & 1], &ulaw_data[i], &amp[i], BLOCK_LEN);
+                        break;
+                    case 1:
+                        g711_decode(state[j & 1], &amp[i], &alaw_data[i], BLOCK_LEN);
+                        break;
+                    case 2:
+                        g711_transcode(state[j & 1], &ulaw_data[i], &alaw_data[i], BLOCK_LEN);
+                        break;
+                    }
+                    /*endswitch*/
+                }
+                /*endfor*/
+            }
+            /*endfor*/
+            ticks[j] = rdtscll() - start;
+            printf("    %-16s %6.2f ticks/sample\n", names[j], (double) ticks[j]/(100.0*(65536/BLOCK_LEN)*BLOCK_LEN));
+        }
+        /*endfor*/
+    }
+    /*endfor*/
+    span_cpu_features_restrict(~0U);
+    g711_free(state[0]);
+    g711_free(state[1]);
+}
+/*- End of function --------------------------------------------------------*/
+
 int main(int argc, char *argv[])
 {
     SNDFILE *inhandle;
@@ -437,6 +623,8 @@ int main(int argc, char *argv[])
     if (basic_tests)
     {
         compliance_tests(true);
+        bulk_tests();
+        benchmark_tests();
     }
     else
     {
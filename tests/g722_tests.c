@@ -76,6 +76,8 @@ and the resulting audio stored in post_g722.wav.
 
 #define MAX_TEST_VECTOR_LEN 40000
 
+#define DISPATCH_TEST_LEN   (10*G722_SAMPLE_RATE)
+
 #define TESTDATA_DIR        "../test-data/itu/g722/"
 
 #define EIGHTK_IN_FILE_NAME "../test-data/local/short_nb_voice.wav"
@@ -446,6 +448,86 @@ static void signal_to_distortion_tests(void)
 }
 /*- End of function --------------------------------------------------------*/
 
+static void dispatch_tests(void)
+{
+    static const uint32_t feature_masks[2] =
+    {
+        ~0U,
+        0
+    };
+    static const int bit_rates[3] =
+    {
+        64000,
+        56000,
+        48000
+    };
+    static int16_t original[DISPATCH_TEST_LEN];
+    static uint8_t compressed[DISPATCH_TEST_LEN];
+    static int16_t decompressed[DISPATCH_TEST_LEN];
+    static uint8_t ref_compressed[DISPATCH_TEST_LEN];
+    static int16_t ref_decompressed[DISPATCH_TEST_LEN];
+    g722_encode_state_t *enc_state;
+    g722_decode_state_t *dec_state;
+    int len2;
+    int len3;
+    int ref_len2;
+    int ref_len3;
+    int i;
+    int j;
+    int k;
+
+    /* The QMFs may use SIMD code, chosen at run time. The ITU tests bypass the QMFs, so check
+       every code path this machine allows gives exactly the same answers with them in use. */
+    printf("Performing run time dispatch tests\n");
+    for (i = 0;  i < DISPATCH_TEST_LEN;  i++)
+    {
+        /* A wideband voice-like signal, with a wandering pitch and a changing level, plus some noise */
+        original[i] = (int16_t) ((8000.0 + 6000.0*sin(i*0.0003))
+                                 *(sin(i*(0.05 + 0.02*sin(i*0.00005))) + 0.5*sin(i*0.41) + 0.3*sin(i*2.3))
+                                 + ((rand() & 0x3FF) - 0x200));
+    }
+    /*endfor*/
+    for (j = 0;  j < 3;  j++)
+    {
+        ref_len2 = 0;
+        ref_len3 = 0;
+        for (k = 0;  k < 2;  k++)
+        {
+            printf("Using CPU features 0x%X at %dbps\n", span_cpu_features_restrict(feature_masks[k]), bit_rates[j]);
+            enc_state = g722_encode_init(NULL, bit_rates[j], G722_PACKED);
+            dec_state = g722_decode_init(NULL, bit_rates[j], G722_PACKED);
+            len2 = g722_encode(enc_state, compressed, original, DISPATCH_TEST_LEN);
+            len3 = g722_decode(dec_state, decompressed, compressed, len2);
+            if (k == 0)
+            {
+                ref_len2 = len2;
+                ref_len3 = len3;
+                memcpy(ref_compressed, compressed, len2);
+                memcpy(ref_decompressed, decompressed, len3*sizeof(int16_t));
+            }
+            else if (len2 != ref_len2
+                     ||
+                     len3 != ref_len3
+                     ||
+                     memcmp(compressed, ref_compressed, len2)
+                     ||
+                     memcmp(decompressed, ref_decompressed, len3*sizeof(int16_t)))
+            {
+                printf("Test failed: results differ between code paths\n");
+                exit(2);
+            }
+            /*endif*/
+            g722_encode_free(enc_state);
+            g722_decode_free(dec_state);
+        }
+        /*endfor*/
+    }
+    /*endfor*/
+    span_cpu_features_restrict(~0U);
+    printf("Run time dispatch tests passed\n");
+}
+/*- End of function --------------------------------------------------------*/
+
 int main(int argc, char *argv[])
 {
     g722_encode_state_t *enc_state;
@@ -549,6 +631,7 @@ int main(int argc, char *argv[])
 
     if (itutests)
     {
+        dispatch_tests();
         itu_compliance_tests();
         signal_to_distortion_tests();
     }
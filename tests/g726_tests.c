@@ -68,6 +68,7 @@ decompressed, and the resulting audio stored in post_g726.wav.
 #include <unistd.h>
 #include <memory.h>
 #include <ctype.h>
+#include <math.h>
 #include <sndfile.h>
 
 #include "spandsp.h"
@@ -75,6 +76,8 @@ decompressed, and the resulting audio stored in post_g726.wav.
 
 #define BLOCK_LEN           320
 #define MAX_TEST_VECTOR_LEN 40000
+#define BATCH_CHANNELS      11
+#define BATCH_LEN           4000
 
 #define TESTDATA_DIR        "../test-data/itu/g726/"
 
@@ -89,6 +92,17 @@ uint8_t itu_ref[MAX_TEST_VECTOR_LEN];
 uint8_t unpacked[MAX_TEST_VECTOR_LEN];
 uint8_t xlaw[MAX_TEST_VECTOR_LEN];
 
+int16_t batch_amp[BATCH_CHANNELS][MAX_TEST_VECTOR_LEN];
+uint8_t batch_adpcm[BATCH_CHANNELS][MAX_TEST_VECTOR_LEN];
+int16_t batch_out[BATCH_CHANNELS][2*MAX_TEST_VECTOR_LEN];
+
+static const uint32_t feature_masks[3] =
+{
+    ~0U,
+    ~(SPAN_CPU_FEATURE_AVX512F | SPAN_CPU_FEATURE_AVX512BW | SPAN_CPU_FEATURE_AVX2),
+    0
+};
+
 /*
 Table 4 - Reset and homing sequences for u-law
             Normal                              I-input     Overload
@@ -1078,8 +1092,160 @@ static int get_test_vector(const char *file, uint8_t buf[], int max_len)
 }
 /*- End of function --------------------------------------------------------*/
 
+static void batch_tests(void)
+{
+    static const int rates[4] = {16000, 24000, 32000, 40000};
+    g726_state_t *batch[BATCH_CHANNELS];
+    g726_state_t *single[BATCH_CHANNELS];
+    const int16_t *in[BATCH_CHANNELS];
+    uint8_t *adpcm[BATCH_CHANNELS];
+    const uint8_t *adpcm_in[BATCH_CHANNELS];
+    int16_t *out[BATCH_CHANNELS];
+    int adpcm_len[BATCH_CHANNELS];
+    int out_len[BATCH_CHANNELS];
+    int len[BATCH_CHANNELS];
+    int rate[BATCH_CHANNELS];
+    int ref_len;
+    int coding;
+    int bytes;
+    int ch;
+    int i;
+    int j;
+    int k;
+    int r;
+
+    /* The batch routines may run several channels side by side with SIMD code. Check they
+       give exactly the same answers as running each channel on its own, using every code
+       path the run time dispatch might select on this machine. Each channel has its own
+       signal, and a different mixture of coding and packing, so when decoding the channels
+       run out of codes at different times. The high tone part of the signal exercises the
+       detection of modem signals. In the last round one channel uses a different bit rate
+       from the others. */
+    for (ch = 0;  ch < BATCH_CHANNELS;  ch++)
+    {
+        coding = ch%3;
+        for (i = 0;  i < BATCH_LEN;  i++)
+        {
+            /* Speech-like audio, then a high tone like a modem's, then silence */
+            if (i < BATCH_LEN/2)
+                j = (int) (12000.0*sin(i*0.01*(ch + 1)) + 4000.0*sin(i*0.37) + ((rand() & 0x7FF) - 0x400)*(ch + 1));
+            else if (i < 7*BATCH_LEN/8)
+                j = (int) (16000.0*sin(i*(2.5 + 0.05*ch)));
+            else
+                j = 0;
+            /*endif*/
+            j = (j > 32767)  ?  32767  :  (j < -32768)  ?  -32768  :  j;
+            if (coding == G726_ENCODING_ULAW)
+                ((uint8_t *) batch_amp[ch])[i] = linear_to_ulaw(j);
+            else if (coding == G726_ENCODING_ALAW)
+                ((uint8_t *) batch_amp[ch])[i] = linear_to_alaw(j);
+            else
+                batch_amp[ch][i] = (int16_t) j;
+            /*endif*/
+        }
+        /*endfor*/
+    }
+    /*endfor*/
+    for (k = 0;  k < 3;  k++)
+    {
+        printf("Batch tests, using CPU features 0x%X\n", span_cpu_features_restrict(feature_masks[k]));
+        for (r = 0;  r < 5;  r++)
+        {
+            for (ch = 0;  ch < BATCH_CHANNELS;  ch++)
+            {
+                rate[ch] = (r < 4)  ?  rates[r]  :  rates[(ch == 5)  ?  0  :  3];
+                batch[ch] = g726_init(NULL, rate[ch], ch%3, (ch/3)%3);
+                single[ch] = g726_init(NULL, rate[ch], ch%3, (ch/3)%3);
+                adpcm_len[ch] = 0;
+            }
+            /*endfor*/
+            /* Encode in uneven blocks, so the batches do not always fill their chunks */
+            for (i = 0;  i < BATCH_LEN;  i += j)
+            {
+                j = (BATCH_LEN - i < 321)  ?  (BATCH_LEN - i)  :  321;
+                for (ch = 0;  ch < BATCH_CHANNELS;  ch++)
+                {
+                    in[ch] = (ch%3)  ?  (const int16_t *) ((const uint8_t *) batch_amp[ch] + i)  :  &batch_amp[ch][i];
+                    adpcm[ch] = &batch_adpcm[ch][adpcm_len[ch]];
+                }
+                /*endfor*/
+                g726_encode_batch(batch, adpcm, len, in, j, BATCH_CHANNELS);
+                for (ch = 0;  ch < BATCH_CHANNELS;  ch++)
+                {
+                    ref_len = g726_encode(single[ch], adpcmdata, in[ch], j);
+                    if (len[ch] != ref_len  ||  memcmp(adpcm[ch], adpcmdata, ref_len))
+                    {
+                        printf("Batch encode mismatch at rate %d, channel %d, sample %d\n", rate[ch], ch, i);
+                        printf("Tests failed\n");
+                        exit(2);
+                    }
+                    /*endif*/
+                    adpcm_len[ch] += ref_len;
+                }
+                /*endfor*/
+            }
+            /*endfor*/
+
+            bytes = MAX_TEST_VECTOR_LEN;
+            for (ch = 0;  ch < BATCH_CHANNELS;  ch++)
+            {
+                g726_init(batch[ch], rate[ch], ch%3, (ch/3)%3);
+                g726_init(single[ch], rate[ch], ch%3, (ch/3)%3);
+                if (adpcm_len[ch] < bytes)
+                    bytes = adpcm_len[ch];
+                /*endif*/
+                out_len[ch] = 0;
+            }
+            /*endfor*/
+            for (i = 0;  i < bytes;  i += j)
+            {
+                j = (bytes - i < 97)  ?  (bytes - i)  :  97;
+                for (ch = 0;  ch < BATCH_CHANNELS;  ch++)
+                {
+                    adpcm_in[ch] = &batch_adpcm[ch][i];
+                    out[ch] = (ch%3)  ?  (int16_t *) ((uint8_t *) batch_out[ch] + out_len[ch])  :  &batch_out[ch][out_len[ch]];
+                }
+                /*endfor*/
+                g726_decode_batch(batch, out, len, adpcm_in, j, BATCH_CHANNELS);
+                for (ch = 0;  ch < BATCH_CHANNELS;  ch++)
+                {
+                    ref_len = g726_decode(single[ch], outdata, adpcm_in[ch], j);
+                    if (len[ch] != ref_len  ||  memcmp(out[ch], outdata, (ch%3)  ?  ref_len  :  ref_len*sizeof(int16_t)))
+                    {
+                        printf("Batch decode mismatch at rate %d, channel %d, octet %d\n", rate[ch], ch, i);
+                        printf("Tests failed\n");
+                        exit(2);
+                    }
+                    /*endif*/
+                    out_len[ch] += ref_len;
+                }
+                /*endfor*/
+            }
+            /*endfor*/
+            for (ch = 0;  ch < BATCH_CHANNELS;  ch++)
+            {
+                g726_free(batch[ch]);
+                g726_free(single[ch]);
+            }
+            /*endfor*/
+        }
+        /*endfor*/
+    }
+    /*endfor*/
+    span_cpu_features_restrict(~0U);
+    printf("Batch tests passed.\n");
+}
+/*- End of function --------------------------------------------------------*/
+
 static void itu_compliance_tests(void)
 {
+    static g726_state_t batch_state[BATCH_CHANNELS];
+    g726_state_t *batch_states[BATCH_CHANNELS];
+    const int16_t *batch_in[BATCH_CHANNELS];
+    uint8_t *batch_out[BATCH_CHANNELS];
+    const uint8_t *batch_in2[BATCH_CHANNELS];
+    int16_t *batch_out2[BATCH_CHANNELS];
+    int batch_len[BATCH_CHANNELS];
     g726_state_t enc_state;
     g726_state_t dec_state;
     int len2;
@@ -1126,6 +1292,26 @@ static void itu_compliance_tests(void)
             memcpy(itudata, xlaw, samples + conditioning_samples);
             printf("Test %d: Compressing %d samples at %dbps\n", test, samples, itu_test_sets[test].rate);
             len2 = g726_encode(&enc_state, adpcmdata, itudata, conditioning_samples + samples);
+            /* The batch encoder must give the same answer for every channel */
+            for (i = 0;  i < BATCH_CHANNELS;  i++)
+            {
+                g726_init(&batch_state[i], itu_test_sets[test].rate, itu_test_sets[test].compression_law, G726_PACKING_NONE);
+                batch_states[i] = &batch_state[i];
+                batch_in[i] = itudata;
+                batch_out[i] = batch_adpcm[i];
+            }
+            /*endfor*/
+            g726_encode_batch(batch_states, batch_out, batch_len, batch_in, conditioning_samples + samples, BATCH_CHANNELS);
+            for (i = 0;  i < BATCH_CHANNELS;  i++)
+            {
+                if (batch_len[i] != len2  ||  memcmp(batch_adpcm[i], adpcmdata, len2))
+                {
+                    printf("Test %d: Batch compressed mismatch in channel %d\n", test, i);
+                    exit(2);
+                }
+                /*endif*/
+            }
+            /*endfor*/
         }
         /*endif*/
         /* Test the decode side */
@@ -1175,6 +1361,26 @@ static void itu_compliance_tests(void)
         /*endif*/
 
         len3 = g726_decode(&dec_state, outdata, unpacked, conditioning_adpcm + adpcm);
+        /* The batch decoder must give the same answer for every channel */
+        for (i = 0;  i < BATCH_CHANNELS;  i++)
+        {
+            g726_init(&batch_state[i], itu_test_sets[test].rate, itu_test_sets[test].decompression_law, G726_PACKING_NONE);
+            batch_states[i] = &batch_state[i];
+            batch_out2[i] = batch_amp[i];
+            batch_in2[i] = unpacked;
+        }
+        /*endfor*/
+        g726_decode_batch(batch_states, batch_out2, batch_len, batch_in2, conditioning_adpcm + adpcm, BATCH_CHANNELS);
+        for (i = 0;  i < BATCH_CHANNELS;  i++)
+        {
+            if (batch_len[i] != len3  ||  memcmp(batch_amp[i], outdata, len3))
+            {
+                printf("Test %d: Batch decompressed mismatch in channel %d\n", test, i);
+                exit(2);
+            }
+            /*endif*/
+        }
+        /*endfor*/
 
         /* Get the output reference data */
         samples = get_test_vector(itu_test_sets[test].output_file, xlaw, MAX_TEST_VECTOR_LEN);
@@ -1261,6 +1467,7 @@ int main(int argc, char *argv[])
 
     if (itutests)
     {
+        batch_tests();
         itu_compliance_tests();
     }
     else
@@ -121,6 +121,8 @@ will be compressed to GSM 06.10 data, decompressed, and the resulting audio stor
 #include <unistd.h>
 #include <string.h>
 #include <ctype.h>
+#include <math.h>
+#include <time.h>
 #include <sndfile.h>
 
 #include "spandsp.h"
@@ -135,6 +137,8 @@ will be compressed to GSM 06.10 data, decompressed, and the resulting audio stor
 
 #define HIST_LEN        1000
 
+#define SPEED_TEST_LEN  (30*SAMPLE_RATE)
+
 uint8_t law_in_vector[1000000];
 int16_t in_vector[1000000];
 uint16_t code_vector_buf[1000000];
@@ -556,6 +560,79 @@ static int perform_pack_unpack_test(void)
 }
 /*- End of function --------------------------------------------------------*/
 
+static void dispatch_tests(void)
+{
+    static const uint32_t feature_masks[3] =
+    {
+        ~0U,
+        ~(SPAN_CPU_FEATURE_AVX512F | SPAN_CPU_FEATURE_AVX512BW | SPAN_CPU_FEATURE_AVX2),
+        0
+    };
+    gsm0610_state_t *enc_state;
+    gsm0610_state_t *dec_state;
+    clock_t start;
+    double enc_time;
+    double dec_time;
+    int bytes;
+    int samples;
+    int ref_bytes;
+    int i;
+    int k;
+
+    /* The codec may use SIMD code, chosen at run time. Check every code path this machine
+       allows gives exactly the same answers, and report how fast each one is, as the
+       fraction of real time taken to process 30 seconds of audio. */
+    printf("Performing run time dispatch tests (not part of the ETSI conformance tests).\n");
+    for (i = 0;  i < SPEED_TEST_LEN;  i++)
+    {
+        /* A voice-like signal, with a wandering pitch and a changing level, plus some noise */
+        in_vector[i] = (int16_t) ((8000.0 + 6000.0*sin(i*0.0007))
+                                  *(sin(i*(0.1 + 0.03*sin(i*0.0001))) + 0.5*sin(i*0.73) + 0.3*sin(i*1.9))
+                                  + ((rand() & 0x3FF) - 0x200));
+    }
+    /*endfor*/
+    ref_bytes = 0;
+    for (k = 0;  k < 3;  k++)
+    {
+        printf("Using CPU features 0x%X\n", span_cpu_features_restrict(feature_masks[k]));
+        enc_state = gsm0610_init(NULL, GSM0610_PACKING_VOIP);
+        dec_state = gsm0610_init(NULL, GSM0610_PACKING_VOIP);
+        start = clock();
+        bytes = gsm0610_encode(enc_state, code_vector, in_vector, SPEED_TEST_LEN);
+        enc_time = (double) (clock() - start)/CLOCKS_PER_SEC;
+        start = clock();
+        samples = gsm0610_decode(dec_state, out_vector, code_vector, bytes);
+        dec_time = (double) (clock() - start)/CLOCKS_PER_SEC;
+        printf("    Encode real time factor %.5f, decode real time factor %.5f\n",
+               enc_time*SAMPLE_RATE/SPEED_TEST_LEN,
+               dec_time*SAMPLE_RATE/SPEED_TEST_LEN);
+        if (k == 0)
+        {
+            ref_bytes = bytes;
+            memcpy(ref_code_vector, code_vector, bytes);
+            memcpy(ref_out_vector, out_vector, samples*sizeof(int16_t));
+        }
+        else if (bytes != ref_bytes
+                 ||
+                 samples != SPEED_TEST_LEN
+                 ||
+                 memcmp(code_vector, ref_code_vector, bytes)
+                 ||
+                 memcmp(out_vector, ref_out_vector, samples*sizeof(int16_t)))
+        {
+            printf("Test failed: results differ between code paths\n");
+            exit(2);
+        }
+        /*endif*/
+        gsm0610_free(enc_state);
+        gsm0610_free(dec_state);
+    }
+    /*endfor*/
+    span_cpu_features_restrict(~0U);
+    printf("Test passed\n");
+}
+/*- End of function --------------------------------------------------------*/
+
 static void etsi_compliance_tests(void)
 {
     perform_linear_test(true, 1, "Seq01");
@@ -617,6 +694,7 @@ int main(int argc, char *argv[])
 
     if (etsitests)
     {
+        dispatch_tests();
         etsi_compliance_tests();
     }
     else
@@ -57,6 +57,85 @@ of the degradation in quality caused by the compression.
 
 #define HIST_LEN        2000
 
+#define BATCH_CHANNELS  11
+#define BATCH_BYTES     4000
+
+static void batch_tests(void)
+{
+    static const int variants[3] = {IMA_ADPCM_DVI4, IMA_ADPCM_IMA4, IMA_ADPCM_VDVI};
+    ima_adpcm_state_t *batch[BATCH_CHANNELS];
+    ima_adpcm_state_t *single[BATCH_CHANNELS];
+    static uint8_t ima_data[BATCH_CHANNELS][BATCH_BYTES];
+    static int16_t out_amp[BATCH_CHANNELS][4*BATCH_BYTES];
+    int16_t ref_amp[4*BATCH_BYTES];
+    const uint8_t *in[BATCH_CHANNELS];
+    int16_t *out[BATCH_CHANNELS];
+    int len[BATCH_CHANNELS];
+    int variant[BATCH_CHANNELS];
+    int chunk_size[BATCH_CHANNELS];
+    int ref_len;
+    int ch;
+    int i;
+    int j;
+    int r;
+
+    /* The batch decoder runs groups of channels side by side. Check it gives exactly the
+       same answers as decoding each channel on its own. The early rounds use one variant
+       for all the channels, with and without a header in each block. The last round mixes
+       variants and header arrangements, so some groups must be split up. */
+    for (ch = 0;  ch < BATCH_CHANNELS;  ch++)
+    {
+        for (i = 0;  i < BATCH_BYTES;  i++)
+            ima_data[ch][i] = (uint8_t) rand();
+        /*endfor*/
+    }
+    /*endfor*/
+    for (r = 0;  r < 7;  r++)
+    {
+        for (ch = 0;  ch < BATCH_CHANNELS;  ch++)
+        {
+            variant[ch] = (r < 6)  ?  variants[r >> 1]  :  variants[ch%3];
+            chunk_size[ch] = (r < 6)  ?  (r & 1)  :  ((ch >> 2) & 1);
+            batch[ch] = ima_adpcm_init(NULL, variant[ch], chunk_size[ch]);
+            single[ch] = ima_adpcm_init(NULL, variant[ch], chunk_size[ch]);
+        }
+        /*endfor*/
+        for (i = 0;  i < BATCH_BYTES;  i += j)
+        {
+            j = (BATCH_BYTES - i < 77)  ?  (BATCH_BYTES - i)  :  77;
+            for (ch = 0;  ch < BATCH_CHANNELS;  ch++)
+            {
+                in[ch] = &ima_data[ch][i];
+                out[ch] = out_amp[ch];
+            }
+            /*endfor*/
+            ima_adpcm_decode_batch(batch, out, len, in, j, BATCH_CHANNELS);
+            for (ch = 0;  ch < BATCH_CHANNELS;  ch++)
+            {
+                ref_len = ima_adpcm_decode(single[ch], ref_amp, in[ch], j);
+                if (len[ch] != ref_len  ||  memcmp(out[ch], ref_amp, ref_len*sizeof(int16_t)))
+                {
+                    printf("Batch decode mismatch for variant %d, channel %d, byte %d\n", variant[ch], ch, i);
+                    printf("Tests failed\n");
+                    exit(2);
+                }
+                /*endif*/
+            }
+            /*endfor*/
+        }
+        /*endfor*/
+        for (ch = 0;  ch < BATCH_CHANNELS;  ch++)
+        {
+            ima_adpcm_free(batch[ch]);
+            ima_adpcm_free(single[ch]);
+        }
+        /*endfor*/
+    }
+    /*endfor*/
+    printf("Batch decode tests passed\n");
+}
+/*- End of function --------------------------------------------------------*/
+
 int main(int argc, char *argv[])
 {
     int i;
@@ -219,6 +298,8 @@ int main(int argc, char *argv[])
     }
     /*endif*/
 
+    batch_tests();
+
     printf("Tests passed.\n");
     return 0;
 }
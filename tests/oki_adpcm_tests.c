@@ -58,6 +58,81 @@ compression may be tested.
 
 #define HIST_LEN        1000
 
+#define BATCH_CHANNELS  9
+#define BATCH_BYTES     4000
+
+static void batch_tests(void)
+{
+    oki_adpcm_state_t *batch[BATCH_CHANNELS];
+    oki_adpcm_state_t *single[BATCH_CHANNELS];
+    static uint8_t oki_data[BATCH_CHANNELS][BATCH_BYTES];
+    static int16_t out_amp[BATCH_CHANNELS][4*BATCH_BYTES];
+    int16_t ref_amp[4*BATCH_BYTES];
+    const uint8_t *in[BATCH_CHANNELS];
+    int16_t *out[BATCH_CHANNELS];
+    int len[BATCH_CHANNELS];
+    int rate[BATCH_CHANNELS];
+    int ref_len;
+    int ch;
+    int i;
+    int j;
+    int r;
+
+    /* The batch decoder runs groups of channels side by side. Check it gives exactly the
+       same answers as decoding each channel on its own. The first round is all 32kbps. In
+       the second round some channels are 24kbps, so some groups must be split up. */
+    for (ch = 0;  ch < BATCH_CHANNELS;  ch++)
+    {
+        for (i = 0;  i < BATCH_BYTES;  i++)
+            oki_data[ch][i] = (uint8_t) rand();
+        /*endfor*/
+    }
+    /*endfor*/
+    for (r = 0;  r < 2;  r++)
+    {
+        for (ch = 0;  ch < BATCH_CHANNELS;  ch++)
+        {
+            rate[ch] = (r == 1  &&  (ch%3) == 1)  ?  24000  :  32000;
+            batch[ch] = oki_adpcm_init(NULL, rate[ch]);
+            single[ch] = oki_adpcm_init(NULL, rate[ch]);
+        }
+        /*endfor*/
+        for (i = 0;  i < BATCH_BYTES;  i += j)
+        {
+            j = (BATCH_BYTES - i < 77)  ?  (BATCH_BYTES - i)  :  77;
+            for (ch = 0;  ch < BATCH_CHANNELS;  ch++)
+            {
+                in[ch] = &oki_data[ch][i];
+                out[ch] = out_amp[ch];
+            }
+            /*endfor*/
+            oki_adpcm_decode_batch(batch, out, len, in, j, BATCH_CHANNELS);
+            for (ch = 0;  ch < BATCH_CHANNELS;  ch++)
+            {
+                ref_len = oki_adpcm_decode(single[ch], ref_amp, in[ch], j);
+                if (len[ch] != ref_len  ||  memcmp(out[ch], ref_amp, ref_len*sizeof(int16_t)))
+                {
+                    printf("Batch decode mismatch at rate %d, channel %d, byte %d\n", rate[ch], ch, i);
+                    printf("Tests failed\n");
+                    exit(2);
+                }
+                /*endif*/
+            }
+            /*endfor*/
+        }
+        /*endfor*/
+        for (ch = 0;  ch < BATCH_CHANNELS;  ch++)
+        {
+            oki_adpcm_free(batch[ch]);
+            oki_adpcm_free(single[ch]);
+        }
+        /*endfor*/
+    }
+    /*endfor*/
+    printf("Batch decode tests passed\n");
+}
+/*- End of function --------------------------------------------------------*/
+
 int main(int argc, char *argv[])
 {
     int i;
@@ -313,6 +388,7 @@ int main(int argc, char *argv[])
     /*endif*/
     oki_adpcm_free(oki_dec_state);
     oki_adpcm_free(oki_dec_state2);
+    batch_tests();
     if (sf_close_telephony(outhandle))
     {
         fprintf(stderr, "    Cannot close audio file '%s'\n", OUT_FILE_NAME);
@@ -57,6 +57,76 @@ audio file, called post_plc.wav. This file contains 8000 sample/second
 #define INPUT_FILE_NAME     "../test-data/local/short_nb_voice.wav"
 #define OUTPUT_FILE_NAME    "post_plc.wav"
 
+#define DISPATCH_TEST_LEN   (60*8000)
+
+static int16_t speech[DISPATCH_TEST_LEN];
+static int16_t out_speech[DISPATCH_TEST_LEN];
+static int16_t ref_speech[DISPATCH_TEST_LEN];
+
+static void dispatch_tests(int block_len, int loss_rate)
+{
+    static const uint32_t feature_masks[3] =
+    {
+        0,
+        ~(SPAN_CPU_FEATURE_AVX512F | SPAN_CPU_FEATURE_AVX512BW | SPAN_CPU_FEATURE_AVX2),
+        ~0U
+    };
+    SNDFILE *inhandle;
+    plc_state_t *plc;
+    int samples;
+    int i;
+    int k;
+
+    /* The pitch search may use SIMD code, chosen at run time. Check every code path this
+       machine allows conceals the same losses in exactly the same way as the C code. */
+    printf("Performing run time dispatch tests\n");
+    if ((inhandle = sf_open_telephony_read(INPUT_FILE_NAME, 1)) == NULL)
+    {
+        fprintf(stderr, "    Failed to open audio file '%s'\n", INPUT_FILE_NAME);
+        exit(2);
+    }
+    /*endif*/
+    samples = sf_readf_short(inhandle, speech, DISPATCH_TEST_LEN);
+    if (sf_close_telephony(inhandle))
+    {
+        fprintf(stderr, "    Cannot close audio file '%s'\n", INPUT_FILE_NAME);
+        exit(2);
+    }
+    /*endif*/
+    samples -= samples%block_len;
+    for (k = 0;  k < 3;  k++)
+    {
+        printf("Using CPU features 0x%X\n", span_cpu_features_restrict(feature_masks[k]));
+        plc = plc_init(NULL);
+        memcpy(out_speech, speech, sizeof(int16_t)*samples);
+        srand(1234);
+        for (i = 0;  i < samples;  i += block_len)
+        {
+            if (rand()/(RAND_MAX/100) > loss_rate)
+                plc_rx(plc, &out_speech[i], block_len);
+            else
+                plc_fillin(plc, &out_speech[i], block_len);
+            /*endif*/
+        }
+        /*endfor*/
+        plc_free(plc);
+        if (k == 0)
+        {
+            memcpy(ref_speech, out_speech, sizeof(int16_t)*samples);
+        }
+        else if (memcmp(out_speech, ref_speech, sizeof(int16_t)*samples))
+        {
+            printf("Test failed: results differ between code paths\n");
+            exit(2);
+        }
+        /*endif*/
+    }
+    /*endfor*/
+    span_cpu_features_restrict(~0U);
+    printf("Run time dispatch tests passed\n");
+}
+/*- End of function --------------------------------------------------------*/
+
 int main(int argc, char *argv[])
 {
     SNDFILE *inhandle;
@@ -110,6 +180,7 @@ int main(int argc, char *argv[])
     inhandle = NULL;
     if (tone < 0)
     {
+        dispatch_tests(block_len, loss_rate);
         if ((inhandle = sf_open_telephony_read(INPUT_FILE_NAME, 1)) == NULL)
         {
             fprintf(stderr, "    Failed to open audio file '%s'\n", INPUT_FILE_NAME);
@@ -406,6 +406,15 @@ then
 fi
 echo r2_mf_tx_tests completed OK
 
+./resample_tests >$STDOUT_DEST 2>$STDERR_DEST
+RETVAL=$?
+if [ $RETVAL != 0 ]
+then
+    echo resample_tests failed!
+    exit $RETVAL
+fi
+echo resample_tests completed OK
+
 #./rfc2198_sim_tests >$STDOUT_DEST 2>$STDERR_DEST
 #RETVAL=$?
 #if [ $RETVAL != 0 ]
@@ -589,6 +598,15 @@ then
 fi
 echo timezone_tests completed OK
 
+./tone_analyser_tests >$STDOUT_DEST 2>$STDERR_DEST
+RETVAL=$?
+if [ $RETVAL != 0 ]
+then
+    echo tone_analyser_tests failed!
+    exit $RETVAL
+fi
+echo tone_analyser_tests completed OK
+
 #./tone_detect_tests >$STDOUT_DEST 2>$STDERR_DEST
 #RETVAL=$?
 #if [ $RETVAL != 0 ]
@@ -609,6 +627,15 @@ echo tone_detect_tests not enabled
 #echo tone_generate_tests completed OK
 echo tone_generate_tests not enabled
 
+./transcoder_tests >$STDOUT_DEST 2>$STDERR_DEST
+RETVAL=$?
+if [ $RETVAL != 0 ]
+then
+    echo transcoder_tests failed!
+    exit $RETVAL
+fi
+echo transcoder_tests completed OK
+
 ./tsb85_tests.sh >/dev/null
 RETVAL=$?
 if [ $RETVAL != 0 ]
@@ -0,0 +1,413 @@
+/*
+ * SpanDSP - a series of DSP components for telephony
+ *
+ * resample_tests.c - Tests for the polyphase sample rate converter.
+ *
+ * Written by Steve Underwood <steveu@coppice.org>
+ *
+ * Copyright (C) 2026 Steve Underwood
+ *
+ * All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2, as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+/*! \page resample_tests_page Sample rate converter tests
+\section resample_tests_page_sec_1 What does it do?
+These tests check, for every pair of 8000, 16000, 32000 and 48000 samples/second, and
+every filter quality:
+    - the number of samples produced is exactly what resample_max_output() predicts,
+      when the input is passed in irregular pieces.
+    - a tone in the passband keeps its level, arrives with the delay resample_delay()
+      reports, and picks up little distortion or imaging.
+    - a tone above the Nyquist frequency of the output is suppressed, rather than
+      aliased into the passband.
+    - the integer and floating point versions agree.
+*/
+
+#if defined(HAVE_CONFIG_H)
+#include "config.h"
+#endif
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+#include "spandsp.h"
+
+#define TEST_SECONDS        1
+#define MAX_RATE            48000
+#define AMPLITUDE           10000.0
+
+static const int rates[4] =
+{
+    8000, 16000, 32000, 48000
+};
+
+static const char *quality_names[3] =
+{
+    "low latency",
+    "standard",
+    "high quality"
+};
+
+/* The least acceptable suppression of distortion, images and aliases, in dB, for each
+   filter quality, for the integer and the floating point versions. The integer version
+   is limited by the precision of its coefficients and data. */
+static const double min_suppression[3][2] =
+{
+    {50.0, 50.0},
+    {70.0, 75.0},
+    {70.0, 80.0}
+};
+
+static int16_t in_amp[TEST_SECONDS*MAX_RATE];
+static int16_t out_amp[6*TEST_SECONDS*MAX_RATE];
+static float in_ampf[TEST_SECONDS*MAX_RATE];
+static float out_ampf[6*TEST_SECONDS*MAX_RATE];
+
+static void make_tone(int sample_rate, double freq)
+{
+    int i;
+
+    for (i = 0;  i < TEST_SECONDS*sample_rate;  i++)
+    {
+        in_ampf[i] = AMPLITUDE*sin(2.0*3.1415926535897932*freq*i/sample_rate);
+        in_amp[i] = (int16_t) lrintf(in_ampf[i]);
+    }
+    /*endfor*/
+}
+/*- End of function --------------------------------------------------------*/
+
+static int run(resample_state_t *s, int samples, bool use_float)
+{
+    int outs;
+    int len;
+    int chunk;
+    int produced;
+    int expected;
+    int i;
+
+    /* Pass the data in irregular pieces, checking the output count every time */
+    outs = 0;
+    chunk = 1;
+    for (i = 0;  i < samples;  i += len)
+    {
+        len = (samples - i < chunk)  ?  (samples - i)  :  chunk;
+        expected = resample_max_output(s, len);
+        if (use_float)
+            produced = resamplef(s, &out_ampf[outs], &in_ampf[i], len);
+        else
+            produced = resample(s, &out_amp[outs], &in_amp[i], len);
+        /*endif*/
+        if (produced != expected)
+        {
+            printf("    Produced %d samples, when %d were expected\n", produced, expected);
+            return -1;
+        }
+        /*endif*/
+        outs += produced;
+        chunk = chunk%37 + 1;
+    }
+    /*endfor*/
+    return outs;
+}
+/*- End of function --------------------------------------------------------*/
+
+/* Fit a sine wave of known frequency to the output, and find its level, phase and the
+   level of whatever is left over, which is the distortion. */
+static void fit_tone(const int16_t amp[], const float ampf[], int start, int len, int sample_rate, double freq, double *level, double *phase, double *residue)
+{
+    double si;
+    double co;
+    double x;
+    double w;
+    double err;
+    int i;
+
+    si = 0.0;
+    co = 0.0;
+    for (i = start;  i < start + len;  i++)
+    {
+        x = (amp)  ?  amp[i]  :  ampf[i];
+        w = 2.0*3.1415926535897932*freq*i/sample_rate;
+        si += x*sin(w);
+        co += x*cos(w);
+    }
+    /*endfor*/
+    si *= 2.0/len;
+    co *= 2.0/len;
+    *level = sqrt(si*si + co*co);
+    *phase = atan2(co, si);
+    err = 0.0;
+    for (i = start;  i < start + len;  i++)
+    {
+        x = (amp)  ?  amp[i]  :  ampf[i];
+        w = 2.0*3.1415926535897932*freq*i/sample_rate;
+        x -= si*sin(w) + co*cos(w);
+        err += x*x;
+    }
+    /*endfor*/
+    *residue = sqrt(2.0*err/len);
+}
+/*- End of function --------------------------------------------------------*/
+
+static int passband_tests(void)
+{
+    resample_state_t *s;
+    double freq;
+    double level;
+    double phase;
+    double residue;
+    double delay;
+    double period;
+    double snr;
+    int in_rate;
+    int out_rate;
+    int quality;
+    int outs;
+    int settle;
+    int i;
+    int j;
+    int k;
+
+    printf("Passband tests\n");
+    for (quality = RESAMPLE_LOW_LATENCY;  quality <= RESAMPLE_HIGH_QUALITY;  quality++)
+    {
+        for (i = 0;  i < 4;  i++)
+        {
+            for (j = 0;  j < 4;  j++)
+            {
+                in_rate = rates[i];
+                out_rate = rates[j];
+                /* Use a frequency in the passband, which does not divide either rate */
+                freq = 0.31*((in_rate < out_rate)  ?  in_rate  :  out_rate) + 7.0;
+                make_tone(in_rate, freq);
+                for (k = 0;  k < 2;  k++)
+                {
+                    if ((s = resample_init(NULL, in_rate, out_rate, quality)) == NULL)
+                    {
+                        printf("    Cannot create a resampler from %d to %d\n", in_rate, out_rate);
+                        return -1;
+                    }
+                    /*endif*/
+                    if ((outs = run(s, TEST_SECONDS*in_rate, k)) < 0)
+                        return -1;
+                    /*endif*/
+                    delay = resample_delay(s);
+                    resample_free(s);
+                    settle = 4*(int) delay + 10;
+                    fit_tone((k)  ?  NULL  :  out_amp, out_ampf, settle, outs - settle, out_rate, freq, &level, &phase, &residue);
+                    snr = 20.0*log10(level/residue);
+                    /* Find how far the delay, from the phase of the tone, differs from the
+                       reported delay. This is only known to within a cycle of the tone. */
+                    period = out_rate/freq;
+                    phase = -phase*out_rate/(2.0*3.1415926535897932*freq) - delay;
+                    phase -= period*floor(phase/period + 0.5);
+                    printf("    %s %5d -> %5d, %s: level %.3fdB, SNR %.1fdB, delay %d%+.2f\n",
+                           (k)  ?  "float"  :  "int  ",
+                           in_rate,
+                           out_rate,
+                           quality_names[quality],
+                           20.0*log10(level/AMPLITUDE),
+                           snr,
+                           (int) delay,
+                           phase);
+                    if (fabs(20.0*log10(level/AMPLITUDE)) > 0.1
+                        ||
+                        snr < min_suppression[quality][k]
+                        ||
+                        fabs(phase) > 0.501)
+                    {
+                        printf("    Failed\n");
+                        return -1;
+                    }
+                    /*endif*/
+                }
+                /*endfor*/
+            }
+            /*endfor*/
+        }
+        /*endfor*/
+    }
+    /*endfor*/
+    printf("    Passed\n");
+    return 0;
+}
+/*- End of function --------------------------------------------------------*/
+
+static int aliasing_tests(void)
+{
+    resample_state_t *s;
+    double freq;
+    double in_level;
+    double out_level;
+    double rejection;
+    int in_rate;
+    int out_rate;
+    int quality;
+    int outs;
+    int i;
+    int j;
+    int k;
+    int n;
+
+    printf("Aliasing tests\n");
+    for (quality = RESAMPLE_LOW_LATENCY;  quality <= RESAMPLE_HIGH_QUALITY;  quality++)
+    {
+        for (i = 0;  i < 4;  i++)
+        {
+            for (j = 0;  j < i;  j++)
+            {
+                in_rate = rates[i];
+                out_rate = rates[j];
+                /* A tone which the decimation would fold back into the passband */
+                freq = 0.7*out_rate;
+                make_tone(in_rate, freq);
+                in_level = 0.0;
+                for (k = 0;  k < TEST_SECONDS*in_rate;  k++)
+                    in_level += in_ampf[k]*in_ampf[k];
+                /*endfor*/
+                in_level = sqrt(in_level/(TEST_SECONDS*in_rate));
+                for (k = 0;  k < 2;  k++)
+                {
+                    s = resample_init(NULL, in_rate, out_rate, quality);
+                    if ((outs = run(s, TEST_SECONDS*in_rate, k)) < 0)
+                        return -1;
+                    /*endif*/
+                    resample_free(s);
+                    out_level = 0.0;
+                    for (n = outs/2;  n < outs;  n++)
+                        out_level += (k)  ?  out_ampf[n]*out_ampf[n]  :  (double) out_amp[n]*out_amp[n];
+                    /*endfor*/
+                    out_level = sqrt(out_level/(outs - outs/2));
+                    /* The integer version can do no better than its 16 bit output */
+                    if (out_level < 0.5)
+                        out_level = 0.5;
+                    /*endif*/
+                    rejection = 20.0*log10(in_level/out_level);
+                    printf("    %s %5d -> %5d, %s: %.0fHz suppressed by %.1fdB\n",
+                           (k)  ?  "float"  :  "int  ",
+                           in_rate,
+                           out_rate,
+                           quality_names[quality],
+                           freq,
+                           rejection);
+                    if (rejection < min_suppression[quality][k])
+                    {
+                        printf("    Failed\n");
+                        return -1;
+                    }
+                    /*endif*/
+                }
+                /*endfor*/
+            }
+            /*endfor*/
+        }
+        /*endfor*/
+    }
+    /*endfor*/
+    printf("    Passed\n");
+    return 0;
+}
+/*- End of function --------------------------------------------------------*/
+
+static int integer_float_tests(void)
+{
+    resample_state_t *s;
+    int in_rate;
+    int out_rate;
+    int quality;
+    int outs;
+    int max_diff;
+    int diff;
+    int i;
+    int j;
+    int k;
+
+    printf("Integer and floating point agreement tests\n");
+    for (quality = RESAMPLE_LOW_LATENCY;  quality <= RESAMPLE_HIGH_QUALITY;  quality++)
+    {
+        for (i = 0;  i < 4;  i++)
+        {
+            for (j = 0;  j < 4;  j++)
+            {
+                in_rate = rates[i];
+                out_rate = rates[j];
+                /* Noise, at a high level, exercises every part of the filter */
+                for (k = 0;  k < TEST_SECONDS*in_rate;  k++)
+                {
+                    in_amp[k] = (rand() & 0x7FFF) - 0x4000;
+                    in_ampf[k] = in_amp[k];
+                }
+                /*endfor*/
+                s = resample_init(NULL, in_rate, out_rate, quality);
+                outs = run(s, TEST_SECONDS*in_rate, false);
+                resample_free(s);
+                s = resample_init(NULL, in_rate, out_rate, quality);
+                if (run(s, TEST_SECONDS*in_rate, true) != outs)
+                    return -1;
+                /*endif*/
+                resample_free(s);
+                max_diff = 0;
+                for (k = 0;  k < outs;  k++)
+                {
+                    diff = abs(out_amp[k] - (int) lrintf(out_ampf[k]));
+                    if (diff > max_diff)
+                        max_diff = diff;
+                    /*endif*/
+                }
+                /*endfor*/
+                /* The Q15 coefficients are slightly different from the floating point
+                   ones, and with loud noise over a long filter those differences can add
+                   up to a few steps. */
+                if (max_diff > 8)
+                {
+                    printf("    %5d -> %5d, %s: integer and floating point differ by up to %d\n",
+                           in_rate,
+                           out_rate,
+                           quality_names[quality],
+                           max_diff);
+                    return -1;
+                }
+                /*endif*/
+            }
+            /*endfor*/
+        }
+        /*endfor*/
+    }
+    /*endfor*/
+    printf("    Passed\n");
+    return 0;
+}
+/*- End of function --------------------------------------------------------*/
+
+int main(int argc, char *argv[])
+{
+    if (passband_tests()
+        ||
+        aliasing_tests()
+        ||
+        integer_float_tests())
+    {
+        printf("Tests failed\n");
+        exit(2);
+    }
+    /*endif*/
+    printf("Tests passed\n");
+    return 0;
+}
+/*- End of function --------------------------------------------------------*/
+/*- End of file ------------------------------------------------------------*/
@@ -93,6 +93,15 @@ int level;
 
 #define SAMPLES_PER_CHUNK           160
 
+#define MAX_TONE_REPORTS            100
+
+typedef struct
+{
+    int codes[MAX_TONE_REPORTS];
+    int levels[MAX_TONE_REPORTS];
+    int reports;
+} tone_report_log_t;
+
 #if defined(HAVE_LIBXML2)
 static int parse_tone(super_tone_rx_descriptor_t *desc, int tone_id, super_tone_tx_step_t **tree, xmlDocPtr doc, xmlNsPtr ns, xmlNodePtr cur)
 {
@@ -471,6 +480,129 @@ static int detection_range_tests(super_tone_rx_state_t *super)
 }
 /*- End of function --------------------------------------------------------*/
 
+static void log_tone_report(void *data, int code, int level, int delay)
+{
+    tone_report_log_t *log;
+
+    log = (tone_report_log_t *) data;
+    if (log->reports < MAX_TONE_REPORTS)
+    {
+        log->codes[log->reports] = code;
+        log->levels[log->reports] = level;
+        log->reports++;
+    }
+    /*endif*/
+}
+/*- End of function --------------------------------------------------------*/
+
+static int power_gate_tests(super_tone_rx_descriptor_t *desc)
+{
+    static const struct
+    {
+        float freq;
+        int level;
+        int on_time;
+        int off_time;
+    } bursts[] =
+    {
+        {1100.0f, -20, 500, 3000},
+        {400.0f, -30, 1000, 1000},
+        {1100.0f, -45, 500, 3000},
+        {400.0f, -40, 1000, 2000},
+        {1100.0f, -10, 500, 3000},
+        {0.0f, 0, 0, 0}
+    };
+    int16_t amp[SAMPLES_PER_CHUNK];
+    super_tone_rx_state_t *gated;
+    super_tone_rx_state_t *ungated;
+    tone_report_log_t gated_log;
+    tone_report_log_t ungated_log;
+    power_gate_t *gate;
+    awgn_state_t *noise_source;
+    uint32_t phase;
+    int32_t phase_inc;
+    int scale;
+    int i;
+    int j;
+    int k;
+
+    /* Check the power gate skips the quiet gaps between tones, without changing
+       what is detected. */
+    printf("Power gate tests\n");
+    memset(&gated_log, 0, sizeof(gated_log));
+    memset(&ungated_log, 0, sizeof(ungated_log));
+    gated = super_tone_rx_init(NULL, desc, log_tone_report, (void *) &gated_log);
+    ungated = super_tone_rx_init(NULL, desc, log_tone_report, (void *) &ungated_log);
+    power_gate_set_level(super_tone_rx_get_power_gate(ungated), -99.0f);
+    noise_source = awgn_init_dbm0(NULL, 1234567, -70.0f);
+    phase = 0;
+    for (k = 0;  bursts[k].on_time;  k++)
+    {
+        phase_inc = dds_phase_rate(bursts[k].freq);
+        scale = dds_scaling_dbm0(bursts[k].level);
+        for (j = 0;  j < (bursts[k].on_time + bursts[k].off_time)*(SAMPLE_RATE/1000);  j += SAMPLES_PER_CHUNK)
+        {
+            for (i = 0;  i < SAMPLES_PER_CHUNK;  i++)
+            {
+                amp[i] = awgn(noise_source);
+                if (j + i < bursts[k].on_time*(SAMPLE_RATE/1000))
+                    amp[i] += (dds(&phase, phase_inc)*scale) >> 15;
+                /*endif*/
+            }
+            /*endfor*/
+            super_tone_rx(gated, amp, SAMPLES_PER_CHUNK);
+            super_tone_rx(ungated, amp, SAMPLES_PER_CHUNK);
+        }
+        /*endfor*/
+    }
+    /*endfor*/
+    awgn_free(noise_source);
+    gate = super_tone_rx_get_power_gate(gated);
+    printf("    %d tone reports\n", gated_log.reports);
+    printf("    %d of %d blocks skipped\n", power_gate_skipped_blocks(gate), power_gate_blocks(gate));
+    if (gated_log.reports != ungated_log.reports
+        ||
+        memcmp(gated_log.codes, ungated_log.codes, gated_log.reports*sizeof(int))
+        ||
+        memcmp(gated_log.levels, ungated_log.levels, gated_log.reports*sizeof(int)))
+    {
+        printf("    The gated and ungated detectors reported different tones\n");
+        printf("    Failed\n");
+        exit(2);
+    }
+    /*endif*/
+#if !defined(SPANDSP_USE_FIXED_POINT)
+    /* The fixed point detector does not yet report these tones, so only the
+       agreement between the detectors can be checked in that case. */
+    if (gated_log.reports == 0)
+    {
+        printf("    Should have reported some tones\n");
+        printf("    Failed\n");
+        exit(2);
+    }
+    /*endif*/
+#endif
+    if (power_gate_skipped_blocks(gate) == 0)
+    {
+        printf("    Should have skipped some blocks\n");
+        printf("    Failed\n");
+        exit(2);
+    }
+    /*endif*/
+    if (power_gate_skipped_blocks(super_tone_rx_get_power_gate(ungated)) != 0)
+    {
+        printf("    The disabled gate skipped some blocks\n");
+        printf("    Failed\n");
+        exit(2);
+    }
+    /*endif*/
+    super_tone_rx_free(gated);
+    super_tone_rx_free(ungated);
+    printf("    Passed\n");
+    return 0;
+}
+/*- End of function --------------------------------------------------------*/
+
 static int file_decode_tests(super_tone_rx_state_t *super, const char *file_name)
 {
     int16_t amp[8000];
@@ -550,6 +682,8 @@ int main(int argc, char *argv[])
     /*endif*/
     super_tone_rx_segment_callback(super, tone_segment);
 
+    power_gate_tests(&desc);
+
     detection_range_tests(super);
 
     if (decode_test_file)
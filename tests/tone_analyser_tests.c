@@ -0,0 +1,362 @@
+/*
+ * SpanDSP - a series of DSP components for telephony
+ *
+ * tone_analyser_tests.c
+ *
+ * Written by Steve Underwood <steveu@coppice.org>
+ *
+ * Copyright (C) 2026 Steve Underwood
+ *
+ * All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2, as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+/*! \page tone_analyser_tests_page Combined tone analysis tests
+\section tone_analyser_tests_page_sec_1 What does it do?
+A test signal containing DTMF digits, a fax CNG tone, an ANSam tone and dial tone,
+in noise, is passed through a tone analyser, and through separate DTMF, modem connect
+tone and supervisory tone receivers. The test passes if the tone analyser reports
+exactly the same events as the separate receivers. This is checked
+with and without the DTMF receiver's dialtone filter.
+*/
+
+#if defined(HAVE_CONFIG_H)
+#include "config.h"
+#endif
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "spandsp.h"
+
+#define SAMPLES_PER_CHUNK       160
+#define TEST_SAMPLES            (SAMPLE_RATE*40)
+#define MAX_EVENTS              1000
+
+typedef struct
+{
+    char type;
+    int code;
+} event_t;
+
+typedef struct
+{
+    event_t event[MAX_EVENTS];
+    int events;
+} event_log_t;
+
+static int16_t amp[TEST_SAMPLES];
+
+static void log_event(event_log_t *log, char type, int code)
+{
+    if (log->events < MAX_EVENTS)
+    {
+        log->event[log->events].type = type;
+        log->event[log->events].code = code;
+        log->events++;
+    }
+    /*endif*/
+}
+/*- End of function --------------------------------------------------------*/
+
+static void digits_rx(void *user_data, const char *digits, int len)
+{
+    int i;
+
+    for (i = 0;  i < len;  i++)
+        log_event((event_log_t *) user_data, 'D', digits[i]);
+    /*endfor*/
+}
+/*- End of function --------------------------------------------------------*/
+
+static void cng_rx(void *user_data, int code, int level, int delay)
+{
+    log_event((event_log_t *) user_data, 'C', code);
+}
+/*- End of function --------------------------------------------------------*/
+
+static void ans_rx(void *user_data, int code, int level, int delay)
+{
+    log_event((event_log_t *) user_data, 'A', code);
+}
+/*- End of function --------------------------------------------------------*/
+
+static void super_tone_rx_report(void *user_data, int code, int level, int delay)
+{
+    log_event((event_log_t *) user_data, 'S', code);
+}
+/*- End of function --------------------------------------------------------*/
+
+static void super_tone_segment_report(void *user_data, int f1, int f2, int duration)
+{
+    log_event((event_log_t *) user_data, 'G', f1*100 + f2);
+}
+/*- End of function --------------------------------------------------------*/
+
+static int count_events(event_log_t *log, char type)
+{
+    int i;
+    int n;
+
+    n = 0;
+    for (i = 0;  i < log->events;  i++)
+    {
+        if (log->event[i].type == type)
+            n++;
+        /*endif*/
+    }
+    /*endfor*/
+    return n;
+}
+/*- End of function --------------------------------------------------------*/
+
+static int compare_events(event_log_t *a, event_log_t *b, char type)
+{
+    int i;
+    int j;
+
+    /* The receivers are run in a different order by the analyser, so only compare
+       the order of events from each receiver. */
+    for (i = 0, j = 0;  ;  i++, j++)
+    {
+        while (i < a->events  &&  a->event[i].type != type)
+            i++;
+        /*endwhile*/
+        while (j < b->events  &&  b->event[j].type != type)
+            j++;
+        /*endwhile*/
+        if (i >= a->events  ||  j >= b->events)
+            break;
+        /*endif*/
+        if (a->event[i].code != b->event[j].code)
+        {
+            printf("    %c event differs - %d vs %d\n", type, a->event[i].code, b->event[j].code);
+            return -1;
+        }
+        /*endif*/
+    }
+    /*endfor*/
+    if (i < a->events  ||  j < b->events)
+    {
+        printf("    The number of %c events differs\n", type);
+        return -1;
+    }
+    /*endif*/
+    return 0;
+}
+/*- End of function --------------------------------------------------------*/
+
+static int make_test_signal(int16_t amp[], int max_len)
+{
+    dtmf_tx_state_t *dtmf_tx_state;
+    modem_connect_tones_tx_state_t *tones_tx;
+    tone_gen_descriptor_t *tone_desc;
+    tone_gen_state_t *tone_gen_state;
+    awgn_state_t *noise_source;
+    int len;
+    int i;
+
+    len = 0;
+    /* Dial tone */
+    tone_desc = tone_gen_descriptor_init(NULL, 425, -15, 0, 0, 3000, 0, 0, 0, false);
+    tone_gen_state = tone_gen_init(NULL, tone_desc);
+    len += tone_gen(tone_gen_state, &amp[len], max_len - len);
+    tone_gen_free(tone_gen_state);
+    tone_gen_descriptor_free(tone_desc);
+    memset(&amp[len], 0, sizeof(int16_t)*SAMPLE_RATE);
+    len += SAMPLE_RATE;
+    /* DTMF digits */
+    dtmf_tx_state = dtmf_tx_init(NULL, NULL, NULL);
+    dtmf_tx_put(dtmf_tx_state, "123A456B789C*0#D", -1);
+    len += dtmf_tx(dtmf_tx_state, &amp[len], max_len - len);
+    dtmf_tx_free(dtmf_tx_state);
+    memset(&amp[len], 0, sizeof(int16_t)*SAMPLE_RATE);
+    len += SAMPLE_RATE;
+    /* A couple of cycles of CNG */
+    tones_tx = modem_connect_tones_tx_init(NULL, MODEM_CONNECT_TONES_FAX_CNG);
+    len += modem_connect_tones_tx(tones_tx, &amp[len], 7*SAMPLE_RATE);
+    modem_connect_tones_tx_free(tones_tx);
+    memset(&amp[len], 0, sizeof(int16_t)*SAMPLE_RATE);
+    len += SAMPLE_RATE;
+    /* ANSam */
+    tones_tx = modem_connect_tones_tx_init(NULL, MODEM_CONNECT_TONES_ANSAM_PR);
+    len += modem_connect_tones_tx(tones_tx, &amp[len], 5*SAMPLE_RATE);
+    modem_connect_tones_tx_free(tones_tx);
+    memset(&amp[len], 0, sizeof(int16_t)*SAMPLE_RATE);
+    len += SAMPLE_RATE;
+    noise_source = awgn_init_dbm0(NULL, 1234567, -50.0f);
+    for (i = 0;  i < len;  i++)
+        amp[i] = sat_add16(amp[i], awgn(noise_source));
+    /*endfor*/
+    awgn_free(noise_source);
+    return len;
+}
+/*- End of function --------------------------------------------------------*/
+
+static super_tone_rx_descriptor_t *make_super_tone_descriptor(void)
+{
+    super_tone_rx_descriptor_t *desc;
+    int tone_id;
+
+    desc = super_tone_rx_make_descriptor(NULL);
+    /* Dial tone */
+    tone_id = super_tone_rx_add_tone(desc);
+    super_tone_rx_add_element(desc, tone_id, 425, 0, 700, 0);
+    /* Busy tone */
+    tone_id = super_tone_rx_add_tone(desc);
+    super_tone_rx_add_element(desc, tone_id, 480, 620, 450, 550);
+    super_tone_rx_add_element(desc, tone_id, 0, 0, 450, 550);
+    return desc;
+}
+/*- End of function --------------------------------------------------------*/
+
+static void run_separate(event_log_t *log, int len, bool filter_dialtone)
+{
+    dtmf_rx_state_t *dtmf_rx_state;
+    modem_connect_tones_rx_state_t *cng_rx_state;
+    modem_connect_tones_rx_state_t *ans_rx_state;
+    super_tone_rx_descriptor_t *desc;
+    super_tone_rx_state_t *super_tone_rx_state;
+    int chunk;
+    int i;
+
+    dtmf_rx_state = dtmf_rx_init(NULL, digits_rx, log);
+    if (filter_dialtone)
+        dtmf_rx_parms(dtmf_rx_state, true, -1.0f, -1.0f, -99.0f);
+    /*endif*/
+    cng_rx_state = modem_connect_tones_rx_init(NULL, MODEM_CONNECT_TONES_FAX_CNG, cng_rx, log);
+    ans_rx_state = modem_connect_tones_rx_init(NULL, MODEM_CONNECT_TONES_ANSAM_PR, ans_rx, log);
+    desc = make_super_tone_descriptor();
+    super_tone_rx_state = super_tone_rx_init(NULL, desc, super_tone_rx_report, log);
+    super_tone_rx_segment_callback(super_tone_rx_state, super_tone_segment_report);
+    log->events = 0;
+    for (i = 0;  i < len;  i += chunk)
+    {
+        chunk = (len - i < SAMPLES_PER_CHUNK)  ?  (len - i)  :  SAMPLES_PER_CHUNK;
+        dtmf_rx(dtmf_rx_state, &amp[i], chunk);
+        modem_connect_tones_rx(cng_rx_state, &amp[i], chunk);
+        modem_connect_tones_rx(ans_rx_state, &amp[i], chunk);
+        super_tone_rx(super_tone_rx_state, &amp[i], chunk);
+    }
+    /*endfor*/
+    dtmf_rx_free(dtmf_rx_state);
+    modem_connect_tones_rx_free(cng_rx_state);
+    modem_connect_tones_rx_free(ans_rx_state);
+    super_tone_rx_free(super_tone_rx_state);
+    super_tone_rx_free_descriptor(desc);
+}
+/*- End of function --------------------------------------------------------*/
+
+static void run_analyser(event_log_t *log, int len, bool filter_dialtone)
+{
+    tone_analyser_state_t *analyser;
+    dtmf_rx_state_t *dtmf_rx_state;
+    super_tone_rx_descriptor_t *desc;
+    super_tone_rx_state_t *super_tone_rx_state;
+    int chunk;
+    int i;
+
+    analyser = tone_analyser_init(NULL);
+    dtmf_rx_state = tone_analyser_enable_dtmf(analyser, digits_rx, log);
+    if (filter_dialtone)
+        dtmf_rx_parms(dtmf_rx_state, true, -1.0f, -1.0f, -99.0f);
+    /*endif*/
+    tone_analyser_enable_modem_connect_tones(analyser, MODEM_CONNECT_TONES_FAX_CNG, cng_rx, log);
+    tone_analyser_enable_modem_connect_tones(analyser, MODEM_CONNECT_TONES_ANSAM_PR, ans_rx, log);
+    desc = make_super_tone_descriptor();
+    super_tone_rx_state = tone_analyser_enable_super_tone(analyser, desc, super_tone_rx_report, log);
+    super_tone_rx_segment_callback(super_tone_rx_state, super_tone_segment_report);
+    printf("    The analyser runs %d Goertzel filters\n", tone_analyser_get_goertzels(analyser));
+    log->events = 0;
+    /* Use irregular chunks, to exercise the banks' partial blocks */
+    for (i = 0, chunk = 1;  i < len;  i += chunk, chunk = (chunk*7 + 3)%317)
+    {
+        if (chunk > len - i)
+            chunk = len - i;
+        /*endif*/
+        tone_analyser_rx(analyser, &amp[i], chunk);
+    }
+    /*endfor*/
+    tone_analyser_free(analyser);
+    super_tone_rx_free_descriptor(desc);
+}
+/*- End of function --------------------------------------------------------*/
+
+static int compare_tests(bool filter_dialtone)
+{
+    static event_log_t separate_log;
+    static event_log_t analyser_log;
+    int len;
+
+    printf("Test: Tone analyser against separate receivers, %s dialtone filter\n", (filter_dialtone)  ?  "with"  :  "without");
+    len = make_test_signal(amp, TEST_SAMPLES);
+    run_separate(&separate_log, len, filter_dialtone);
+    run_analyser(&analyser_log, len, filter_dialtone);
+    printf("    %d DTMF digits, %d CNG reports, %d ANS reports, %d supervisory tone reports, %d segments\n",
+           count_events(&separate_log, 'D'),
+           count_events(&separate_log, 'C'),
+           count_events(&separate_log, 'A'),
+           count_events(&separate_log, 'S'),
+           count_events(&separate_log, 'G'));
+    if (count_events(&separate_log, 'D') != 16
+        ||
+        count_events(&separate_log, 'C') == 0
+        ||
+        count_events(&separate_log, 'A') == 0
+        ||
+        count_events(&separate_log, 'S') == 0)
+    {
+        printf("    The separate receivers missed something\n");
+        return -1;
+    }
+    /*endif*/
+    if (compare_events(&separate_log, &analyser_log, 'D')
+        ||
+        compare_events(&separate_log, &analyser_log, 'C')
+        ||
+        compare_events(&separate_log, &analyser_log, 'A')
+        ||
+        compare_events(&separate_log, &analyser_log, 'S')
+        ||
+        compare_events(&separate_log, &analyser_log, 'G'))
+    {
+        return -1;
+    }
+    /*endif*/
+    printf("    Passed\n");
+    return 0;
+}
+/*- End of function --------------------------------------------------------*/
+
+int main(int argc, char *argv[])
+{
+    if (compare_tests(false))
+    {
+        printf("Tests failed\n");
+        exit(2);
+    }
+    /*endif*/
+    if (compare_tests(true))
+    {
+        printf("Tests failed\n");
+        exit(2);
+    }
+    /*endif*/
+    printf("Tests passed\n");
+    return 0;
+}
+/*- End of function --------------------------------------------------------*/
+/*- End of file ------------------------------------------------------------*/
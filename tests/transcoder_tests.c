@@ -0,0 +1,366 @@
+/*
+ * SpanDSP - a series of DSP components for telephony
+ *
+ * transcoder_tests.c
+ *
+ * Written by Steve Underwood <steveu@coppice.org>
+ *
+ * Copyright (C) 2026 Steve Underwood
+ *
+ * All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2, as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+/*! \page transcoder_tests_page Speech codec transcoder tests
+\section transcoder_tests_page_sec_1 What does it do?
+These tests check:
+    - every pair of formats gives exactly the same result when the data is passed to
+      the transcoder in irregular pieces as when it is passed in one go.
+    - transcoding gives exactly the same result as decoding and re-encoding with
+      separate codec contexts.
+    - resampling from 8000 to 16000 samples/second and back preserves a tone.
+    - transcoding a batch of streams gives the same results as transcoding them one
+      at a time.
+*/
+
+#if defined(HAVE_CONFIG_H)
+#include "config.h"
+#endif
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "spandsp.h"
+
+#define TEST_SAMPLES        16000
+#define MAX_DATA            (4*TEST_SAMPLES + 1000)
+
+static const char *format_names[TRANSCODER_FORMATS] =
+{
+    "linear 8000",
+    "linear 16000",
+    "A-law",
+    "u-law",
+    "G.722 64000",
+    "G.722 56000",
+    "G.722 48000",
+    "G.726 16000",
+    "G.726 24000",
+    "G.726 32000",
+    "G.726 40000",
+    "GSM 06.10",
+    "IMA ADPCM",
+    "OKI ADPCM 24000",
+    "OKI ADPCM 32000",
+    "LPC10"
+};
+
+static uint8_t in_data[TRANSCODER_FORMATS][MAX_DATA];
+static int in_len[TRANSCODER_FORMATS];
+static uint8_t out_data[MAX_DATA];
+static uint8_t out_data2[MAX_DATA];
+
+static int make_tone(int16_t amp[], int samples, int sample_rate, float level)
+{
+    tone_gen_descriptor_t *tone_desc;
+    tone_gen_state_t *tone_gen_state;
+    int len;
+
+    /* Use a tone at each end of the narrow band, so resampling can be checked */
+    tone_desc = tone_gen_descriptor_init(NULL, 400, level, 3000, level, 1, 0, 0, 0, true);
+    tone_gen_state = tone_gen_init(NULL, tone_desc);
+    if (sample_rate == SAMPLE_RATE)
+    {
+        len = tone_gen(tone_gen_state, amp, samples);
+    }
+    else
+    {
+        /* The tone generator works at 8000 samples/second, so halve the frequencies
+           and treat the result as 16000 samples/second. */
+        tone_gen_descriptor_free(tone_desc);
+        tone_gen_free(tone_gen_state);
+        tone_desc = tone_gen_descriptor_init(NULL, 200, level, 1500, level, 1, 0, 0, 0, true);
+        tone_gen_state = tone_gen_init(NULL, tone_desc);
+        len = tone_gen(tone_gen_state, amp, samples);
+    }
+    /*endif*/
+    tone_gen_free(tone_gen_state);
+    tone_gen_descriptor_free(tone_desc);
+    return len;
+}
+/*- End of function --------------------------------------------------------*/
+
+static void make_input_data(void)
+{
+    static int16_t amp[2*TEST_SAMPLES];
+    transcoder_state_t *s;
+    int format;
+    int linear;
+    int len;
+
+    for (format = 0;  format < TRANSCODER_FORMATS;  format++)
+    {
+        if (transcoder_format_sample_rate(format) == SAMPLE_RATE)
+        {
+            linear = TRANSCODER_LINEAR_8000;
+            len = make_tone(amp, TEST_SAMPLES, SAMPLE_RATE, -10.0f);
+        }
+        else
+        {
+            linear = TRANSCODER_LINEAR_16000;
+            len = make_tone(amp, 2*TEST_SAMPLES, 2*SAMPLE_RATE, -10.0f);
+        }
+        /*endif*/
+        s = transcoder_init(NULL, linear, format);
+        in_len[format] = transcoder_transcode(s, in_data[format], (const uint8_t *) amp, len*sizeof(int16_t));
+        transcoder_free(s);
+    }
+    /*endfor*/
+}
+/*- End of function --------------------------------------------------------*/
+
+static int chunking_tests(void)
+{
+    transcoder_state_t *s;
+    int in_format;
+    int out_format;
+    int len;
+    int len2;
+    int chunk;
+    int i;
+
+    printf("Test: transcoding in irregular pieces\n");
+    for (in_format = 0;  in_format < TRANSCODER_FORMATS;  in_format++)
+    {
+        for (out_format = 0;  out_format < TRANSCODER_FORMATS;  out_format++)
+        {
+            s = transcoder_init(NULL, in_format, out_format);
+            if (transcoder_max_output(s, in_len[in_format]) > MAX_DATA)
+            {
+                printf("    %s -> %s - output would be too long\n", format_names[in_format], format_names[out_format]);
+                return -1;
+            }
+            /*endif*/
+            len = transcoder_transcode(s, out_data, in_data[in_format], in_len[in_format]);
+            transcoder_free(s);
+
+            s = transcoder_init(NULL, in_format, out_format);
+            len2 = 0;
+            for (i = 0, chunk = 1;  i < in_len[in_format];  i += chunk, chunk = (chunk*7 + 3)%253)
+            {
+                if (chunk > in_len[in_format] - i)
+                    chunk = in_len[in_format] - i;
+                /*endif*/
+                len2 += transcoder_transcode(s, &out_data2[len2], &in_data[in_format][i], chunk);
+            }
+            /*endfor*/
+            transcoder_free(s);
+            if (len == 0  ||  len != len2  ||  memcmp(out_data, out_data2, len) != 0)
+            {
+                printf("    %s -> %s - %d bytes in one go, %d bytes in pieces\n", format_names[in_format], format_names[out_format], len, len2);
+                return -1;
+            }
+            /*endif*/
+        }
+        /*endfor*/
+    }
+    /*endfor*/
+    printf("    Passed\n");
+    return 0;
+}
+/*- End of function --------------------------------------------------------*/
+
+static int reference_tests(void)
+{
+    static int16_t amp[2*TEST_SAMPLES];
+    transcoder_state_t *s;
+    g726_state_t *g726;
+    gsm0610_state_t *gsm0610;
+    lpc10_encode_state_t *lpc10;
+    g722_decode_state_t *g722;
+    g711_state_t *g711;
+    int samples;
+    int len;
+    int len2;
+
+    printf("Test: transcoding against separate codecs\n");
+    /* A-law -> G.726 */
+    s = transcoder_init(NULL, TRANSCODER_ALAW, TRANSCODER_G726_32000);
+    len = transcoder_transcode(s, out_data, in_data[TRANSCODER_ALAW], in_len[TRANSCODER_ALAW]);
+    transcoder_free(s);
+    g711 = g711_init(NULL, G711_ALAW);
+    samples = g711_decode(g711, amp, in_data[TRANSCODER_ALAW], in_len[TRANSCODER_ALAW]);
+    g711_free(g711);
+    g726 = g726_init(NULL, 32000, G726_ENCODING_LINEAR, G726_PACKING_RIGHT);
+    len2 = g726_encode(g726, out_data2, amp, samples);
+    g726_free(g726);
+    if (len != len2  ||  memcmp(out_data, out_data2, len) != 0)
+    {
+        printf("    A-law -> G.726 differs\n");
+        return -1;
+    }
+    /*endif*/
+
+    /* GSM 06.10 -> LPC10 */
+    s = transcoder_init(NULL, TRANSCODER_GSM0610, TRANSCODER_LPC10);
+    len = transcoder_transcode(s, out_data, in_data[TRANSCODER_GSM0610], in_len[TRANSCODER_GSM0610]);
+    transcoder_free(s);
+    gsm0610 = gsm0610_init(NULL, GSM0610_PACKING_VOIP);
+    samples = gsm0610_decode(gsm0610, amp, in_data[TRANSCODER_GSM0610], in_len[TRANSCODER_GSM0610]);
+    gsm0610_free(gsm0610);
+    lpc10 = lpc10_encode_init(NULL, false);
+    len2 = lpc10_encode(lpc10, out_data2, amp, samples - samples%LPC10_SAMPLES_PER_FRAME);
+    lpc10_encode_free(lpc10);
+    if (len != len2  ||  memcmp(out_data, out_data2, len) != 0)
+    {
+        printf("    GSM 06.10 -> LPC10 differs\n");
+        return -1;
+    }
+    /*endif*/
+
+    /* G.722 -> linear */
+    s = transcoder_init(NULL, TRANSCODER_G722_64000, TRANSCODER_LINEAR_16000);
+    len = transcoder_transcode(s, out_data, in_data[TRANSCODER_G722_64000], in_len[TRANSCODER_G722_64000]);
+    transcoder_free(s);
+    g722 = g722_decode_init(NULL, 64000, G722_PACKED);
+    samples = g722_decode(g722, amp, in_data[TRANSCODER_G722_64000], in_len[TRANSCODER_G722_64000]);
+    g722_decode_free(g722);
+    if (len != samples*sizeof(int16_t)  ||  memcmp(out_data, amp, len) != 0)
+    {
+        printf("    G.722 -> linear differs\n");
+        return -1;
+    }
+    /*endif*/
+    printf("    Passed\n");
+    return 0;
+}
+/*- End of function --------------------------------------------------------*/
+
+static int resampling_tests(void)
+{
+    static int16_t amp[2*TEST_SAMPLES];
+    static int16_t amp2[2*TEST_SAMPLES];
+    static int16_t amp3[TEST_SAMPLES];
+    transcoder_state_t *s;
+    power_meter_t *before;
+    power_meter_t *after;
+    int len;
+    int i;
+
+    printf("Test: resampling\n");
+    len = make_tone(amp, TEST_SAMPLES, SAMPLE_RATE, -10.0f);
+    s = transcoder_init(NULL, TRANSCODER_LINEAR_8000, TRANSCODER_LINEAR_16000);
+    len = transcoder_transcode(s, (uint8_t *) amp2, (const uint8_t *) amp, len*sizeof(int16_t))/sizeof(int16_t);
+    transcoder_free(s);
+    if (len != 2*TEST_SAMPLES)
+    {
+        printf("    Upsampling gave %d samples\n", len);
+        return -1;
+    }
+    /*endif*/
+    s = transcoder_init(NULL, TRANSCODER_LINEAR_16000, TRANSCODER_LINEAR_8000);
+    len = transcoder_transcode(s, (uint8_t *) amp3, (const uint8_t *) amp2, len*sizeof(int16_t))/sizeof(int16_t);
+    transcoder_free(s);
+    if (len != TEST_SAMPLES)
+    {
+        printf("    Downsampling gave %d samples\n", len);
+        return -1;
+    }
+    /*endif*/
+    /* The resampler's RESAMPLE_STANDARD filters each delay the audio by 15.5 samples at
+       8000 samples/second, so the round trip delays it by 31 samples. */
+    before = power_meter_init(NULL, 10);
+    after = power_meter_init(NULL, 10);
+    for (i = 1000;  i < TEST_SAMPLES;  i++)
+    {
+        power_meter_update(before, amp[i - 31]);
+        power_meter_update(after, (int16_t) (amp3[i] - amp[i - 31]));
+    }
+    /*endfor*/
+    printf("    Tone %.2fdBm0, error after resampling up and down %.2fdBm0\n",
+           power_meter_current_dbm0(before),
+           power_meter_current_dbm0(after));
+    if (power_meter_current_dbm0(after) > power_meter_current_dbm0(before) - 40.0f)
+    {
+        printf("    Resampling error is too large\n");
+        return -1;
+    }
+    /*endif*/
+    power_meter_free(before);
+    power_meter_free(after);
+    printf("    Passed\n");
+    return 0;
+}
+/*- End of function --------------------------------------------------------*/
+
+static int batch_tests(void)
+{
+    static uint8_t batch_out[TRANSCODER_FORMATS][MAX_DATA];
+    transcoder_state_t *s[TRANSCODER_FORMATS];
+    uint8_t *out[TRANSCODER_FORMATS];
+    const uint8_t *in[TRANSCODER_FORMATS];
+    int out_len[TRANSCODER_FORMATS];
+    int len;
+    int i;
+
+    printf("Test: transcoding a batch of streams\n");
+    for (i = 0;  i < TRANSCODER_FORMATS;  i++)
+    {
+        s[i] = transcoder_init(NULL, i, TRANSCODER_FORMATS - 1 - i);
+        out[i] = batch_out[i];
+        in[i] = in_data[i];
+    }
+    /*endfor*/
+    transcoder_batch(s, out, out_len, in, in_len, TRANSCODER_FORMATS);
+    for (i = 0;  i < TRANSCODER_FORMATS;  i++)
+    {
+        transcoder_free(s[i]);
+        s[i] = transcoder_init(NULL, i, TRANSCODER_FORMATS - 1 - i);
+        len = transcoder_transcode(s[i], out_data, in_data[i], in_len[i]);
+        transcoder_free(s[i]);
+        if (len != out_len[i]  ||  memcmp(out_data, batch_out[i], len) != 0)
+        {
+            printf("    Stream %d (%s -> %s) differs\n", i, format_names[i], format_names[TRANSCODER_FORMATS - 1 - i]);
+            return -1;
+        }
+        /*endif*/
+    }
+    /*endfor*/
+    printf("    Passed\n");
+    return 0;
+}
+/*- End of function --------------------------------------------------------*/
+
+int main(int argc, char *argv[])
+{
+    make_input_data();
+    if (chunking_tests()
+        ||
+        reference_tests()
+        ||
+        resampling_tests()
+        ||
+        batch_tests())
+    {
+        printf("Tests failed\n");
+        exit(2);
+    }
+    /*endif*/
+    printf("Tests passed\n");
+    return 0;
+}
+/*- End of function --------------------------------------------------------*/
+/*- End of file ------------------------------------------------------------*/
@@ -97,6 +97,12 @@ qam_monitor_t *qam_monitor;
 
 bert_results_t latest_results;
 
+/* A snapshot of the receiver's training, taken each time training succeeds. Later
+   training attempts, such as one on the noise after the carrier drops, may fail
+   and discard what the receiver holds. */
+uint8_t training_snapshot[1000];
+int training_snapshot_len = -1;
+
 static void reporter(void *user_data, int reason, bert_results_t *results)
 {
     switch (reason)
@@ -130,6 +136,7 @@ static void v17_rx_status(void *user_data, int status)
     {
     case SIG_STATUS_TRAINING_SUCCEEDED:
         printf("Training succeeded\n");
+        training_snapshot_len = v17_rx_export_training(s, 42, training_snapshot, sizeof(training_snapshot));
         if ((len = v17_rx_equalizer_state(s, &coeffs)))
         {
             printf("Equalizer:\n");
@@ -263,6 +270,148 @@ static void qam_report(void *user_data, const complexf_t *constel, const complex
 }
 /*- End of function --------------------------------------------------------*/
 
+static int test_training_export(const uint8_t buf[], int len, int bit_rate)
+{
+    v17_rx_state_t *rx2;
+    uint8_t buf2[1000];
+
+    /* Carry the training into a fresh receiver, as an application might between calls
+       over the same route. */
+    if (len <= 0)
+        return -1;
+    /*endif*/
+    if ((rx2 = v17_rx_init(NULL, bit_rate, v17putbit, NULL)) == NULL)
+        return -1;
+    /*endif*/
+    /* An untrained receiver has nothing to export, and training for another route must be refused */
+    if (v17_rx_export_training(rx2, 42, buf2, sizeof(buf2)) >= 0
+        ||
+        v17_rx_import_training(rx2, 43, buf, len) == 0
+        ||
+        v17_rx_import_training(rx2, 42, buf, len) != 0
+        ||
+        v17_rx_export_training(rx2, 42, buf2, sizeof(buf2)) != len
+        ||
+        memcmp(buf, buf2, len) != 0)
+    {
+        v17_rx_free(rx2);
+        return -1;
+    }
+    /*endif*/
+    v17_rx_free(rx2);
+    return 0;
+}
+/*- End of function --------------------------------------------------------*/
+
+static void imported_training_putbit(void *user_data, int bit)
+{
+    if (bit < 0)
+    {
+        /* Remember the last training result */
+        if (bit == SIG_STATUS_TRAINING_SUCCEEDED  ||  bit == SIG_STATUS_TRAINING_FAILED)
+            *((int *) user_data) = bit;
+        /*endif*/
+        return;
+    }
+    /*endif*/
+    bert_put_bit(&bert, bit);
+}
+/*- End of function --------------------------------------------------------*/
+
+static void run_imported_training(v17_tx_state_t *tx, v17_rx_state_t *rx, one_way_line_model_state_t *model, int blocks)
+{
+    int16_t gen_amp[BLOCK_LEN];
+    int16_t amp[BLOCK_LEN];
+    int samples;
+    int i;
+
+    for (i = 0;  i < blocks;  i++)
+    {
+        samples = v17_tx(tx, gen_amp, BLOCK_LEN);
+        one_way_line_model(model, amp, gen_amp, samples);
+        v17_rx(rx, amp, samples);
+    }
+    /*endfor*/
+}
+/*- End of function --------------------------------------------------------*/
+
+static int test_imported_training(int bit_rate, bool tep)
+{
+    v17_tx_state_t *tx;
+    v17_rx_state_t *rx;
+    v17_rx_state_t *rx2;
+    one_way_line_model_state_t *model;
+    bert_results_t bert_results;
+    uint8_t buf[1000];
+    int status;
+    int status2;
+    int len;
+
+    /* Train a receiver with a long training sequence, and carry its training into a fresh
+       receiver. The fresh receiver must then train on a short training sequence, and
+       receive data without errors. */
+    printf("Testing short training with imported training\n");
+    if ((model = one_way_line_model_init(0, -70.0f, MUNGE_CODEC_NONE, 0)) == NULL)
+        return -1;
+    /*endif*/
+    one_way_line_model_set_dc(model, 0.0f);
+    bert_init(&bert, 0, BERT_PATTERN_ITU_O152_11, bit_rate, 20);
+    tx = v17_tx_init(NULL, bit_rate, tep, v17getbit, NULL);
+    v17_tx_power(tx, -13.0f);
+    status = 0;
+    rx = v17_rx_init(NULL, bit_rate, imported_training_putbit, &status);
+    /* 3 seconds is plenty for the long training sequence */
+    run_imported_training(tx, rx, model, 3*SAMPLE_RATE/BLOCK_LEN);
+    if (status != SIG_STATUS_TRAINING_SUCCEEDED
+        ||
+        (len = v17_rx_export_training(rx, 42, buf, sizeof(buf))) <= 0)
+    {
+        printf("Long training failed\n");
+        len = -1;
+    }
+    /*endif*/
+    v17_rx_free(rx);
+
+    status2 = 0;
+    rx2 = v17_rx_init(NULL, bit_rate, imported_training_putbit, &status2);
+    if (len <= 0  ||  v17_rx_import_training(rx2, 42, buf, len))
+    {
+        printf("Import failed\n");
+        v17_rx_free(rx2);
+        v17_tx_free(tx);
+        one_way_line_model_free(model);
+        return -1;
+    }
+    /*endif*/
+    v17_rx_restart(rx2, bit_rate, true);
+    v17_tx_restart(tx, bit_rate, tep, true);
+    bert_init(&bert, 0, BERT_PATTERN_ITU_O152_11, bit_rate, 20);
+    run_imported_training(tx, rx2, model, 3*SAMPLE_RATE/BLOCK_LEN);
+    bert_result(&bert, &bert_results);
+    printf("Short training %s, %d bits, %d bad bits, %d resyncs\n",
+           signal_status_to_str(status2),
+           bert_results.total_bits,
+           bert_results.bad_bits,
+           bert_results.resyncs);
+    v17_rx_free(rx2);
+    v17_tx_free(tx);
+    one_way_line_model_free(model);
+    /* The short training sequence is about 20ms, so at least 2 seconds of data should arrive */
+    if (status2 != SIG_STATUS_TRAINING_SUCCEEDED
+        ||
+        bert_results.total_bits < 2*bit_rate
+        ||
+        bert_results.bad_bits != 0
+        ||
+        bert_results.resyncs != 0)
+    {
+        return -1;
+    }
+    /*endif*/
+    return 0;
+}
+/*- End of function --------------------------------------------------------*/
+
 #if defined(HAVE_FENV_H)
 static void sigfpe_handler(int sig_num, siginfo_t *info, void *data)
 {
@@ -607,6 +756,20 @@ int main(int argc, char *argv[])
             exit(2);
         }
         /*endif*/
+        if (test_training_export(training_snapshot, training_snapshot_len, test_bps))
+        {
+            printf("Training export failed.\n");
+            printf("Tests failed.\n");
+            exit(2);
+        }
+        /*endif*/
+        if (test_imported_training(test_bps, tep))
+        {
+            printf("Short training with imported training failed.\n");
+            printf("Tests failed.\n");
+            exit(2);
+        }
+        /*endif*/
 
         printf("Tests passed.\n");
     }
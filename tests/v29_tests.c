@@ -56,6 +56,7 @@ display of modem status is maintained.
 #include <fcntl.h>
 #include <unistd.h>
 #include <string.h>
+#include <math.h>
 #include <sndfile.h>
 #include <signal.h>
 #if defined(HAVE_FENV_H)
@@ -92,6 +93,12 @@ qam_monitor_t *qam_monitor;
 
 bert_results_t latest_results;
 
+/* A snapshot of the receiver's training, taken each time training succeeds. Later
+   training attempts, such as one on the noise after the carrier drops, may fail
+   and discard what the receiver holds. */
+uint8_t training_snapshot[1000];
+int training_snapshot_len = -1;
+
 static void reporter(void *user_data, int reason, bert_results_t *results)
 {
     switch (reason)
@@ -125,6 +132,7 @@ static void v29_rx_status(void *user_data, int status)
     {
     case SIG_STATUS_TRAINING_SUCCEEDED:
         printf("Training succeeded\n");
+        training_snapshot_len = v29_rx_export_training(s, 42, training_snapshot, sizeof(training_snapshot));
         if ((len = v29_rx_equalizer_state(s, &coeffs)))
         {
             printf("Equalizer:\n");
@@ -257,6 +265,157 @@ static void qam_report(void *user_data, const complexf_t *constel, const complex
 }
 /*- End of function --------------------------------------------------------*/
 
+static int test_training_export(const uint8_t buf[], int len, int bit_rate)
+{
+    v29_rx_state_t *rx2;
+    uint8_t buf2[1000];
+
+    /* Carry the training into a fresh receiver, as an application might between calls
+       over the same route. */
+    if (len <= 0)
+        return -1;
+    /*endif*/
+    if ((rx2 = v29_rx_init(NULL, bit_rate, v29putbit, NULL)) == NULL)
+        return -1;
+    /*endif*/
+    /* An untrained receiver has nothing to export, and training for another route must be refused */
+    if (v29_rx_export_training(rx2, 42, buf2, sizeof(buf2)) >= 0
+        ||
+        v29_rx_import_training(rx2, 43, buf, len) == 0
+        ||
+        v29_rx_import_training(rx2, 42, buf, len) != 0
+        ||
+        v29_rx_export_training(rx2, 42, buf2, sizeof(buf2)) != len
+        ||
+        memcmp(buf, buf2, len) != 0)
+    {
+        v29_rx_free(rx2);
+        return -1;
+    }
+    /*endif*/
+    v29_rx_free(rx2);
+    return 0;
+}
+/*- End of function --------------------------------------------------------*/
+
+static void imported_training_putbit(void *user_data, int bit)
+{
+    if (bit < 0)
+    {
+        /* Remember the last training result */
+        if (bit == SIG_STATUS_TRAINING_SUCCEEDED  ||  bit == SIG_STATUS_TRAINING_FAILED)
+            *((int *) user_data) = bit;
+        /*endif*/
+        return;
+    }
+    /*endif*/
+    bert_put_bit(&bert, bit);
+}
+/*- End of function --------------------------------------------------------*/
+
+static void run_imported_training(v29_tx_state_t *tx, v29_rx_state_t *rx, one_way_line_model_state_t *model, int blocks)
+{
+    int16_t gen_amp[BLOCK_LEN];
+    int16_t amp[BLOCK_LEN];
+    int samples;
+    int i;
+
+    for (i = 0;  i < blocks;  i++)
+    {
+        samples = v29_tx(tx, gen_amp, BLOCK_LEN);
+        one_way_line_model(model, amp, gen_amp, samples);
+        v29_rx(rx, amp, samples);
+    }
+    /*endfor*/
+}
+/*- End of function --------------------------------------------------------*/
+
+static int test_imported_training(int bit_rate, bool tep)
+{
+    v29_tx_state_t *tx;
+    v29_rx_state_t *rx;
+    v29_rx_state_t *rx2;
+    one_way_line_model_state_t *model;
+    bert_results_t bert_results;
+    uint8_t buf[1000];
+    float carrier;
+    int status;
+    int status2;
+    int len;
+
+    /* Train a receiver, and carry its training into a fresh receiver. The fresh receiver
+       must then start from that old training, and receive data without errors. */
+    printf("Testing old training with imported training\n");
+    if ((model = one_way_line_model_init(0, -70.0f, MUNGE_CODEC_NONE, 0)) == NULL)
+        return -1;
+    /*endif*/
+    bert_init(&bert, 0, BERT_PATTERN_ITU_O152_11, bit_rate, 20);
+    tx = v29_tx_init(NULL, bit_rate, tep, v29getbit, NULL);
+    v29_tx_power(tx, -13.0f);
+    status = 0;
+    rx = v29_rx_init(NULL, bit_rate, imported_training_putbit, &status);
+    run_imported_training(tx, rx, model, 3*SAMPLE_RATE/BLOCK_LEN);
+    if (status != SIG_STATUS_TRAINING_SUCCEEDED
+        ||
+        (len = v29_rx_export_training(rx, 42, buf, sizeof(buf))) <= 0)
+    {
+        printf("Training failed\n");
+        len = -1;
+    }
+    /*endif*/
+    carrier = v29_rx_carrier_frequency(rx);
+    v29_rx_free(rx);
+
+    status2 = 0;
+    rx2 = v29_rx_init(NULL, bit_rate, imported_training_putbit, &status2);
+    if (len <= 0  ||  v29_rx_import_training(rx2, 42, buf, len))
+    {
+        printf("Import failed\n");
+        v29_rx_free(rx2);
+        v29_tx_free(tx);
+        one_way_line_model_free(model);
+        return -1;
+    }
+    /*endif*/
+    v29_rx_restart(rx2, bit_rate, true);
+    /* The transmitter always sends the full training sequence, so check the fresh
+       receiver really is starting from the imported training. */
+    if (fabsf(v29_rx_carrier_frequency(rx2) - carrier) > 1.0f)
+    {
+        printf("Old training did not restore the carrier frequency (%.2fHz vs %.2fHz)\n", v29_rx_carrier_frequency(rx2), carrier);
+        v29_rx_free(rx2);
+        v29_tx_free(tx);
+        one_way_line_model_free(model);
+        return -1;
+    }
+    /*endif*/
+    v29_tx_restart(tx, bit_rate, tep);
+    bert_init(&bert, 0, BERT_PATTERN_ITU_O152_11, bit_rate, 20);
+    run_imported_training(tx, rx2, model, 3*SAMPLE_RATE/BLOCK_LEN);
+    bert_result(&bert, &bert_results);
+    printf("Old training %s, %d bits, %d bad bits, %d resyncs\n",
+           signal_status_to_str(status2),
+           bert_results.total_bits,
+           bert_results.bad_bits,
+           bert_results.resyncs);
+    v29_rx_free(rx2);
+    v29_tx_free(tx);
+    one_way_line_model_free(model);
+    if (status2 != SIG_STATUS_TRAINING_SUCCEEDED
+        ||
+        bert_results.total_bits < 2*bit_rate
+        ||
+        bert_results.bad_bits != 0
+        ||
+        bert_results.resyncs != 0)
+    {
+        return -1;
+    }
+    /*endif*/
+    return 0;
+}
+/*- End of function --------------------------------------------------------*/
+
 #if defined(HAVE_FENV_H)
 static void sigfpe_handler(int sig_num, siginfo_t *info, void *data)
 {
@@ -589,6 +748,20 @@ int main(int argc, char *argv[])
             exit(2);
         }
         /*endif*/
+        if (test_training_export(training_snapshot, training_snapshot_len, test_bps))
+        {
+            printf("Training export failed.\n");
+            printf("Tests failed.\n");
+            exit(2);
+        }
+        /*endif*/
+        if (test_imported_training(test_bps, tep))
+        {
+            printf("Old training with imported training failed.\n");
+            printf("Tests failed.\n");
+            exit(2);
+        }
+        /*endif*/
 
         printf("Tests passed.\n");
     }
@@ -33,6 +33,11 @@ If the appropriate GUI environment exists, the tests are built such that a visua
 display of modem status is maintained.
 
 \section v34_tests_page_sec_2 How is it used?
+The -P option measures the CPU cost of the receiver, rather than testing it. The
+signal from one modem is fed to the receiver of another, and the time spent in the
+receiver is reported as CPU clock ticks and nanoseconds per sample, and as the number
+of receivers one CPU core could sustain. The time spent decoding mapping frames is
+reported separately.
 */
 
 #if defined(HAVE_CONFIG_H)
@@ -48,6 +53,7 @@ display of modem status is maintained.
 #include <fcntl.h>
 #include <unistd.h>
 #include <string.h>
+#include <sys/time.h>
 #include <sndfile.h>
 
 #define SPANDSP_EXPOSE_INTERNAL_STRUCTURES
@@ -495,6 +501,100 @@ static void v34_mapping_frame_tests(int test_baud_rate, int test_bps, bool duple
 /*- End of function --------------------------------------------------------*/
 #endif
 
+static int perf_bits = 0;
+
+static void v34_perf_put_bit(void *user_data, int bit)
+{
+    if (bit >= 0)
+        perf_bits++;
+    /*endif*/
+}
+/*- End of function --------------------------------------------------------*/
+
+static double now_ns(void)
+{
+    struct timeval tv;
+
+    gettimeofday(&tv, NULL);
+    return tv.tv_sec*1.0e9 + tv.tv_usec*1.0e3;
+}
+/*- End of function --------------------------------------------------------*/
+
+static void v34_rx_perf_tests(int test_baud_rate, int test_bps, int seconds)
+{
+    int16_t caller_amp[SAMPLES_PER_CHUNK];
+    int16_t answerer_amp[SAMPLES_PER_CHUNK];
+    int16_t bits[16];
+    int samples;
+    int chunks;
+    int frames;
+    int i;
+    uint64_t start;
+    uint64_t ticks;
+    double start_ns;
+    double ns;
+
+    /* Time the receivers of two modems talking to each other. Only the time spent in
+       the receivers counts. */
+    if (v34_init(&v34_caller, test_baud_rate, test_bps, true, true, v34_get_bit, &v34_caller, v34_perf_put_bit, &v34_caller) == NULL
+        ||
+        v34_init(&v34_answerer, test_baud_rate, test_bps, false, true, v34_get_bit, &v34_answerer, v34_perf_put_bit, &v34_answerer) == NULL)
+    {
+        fprintf(stderr, "    Cannot init V.34\n");
+        exit(2);
+    }
+    /*endif*/
+    chunks = seconds*SAMPLE_RATE/SAMPLES_PER_CHUNK;
+    ticks = 0;
+    ns = 0.0;
+    for (i = 0;  i < chunks;  i++)
+    {
+        samples = v34_tx(&v34_caller, caller_amp, SAMPLES_PER_CHUNK);
+        vec_zeroi16(&caller_amp[samples], SAMPLES_PER_CHUNK - samples);
+        samples = v34_tx(&v34_answerer, answerer_amp, SAMPLES_PER_CHUNK);
+        vec_zeroi16(&answerer_amp[samples], SAMPLES_PER_CHUNK - samples);
+        start_ns = now_ns();
+        start = rdtscll();
+        v34_rx(&v34_answerer, caller_amp, SAMPLES_PER_CHUNK);
+        v34_rx(&v34_caller, answerer_amp, SAMPLES_PER_CHUNK);
+        ticks += rdtscll() - start;
+        ns += now_ns() - start_ns;
+    }
+    /*endfor*/
+    samples = 2*chunks*SAMPLES_PER_CHUNK;
+    printf("V.34 receive, %d samples: %.1f ticks/sample, %.1f ns/sample, %.1f receivers per core\n",
+           samples,
+           (double) ticks/samples,
+           ns/samples,
+           (ns > 0.0)  ?  1.0e9*samples/(SAMPLE_RATE*ns)  :  0.0);
+
+    /* Time the decoding of mapping frames - Viterbi decoding, shell unmapping and
+       descrambling - with a little noise added to the 2D points. */
+    frames = seconds*test_baud_rate/8;
+    ticks = 0;
+    ns = 0.0;
+    perf_bits = 0;
+    for (i = 0;  i < frames;  i++)
+    {
+        v34_get_mapping_frame(&v34_answerer.tx, bits);
+        for (samples = 0;  samples < 16;  samples++)
+            bits[samples] += (rand() & 0x3F) - 0x20;
+        /*endfor*/
+        start_ns = now_ns();
+        start = rdtscll();
+        v34_put_mapping_frame(&v34_caller.rx, bits);
+        ticks += rdtscll() - start;
+        ns += now_ns() - start_ns;
+    }
+    /*endfor*/
+    printf("V.34 mapping frame decode, %d frames, %d bits: %.1f ticks/frame, %.1f ns/frame\n",
+           frames,
+           perf_bits,
+           (double) ticks/frames,
+           ns/frames);
+}
+/*- End of function --------------------------------------------------------*/
+
 int main(int argc, char *argv[])
 {
     v8_parms_t v8_call_parms;
@@ -519,6 +619,7 @@ int main(int argc, char *argv[])
     int residue;
     bool calling_party;
     bool test_4d;
+    bool test_perf;
     bool duplex;
     bool log_audio;
     logging_state_t *logging;
@@ -536,8 +637,9 @@ int main(int argc, char *argv[])
     log_audio = false;
     calling_party = true;
     test_4d = false;
+    test_perf = false;
     duplex = true;
-    while ((opt = getopt(argc, argv, "4a:b:B:c:d:D:e:ghlm:n:s:")) != -1)
+    while ((opt = getopt(argc, argv, "4a:b:B:c:d:D:e:ghlm:n:Ps:")) != -1)
     {
         switch (opt)
         {
@@ -614,6 +716,9 @@ int main(int argc, char *argv[])
         case 'n':
             noise_level = atoi(optarg);
             break;
+        case 'P':
+            test_perf = true;
+            break;
         case 's':
             signal_level = atoi(optarg);
             break;
@@ -625,6 +730,12 @@ int main(int argc, char *argv[])
         /*endswitch*/
     }
     /*endwhile*/
+    if (test_perf)
+    {
+        v34_rx_perf_tests(test_baud_rate, test_bps, 10);
+        exit(0);
+    }
+    /*endif*/
     if (test_4d)
     {
 #if 1
@@ -700,6 +700,15 @@ static int test_vec_scaledy_addf(void)
 
 int main(int argc, char *argv[])
 {
+    static const uint32_t feature_masks[] =
+    {
+        ~0U,
+        ~(SPAN_CPU_FEATURE_AVX512F | SPAN_CPU_FEATURE_AVX512BW),
+        ~(SPAN_CPU_FEATURE_AVX512F | SPAN_CPU_FEATURE_AVX512BW | SPAN_CPU_FEATURE_AVX2 | SPAN_CPU_FEATURE_AVX),
+        0
+    };
+    int i;
+
     test_vec_copyf();
     test_vec_negatef();
     test_vec_zerof();
@@ -710,8 +719,15 @@ int main(int argc, char *argv[])
     test_vec_scaledxy_addf();
     test_vec_scaledy_addf();
     test_vec_dot_prod();
-    test_vec_dot_prodf();
-    test_vec_lmsf();
+    /* Check every code path the run time dispatch might select on this machine */
+    for (i = 0;  i < 4;  i++)
+    {
+        printf("Using CPU features 0x%X\n", span_cpu_features_restrict(feature_masks[i]));
+        test_vec_dot_prodf();
+        test_vec_lmsf();
+    }
+    /*endfor*/
+    span_cpu_features_restrict(~0U);
 
     printf("Tests passed.\n");
     return 0;
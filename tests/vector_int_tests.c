@@ -183,11 +183,129 @@ static int test_vec_circular_dot_prodi16(void)
 }
 /*- End of function --------------------------------------------------------*/
 
+static void vec_lmsi16_dumb(const int16_t x[], int16_t y[], int n, int16_t error)
+{
+    int i;
+
+    for (i = 0;  i < n;  i++)
+        y[i] += (int16_t) (((int32_t) x[i]*(int32_t) error) >> 15);
+    /*endfor*/
+}
+/*- End of function --------------------------------------------------------*/
+
+static int test_vec_lmsi16(void)
+{
+    int i;
+    int j;
+    int16_t x[99];
+    int16_t ya[99];
+    int16_t yb[99];
+    int16_t error;
+
+    for (i = 0;  i < 99;  i++)
+    {
+        x[i] = rand();
+        ya[i] =
+        yb[i] = rand();
+    }
+    /*endfor*/
+    /* Make sure the extremes of the multiply are exercised */
+    x[0] = INT16_MIN;
+    x[17] = INT16_MAX;
+    x[42] = INT16_MIN;
+
+    for (i = 1;  i < 99;  i++)
+    {
+        error = (i == 42)  ?  INT16_MIN  :  rand();
+        vec_lmsi16(x, ya, i, error);
+        vec_lmsi16_dumb(x, yb, i, error);
+        for (j = 0;  j < 99;  j++)
+        {
+            if (ya[j] != yb[j])
+            {
+                printf("Tests failed\n");
+                exit(2);
+            }
+            /*endif*/
+        }
+        /*endfor*/
+    }
+    /*endfor*/
+    return 0;
+}
+/*- End of function --------------------------------------------------------*/
+
+static int test_vec_circular_lmsi16(void)
+{
+    int i;
+    int j;
+    int pos;
+    int len;
+    int16_t x[99];
+    int16_t ya[99];
+    int16_t yb[99];
+    int16_t error;
+
+    /* Verify that we can do circular sample buffer LMS updates of a linear coefficient
+       buffer properly. */
+    for (i = 0;  i < 99;  i++)
+    {
+        x[i] = rand();
+        ya[i] =
+        yb[i] = rand();
+    }
+    /*endfor*/
+
+    len = 95;
+    for (pos = 0;  pos < len;  pos++)
+    {
+        error = rand();
+        vec_circular_lmsi16(x, ya, len, pos, error);
+        for (i = 0;  i < len;  i++)
+        {
+            j = (pos + i) % len;
+            yb[i] += (int16_t) (((int32_t) x[j]*(int32_t) error) >> 15);
+        }
+        /*endfor*/
+        for (i = 0;  i < 99;  i++)
+        {
+            if (ya[i] != yb[i])
+            {
+                printf("Tests failed\n");
+                exit(2);
+            }
+            /*endif*/
+        }
+        /*endfor*/
+    }
+    /*endfor*/
+    return 0;
+}
+/*- End of function --------------------------------------------------------*/
+
 int main(int argc, char *argv[])
 {
-    test_vec_dot_prodi16();
+    static const uint32_t feature_masks[] =
+    {
+        ~0U,
+        ~(SPAN_CPU_FEATURE_AVX512F | SPAN_CPU_FEATURE_AVX512BW),
+        ~(SPAN_CPU_FEATURE_AVX512F | SPAN_CPU_FEATURE_AVX512BW | SPAN_CPU_FEATURE_AVX2),
+        0
+    };
+    int i;
+
+    /* Check every code path the run time dispatch might select on this machine */
+    for (i = 0;  i < 4;  i++)
+    {
+        printf("Using CPU features 0x%X\n", span_cpu_features_restrict(feature_masks[i]));
+        test_vec_dot_prodi16();
+        test_vec_circular_dot_prodi16();
+        test_vec_lmsi16();
+        test_vec_circular_lmsi16();
+    }
+    /*endfor*/
+    span_cpu_features_restrict(~0U);
     test_vec_min_maxi16();
-    test_vec_circular_dot_prodi16();
 
     printf("Tests passed.\n");
     return 0;